@@ -25,6 +25,10 @@ extern size_t peloton_data_file_size;
 
 extern int64_t peloton_wait_timeout;
 
+extern size_t peloton_log_segment_size;
+
+extern bool peloton_log_direct_io;
+
 namespace peloton {
 namespace benchmark {
 
@@ -49,6 +53,8 @@ void RunBenchmark() {
   peloton_logging_mode = state.logging_type;
   peloton_data_file_size = state.data_file_size;
   peloton_wait_timeout = state.wait_timeout;
+  peloton_log_segment_size = state.log_segment_size;
+  peloton_log_direct_io = state.direct_io;
 
   //===--------------------------------------------------------------------===//
   // WAL
@@ -33,6 +33,8 @@ void Usage(FILE* out) {
           "   -f --data-file-size    :  Data file size (MB) \n"
           "   -e --experiment_type   :  Experiment Type \n"
           "   -w --wait-timeout      :  Wait timeout (us) \n"
+          "   -s --segment-size      :  WAL segment size (MB), 0 = no segments \n"
+          "   -d --direct-io         :  Open WAL segments with O_DIRECT \n"
           "   -h --help              :  Print help message \n"
           "   -k --scale-factor      :  # of tuples \n"
           "   -t --transactions      :  # of transactions \n"
@@ -47,6 +49,8 @@ static struct option opts[] = {
     {"data-file-size", optional_argument, NULL, 'f'},
     {"experiment-type", optional_argument, NULL, 'e'},
     {"wait-timeout", optional_argument, NULL, 'w'},
+    {"segment-size", optional_argument, NULL, 's'},
+    {"direct-io", no_argument, NULL, 'd'},
     {"scale-factor", optional_argument, NULL, 'k'},
     {"transaction_count", optional_argument, NULL, 't'},
     {"update_ratio", optional_argument, NULL, 'u'},
@@ -85,6 +89,16 @@ static void ValidateWaitTimeout(const configuration& state) {
   LOG_INFO("wait_timeout :: %lu", state.wait_timeout);
 }
 
+static void ValidateLogSegmentSize(const configuration& state) {
+  if (state.direct_io && state.log_segment_size == 0) {
+    LOG_ERROR("Direct IO requires log segments (-s)");
+    exit(EXIT_FAILURE);
+  }
+
+  LOG_INFO("log_segment_size :: %lu", state.log_segment_size);
+  LOG_INFO("direct_io :: %d", state.direct_io);
+}
+
 static void ValidateLogFileDir(configuration& state) {
   struct stat data_stat;
 
@@ -135,6 +149,9 @@ void ParseArguments(int argc, char* argv[], configuration& state) {
   state.experiment_type = EXPERIMENT_TYPE_INVALID;
   state.wait_timeout = 200;
 
+  state.log_segment_size = 0;
+  state.direct_io = false;
+
   // Default Values
   ycsb::state.scale_factor = 1;
   ycsb::state.transaction_count = 10000;
@@ -145,7 +162,7 @@ void ParseArguments(int argc, char* argv[], configuration& state) {
   // Parse args
   while (1) {
     int idx = 0;
-    int c = getopt_long(argc, argv, "ahl:f:e:w:k:t:c:u:b:", opts, &idx);
+    int c = getopt_long(argc, argv, "ahl:f:e:w:s:dk:t:c:u:b:", opts, &idx);
 
     if (c == -1) break;
 
@@ -162,6 +179,12 @@ void ParseArguments(int argc, char* argv[], configuration& state) {
       case 'w':
         state.wait_timeout = atoi(optarg);
         break;
+      case 's':
+        state.log_segment_size = atoi(optarg);
+        break;
+      case 'd':
+        state.direct_io = true;
+        break;
 
         // YCSB
       case 'k':
@@ -195,6 +218,7 @@ void ParseArguments(int argc, char* argv[], configuration& state) {
   ValidateDataFileSize(state);
   ValidateLogFileDir(state);
   ValidateWaitTimeout(state);
+  ValidateLogSegmentSize(state);
   ValidateExperiment(state);
 
   // Print configuration
@@ -50,6 +50,12 @@ class configuration {
 
   // frequency with which the logger flushes
   int64_t wait_timeout;
+
+  // size of the preallocated WAL segments (in MB, 0 = growing log files)
+  size_t log_segment_size;
+
+  // open WAL segments with O_DIRECT
+  bool direct_io;
 };
 
 void Usage(FILE *out);
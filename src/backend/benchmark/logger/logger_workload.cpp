@@ -57,8 +57,55 @@ namespace logger {
 
 std::ofstream out("outputfile.summary");
 
+std::ofstream latency_out("outputfile.latency");
+
 size_t GetLogFileSize();
 
+/**
+ * @brief Report the commit latency distribution from the histogram of the
+ * backend loggers. Percentiles are upper bounds of power-of-two buckets.
+ */
+static void WriteCommitLatency(const std::vector<size_t> &histogram) {
+  size_t commit_count = 0;
+  for (auto bucket_count : histogram) {
+    commit_count += bucket_count;
+  }
+
+  if (commit_count == 0) {
+    return;
+  }
+
+  const std::vector<double> percentiles = {50, 90, 99, 99.9, 100};
+  std::vector<uint64_t> latencies;
+
+  size_t seen_count = 0;
+  size_t percentile_itr = 0;
+  for (size_t bucket = 0; bucket < histogram.size(); bucket++) {
+    seen_count += histogram[bucket];
+    while (percentile_itr < percentiles.size() &&
+           seen_count * 100.0 >= percentiles[percentile_itr] * commit_count) {
+      latencies.push_back(UINT64_C(1) << bucket);
+      percentile_itr++;
+    }
+  }
+
+  LOG_INFO("commit count : %lu", commit_count);
+  LOG_INFO("commit latency (us) p50 <= %lu p90 <= %lu p99 <= %lu "
+           "p99.9 <= %lu max <= %lu",
+           latencies[0], latencies[1], latencies[2], latencies[3],
+           latencies[4]);
+
+  latency_out << state.logging_type << " ";
+  latency_out << state.log_segment_size << " ";
+  latency_out << state.direct_io << " ";
+  latency_out << ycsb::state.backend_count << " ";
+  for (auto latency : latencies) {
+    latency_out << latency << " ";
+  }
+  latency_out << "\n";
+  latency_out.flush();
+}
+
 static void WriteOutput(double value) {
   LOG_INFO("----------------------------------------------------------\n");
   LOG_INFO("%d %f %d %d :: %lf",
@@ -74,6 +121,7 @@ static void WriteOutput(double value) {
   auto fsync_count = 0;
   if(frontend_logger != nullptr){
     fsync_count = frontend_logger->GetFsyncCount();
+    WriteCommitLatency(frontend_logger->GetCommitLatencyHistogram());
   }
 
   LOG_INFO("fsync count : %d", fsync_count);
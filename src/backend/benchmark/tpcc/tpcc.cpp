@@ -29,12 +29,20 @@ std::ofstream out("outputfile.summary");
 
 static void WriteOutput(double stat) {
   LOG_INFO("----------------------------------------------------------");
-  LOG_INFO("%d :: %lf tps",
+  LOG_INFO("%d %d :: %lf tps (%lf tps with aborts), %lf, %lf allocs/txn",
            state.scale_factor,
-           stat);
+           state.warehouse_count,
+           stat,
+           state.raw_throughput,
+           state.abort_rate,
+           state.allocation_rate);
 
   out << state.scale_factor << " ";
-  out << stat << "\n";
+  out << state.warehouse_count << " ";
+  out << stat << " ";
+  out << state.raw_throughput << " ";
+  out << state.abort_rate << " ";
+  out << state.allocation_rate << "\n";
   out.flush();
 }
 
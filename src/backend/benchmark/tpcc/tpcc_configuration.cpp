@@ -16,6 +16,9 @@
 
 #include "backend/benchmark/tpcc/tpcc_configuration.h"
 #include "backend/common/logger.h"
+#include "backend/common/numa.h"
+#include "backend/concurrency/transaction_manager_factory.h"
+#include "backend/storage/data_table.h"
 
 namespace peloton {
 namespace benchmark {
@@ -29,6 +32,19 @@ void Usage(FILE *out) {
           "   -w --warehouse_count   :  # of warehouses \n"
           "   -b --backend_count     :  # of backends \n"
           "   -t --transaction_count :  # of transactions \n"
+          "   -n --numa_placement    :  0 (default), 1 (local), 2 (interleave) \n"
+          "   -p --protocol          :  0 (optimistic, default), 1 (pessimistic), \n"
+          "                             2 (speculative read), 3 (eager write), \n"
+          "                             4 (timestamp ordering), 5 (ssi), \n"
+          "                             6 (hybrid), 7 (partitioned by \n"
+          "                             warehouse, a backend per warehouse), \n"
+          "                             8 (deterministic batches) \n"
+          "   -l --lock_policy       :  0 (no-wait, default), 1 (wait-die), \n"
+          "                             2 (wound-wait) \n"
+          "   -r --retry_policy      :  0 (immediate, default), 1 (backoff), \n"
+          "                             2 (backoff, queue on hot tuples) \n"
+          "   -a --active_tilegroup_count :  # of tile groups per table \n"
+          "                             taking inserts, 1 (default) \n"
           );
   exit(EXIT_FAILURE);
 }
@@ -38,6 +54,11 @@ static struct option opts[] = {
     {"warehouse_count", optional_argument, NULL, 'w'},
     {"backend_count", optional_argument, NULL, 'b'},
     {"transaction_count", optional_argument, NULL, 't'},
+    {"numa_placement", optional_argument, NULL, 'n'},
+    {"protocol", optional_argument, NULL, 'p'},
+    {"lock_policy", optional_argument, NULL, 'l'},
+    {"retry_policy", optional_argument, NULL, 'r'},
+    {"active_tilegroup_count", optional_argument, NULL, 'a'},
     {NULL, 0, NULL, 0}};
 
 void ValidateScaleFactor(const configuration &state) {
@@ -76,6 +97,56 @@ void ValidateWarehouseCount(const configuration &state) {
   LOG_INFO("%s : %d", "warehouse_count", state.warehouse_count);
 }
 
+void ValidateNumaPlacement(const configuration &state) {
+  if (state.numa_placement < NUMA_PLACEMENT_DEFAULT ||
+      state.numa_placement > NUMA_PLACEMENT_INTERLEAVE) {
+    LOG_ERROR("Invalid numa_placement :: %d", state.numa_placement);
+    exit(EXIT_FAILURE);
+  }
+
+  LOG_INFO("%s : %d", "numa_placement", state.numa_placement);
+}
+
+void ValidateProtocol(const configuration &state) {
+  if (state.protocol < CONCURRENCY_TYPE_OPTIMISTIC ||
+      state.protocol > CONCURRENCY_TYPE_DETERMINISTIC) {
+    LOG_ERROR("Invalid protocol :: %d", state.protocol);
+    exit(EXIT_FAILURE);
+  }
+
+  LOG_INFO("%s : %d", "protocol", state.protocol);
+}
+
+void ValidateLockPolicy(const configuration &state) {
+  if (state.lock_policy < LOCK_POLICY_NO_WAIT ||
+      state.lock_policy > LOCK_POLICY_WOUND_WAIT) {
+    LOG_ERROR("Invalid lock_policy :: %d", state.lock_policy);
+    exit(EXIT_FAILURE);
+  }
+
+  LOG_INFO("%s : %d", "lock_policy", state.lock_policy);
+}
+
+void ValidateRetryPolicy(const configuration &state) {
+  if (state.retry_policy < RETRY_POLICY_IMMEDIATE ||
+      state.retry_policy > RETRY_POLICY_QUEUE) {
+    LOG_ERROR("Invalid retry_policy :: %d", state.retry_policy);
+    exit(EXIT_FAILURE);
+  }
+
+  LOG_INFO("%s : %d", "retry_policy", state.retry_policy);
+}
+
+void ValidateActiveTileGroupCount(const configuration &state) {
+  if (state.active_tilegroup_count <= 0) {
+    LOG_ERROR("Invalid active_tilegroup_count :: %d",
+              state.active_tilegroup_count);
+    exit(EXIT_FAILURE);
+  }
+
+  LOG_INFO("%s : %d", "active_tilegroup_count", state.active_tilegroup_count);
+}
+
 void ParseArguments(int argc, char *argv[], configuration &state) {
 
   // Default Values
@@ -83,11 +154,16 @@ void ParseArguments(int argc, char *argv[], configuration &state) {
   state.warehouse_count = 1;
   state.transaction_count = 100;
   state.scale_factor = 1;
+  state.numa_placement = NUMA_PLACEMENT_DEFAULT;
+  state.protocol = CONCURRENCY_TYPE_OPTIMISTIC;
+  state.lock_policy = LOCK_POLICY_NO_WAIT;
+  state.retry_policy = RETRY_POLICY_IMMEDIATE;
+  state.active_tilegroup_count = 1;
 
   // Parse args
   while (1) {
     int idx = 0;
-    int c = getopt_long(argc, argv, "ah:k:w:b:t:", opts, &idx);
+    int c = getopt_long(argc, argv, "a:hk:w:b:t:n:p:l:r:", opts, &idx);
 
     if (c == -1) break;
 
@@ -108,6 +184,26 @@ void ParseArguments(int argc, char *argv[], configuration &state) {
         state.transaction_count = atoi(optarg);
         break;
 
+      case 'n':
+        state.numa_placement = atoi(optarg);
+        break;
+
+      case 'p':
+        state.protocol = atoi(optarg);
+        break;
+
+      case 'l':
+        state.lock_policy = atoi(optarg);
+        break;
+
+      case 'r':
+        state.retry_policy = atoi(optarg);
+        break;
+
+      case 'a':
+        state.active_tilegroup_count = atoi(optarg);
+        break;
+
       case 'h':
         Usage(stderr);
         exit(EXIT_FAILURE);
@@ -131,6 +227,41 @@ void ParseArguments(int argc, char *argv[], configuration &state) {
   ValidateWarehouseCount(state);
   ValidateScaleFactor(state);
   ValidateTransactionCount(state);
+  ValidateNumaPlacement(state);
+  ValidateProtocol(state);
+  ValidateLockPolicy(state);
+  ValidateRetryPolicy(state);
+  ValidateActiveTileGroupCount(state);
+
+  peloton_numa_placement = (NumaPlacementType)state.numa_placement;
+  peloton_active_tilegroup_count = state.active_tilegroup_count;
+
+  concurrency::TransactionManagerFactory::Configure(
+      (ConcurrencyType)state.protocol, ISOLATION_LEVEL_TYPE_FULL,
+      (LockPolicyType)state.lock_policy);
+
+  concurrency::ContentionManager::GetInstance().SetRetryPolicy(
+      (RetryPolicyType)state.retry_policy);
+
+  // A partition per warehouse, the items are read by every warehouse
+  if (state.protocol == CONCURRENCY_TYPE_PARTITIONED) {
+    auto &txn_manager = concurrency::PartitionedTxnManager::GetInstance();
+    txn_manager.SetPartitionCount(state.warehouse_count);
+    txn_manager.SetPartitionColumn(warehouse_table_oid, 0);   // W_ID
+    txn_manager.SetPartitionColumn(district_table_oid, 1);    // D_W_ID
+    txn_manager.SetPartitionColumn(customer_table_oid, 2);    // C_W_ID
+    txn_manager.SetPartitionColumn(history_table_oid, 4);     // H_W_ID
+    txn_manager.SetPartitionColumn(stock_table_oid, 1);       // S_W_ID
+    txn_manager.SetPartitionColumn(orders_table_oid, 3);      // O_W_ID
+    txn_manager.SetPartitionColumn(new_order_table_oid, 2);   // NO_W_ID
+    txn_manager.SetPartitionColumn(order_line_table_oid, 2);  // OL_W_ID
+  }
+
+  // A batch closes once every backend is in it
+  if (state.protocol == CONCURRENCY_TYPE_DETERMINISTIC) {
+    concurrency::DeterministicTxnManager::GetInstance().SetBatchSize(
+        std::min(state.backend_count, DETERMINISTIC_BATCH_MAX_SIZE));
+  }
 
 }
 
@@ -78,6 +78,30 @@ class configuration {
   int customers_per_district;
 
   int new_orders_per_district;
+
+  // placement of the tile groups, also pins the backends if set
+  int numa_placement;
+
+  // concurrency control protocol
+  int protocol;
+
+  // what pessimistic transactions do on lock conflicts
+  int lock_policy;
+
+  // what aborted transactions do before they run again
+  int retry_policy;
+
+  // # of tile groups per table that take inserts concurrently
+  int active_tilegroup_count;
+
+  // # of aborts per committed transaction
+  double abort_rate;
+
+  // # of transactions run per second, the aborted ones included
+  double raw_throughput;
+
+  // # of objects the transaction managers allocated per transaction
+  double allocation_rate;
 };
 
 extern configuration state;
@@ -90,6 +114,16 @@ void ValidateWarehouseCount(const configuration &state);
 
 void ValidateTransactionCount(const configuration &state);
 
+void ValidateNumaPlacement(const configuration &state);
+
+void ValidateProtocol(const configuration &state);
+
+void ValidateLockPolicy(const configuration &state);
+
+void ValidateRetryPolicy(const configuration &state);
+
+void ValidateActiveTileGroupCount(const configuration &state);
+
 void ParseArguments(int argc, char *argv[], configuration &state);
 
 }  // namespace tpcc
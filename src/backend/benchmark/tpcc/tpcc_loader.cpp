@@ -18,11 +18,13 @@
 #include <iostream>
 #include <ctime>
 #include <cassert>
+#include <random>
 
 #include "backend/benchmark/tpcc/tpcc_loader.h"
 #include "backend/benchmark/tpcc/tpcc_configuration.h"
 #include "backend/catalog/manager.h"
 #include "backend/catalog/schema.h"
+#include "backend/common/logger.h"
 #include "backend/concurrency/transaction.h"
 #include "backend/concurrency/transaction_manager_factory.h"
 #include "backend/executor/abstract_executor.h"
@@ -1252,135 +1254,101 @@ std::unique_ptr<storage::Tuple> BuildStockTuple(const int stock_id,
   return stock_tuple;
 }
 
-void LoadItems() {
+// Tuples of a table waiting to be bulk loaded
+typedef std::vector<std::unique_ptr<storage::Tuple>> TupleBatch;
+
+static void BulkLoad(storage::DataTable *table, TupleBatch &tuples) {
+  table->BulkInsertTuples(tuples);
+  tuples.clear();
+}
 
-  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
-  auto txn = txn_manager.BeginTransaction();
+void LoadItems() {
   std::unique_ptr<VarlenPool> pool(new VarlenPool(BACKEND_TYPE_MM));
-  std::unique_ptr<executor::ExecutorContext> context(
-      new executor::ExecutorContext(txn));
+  TupleBatch item_tuples;
 
   for (auto item_itr = 0; item_itr < state.item_count; item_itr++) {
-
-    auto item_tuple = BuildItemTuple(item_itr, pool);
-    planner::InsertPlan node(item_table, std::move(item_tuple));
-    executor::InsertExecutor executor(&node, context.get());
-    executor.Execute();
+    item_tuples.push_back(BuildItemTuple(item_itr, pool));
   }
 
-  txn_manager.CommitTransaction();
+  BulkLoad(item_table, item_tuples);
 }
 
 void LoadWarehouses() {
-  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
-  std::unique_ptr<executor::ExecutorContext> context;
+  TupleBatch warehouse_tuples, district_tuples, customer_tuples,
+      history_tuples, orders_tuples, new_order_tuples, order_line_tuples,
+      stock_tuples;
 
   // WAREHOUSES
   for (auto warehouse_itr = 0; warehouse_itr < state.warehouse_count; warehouse_itr++) {
     std::unique_ptr<VarlenPool> pool(new VarlenPool(BACKEND_TYPE_MM));
 
-    auto txn = txn_manager.BeginTransaction();
-    context.reset(new executor::ExecutorContext(txn));
-
-    auto warehouse_tuple = BuildWarehouseTuple(warehouse_itr, pool);
-    planner::InsertPlan warehouse_node(warehouse_table, std::move(warehouse_tuple));
-    executor::InsertExecutor warehouse_executor(&warehouse_node, context.get());
-    warehouse_executor.Execute();
-
-    txn_manager.CommitTransaction();
+    warehouse_tuples.push_back(BuildWarehouseTuple(warehouse_itr, pool));
 
     // DISTRICTS
     for (auto district_itr = 0; district_itr < state.districts_per_warehouse; district_itr++) {
-      auto txn = txn_manager.BeginTransaction();
-      context.reset(new executor::ExecutorContext(txn));
-
-      auto district_tuple = BuildDistrictTuple(district_itr, warehouse_itr, pool);
-      planner::InsertPlan district_node(district_table, std::move(district_tuple));
-      executor::InsertExecutor district_executor(&district_node, context.get());
-      district_executor.Execute();
-
-      txn_manager.CommitTransaction();
+      district_tuples.push_back(BuildDistrictTuple(district_itr, warehouse_itr, pool));
 
       // CUSTOMERS
       for (auto customer_itr = 0; customer_itr < state.customers_per_district; customer_itr++) {
-        auto txn = txn_manager.BeginTransaction();
-        context.reset(new executor::ExecutorContext(txn));
-
-        auto customer_tuple = BuildCustomerTuple(customer_itr, district_itr, warehouse_itr, pool);
-        planner::InsertPlan customer_node(customer_table, std::move(customer_tuple));
-        executor::InsertExecutor customer_executor(&customer_node, context.get());
-        customer_executor.Execute();
+        customer_tuples.push_back(
+            BuildCustomerTuple(customer_itr, district_itr, warehouse_itr, pool));
 
         // HISTORY
 
         int history_district_id = district_itr;
         int history_warehouse_id = warehouse_itr;
-        auto history_tuple = BuildHistoryTuple(customer_itr, district_itr, warehouse_itr,
-                                               history_district_id, history_warehouse_id, pool);
-        planner::InsertPlan history_node(history_table, std::move(history_tuple));
-        executor::InsertExecutor history_executor(&history_node, context.get());
-        history_executor.Execute();
-
-        txn_manager.CommitTransaction();
+        history_tuples.push_back(
+            BuildHistoryTuple(customer_itr, district_itr, warehouse_itr,
+                              history_district_id, history_warehouse_id, pool));
 
       } // END CUSTOMERS
 
 
       // ORDERS
       for(auto orders_itr = 0; orders_itr < state.customers_per_district; orders_itr++) {
-        auto txn = txn_manager.BeginTransaction();
-        context.reset(new executor::ExecutorContext(txn));
-
         // New order ?
         auto new_order_threshold = state.customers_per_district-new_orders_per_district;
         bool new_order = (orders_itr > new_order_threshold);
         auto o_ol_cnt = GetRandomInteger(orders_min_ol_cnt, orders_max_ol_cnt);
 
-        auto orders_tuple = BuildOrdersTuple(orders_itr, district_itr, warehouse_itr,
-                                             new_order, o_ol_cnt);
-        planner::InsertPlan orders_node(orders_table, std::move(orders_tuple));
-        executor::InsertExecutor orders_executor(&orders_node, context.get());
-        orders_executor.Execute();
+        orders_tuples.push_back(BuildOrdersTuple(orders_itr, district_itr, warehouse_itr,
+                                                 new_order, o_ol_cnt));
 
         // NEW_ORDER
         if(new_order){
-          auto new_order_tuple = BuildNewOrderTuple(orders_itr, district_itr, warehouse_itr);
-          planner::InsertPlan new_order_node(new_order_table, std::move(new_order_tuple));
-          executor::InsertExecutor new_order_executor(&new_order_node, context.get());
-          new_order_executor.Execute();
+          new_order_tuples.push_back(
+              BuildNewOrderTuple(orders_itr, district_itr, warehouse_itr));
         }
 
         // ORDER_LINE
         for (auto order_line_itr = 0; order_line_itr < o_ol_cnt; order_line_itr++) {
 
           int ol_supply_w_id = warehouse_itr;
-          auto order_line_tuple = BuildOrderLineTuple(orders_itr, district_itr, warehouse_itr,
-                                                      order_line_itr, ol_supply_w_id, new_order, pool);
-          planner::InsertPlan order_line_node(order_line_table, std::move(order_line_tuple));
-          executor::InsertExecutor order_line_executor(&order_line_node, context.get());
-          order_line_executor.Execute();
+          order_line_tuples.push_back(
+              BuildOrderLineTuple(orders_itr, district_itr, warehouse_itr,
+                                  order_line_itr, ol_supply_w_id, new_order, pool));
         }
 
-        txn_manager.CommitTransaction();
-
       }
 
     } // END DISTRICTS
 
     // STOCK
     for(auto stock_itr = 0; stock_itr < state.item_count; stock_itr++) {
-      auto txn = txn_manager.BeginTransaction();
-      context.reset(new executor::ExecutorContext(txn));
-
       int s_w_id = warehouse_itr;
-      auto stock_tuple = BuildStockTuple(stock_itr, s_w_id, pool);
-      planner::InsertPlan stock_node(stock_table, std::move(stock_tuple));
-      executor::InsertExecutor stock_executor(&stock_node, context.get());
-      stock_executor.Execute();
-
-      txn_manager.CommitTransaction();
+      stock_tuples.push_back(BuildStockTuple(stock_itr, s_w_id, pool));
     }
 
+    // The tuples are copied out before the pool goes away
+    BulkLoad(warehouse_table, warehouse_tuples);
+    BulkLoad(district_table, district_tuples);
+    BulkLoad(customer_table, customer_tuples);
+    BulkLoad(history_table, history_tuples);
+    BulkLoad(orders_table, orders_tuples);
+    BulkLoad(new_order_table, new_order_tuples);
+    BulkLoad(order_line_table, order_line_tuples);
+    BulkLoad(stock_table, stock_tuples);
+
   } // END WAREHOUSES
 
 }
@@ -1391,6 +1359,18 @@ void LoadTPCCDatabase() {
 
   LoadWarehouses();
 
+  // Build the indexes once all the tuples are in
+  std::vector<storage::DataTable *> tables = {
+      warehouse_table, district_table, item_table,
+      customer_table, history_table, stock_table,
+      orders_table, new_order_table, order_line_table};
+  for (auto table : tables) {
+    if (table->BuildIndexes() == false) {
+      LOG_ERROR("Failed to build the indexes of table %s",
+                table->GetName().c_str());
+    }
+  }
+
 }
 
 
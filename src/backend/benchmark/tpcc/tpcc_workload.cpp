@@ -38,6 +38,8 @@
 #include "backend/common/logger.h"
 #include "backend/common/timer.h"
 #include "backend/common/generator.h"
+#include "backend/common/numa.h"
+#include "backend/common/value_peeker.h"
 
 #include "backend/concurrency/transaction.h"
 #include "backend/concurrency/transaction_manager_factory.h"
@@ -78,15 +80,17 @@ namespace tpcc {
 // TRANSACTION TYPES
 /////////////////////////////////////////////////////////
 
-void RunStockLevel();
+// Each returns false if the transaction aborted
 
-void RunDelivery();
+bool RunStockLevel();
 
-void RunOrderStatus();
+bool RunDelivery();
 
-void RunPayment();
+bool RunOrderStatus();
 
-void RunNewOrder();
+bool RunPayment();
+
+bool RunNewOrder();
 
 /////////////////////////////////////////////////////////
 // WORKLOAD
@@ -94,11 +98,42 @@ void RunNewOrder();
 
 std::vector<double> durations;
 
+std::vector<oid_t> abort_counts;
+
+// Under the partitioned protocol each backend runs the transactions of its
+// home warehouse, so that it is the only one using that partition. -1 if the
+// warehouses are picked at random.
+thread_local int home_warehouse_id = -1;
+
+// Keys the deterministic protocol locks, one per warehouse, district and
+// stock row
+oid_t GetWarehouseKey(const int warehouse_id) { return warehouse_id; }
+
+oid_t GetDistrictKey(const int warehouse_id, const int district_id) {
+  return state.warehouse_count +
+         warehouse_id * state.districts_per_warehouse + district_id;
+}
+
+oid_t GetStockKey(const int warehouse_id, const int item_id) {
+  return state.warehouse_count * (1 + state.districts_per_warehouse) +
+         warehouse_id * (state.item_count + 1) + item_id;
+}
+
 void RunBackend(oid_t thread_id) {
+  if (state.numa_placement != NUMA_PLACEMENT_DEFAULT) {
+    NumaManager::GetInstance().PinThread(thread_id);
+  }
+
   auto txn_count = state.transaction_count;
+  oid_t abort_count = 0;
+
+  if (state.protocol == CONCURRENCY_TYPE_PARTITIONED) {
+    home_warehouse_id = thread_id % state.warehouse_count;
+  }
 
   UniformGenerator generator;
   Timer<> timer;
+  auto &contention_manager = concurrency::ContentionManager::GetInstance();
 
   // Start timer
   timer.Reset();
@@ -108,16 +143,17 @@ void RunBackend(oid_t thread_id) {
   for (oid_t txn_itr = 0; txn_itr < txn_count; txn_itr++) {
     auto rng_val = generator.GetSample();
 
+    // Aborted transactions are retried until they commit
     if (rng_val <= 0.04) {
-      RunStockLevel();
+      abort_count += contention_manager.RunWithRetry(RunStockLevel);
     } else if (rng_val <= 0.08) {
-      RunDelivery();
+      abort_count += contention_manager.RunWithRetry(RunDelivery);
     } else if (rng_val <= 0.12) {
-      RunOrderStatus();
+      abort_count += contention_manager.RunWithRetry(RunOrderStatus);
     } else if (rng_val <= 0.55) {
-      RunPayment();
+      abort_count += contention_manager.RunWithRetry(RunPayment);
     } else {
-      RunNewOrder();
+      abort_count += contention_manager.RunWithRetry(RunNewOrder);
     }
 
   }
@@ -127,6 +163,7 @@ void RunBackend(oid_t thread_id) {
 
   // Set duration
   durations[thread_id] = timer.GetDuration();
+  abort_counts[thread_id] = abort_count;
 }
 
 double RunWorkload() {
@@ -136,6 +173,9 @@ double RunWorkload() {
   oid_t num_threads = state.backend_count;
   double max_duration = std::numeric_limits<double>::min();
   durations.reserve(num_threads);
+  abort_counts.resize(num_threads, 0);
+  auto allocation_count =
+      concurrency::TransactionManagerFactory::GetAllocationCount();
 
   // Launch a group of threads
   for (oid_t thread_itr = 0; thread_itr < num_threads; ++thread_itr) {
@@ -154,6 +194,25 @@ double RunWorkload() {
 
   double throughput = (state.transaction_count * num_threads)/max_duration;
 
+  // # of aborts per committed transaction
+  oid_t total_abort_count = 0;
+  for (oid_t thread_itr = 0; thread_itr < num_threads; ++thread_itr) {
+    total_abort_count += abort_counts[thread_itr];
+  }
+  state.abort_rate =
+      total_abort_count * 1.0 / (state.transaction_count * num_threads);
+  state.raw_throughput =
+      (state.transaction_count * num_threads + total_abort_count) /
+      max_duration;
+
+  // # of allocations per transaction, aborted ones included
+  allocation_count =
+      concurrency::TransactionManagerFactory::GetAllocationCount() -
+      allocation_count;
+  state.allocation_rate =
+      allocation_count * 1.0 /
+      (state.transaction_count * num_threads + total_abort_count);
+
   return throughput;
 }
 
@@ -383,7 +442,7 @@ ExecuteTest(executor::AbstractExecutor* executor) {
   return std::move(logical_tile_values);
 }
 
-void RunNewOrder(){
+bool RunNewOrder(){
   /*
      "NEW_ORDER": {
      "getWarehouseTaxRate": "SELECT W_TAX FROM WAREHOUSE WHERE W_ID = ?", # w_id
@@ -401,7 +460,9 @@ void RunNewOrder(){
 
   LOG_INFO("-------------------------------------");
 
-  int warehouse_id = GetRandomInteger(0, state.warehouse_count - 1);
+  int warehouse_id = (home_warehouse_id >= 0)
+                         ? home_warehouse_id
+                         : GetRandomInteger(0, state.warehouse_count - 1);
   int district_id = GetRandomInteger(0, state.districts_per_warehouse - 1);
   //int customer_id = GetRandomInteger(0, state.customers_per_district);
   int o_ol_cnt = GetRandomInteger(orders_min_ol_cnt, orders_max_ol_cnt);
@@ -424,7 +485,21 @@ void RunNewOrder(){
   }
 
   auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
-  auto txn = txn_manager.BeginTransaction();
+  concurrency::Transaction *txn = nullptr;
+  if (state.protocol == CONCURRENCY_TYPE_DETERMINISTIC) {
+    // The stock rows of the order lines are declared as well
+    std::vector<oid_t> read_keys = {GetWarehouseKey(warehouse_id)};
+    std::vector<oid_t> write_keys = {GetDistrictKey(warehouse_id, district_id)};
+    for (auto ol_itr = 0; ol_itr < o_ol_cnt; ol_itr++) {
+      write_keys.push_back(GetStockKey(i_w_ids[ol_itr], i_ids[ol_itr]));
+    }
+    txn = txn_manager.BeginDeterministicTransaction(read_keys, write_keys);
+  } else {
+    // The supplying warehouses make the transaction multi-partition
+    std::vector<oid_t> partition_keys(i_w_ids.begin(), i_w_ids.end());
+    partition_keys.push_back(warehouse_id);
+    txn = txn_manager.BeginPartitionedTransaction(partition_keys);
+  }
   std::unique_ptr<VarlenPool> pool(new VarlenPool(BACKEND_TYPE_MM));
   std::unique_ptr<executor::ExecutorContext> context(
       new executor::ExecutorContext(txn));
@@ -460,7 +535,7 @@ void RunNewOrder(){
   if(gwtr_lists_values.empty() == true) {
     LOG_ERROR("getWarehouseTaxRate failed");
     txn_manager.AbortTransaction();
-    return;
+    return false;
   }
 
   auto w_tax = gwtr_lists_values[0][0];
@@ -500,7 +575,7 @@ void RunNewOrder(){
   if(gd_lists_values.empty() == true) {
     LOG_ERROR("getDistrict failed");
     txn_manager.AbortTransaction();
-    return;
+    return false;
   }
 
   auto d_tax = gd_lists_values[0][0];
@@ -510,11 +585,54 @@ void RunNewOrder(){
 
   // incrementNextOrderId
 
-  txn_manager.CommitTransaction();
+  // The update reads the whole row again
+  std::vector<oid_t> district_update_column_ids;
+  for (oid_t col_itr = 0; col_itr <= 10; col_itr++) {
+    district_update_column_ids.push_back(col_itr);
+  }
+
+  planner::IndexScanPlan district_update_index_scan_node(
+      district_table, predicate, district_update_column_ids,
+      district_index_scan_desc);
+  executor::IndexScanExecutor district_update_index_scan_executor(
+      &district_update_index_scan_node, context.get());
+
+  planner::ProjectInfo::TargetList district_target_list;
+  planner::ProjectInfo::DirectMapList district_direct_map_list;
+
+  // Update D_NEXT_O_ID
+  for (oid_t col_itr = 0; col_itr < 10; col_itr++) {
+    district_direct_map_list.emplace_back(col_itr,
+                                          std::pair<oid_t, oid_t>(0, col_itr));
+  }
+  Value district_update_val = ValueFactory::GetIntegerValue(
+      ValuePeeker::PeekInteger(d_next_o_id) + 1);
+  district_target_list.emplace_back(
+      10, expression::ExpressionUtil::ConstantValueFactory(district_update_val));
+
+  std::unique_ptr<const planner::ProjectInfo> district_project_info(
+      new planner::ProjectInfo(std::move(district_target_list),
+                               std::move(district_direct_map_list)));
+  planner::UpdatePlan district_update_node(district_table,
+                                           std::move(district_project_info));
+
+  executor::UpdateExecutor district_update_executor(&district_update_node,
+                                                    context.get());
+  district_update_executor.AddChild(&district_update_index_scan_executor);
+
+  ExecuteTest(&district_update_executor);
+
+  if (txn->GetResult() != Result::RESULT_SUCCESS) {
+    LOG_TRACE("incrementNextOrderId failed");
+    txn_manager.AbortTransaction();
+    return false;
+  }
 
+  auto result = txn_manager.CommitTransaction();
+  return (result == Result::RESULT_SUCCESS);
 }
 
-void RunPayment(){
+bool RunPayment(){
   /*
      "PAYMENT": {
      "getWarehouse": "SELECT W_NAME, W_STREET_1, W_STREET_2, W_CITY, W_STATE, W_ZIP FROM WAREHOUSE WHERE W_ID = ?", # w_id
@@ -529,9 +647,10 @@ void RunPayment(){
      }
    */
 
+  return true;
 }
 
-void RunOrderStatus(){
+bool RunOrderStatus(){
   /*
     "ORDER_STATUS": {
     "getCustomerByCustomerId": "SELECT C_ID, C_FIRST, C_MIDDLE, C_LAST, C_BALANCE FROM CUSTOMER WHERE C_W_ID = ? AND C_D_ID = ? AND C_ID = ?", # w_id, d_id, c_id
@@ -541,9 +660,10 @@ void RunOrderStatus(){
     }
    */
 
+  return true;
 }
 
-void RunDelivery(){
+bool RunDelivery(){
   /*
    "DELIVERY": {
    "getNewOrder": "SELECT NO_O_ID FROM NEW_ORDER WHERE NO_D_ID = ? AND NO_W_ID = ? AND NO_O_ID > -1 LIMIT 1", #
@@ -556,9 +676,10 @@ void RunDelivery(){
    }
    */
 
+  return true;
 }
 
-void RunStockLevel() {
+bool RunStockLevel() {
   /*
      "STOCK_LEVEL": {
      "getOId": "SELECT D_NEXT_O_ID FROM DISTRICT WHERE D_W_ID = ? AND D_ID = ?",
@@ -566,6 +687,7 @@ void RunStockLevel() {
      }
    */
 
+  return true;
 }
 
 }  // namespace tpcc
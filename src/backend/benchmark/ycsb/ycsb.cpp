@@ -30,8 +30,10 @@ std::ofstream out("outputfile.summary", std::ofstream::out);
 
 static void WriteOutput() {
   LOG_INFO("----------------------------------------------------------");
-  LOG_INFO("%lf %d %d :: %lf tps, %lf", state.update_ratio, state.scale_factor,
-           state.column_count, state.throughput, state.abort_rate);
+  LOG_INFO("%lf %d %d :: %lf tps (%lf tps with aborts), %lf, %lf allocs/txn",
+           state.update_ratio, state.scale_factor, state.column_count,
+           state.throughput, state.raw_throughput, state.abort_rate,
+           state.allocation_rate);
 
   out << state.update_ratio << " ";
   out << state.scale_factor << " ";
@@ -48,7 +50,9 @@ static void WriteOutput() {
   }
 
   out << state.throughput << " ";
-  out << state.abort_rate << "\n";
+  out << state.raw_throughput << " ";
+  out << state.abort_rate << " ";
+  out << state.allocation_rate << "\n";
   out.flush();
   out.close();
 }
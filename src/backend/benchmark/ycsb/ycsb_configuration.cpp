@@ -17,6 +17,9 @@
 
 #include "backend/benchmark/ycsb/ycsb_configuration.h"
 #include "backend/common/logger.h"
+#include "backend/common/numa.h"
+#include "backend/concurrency/contention_manager.h"
+#include "backend/storage/data_table.h"
 
 namespace peloton {
 namespace benchmark {
@@ -30,7 +33,12 @@ void Usage(FILE *out) {
                "   -s --snapshot_duration :  snapshot duration \n"
                "   -c --column_count      :  # of columns \n"
                "   -u --write_ratio       :  Fraction of updates \n"
-               "   -b --backend_count     :  # of backends \n");
+               "   -b --backend_count     :  # of backends \n"
+               "   -n --numa_placement    :  0 (default), 1 (local), 2 (interleave) \n"
+               "   -r --retry_policy      :  0 (immediate, default), 1 (backoff), \n"
+               "                             2 (backoff, queue on hot tuples) \n"
+               "   -a --active_tilegroup_count :  # of tile groups per table \n"
+               "                             taking inserts, 1 (default) \n");
   exit(EXIT_FAILURE);
 }
 
@@ -40,7 +48,11 @@ static struct option opts[] = {
   { "snapshot_duration", optional_argument, NULL, 's' },
   { "column_count", optional_argument, NULL, 'c' },
   { "update_ratio", optional_argument, NULL, 'u' },
-  { "backend_count", optional_argument, NULL, 'b' }, { NULL, 0, NULL, 0 }
+  { "backend_count", optional_argument, NULL, 'b' },
+  { "numa_placement", optional_argument, NULL, 'n' },
+  { "retry_policy", optional_argument, NULL, 'r' },
+  { "active_tilegroup_count", optional_argument, NULL, 'a' },
+  { NULL, 0, NULL, 0 }
 };
 
 void ValidateScaleFactor(const configuration &state) {
@@ -97,6 +109,36 @@ void ValidateSnapshotDuration(const configuration &state) {
   LOG_INFO("%s : %lf", "snapshot_duration", state.snapshot_duration);
 }
 
+void ValidateNumaPlacement(const configuration &state) {
+  if (state.numa_placement < NUMA_PLACEMENT_DEFAULT ||
+      state.numa_placement > NUMA_PLACEMENT_INTERLEAVE) {
+    LOG_ERROR("Invalid numa_placement :: %d", state.numa_placement);
+    exit(EXIT_FAILURE);
+  }
+
+  LOG_INFO("%s : %d", "numa_placement", state.numa_placement);
+}
+
+void ValidateRetryPolicy(const configuration &state) {
+  if (state.retry_policy < RETRY_POLICY_IMMEDIATE ||
+      state.retry_policy > RETRY_POLICY_QUEUE) {
+    LOG_ERROR("Invalid retry_policy :: %d", state.retry_policy);
+    exit(EXIT_FAILURE);
+  }
+
+  LOG_INFO("%s : %d", "retry_policy", state.retry_policy);
+}
+
+void ValidateActiveTileGroupCount(const configuration &state) {
+  if (state.active_tilegroup_count <= 0) {
+    LOG_ERROR("Invalid active_tilegroup_count :: %d",
+              state.active_tilegroup_count);
+    exit(EXIT_FAILURE);
+  }
+
+  LOG_INFO("%s : %d", "active_tilegroup_count", state.active_tilegroup_count);
+}
+
 void ParseArguments(int argc, char *argv[], configuration &state) {
 
   // Default Values
@@ -106,11 +148,14 @@ void ParseArguments(int argc, char *argv[], configuration &state) {
   state.column_count = 10;
   state.update_ratio = 0.5;
   state.backend_count = 2;
+  state.numa_placement = NUMA_PLACEMENT_DEFAULT;
+  state.retry_policy = RETRY_POLICY_IMMEDIATE;
+  state.active_tilegroup_count = 1;
 
   // Parse args
   while (1) {
     int idx = 0;
-    int c = getopt_long(argc, argv, "ahk:d:s:c:u:b:", opts, &idx);
+    int c = getopt_long(argc, argv, "a:hk:d:s:c:u:b:n:r:", opts, &idx);
 
     if (c == -1) break;
 
@@ -133,6 +178,15 @@ void ParseArguments(int argc, char *argv[], configuration &state) {
       case 'b':
         state.backend_count = atoi(optarg);
         break;
+      case 'n':
+        state.numa_placement = atoi(optarg);
+        break;
+      case 'r':
+        state.retry_policy = atoi(optarg);
+        break;
+      case 'a':
+        state.active_tilegroup_count = atoi(optarg);
+        break;
       case 'h':
         Usage(stderr);
         exit(EXIT_FAILURE);
@@ -152,6 +206,15 @@ void ParseArguments(int argc, char *argv[], configuration &state) {
   ValidateBackendCount(state);
   ValidateDuration(state);
   ValidateSnapshotDuration(state);
+  ValidateNumaPlacement(state);
+  ValidateRetryPolicy(state);
+  ValidateActiveTileGroupCount(state);
+
+  peloton_numa_placement = (NumaPlacementType)state.numa_placement;
+  peloton_active_tilegroup_count = state.active_tilegroup_count;
+
+  concurrency::ContentionManager::GetInstance().SetRetryPolicy(
+      (RetryPolicyType)state.retry_policy);
 
 }
 
@@ -55,14 +55,29 @@ class configuration {
   // number of backends
   int backend_count;
 
+  // placement of the tile groups, also pins the backends if set
+  int numa_placement;
+
+  // what aborted transactions do before they run again
+  int retry_policy;
+
+  // # of tile groups per table that take inserts concurrently
+  int active_tilegroup_count;
+
   std::vector<double> snapshot_throughput;
 
   std::vector<double> snapshot_abort_rate;
 
   double throughput;
 
+  // # of transactions run per second, the aborted ones included
+  double raw_throughput;
+
   double abort_rate;
 
+  // # of objects the transaction managers allocated per transaction
+  double allocation_rate;
+
 };
 
 extern configuration state;
@@ -81,6 +96,12 @@ void ValidateDuration(const configuration &state);
 
 void ValidateSnapshotDuration(const configuration &state);
 
+void ValidateNumaPlacement(const configuration &state);
+
+void ValidateRetryPolicy(const configuration &state);
+
+void ValidateActiveTileGroupCount(const configuration &state);
+
 void ParseArguments(int argc, char *argv[], configuration &state);
 
 }  // namespace ycsb
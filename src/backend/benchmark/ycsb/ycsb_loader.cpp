@@ -23,6 +23,7 @@
 #include "backend/benchmark/ycsb/ycsb_configuration.h"
 #include "backend/catalog/manager.h"
 #include "backend/catalog/schema.h"
+#include "backend/common/logger.h"
 #include "backend/concurrency/transaction.h"
 #include "backend/concurrency/transaction_manager_factory.h"
 #include "backend/executor/abstract_executor.h"
@@ -125,12 +126,9 @@ void LoadYCSBDatabase() {
   /////////////////////////////////////////////////////////
 
   // Insert tuples into tile_group.
-  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
   const bool allocate = true;
-  auto txn = txn_manager.BeginTransaction();
   std::unique_ptr<VarlenPool> pool(new VarlenPool(BACKEND_TYPE_MM));
-  std::unique_ptr<executor::ExecutorContext> context(
-      new executor::ExecutorContext(txn));
+  std::vector<std::unique_ptr<storage::Tuple>> tuples;
 
   int rowid;
   for (rowid = 0; rowid < tuple_count; rowid++) {
@@ -145,12 +143,14 @@ void LoadYCSBDatabase() {
       tuple->SetValue(col_itr, field_value, pool.get());
     }
 
-    planner::InsertPlan node(user_table, std::move(tuple));
-    executor::InsertExecutor executor(&node, context.get());
-    executor.Execute();
+    tuples.push_back(std::move(tuple));
   }
 
-  txn_manager.CommitTransaction();
+  user_table->BulkInsertTuples(tuples);
+
+  if (user_table->BuildIndexes() == false) {
+    LOG_ERROR("Failed to build the indexes of the user table");
+  }
 }
 
 }  // namespace ycsb
@@ -39,6 +39,7 @@
 #include "backend/common/logger.h"
 #include "backend/common/timer.h"
 #include "backend/common/generator.h"
+#include "backend/common/numa.h"
 
 #include "backend/concurrency/transaction.h"
 #include "backend/concurrency/transaction_manager_factory.h"
@@ -92,9 +93,14 @@ oid_t *abort_counts;
 oid_t *commit_counts;
 
 void RunBackend(oid_t thread_id) {
+  if (state.numa_placement != NUMA_PLACEMENT_DEFAULT) {
+    NumaManager::GetInstance().PinThread(thread_id);
+  }
+
   auto update_ratio = state.update_ratio;
 
   UniformGenerator generator;
+  auto &contention_manager = concurrency::ContentionManager::GetInstance();
 
   oid_t &execution_count_ref = abort_counts[thread_id];
   oid_t &transaction_count_ref = commit_counts[thread_id];
@@ -107,13 +113,9 @@ void RunBackend(oid_t thread_id) {
     auto rng_val = generator.GetSample();
 
     if (rng_val < update_ratio) {
-      while (RunUpdate() == false) {
-        execution_count_ref++;
-      }
+      execution_count_ref += contention_manager.RunWithRetry(RunUpdate);
     } else {
-      while (RunRead() == false) {
-        execution_count_ref++;
-      }
+      execution_count_ref += contention_manager.RunWithRetry(RunRead);
     }
 
     transaction_count_ref++;
@@ -145,6 +147,9 @@ void RunWorkload() {
     commit_counts_snapshots[round_id] = new oid_t[num_threads];
   }
 
+  auto allocation_count =
+      concurrency::TransactionManagerFactory::GetAllocationCount();
+
   // Launch a group of threads
   for (oid_t thread_itr = 0; thread_itr < num_threads; ++thread_itr) {
     thread_group.push_back(std::move(std::thread(RunBackend, thread_itr)));
@@ -214,8 +219,17 @@ void RunWorkload() {
   }
 
   state.throughput = total_commit_count * 1.0 / state.duration;
+  state.raw_throughput =
+      (total_commit_count + total_abort_count) * 1.0 / state.duration;
   state.abort_rate = total_abort_count * 1.0 / total_commit_count;
 
+  // # of allocations per transaction, aborted ones included
+  allocation_count =
+      concurrency::TransactionManagerFactory::GetAllocationCount() -
+      allocation_count;
+  state.allocation_rate =
+      allocation_count * 1.0 / (total_commit_count + total_abort_count);
+
   // cleanup everything.
   for (size_t round_id = 0; round_id < snapshot_round; ++round_id) {
     delete[] abort_counts_snapshots[round_id];
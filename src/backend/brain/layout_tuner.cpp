@@ -0,0 +1,252 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// layout_tuner.cpp
+//
+// Identification: src/backend/brain/layout_tuner.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+#include "backend/brain/layout_tuner.h"
+#include "backend/brain/sample.h"
+#include "backend/catalog/manager.h"
+#include "backend/common/logger.h"
+#include "backend/common/timer.h"
+#include "backend/expression/abstract_expression.h"
+#include "backend/expression/tuple_value_expression.h"
+#include "backend/storage/data_table.h"
+#include "backend/storage/database.h"
+#include "backend/storage/tile.h"
+#include "backend/storage/tile_group.h"
+
+namespace peloton {
+namespace brain {
+
+// Scans seen by this thread, for sampling
+static thread_local size_t scan_count_of_thread = 0;
+
+LayoutTuner::LayoutTuner(unsigned int sleep_time, double cpu_budget,
+                         double theta)
+    : is_running_(false),
+      sleep_time_(sleep_time),
+      cpu_budget_(cpu_budget),
+      theta_(theta),
+      transformed_tile_group_count_(0),
+      partition_update_count_(0),
+      scan_time_before_(0),
+      scan_time_after_(0) {}
+
+LayoutTuner::~LayoutTuner() { StopTuning(); }
+
+LayoutTuner &LayoutTuner::GetInstance() {
+  static LayoutTuner layout_tuner;
+  return layout_tuner;
+}
+
+void LayoutTuner::StartTuning() {
+  if (tuner_thread_.joinable() == true) {
+    return;
+  }
+  this->is_running_ = true;
+  tuner_thread_ = std::thread(&LayoutTuner::Poll, this);
+}
+
+void LayoutTuner::StopTuning() {
+  this->is_running_ = false;
+  if (tuner_thread_.joinable() == true) {
+    tuner_thread_.join();
+  }
+}
+
+// Called by start tuning as the thread function
+void LayoutTuner::Poll() {
+  auto &manager = catalog::Manager::GetInstance();
+
+  while (this->is_running_) {
+    auto round_start = std::chrono::steady_clock::now();
+    double budget = cpu_budget_ * sleep_time_ / 1000;
+
+    for (oid_t database_offset = 0;
+         database_offset < manager.GetDatabaseCount(); database_offset++) {
+      auto database = manager.GetDatabase(database_offset);
+      for (oid_t table_offset = 0; table_offset < database->GetTableCount();
+           table_offset++) {
+        auto table = database->GetTable(table_offset);
+        if (table->IsAdaptTable() == false) {
+          continue;
+        }
+
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - round_start;
+        if (elapsed.count() >= budget) {
+          break;
+        }
+        TuneTable(table, budget - elapsed.count());
+      }
+    }
+
+    // sleep in short steps so that stopping does not wait for a whole round
+    for (unsigned int slept = 0; slept < sleep_time_ && this->is_running_;
+         slept += 100) {
+      std::this_thread::sleep_for(
+          std::chrono::milliseconds(std::min(100u, sleep_time_ - slept)));
+    }
+  }
+}
+
+void LayoutTuner::RecordScan(storage::DataTable *table,
+                             const std::vector<oid_t> &column_ids,
+                             const expression::AbstractExpression *predicate) {
+  if (this->is_running_ == false ||
+      ++scan_count_of_thread % LAYOUT_TUNER_SAMPLE_RATE != 0) {
+    return;
+  }
+
+  auto column_count = table->GetSchema()->GetColumnCount();
+  std::vector<double> columns_accessed(column_count, 0);
+
+  for (auto column_id : column_ids) {
+    if (column_id < column_count) {
+      columns_accessed[column_id] = 1;
+    }
+  }
+
+  // Columns the predicate looks at
+  std::vector<const expression::AbstractExpression *> expressions;
+  if (predicate != nullptr) {
+    expressions.push_back(predicate);
+  }
+  while (expressions.empty() == false) {
+    auto expression = expressions.back();
+    expressions.pop_back();
+
+    if (expression->GetExpressionType() == EXPRESSION_TYPE_VALUE_TUPLE) {
+      auto tuple_value =
+          static_cast<const expression::TupleValueExpression *>(expression);
+      oid_t column_id = tuple_value->GetColumnId();
+      if (tuple_value->GetTupleIdx() == 0 && column_id < column_count) {
+        columns_accessed[column_id] = 1;
+      }
+    }
+    if (expression->GetLeft() != nullptr) {
+      expressions.push_back(expression->GetLeft());
+    }
+    if (expression->GetRight() != nullptr) {
+      expressions.push_back(expression->GetRight());
+    }
+  }
+
+  table->RecordSample(Sample(columns_accessed));
+}
+
+size_t LayoutTuner::TuneTable(storage::DataTable *table, double budget) {
+  std::lock_guard<std::mutex> lock(tuner_mutex_);
+  auto start = std::chrono::steady_clock::now();
+
+  // the partitioning always has two tiles
+  if (table->GetSchema()->GetColumnCount() < 2) {
+    return 0;
+  }
+
+  auto &next_offset = next_tile_group_offsets_[table->GetOid()];
+
+  // Recompute the partitioning, start over if it changed
+  if (table->GetSampleCount() >= LAYOUT_TUNER_MIN_SAMPLE_COUNT) {
+    auto column_map = table->GetDefaultPartition();
+    table->UpdateDefaultPartition();
+    if (column_map != table->GetDefaultPartition()) {
+      partition_update_count_++;
+      next_offset = 0;
+    }
+  }
+
+  auto column_map = table->GetDefaultPartition();
+
+  // The hottest columns make up the first tile
+  std::vector<oid_t> hot_column_ids;
+  for (auto entry : column_map) {
+    if (entry.second.first == 0) {
+      hot_column_ids.push_back(entry.first);
+    }
+  }
+
+  // Go around the table once, the tile groups skipped are retried later
+  auto tile_group_ids = table->GetTileGroupIds();
+  size_t transformed_count = 0;
+
+  for (size_t visited_count = 0; visited_count < tile_group_ids.size();
+       visited_count++) {
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    if (elapsed.count() >= budget) {
+      break;
+    }
+
+    if (next_offset >= tile_group_ids.size()) {
+      next_offset = 0;
+    }
+    auto tile_group_id = tile_group_ids[next_offset++];
+
+    auto tile_group = table->GetTileGroupById(tile_group_id);
+    if (tile_group == nullptr ||
+        tile_group->GetSchemaDifference(column_map) < theta_) {
+      continue;
+    }
+
+    if (table->TransformTileGroupById(tile_group_id, theta_) == nullptr) {
+      continue;
+    }
+    auto new_tile_group = table->GetTileGroupById(tile_group_id);
+
+    transformed_count++;
+    transformed_tile_group_count_++;
+    LOG_TRACE("Transformed tile group %u of table %u", tile_group_id,
+              table->GetOid());
+
+    // the orig tile group is still around, we hold on to it
+    if (new_tile_group != nullptr) {
+      scan_time_before_ += TimeScan(tile_group.get(), hot_column_ids);
+      scan_time_after_ += TimeScan(new_tile_group.get(), hot_column_ids);
+    }
+  }
+
+  return transformed_count;
+}
+
+double LayoutTuner::GetScanSpeedup() {
+  std::lock_guard<std::mutex> lock(tuner_mutex_);
+  if (scan_time_after_ == 0) {
+    return 1.0;
+  }
+  return scan_time_before_ / scan_time_after_;
+}
+
+double LayoutTuner::TimeScan(storage::TileGroup *tile_group,
+                             const std::vector<oid_t> &column_ids) const {
+  Timer<> timer;
+  oid_t tile_offset, tile_column_offset;
+  auto tuple_count = tile_group->GetNextTupleSlot();
+
+  timer.Start();
+  for (auto column_id : column_ids) {
+    tile_group->LocateTileAndColumn(column_id, tile_offset,
+                                    tile_column_offset);
+    auto tile = tile_group->GetTile(tile_offset);
+    for (oid_t tuple_id = 0; tuple_id < tuple_count; tuple_id++) {
+      tile->GetValue(tuple_id, tile_column_offset);
+    }
+  }
+  timer.Stop();
+
+  return timer.GetDuration();
+}
+
+}  // End brain namespace
+}  // End peloton namespace
@@ -0,0 +1,152 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// layout_tuner.h
+//
+// Identification: src/backend/brain/layout_tuner.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "backend/common/types.h"
+
+namespace peloton {
+
+namespace expression {
+class AbstractExpression;
+}
+
+namespace storage {
+class DataTable;
+class TileGroup;
+}
+
+namespace brain {
+
+//===--------------------------------------------------------------------===//
+// Layout Tuner
+//===--------------------------------------------------------------------===//
+
+// Milliseconds between two tuning rounds
+#define LAYOUT_TUNER_SLEEP_TIME 1000
+// Fraction of the time between two rounds spent transforming tile groups
+#define LAYOUT_TUNER_CPU_BUDGET 0.1
+// Every n-th scan of a table records a sample
+#define LAYOUT_TUNER_SAMPLE_RATE 16
+// Samples needed to recompute the partitioning of a table
+#define LAYOUT_TUNER_MIN_SAMPLE_COUNT 16
+// Fraction of columns that must change tiles for a tile group to be
+// transformed
+#define LAYOUT_TUNER_THETA 0.1
+
+/**
+ * Adapts the layout of the tables to the workload while it runs.
+ *
+ * Scans record which columns they access in a sample every so often. In every
+ * round the tuner clusters the samples of a table into a new default
+ * partition and transforms the tile groups laid out differently, a few at a
+ * time, within the CPU budget of the round. Tables pick up where they left
+ * off in the next round. Tile groups still taking inserts or being written
+ * are skipped and tried again later.
+ *
+ * The speedup reported is measured on the transformed tile groups, by
+ * reading the columns of the hottest tile before and after transforming.
+ */
+class LayoutTuner {
+ public:
+  LayoutTuner(const LayoutTuner &) = delete;
+  LayoutTuner &operator=(const LayoutTuner &) = delete;
+  LayoutTuner(LayoutTuner &&) = delete;
+  LayoutTuner &operator=(LayoutTuner &&) = delete;
+
+  LayoutTuner(unsigned int sleep_time = LAYOUT_TUNER_SLEEP_TIME,
+              double cpu_budget = LAYOUT_TUNER_CPU_BUDGET,
+              double theta = LAYOUT_TUNER_THETA);
+
+  ~LayoutTuner();
+
+  static LayoutTuner &GetInstance();
+
+  // Start and Stop the tuner thread
+  void StartTuning();
+  void StopTuning();
+
+  // Get status of whether tuner thread is running or not
+  bool GetStatus() { return this->is_running_; }
+
+  // Get and Set Sleep Time for tuner thread
+  unsigned int GetTunerSleepTime() { return this->sleep_time_; }
+  void SetTunerSleepTime(unsigned int sleep_time) {
+    this->sleep_time_ = sleep_time;
+  }
+  // Get and Set the fraction of time spent transforming
+  double GetCpuBudget() { return this->cpu_budget_; }
+  void SetCpuBudget(double cpu_budget) { this->cpu_budget_ = cpu_budget; }
+
+  // Records the columns accessed by a scan of the table, if the tuner is
+  // running. Only every n-th scan is sampled.
+  void RecordScan(storage::DataTable *table,
+                  const std::vector<oid_t> &column_ids,
+                  const expression::AbstractExpression *predicate);
+
+  // Runs one tuning round over the table for at most the given time.
+  // Returns the number of tile groups transformed.
+  size_t TuneTable(storage::DataTable *table, double budget);
+
+  // Tuning stats
+  size_t GetTransformedTileGroupCount() const {
+    return transformed_tile_group_count_;
+  }
+  size_t GetPartitionUpdateCount() const { return partition_update_count_; }
+
+  // Time to read the hot columns of the transformed tile groups before,
+  // divided by the time after
+  double GetScanSpeedup();
+
+ private:
+  // Infinite poll used by the tuner thread
+  void Poll();
+
+  // Seconds to read the given columns of the tile group
+  double TimeScan(storage::TileGroup *tile_group,
+                  const std::vector<oid_t> &column_ids) const;
+
+ private:
+  //===--------------------------------------------------------------------===//
+  // Data members
+  //===--------------------------------------------------------------------===//
+
+  // Is the tuner thread running
+  volatile bool is_running_;
+  // Milliseconds to sleep for the tuner thread
+  unsigned int sleep_time_;
+  // Fraction of the time between two rounds spent transforming
+  double cpu_budget_;
+  // Fraction of columns that must change tiles to transform a tile group
+  double theta_;
+  std::thread tuner_thread_;
+
+  // Offset of the next tile group to look at, per table
+  std::map<oid_t, oid_t> next_tile_group_offsets_;
+  // Serializes tuning rounds
+  std::mutex tuner_mutex_;
+
+  // Tuning stats
+  std::atomic<size_t> transformed_tile_group_count_;
+  std::atomic<size_t> partition_update_count_;
+  double scan_time_before_;
+  double scan_time_after_;
+};
+
+}  // End brain namespace
+}  // End peloton namespace
@@ -44,6 +44,12 @@ class LockfreeQueue {
   }
 
 
+  // number of items in the queue, only exact if there are no concurrent
+  // producers or consumers
+  size_t GetApproximateSize() const {
+    return queue_.size_approx();
+  }
+
   void BlockingPop(T& item) {
     while (queue_.try_dequeue(item) == false) {
       _mm_pause();
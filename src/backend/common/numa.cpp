@@ -0,0 +1,227 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// numa.cpp
+//
+// Identification: src/backend/common/numa.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "backend/common/numa.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "backend/common/logger.h"
+
+//===--------------------------------------------------------------------===//
+// Configuration Variables
+//===--------------------------------------------------------------------===//
+
+NumaPlacementType peloton_numa_placement = NUMA_PLACEMENT_DEFAULT;
+
+// Memory policies, see mbind(2)
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+
+#ifndef MPOL_INTERLEAVE
+#define MPOL_INTERLEAVE 3
+#endif
+
+#ifndef MPOL_MF_MOVE
+#define MPOL_MF_MOVE (1 << 1)
+#endif
+
+namespace peloton {
+
+#define NUMA_NODE_DIR "/sys/devices/system/node"
+
+// Parses a cpu list like "0-3,8-11"
+static std::vector<int> ParseCpuList(const std::string &cpu_list) {
+  std::vector<int> cpus;
+  std::stringstream cpu_stream(cpu_list);
+  std::string range;
+
+  while (std::getline(cpu_stream, range, ',')) {
+    int first_cpu, last_cpu;
+    auto dash = range.find('-');
+    try {
+      first_cpu = std::stoi(range.substr(0, dash));
+      last_cpu = (dash == std::string::npos) ? first_cpu
+                                             : std::stoi(range.substr(dash + 1));
+    } catch (const std::exception &) {
+      continue;
+    }
+    for (int cpu = first_cpu; cpu <= last_cpu; cpu++) {
+      cpus.push_back(cpu);
+    }
+  }
+
+  return cpus;
+}
+
+// global singleton
+NumaManager &NumaManager::GetInstance() {
+  static NumaManager numa_manager;
+  return numa_manager;
+}
+
+NumaManager::NumaManager() {
+  DIR *node_dir = opendir(NUMA_NODE_DIR);
+  if (node_dir != nullptr) {
+    struct dirent *entry;
+    while ((entry = readdir(node_dir)) != nullptr) {
+      int node_id;
+      if (sscanf(entry->d_name, "node%d", &node_id) != 1) {
+        continue;
+      }
+
+      std::ifstream cpu_list_file(std::string(NUMA_NODE_DIR) + "/" +
+                                  entry->d_name + "/cpulist");
+      std::string cpu_list;
+      std::getline(cpu_list_file, cpu_list);
+      auto cpus = ParseCpuList(cpu_list);
+
+      // memory only nodes have no cpus to pin threads to
+      if (cpus.empty() == false && node_id < 64) {
+        node_ids.push_back(node_id);
+        node_cpus.push_back(cpus);
+      }
+    }
+    closedir(node_dir);
+  }
+
+  // Without NUMA support everything is on a single node
+  if (node_ids.empty() == true) {
+    node_ids.push_back(0);
+    node_cpus.push_back(std::vector<int>());
+  }
+
+  LOG_TRACE("# of NUMA nodes : %lu", node_ids.size());
+}
+
+int NumaManager::GetCurrentNode() const {
+  if (IsNuma() == false) {
+    return 0;
+  }
+
+  int cpu = sched_getcpu();
+  for (size_t node_itr = 0; node_itr < node_cpus.size(); node_itr++) {
+    auto &cpus = node_cpus[node_itr];
+    if (std::find(cpus.begin(), cpus.end(), cpu) != cpus.end()) {
+      return node_itr;
+    }
+  }
+
+  return 0;
+}
+
+bool NumaManager::PinThreadToNode(const int node) const {
+  if (IsNuma() == false || node < 0 || node >= (int)GetNodeCount()) {
+    return false;
+  }
+
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (auto cpu : node_cpus[node]) {
+    CPU_SET(cpu, &cpu_set);
+  }
+
+  int status = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t),
+                                      &cpu_set);
+  if (status != 0) {
+    LOG_WARN("Could not pin thread to node %d : %s", node, strerror(status));
+    return false;
+  }
+
+  return true;
+}
+
+bool NumaManager::PinThread(const size_t thread_id) const {
+  if (IsNuma() == false) {
+    return false;
+  }
+
+  // thread 0 goes to node 0, thread 1 to node 1, and so on
+  auto &cpus = node_cpus[thread_id % GetNodeCount()];
+  int cpu = cpus[(thread_id / GetNodeCount()) % cpus.size()];
+
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpu, &cpu_set);
+
+  int status = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t),
+                                      &cpu_set);
+  if (status != 0) {
+    LOG_WARN("Could not pin thread to cpu %d : %s", cpu, strerror(status));
+    return false;
+  }
+
+  return true;
+}
+
+void NumaManager::PlaceMemory(void *address, const size_t size) const {
+  if (IsNuma() == false || size < NUMA_MIN_PLACEMENT_SIZE) {
+    return;
+  }
+
+  switch (peloton_numa_placement) {
+    case NUMA_PLACEMENT_LOCAL:
+      BindMemory(address, size, MPOL_PREFERRED,
+                 1UL << node_ids[GetCurrentNode()]);
+      break;
+    case NUMA_PLACEMENT_INTERLEAVE: {
+      unsigned long node_mask = 0;
+      for (auto node_id : node_ids) {
+        node_mask |= 1UL << node_id;
+      }
+      BindMemory(address, size, MPOL_INTERLEAVE, node_mask);
+    } break;
+    case NUMA_PLACEMENT_DEFAULT:
+    default:
+      break;
+  }
+}
+
+void NumaManager::BindMemory(void *address, const size_t size, const int mode,
+                             const unsigned long node_mask) const {
+  // Only the pages that lie within the memory are placed
+  uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  uintptr_t begin = reinterpret_cast<uintptr_t>(address);
+  uintptr_t end = begin + size;
+  begin = (begin + page_size - 1) & ~(page_size - 1);
+  end = end & ~(page_size - 1);
+  if (begin >= end) {
+    return;
+  }
+
+#ifdef SYS_mbind
+  // the kernel reads one bit less than it is told
+  long status = syscall(SYS_mbind, begin, end - begin, mode, &node_mask,
+                        sizeof(node_mask) * 8 + 1, MPOL_MF_MOVE);
+  if (status != 0) {
+    LOG_TRACE("Could not place memory : %s", strerror(errno));
+  }
+#else
+  (void)mode;
+  (void)node_mask;
+#endif
+}
+
+}  // End peloton namespace
@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// numa.h
+//
+// Identification: src/backend/common/numa.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+//===--------------------------------------------------------------------===//
+// Configuration Variables
+//===--------------------------------------------------------------------===//
+
+/* Possible values for peloton_numa_placement */
+typedef enum NumaPlacementType {
+  NUMA_PLACEMENT_DEFAULT,    /* Leave it to the operating system */
+  NUMA_PLACEMENT_LOCAL,      /* Node of the allocating thread */
+  NUMA_PLACEMENT_INTERLEAVE  /* Pages spread over all nodes */
+} NumaPlacementType;
+
+extern NumaPlacementType peloton_numa_placement;
+
+namespace peloton {
+
+// Memory smaller than this shares its pages with other allocations
+#define NUMA_MIN_PLACEMENT_SIZE 64 * 1024
+
+//===--------------------------------------------------------------------===//
+// NUMA Manager
+//===--------------------------------------------------------------------===//
+
+/**
+ * Places memory on NUMA nodes and pins threads to their cpus.
+ *
+ * The nodes are read from sysfs once. On machines with a single node, or
+ * without NUMA support, there is nothing to place and everything here is a
+ * no-op.
+ */
+class NumaManager {
+  NumaManager(NumaManager const &) = delete;
+
+ public:
+  // global singleton
+  static NumaManager &GetInstance();
+
+  // # of nodes, 1 without NUMA support
+  size_t GetNodeCount() const { return node_cpus.size(); }
+
+  bool IsNuma() const { return (GetNodeCount() > 1); }
+
+  // Node of the cpu the calling thread runs on
+  int GetCurrentNode() const;
+
+  // Pin the calling thread to the cpus of the node
+  bool PinThreadToNode(const int node) const;
+
+  // Pin the calling thread to one cpu, thread ids are spread over the nodes
+  // round robin so that each node gets its share of the threads
+  bool PinThread(const size_t thread_id) const;
+
+  // Place the pages of the memory, as asked for by peloton_numa_placement.
+  // Pages that are already in use move over.
+  void PlaceMemory(void *address, const size_t size) const;
+
+ private:
+  NumaManager();
+
+  // Place the pages of the memory with the given memory policy
+  void BindMemory(void *address, const size_t size, const int mode,
+                  const unsigned long node_mask) const;
+
+  // ids of the nodes, as the kernel knows them
+  std::vector<int> node_ids;
+
+  // cpus of each node
+  std::vector<std::vector<int>> node_cpus;
+};
+
+}  // End peloton namespace
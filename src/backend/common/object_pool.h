@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// object_pool.h
+//
+// Identification: src/backend/common/object_pool.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace peloton {
+
+// # of free objects a thread keeps for itself
+#define OBJECT_POOL_LOCAL_COUNT 64
+
+// # of objects moved between a thread and the depot at once
+#define OBJECT_POOL_BATCH_COUNT 32
+
+// # of free objects the depot keeps, the others are freed
+#define OBJECT_POOL_DEPOT_COUNT 4096
+
+//===--------------------------------------------------------------------===//
+// Object Pool
+//===--------------------------------------------------------------------===//
+
+/**
+ * Free objects of one type, kept to be used again instead of being freed.
+ *
+ * Each thread keeps the objects it frees in a list of its own and takes them
+ * from there. When its list is full, a batch of them goes to the shared
+ * depot, and when it is empty, it takes a batch from the depot. Objects
+ * freed by a thread that does not allocate any, like the ones the epoch
+ * manager reclaims, are used again that way too.
+ *
+ * An object is not reset when it is freed, the caller resets the objects it
+ * takes out of the pool.
+ */
+template <typename T>
+class ObjectPool {
+  ObjectPool(ObjectPool const &) = delete;
+
+ public:
+  // Never destroyed, threads exiting late still free their objects into it
+  static ObjectPool &GetInstance() {
+    static ObjectPool *pool = new ObjectPool();
+    return *pool;
+  }
+
+  // A used object, or a default constructed one
+  T *Acquire() {
+    auto &objects = local_list_.objects;
+    if (objects.empty() == true) {
+      Refill(objects);
+    }
+
+    if (objects.empty() == true) {
+      allocation_count_.fetch_add(1, std::memory_order_relaxed);
+      return new T();
+    }
+
+    T *object = objects.back();
+    objects.pop_back();
+    return object;
+  }
+
+  void Release(T *object) {
+    auto &objects = local_list_.objects;
+    if (objects.size() >= OBJECT_POOL_LOCAL_COUNT) {
+      Spill(objects, OBJECT_POOL_BATCH_COUNT);
+    }
+    objects.push_back(object);
+  }
+
+  // # of objects allocated so far
+  size_t GetAllocationCount() const {
+    return allocation_count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  ObjectPool() : allocation_count_(0) {}
+
+  struct LocalList {
+    ~LocalList() { ObjectPool::GetInstance().Spill(objects, objects.size()); }
+
+    std::vector<T *> objects;
+  };
+
+  // Takes a batch of objects from the depot
+  void Refill(std::vector<T *> &objects) {
+    std::lock_guard<std::mutex> lock(depot_mutex_);
+    while (depot_.empty() == false &&
+           objects.size() < OBJECT_POOL_BATCH_COUNT) {
+      objects.push_back(depot_.back());
+      depot_.pop_back();
+    }
+  }
+
+  // Moves the given # of objects to the depot
+  void Spill(std::vector<T *> &objects, size_t count) {
+    std::lock_guard<std::mutex> lock(depot_mutex_);
+    while (count-- > 0) {
+      if (depot_.size() < OBJECT_POOL_DEPOT_COUNT) {
+        depot_.push_back(objects.back());
+      } else {
+        delete objects.back();
+      }
+      objects.pop_back();
+    }
+  }
+
+  static thread_local LocalList local_list_;
+
+  std::mutex depot_mutex_;
+
+  std::vector<T *> depot_;
+
+  std::atomic<size_t> allocation_count_;
+};
+
+template <typename T>
+thread_local typename ObjectPool<T>::LocalList ObjectPool<T>::local_list_;
+
+}  // End peloton namespace
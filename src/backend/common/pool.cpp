@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cassert>
 #include <cstring>
 
 #include "backend/common/pool.h"
@@ -18,11 +19,53 @@ namespace peloton {
 
 static const size_t TEMP_POOL_CHUNK_SIZE = 512;  // 512 B
 
+// Every block starts with its size class and the arena it belongs to
+struct BlockHeader {
+  uint32_t size_class;
+  uint32_t arena_index;
+};
+
+static const size_t BLOCK_HEADER_SIZE = sizeof(uint64_t);
+static_assert(sizeof(BlockHeader) <= BLOCK_HEADER_SIZE,
+              "block header does not fit");
+
+// Size class of blocks in an oversize chunk
+static const uint32_t OVERSIZE_CLASS = UINT32_MAX;
+
+static inline BlockHeader *GetBlockHeader(char *block) {
+  return reinterpret_cast<BlockHeader *>(block);
+}
+
+// Hands out the arenas to the threads round robin
+static std::atomic<size_t> next_arena_index(0);
+
+static thread_local size_t arena_index_of_thread = next_arena_index++;
+
+// Block size of a size class: 16, 24, 32, 48, 64, 96, ...
+static inline std::size_t GetBlockSize(std::size_t size_class) {
+  if (size_class == 0) return 16;
+  std::size_t exponent = 4 + (size_class - 1) / 2;
+  if (size_class % 2 == 1) return std::size_t(3) << (exponent - 1);
+  return std::size_t(1) << (exponent + 1);
+}
+
+// Smallest size class whose blocks hold the given number of bytes
+static inline std::size_t GetSizeClass(std::size_t block_size) {
+  if (block_size <= 16) return 0;
+  // block_size lies in (2^exponent, 2^(exponent + 1)]
+  std::size_t exponent = 63 - __builtin_clzll(block_size - 1);
+  std::size_t size_class = 2 * (exponent - 4) + 1;
+  if (block_size > (std::size_t(3) << (exponent - 1))) size_class++;
+  return size_class;
+}
+
 VarlenPool::VarlenPool(BackendType backend_type)
     : backend_type(backend_type),
       allocation_size(TEMP_POOL_CHUNK_SIZE),
       max_chunk_count(1),
-      current_chunk_index(0) {
+      current_chunk_index(0),
+      reserved_bytes(0),
+      live_bytes(0) {
   Init();
 }
 
@@ -31,16 +74,26 @@ VarlenPool::VarlenPool(BackendType backend_type, uint64_t allocation_size,
     : backend_type(backend_type),
       allocation_size(allocation_size),
       max_chunk_count(static_cast<std::size_t>(max_chunk_count)),
-      current_chunk_index(0) {
+      current_chunk_index(0),
+      reserved_bytes(0),
+      live_bytes(0) {
   Init();
 }
 
 void VarlenPool::Init() {
+  // Largest size class that still fits into a chunk
+  max_size_class = 0;
+  while (max_size_class + 1 < VARLEN_POOL_SIZE_CLASS_COUNT &&
+         GetBlockSize(max_size_class + 1) <= allocation_size) {
+    max_size_class++;
+  }
+
   auto &storage_manager = storage::StorageManager::GetInstance();
   char *storage = reinterpret_cast<char *>(
       storage_manager.Allocate(backend_type, allocation_size));
 
   chunks.push_back(Chunk(allocation_size, storage));
+  reserved_bytes += allocation_size;
 }
 
 VarlenPool::~VarlenPool() {
@@ -55,64 +108,86 @@ VarlenPool::~VarlenPool() {
   }
 }
 
-// Allocate a continous block of memory of the specified size.
-void *VarlenPool::Allocate(std::size_t size) {
-  void *retval = nullptr;
+std::size_t VarlenPool::GetArenaIndex() {
+  return arena_index_of_thread % VARLEN_POOL_ARENA_COUNT;
+}
+
+void VarlenPool::RefillArena(Arena &arena) {
+  std::lock_guard<std::mutex> pool_lock(pool_mutex);
+
+  // Check if there is an already allocated chunk we can use.
+  if (current_chunk_index >= chunks.size()) {
+    // Need to allocate a new chunk
+    auto &storage_manager = storage::StorageManager::GetInstance();
+    char *storage = reinterpret_cast<char *>(
+        storage_manager.Allocate(backend_type, allocation_size));
+
+    chunks.push_back(Chunk(allocation_size, storage));
+    reserved_bytes += allocation_size;
+  }
+
+  // The rest of the previous chunk is too small for the block, leave it
+  Chunk &chunk = chunks[current_chunk_index++];
+  arena.chunk_data = chunk.chunk_data;
+  arena.chunk_offset = 0;
+  arena.chunk_size = chunk.size;
+}
+
+void *VarlenPool::AllocateOversize(std::size_t size) {
+  std::size_t block_size = size + BLOCK_HEADER_SIZE;
+
+  // Allocate an oversize chunk that is released when the block is freed.
+  auto &storage_manager = storage::StorageManager::GetInstance();
+  char *storage = reinterpret_cast<char *>(
+      storage_manager.Allocate(backend_type, block_size));
+  GetBlockHeader(storage)->size_class = OVERSIZE_CLASS;
 
-  // Protect using pool lock
-  // TODO: Can make locking more fine-grained
   {
     std::lock_guard<std::mutex> pool_lock(pool_mutex);
+    oversize_chunks.push_back(Chunk(block_size, storage));
+  }
 
-    // See if there is space in the current chunk
-    Chunk *current_chunk = &chunks[current_chunk_index];
-    if (size > current_chunk->size - current_chunk->offset) {
-      // Not enough space. Check if it is greater than our allocation size.
-      if (size > allocation_size) {
-        // Allocate an oversize chunk that will not be reused.
-        auto &storage_manager = storage::StorageManager::GetInstance();
-        char *storage = reinterpret_cast<char *>(
-            storage_manager.Allocate(backend_type, size));
-
-        oversize_chunks.push_back(Chunk(nexthigher(size), storage));
-        Chunk &newChunk = oversize_chunks.back();
-        newChunk.offset = size;
-        return newChunk.chunk_data;
-      }
+  reserved_bytes += block_size;
+  live_bytes += block_size;
+  return storage + BLOCK_HEADER_SIZE;
+}
 
-      // Check if there is an already allocated chunk we can use.
-      current_chunk_index++;
-
-      if (current_chunk_index < chunks.size()) {
-        current_chunk = &chunks[current_chunk_index];
-        current_chunk->offset = size;
-        return current_chunk->chunk_data;
-      } else {
-        // Need to allocate a new chunk
-        auto &storage_manager = storage::StorageManager::GetInstance();
-        char *storage = reinterpret_cast<char *>(
-            storage_manager.Allocate(backend_type, allocation_size));
-
-        chunks.push_back(Chunk(allocation_size, storage));
-        Chunk &new_chunk = chunks.back();
-        new_chunk.offset = size;
-        return new_chunk.chunk_data;
-      }
-    }
+// Allocate a continous block of memory of the specified size.
+void *VarlenPool::Allocate(std::size_t size) {
+  std::size_t size_class = GetSizeClass(size + BLOCK_HEADER_SIZE);
+  if (size_class > max_size_class) {
+    return AllocateOversize(size);
+  }
 
-    // Get the offset into the current chunk. Then increment the
-    // offset counter by the amount being allocated.
-    retval = current_chunk->chunk_data + current_chunk->offset;
-    current_chunk->offset += size;
+  std::size_t block_size = GetBlockSize(size_class);
+  std::size_t arena_index = GetArenaIndex();
+  char *block = nullptr;
+
+  {
+    Arena &arena = arenas[arena_index];
+    std::lock_guard<std::mutex> arena_lock(arena.arena_mutex);
 
-    // Ensure 8 byte alignment of future allocations
-    current_chunk->offset += (8 - (current_chunk->offset % 8));
-    if (current_chunk->offset > current_chunk->size) {
-      current_chunk->offset = current_chunk->size;
+    // Reuse a freed block of the same size class
+    block = arena.free_lists[size_class];
+    if (block != nullptr) {
+      arena.free_lists[size_class] =
+          *reinterpret_cast<char **>(block + BLOCK_HEADER_SIZE);
+    } else {
+      // Carve a new block from the arena's chunk
+      if (arena.chunk_data == nullptr ||
+          block_size > arena.chunk_size - arena.chunk_offset) {
+        RefillArena(arena);
+      }
+
+      block = arena.chunk_data + arena.chunk_offset;
+      arena.chunk_offset += block_size;
     }
   }
 
-  return retval;
+  GetBlockHeader(block)->size_class = static_cast<uint32_t>(size_class);
+  GetBlockHeader(block)->arena_index = static_cast<uint32_t>(arena_index);
+  live_bytes += block_size;
+  return block + BLOCK_HEADER_SIZE;
 }
 
 // Allocate a continous block of memory of the specified size conveniently
@@ -121,16 +196,66 @@ void *VarlenPool::AllocateZeroes(std::size_t size) {
   return ::memset(Allocate(size), 0, size);
 }
 
+void VarlenPool::Free(void *ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+
+  char *block = reinterpret_cast<char *>(ptr) - BLOCK_HEADER_SIZE;
+  uint32_t size_class = GetBlockHeader(block)->size_class;
+
+  if (size_class == OVERSIZE_CLASS) {
+    int64_t block_size = 0;
+    {
+      std::lock_guard<std::mutex> pool_lock(pool_mutex);
+      for (auto itr = oversize_chunks.begin(); itr != oversize_chunks.end();
+           ++itr) {
+        if (itr->chunk_data == block) {
+          block_size = itr->getSize();
+          oversize_chunks.erase(itr);
+          break;
+        }
+      }
+    }
+
+    auto &storage_manager = storage::StorageManager::GetInstance();
+    storage_manager.Release(backend_type, block);
+    reserved_bytes -= block_size;
+    live_bytes -= block_size;
+    return;
+  }
+
+  assert(size_class <= max_size_class);
+
+  // The block goes back to the arena it was carved from, not to the freeing
+  // thread's one, so the allocating threads find it again
+  {
+    Arena &arena = arenas[GetBlockHeader(block)->arena_index];
+    std::lock_guard<std::mutex> arena_lock(arena.arena_mutex);
+    *reinterpret_cast<char **>(block + BLOCK_HEADER_SIZE) =
+        arena.free_lists[size_class];
+    arena.free_lists[size_class] = block;
+  }
+
+  live_bytes -= GetBlockSize(size_class);
+}
+
 void VarlenPool::Purge() {
+  // Stop all arenas while the chunks are reset
+  for (auto &arena : arenas) {
+    arena.arena_mutex.lock();
+  }
+
   // Protect using pool lock
   {
     std::lock_guard<std::mutex> pool_lock(pool_mutex);
+    auto &storage_manager = storage::StorageManager::GetInstance();
 
     // Erase any oversize chunks that were allocated
     const std::size_t numOversizeChunks = oversize_chunks.size();
     for (std::size_t ii = 0; ii < numOversizeChunks; ii++) {
-      auto &storage_manager = storage::StorageManager::GetInstance();
       storage_manager.Release(backend_type, oversize_chunks[ii].chunk_data);
+      reserved_bytes -= oversize_chunks[ii].getSize();
     }
     oversize_chunks.clear();
 
@@ -141,26 +266,29 @@ void VarlenPool::Purge() {
     // If more then maxChunkCount chunks are allocated erase all extra chunks
     if (num_chunks > max_chunk_count) {
       for (std::size_t ii = max_chunk_count; ii < num_chunks; ii++) {
-        auto &storage_manager = storage::StorageManager::GetInstance();
         storage_manager.Release(backend_type, chunks[ii].chunk_data);
+        reserved_bytes -= chunks[ii].getSize();
       }
       chunks.resize(max_chunk_count);
     }
 
-    num_chunks = chunks.size();
-    for (std::size_t ii = 0; ii < num_chunks; ii++) {
-      chunks[ii].offset = 0;
+    // Forget the blocks carved from the kept chunks
+    for (auto &arena : arenas) {
+      arena.chunk_data = nullptr;
+      arena.chunk_offset = 0;
+      arena.chunk_size = 0;
+      for (auto &free_list : arena.free_lists) {
+        free_list = nullptr;
+      }
     }
+    live_bytes = 0;
   }
-}
 
-int64_t VarlenPool::GetAllocatedMemory() {
-  int64_t total = 0;
-  total += chunks.size() * allocation_size;
-  for (uint32_t i = 0; i < oversize_chunks.size(); i++) {
-    total += oversize_chunks[i].getSize();
+  for (auto &arena : arenas) {
+    arena.arena_mutex.unlock();
   }
-  return total;
 }
 
+int64_t VarlenPool::GetAllocatedMemory() { return reserved_bytes; }
+
 }  // End peloton namespace
@@ -19,6 +19,7 @@
 #include <climits>
 #include <string.h>
 #include <mutex>
+#include <atomic>
 
 #include "backend/storage/storage_manager.h"
 
@@ -55,10 +56,24 @@ inline T nexthigher(T k) {
 // Memory Pool
 //===--------------------------------------------------------------------===//
 
+// Number of independently locked arenas in a pool
+#define VARLEN_POOL_ARENA_COUNT 8
+// Block sizes go from 16 B up to 16 MB in steps of 1 and 1.5 times a power
+// of two
+#define VARLEN_POOL_SIZE_CLASS_COUNT 41
+
 /**
- * A memory pool that provides fast allocation and deallocation. The
- * only way to release memory is to free all memory in the pool by
- * calling purge.
+ * A memory pool that provides fast allocation and deallocation.
+ *
+ * Blocks are handed out in size classes. Each thread allocates from one of
+ * several arenas, each with its own lock, current chunk and free lists, so
+ * that threads writing to the same tile rarely wait for each other. Every
+ * block remembers its arena, and a freed block goes back to the free list of
+ * that arena, even when another thread (like the GC) frees it, to be reused
+ * for the next allocation of the same size class. Blocks bigger than a chunk get
+ * an oversize chunk of their own, which is released when freed.
+ *
+ * Purge releases all memory in the pool at once.
  */
 class VarlenPool {
   VarlenPool(const VarlenPool &) = delete;
@@ -83,11 +98,39 @@ class VarlenPool {
   // initialized to 0s
   void *AllocateZeroes(std::size_t size);
 
+  // Return a block obtained from Allocate to the pool
+  void Free(void *ptr);
+
   void Purge();
 
+  // Bytes reserved from the storage manager
   int64_t GetAllocatedMemory();
 
+  // Bytes in blocks handed out and not freed yet
+  int64_t GetLiveMemory() const { return live_bytes; }
+
  private:
+  // Per arena allocation state
+  struct Arena {
+    std::mutex arena_mutex;
+
+    // chunk the arena carves new blocks from
+    char *chunk_data = nullptr;
+    uint64_t chunk_offset = 0;
+    uint64_t chunk_size = 0;
+
+    // singly linked lists of free blocks, one per size class
+    char *free_lists[VARLEN_POOL_SIZE_CLASS_COUNT] = {};
+  };
+
+  // Index of the arena of the calling thread
+  std::size_t GetArenaIndex();
+
+  // Hand a chunk to the arena, reusing the chunks kept by Purge first
+  void RefillArena(Arena &arena);
+
+  void *AllocateOversize(std::size_t size);
+
   // backend type
   BackendType backend_type;
 
@@ -96,10 +139,20 @@ class VarlenPool {
   std::size_t current_chunk_index;
   std::vector<Chunk> chunks;
 
-  // Oversize chunks that will be freed and not reused.
+  // Oversize chunks that are released when freed
   std::vector<Chunk> oversize_chunks;
 
+  // Largest size class that fits into a chunk
+  std::size_t max_size_class;
+
+  Arena arenas[VARLEN_POOL_ARENA_COUNT];
+
+  // protects the chunks
   std::mutex pool_mutex;
+
+  std::atomic<int64_t> reserved_bytes;
+
+  std::atomic<int64_t> live_bytes;
 };
 
 }  // End peloton namespace
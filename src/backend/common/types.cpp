@@ -359,6 +359,19 @@ void AtomicUpdateItemPointer(ItemPointer* src_ptr, const ItemPointer& value) {
   __sync_bool_compare_and_swap(cast_src_ptr, *cast_src_ptr, *cast_value_ptr);
 }
 
+bool AtomicCompareAndSwapItemPointer(ItemPointer* src_ptr,
+                                     const ItemPointer& expected,
+                                     const ItemPointer& value) {
+  assert(sizeof(ItemPointer) == sizeof(int64_t));
+  int64_t* cast_src_ptr = reinterpret_cast<int64_t*>((void*)src_ptr);
+  const int64_t* cast_expected_ptr =
+      reinterpret_cast<const int64_t*>((const void*)&expected);
+  const int64_t* cast_value_ptr =
+      reinterpret_cast<const int64_t*>((const void*)&value);
+  return __sync_bool_compare_and_swap(cast_src_ptr, *cast_expected_ptr,
+                                      *cast_value_ptr);
+}
+
 //===--------------------------------------------------------------------===//
 // Expression - String Utilities
 //===--------------------------------------------------------------------===//
@@ -1036,6 +1049,9 @@ std::string LogRecordTypeToString(LogRecordType type) {
     case LOGRECORD_TYPE_TUPLE_UPDATE: {
       return "LOGRECORD_TYPE_TUPLE_UPDATE";
     }
+    case LOGRECORD_TYPE_TUPLE_DELTA_UPDATE: {
+      return "LOGRECORD_TYPE_TUPLE_DELTA_UPDATE";
+    }
     case LOGRECORD_TYPE_WAL_TUPLE_INSERT: {
       return "LOGRECORD_TYPE_WAL_TUPLE_INSERT";
     }
@@ -1045,6 +1061,9 @@ std::string LogRecordTypeToString(LogRecordType type) {
     case LOGRECORD_TYPE_WAL_TUPLE_UPDATE: {
       return "LOGRECORD_TYPE_WAL_TUPLE_UPDATE";
     }
+    case LOGRECORD_TYPE_WAL_TUPLE_DELTA_UPDATE: {
+      return "LOGRECORD_TYPE_WAL_TUPLE_DELTA_UPDATE";
+    }
     case LOGRECORD_TYPE_WBL_TUPLE_INSERT: {
       return "LOGRECORD_TYPE_WBL_TUPLE_INSERT";
     }
@@ -57,6 +57,7 @@ enum GCType {
   GC_TYPE_VACUUM = 1,
   GC_TYPE_COOPERATIVE = 2,
   GC_TYPE_EPOCH = 3,
+  GC_TYPE_PARALLEL_VACUUM = 4,
 };
 
 // Initial size of the free lists
@@ -372,7 +373,10 @@ enum ConcurrencyType {
   CONCURRENCY_TYPE_SPECULATIVE_READ = 2,  // optimistic + speculative read
   CONCURRENCY_TYPE_EAGER_WRITE = 3,       // pessimistic + eager write
   CONCURRENCY_TYPE_TO = 4,                // timestamp ordering
-  CONCURRENCY_TYPE_SSI = 5                // serializable snapshot isolation
+  CONCURRENCY_TYPE_SSI = 5,               // serializable snapshot isolation
+  CONCURRENCY_TYPE_HYBRID = 6,            // optimistic or locking per table
+  CONCURRENCY_TYPE_PARTITIONED = 7,       // partitioned, H-Store style
+  CONCURRENCY_TYPE_DETERMINISTIC = 8      // ordered batches, Calvin style
 };
 
 enum IsolationLevelType {
@@ -381,6 +385,20 @@ enum IsolationLevelType {
   ISOLATION_LEVEL_TYPE_REPEATABLE_READ = 2  // repeatable read
 };
 
+// What a pessimistic transaction does when a tuple is locked by another one
+enum LockPolicyType {
+  LOCK_POLICY_NO_WAIT = 0,    // abort right away
+  LOCK_POLICY_WAIT_DIE = 1,   // wait if older than the holders, else abort
+  LOCK_POLICY_WOUND_WAIT = 2  // abort the younger holders and wait
+};
+
+// What a transaction that aborted does before it runs again
+enum RetryPolicyType {
+  RETRY_POLICY_IMMEDIATE = 0,  // run again right away
+  RETRY_POLICY_BACKOFF = 1,    // wait a random, exponentially growing time
+  RETRY_POLICY_QUEUE = 2       // back off, or queue behind a hot tuple
+};
+
 enum BackendType {
   BACKEND_TYPE_INVALID = 0,  // invalid backend type
 
@@ -686,11 +704,13 @@ enum LogRecordType {
   LOGRECORD_TYPE_TUPLE_INSERT = 11,
   LOGRECORD_TYPE_TUPLE_DELETE = 12,
   LOGRECORD_TYPE_TUPLE_UPDATE = 13,
+  LOGRECORD_TYPE_TUPLE_DELTA_UPDATE = 14,
 
   // DML records for Write ahead logging
   LOGRECORD_TYPE_WAL_TUPLE_INSERT = 21,
   LOGRECORD_TYPE_WAL_TUPLE_DELETE = 22,
   LOGRECORD_TYPE_WAL_TUPLE_UPDATE = 23,
+  LOGRECORD_TYPE_WAL_TUPLE_DELTA_UPDATE = 24,
 
   // DML records for Write behind logging
   LOGRECORD_TYPE_WBL_TUPLE_INSERT = 31,
@@ -820,6 +840,10 @@ BackendType GetBackendType(const LoggingType& logging_type);
 
 void AtomicUpdateItemPointer(ItemPointer* src_ptr, const ItemPointer& value);
 
+bool AtomicCompareAndSwapItemPointer(ItemPointer* src_ptr,
+                                     const ItemPointer& expected,
+                                     const ItemPointer& value);
+
 //===--------------------------------------------------------------------===//
 // Transformers
 //===--------------------------------------------------------------------===//
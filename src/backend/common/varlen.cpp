@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cassert>
+
 #include "backend/common/varlen.h"
 #include "backend/common/pool.h"
 
@@ -37,6 +39,14 @@ Varlen *Varlen::Clone(const Varlen &src, VarlenPool *data_pool) {
   return rv;
 }
 
+void Varlen::Destroy(Varlen *varlen, VarlenPool *data_pool) {
+  assert(varlen->varlen_temp_pool == false);
+
+  data_pool->Free(varlen->varlen_string_ptr);
+  varlen->~Varlen();
+  data_pool->Free(varlen);
+}
+
 // Construct varlen in heap
 Varlen::Varlen(size_t size) {
   varlen_size = size + sizeof(Varlen *);
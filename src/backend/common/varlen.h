@@ -47,6 +47,10 @@ class Varlen {
   /// temporary Pool
   ~Varlen();
 
+  /// Return the memory of a Varlen created in the given data pool, and
+  /// of the Varlen object itself, to that pool.
+  static void Destroy(Varlen *varlen, VarlenPool *data_pool);
+
   /**
    * @brief Clone (deep copy) the source Varlen in the provided data pool.
    */
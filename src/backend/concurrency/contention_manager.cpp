@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// contention_manager.cpp
+//
+// Identification: src/backend/concurrency/contention_manager.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "backend/concurrency/contention_manager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+
+#include "backend/common/logger.h"
+
+namespace peloton {
+namespace concurrency {
+
+// The tuple the last transaction of the thread conflicted on
+thread_local ItemPointer last_conflict;
+
+ContentionManager &ContentionManager::GetInstance() {
+  static ContentionManager contention_manager;
+  return contention_manager;
+}
+
+ContentionManager::ContentionManager()
+    : retry_policy_(RETRY_POLICY_IMMEDIATE), conflict_count_(0) {
+  for (auto &counter : counters_) {
+    counter = 0;
+  }
+}
+
+void ContentionManager::RecordConflict(const ItemPointer &location) {
+  last_conflict = location;
+  counters_[GetSlot(location) % CONTENTION_COUNTER_COUNT].fetch_add(
+      1, std::memory_order_relaxed);
+
+  if ((conflict_count_.fetch_add(1, std::memory_order_relaxed) + 1) %
+          CONTENTION_DECAY_INTERVAL ==
+      0) {
+    Decay();
+  }
+}
+
+void ContentionManager::Decay() {
+  // Conflicts counted meanwhile may be lost, the counters are only hints
+  for (auto &counter : counters_) {
+    counter.store(counter.load(std::memory_order_relaxed) / 2,
+                  std::memory_order_relaxed);
+  }
+}
+
+void ContentionManager::Backoff(const size_t abort_count) {
+  thread_local std::minstd_rand generator(
+      std::hash<std::thread::id>()(std::this_thread::get_id()));
+
+  uint64_t max_sleep = CONTENTION_BACKOFF_MAX;
+  if (abort_count <= 10) {
+    max_sleep = std::min(max_sleep, (uint64_t)CONTENTION_BACKOFF_MIN
+                                        << (abort_count - 1));
+  }
+  std::uniform_int_distribution<uint64_t> distribution(1, max_sleep);
+  std::this_thread::sleep_for(
+      std::chrono::microseconds(distribution(generator)));
+}
+
+size_t ContentionManager::RunWithRetry(const std::function<bool()> &run) {
+  size_t abort_count = 0;
+  std::unique_lock<std::mutex> queue;
+
+  while (true) {
+    last_conflict = ItemPointer();
+    if (run() == true) {
+      return abort_count;
+    }
+    abort_count++;
+
+    if (retry_policy_ == RETRY_POLICY_IMMEDIATE) {
+      continue;
+    }
+
+    // Waiting in the queue replaces the backoff
+    if (retry_policy_ == RETRY_POLICY_QUEUE && queue.owns_lock() == false &&
+        last_conflict.IsNull() == false && IsHot(last_conflict) == true) {
+      LOG_TRACE("Queueing on hot tuple (%u, %u)", last_conflict.block,
+                last_conflict.offset);
+      queue = std::unique_lock<std::mutex>(
+          queues_[GetSlot(last_conflict) % CONTENTION_QUEUE_COUNT]);
+      continue;
+    }
+
+    Backoff(abort_count);
+  }
+}
+
+}  // End concurrency namespace
+}  // End peloton namespace
@@ -0,0 +1,112 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// contention_manager.h
+//
+// Identification: src/backend/concurrency/contention_manager.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+#include "backend/common/types.h"
+
+namespace peloton {
+namespace concurrency {
+
+// # of conflict counters, the tuples are hashed to them
+#define CONTENTION_COUNTER_COUNT 4096
+
+// # of recent conflicts that make a tuple hot
+#define CONTENTION_HOT_THRESHOLD 8
+
+// The counters are halved every that many conflicts
+#define CONTENTION_DECAY_INTERVAL 1024
+
+// # of queues the hot tuples are hashed to
+#define CONTENTION_QUEUE_COUNT 64
+
+// Longest time a transaction backs off after its first abort, and after any
+// abort, in microseconds
+#define CONTENTION_BACKOFF_MIN 16
+#define CONTENTION_BACKOFF_MAX 8192
+
+//===--------------------------------------------------------------------===//
+// Contention Manager
+//===--------------------------------------------------------------------===//
+
+/**
+ * Retries aborted transactions, and finds the tuples they conflict on.
+ *
+ * The executors and the transaction managers report the tuple a transaction
+ * conflicted on before it aborts. The conflicts are counted per tuple, and
+ * the counters are halved every CONTENTION_DECAY_INTERVAL conflicts, so a
+ * tuple is hot while it keeps causing aborts.
+ *
+ * Under the backoff policy, a transaction that aborted waits a random time
+ * before it runs again, at most twice as long as after its previous abort.
+ * Under the queue policy, a transaction that aborted on a hot tuple instead
+ * waits in the queue of the tuple, and holds it until it commits, so that
+ * the retries on the tuple run one at a time. A transaction holds at most
+ * one queue and never waits for one while it runs, so the queues cannot
+ * deadlock.
+ */
+class ContentionManager {
+  ContentionManager(ContentionManager const &) = delete;
+
+ public:
+  ContentionManager();
+
+  static ContentionManager &GetInstance();
+
+  void SetRetryPolicy(const RetryPolicyType policy) { retry_policy_ = policy; }
+
+  RetryPolicyType GetRetryPolicy() const { return retry_policy_; }
+
+  // The current transaction has to abort because of the tuple
+  void RecordConflict(const ItemPointer &location);
+
+  // # of recent conflicts on the tuple, and on the tuples hashed with it
+  uint32_t GetConflictCount(const ItemPointer &location) const {
+    return counters_[GetSlot(location) % CONTENTION_COUNTER_COUNT].load(
+        std::memory_order_relaxed);
+  }
+
+  bool IsHot(const ItemPointer &location) const {
+    return GetConflictCount(location) >= CONTENTION_HOT_THRESHOLD;
+  }
+
+  // Runs the transaction until it commits, run returns false if it aborted.
+  // Returns the # of aborts.
+  size_t RunWithRetry(const std::function<bool()> &run);
+
+ private:
+  static uint64_t GetSlot(const ItemPointer &location) {
+    uint64_t key = (static_cast<uint64_t>(location.block) << 32) |
+                   static_cast<uint64_t>(location.offset);
+    return (key * 0x9E3779B97F4A7C15ULL) >> 32;
+  }
+
+  // Sleeps a random time, that grows with the # of aborts
+  void Backoff(const size_t abort_count);
+
+  void Decay();
+
+  RetryPolicyType retry_policy_;
+
+  std::atomic<uint32_t> counters_[CONTENTION_COUNTER_COUNT];
+
+  std::atomic<uint64_t> conflict_count_;
+
+  std::mutex queues_[CONTENTION_QUEUE_COUNT];
+};
+
+}  // End concurrency namespace
+}  // End peloton namespace
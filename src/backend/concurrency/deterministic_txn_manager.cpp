@@ -0,0 +1,308 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// deterministic_txn_manager.cpp
+//
+// Identification: src/backend/concurrency/deterministic_txn_manager.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "deterministic_txn_manager.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "backend/concurrency/transaction.h"
+#include "backend/common/exception.h"
+#include "backend/common/logger.h"
+#include "backend/storage/tile_group_header.h"
+
+namespace peloton {
+namespace concurrency {
+
+// Every transaction shares one of the stripe keys, a transaction that
+// declares no keys locks all of them exclusively. The stripe keys are in
+// different shards, so that the transactions do not all queue on one key.
+#define DETERMINISTIC_STRIPE_KEY(stripe) (INVALID_OID - (oid_t)(stripe))
+
+// Keys of a transaction and where it is in its batch
+struct DeterministicRequest {
+  // sorted, with the mode of each key
+  std::vector<std::pair<oid_t, bool>> keys;
+
+  std::atomic<bool> is_sequenced{false};
+
+  // # of its locks not granted yet
+  std::atomic<size_t> waiting_count{0};
+
+  // the transaction waits here for its batch and its locks
+  std::mutex mutex;
+
+  std::condition_variable cv;
+};
+
+// Wakes up the transaction of the request
+static void WakeUp(DeterministicRequest *request) {
+  std::lock_guard<std::mutex> lock(request->mutex);
+  request->cv.notify_one();
+}
+
+// The request of the transaction of the thread
+thread_local DeterministicRequest current_request;
+
+DeterministicTxnManager &DeterministicTxnManager::GetInstance() {
+  static DeterministicTxnManager txn_manager;
+  return txn_manager;
+}
+
+DeterministicTxnManager::DeterministicTxnManager()
+    : open_batch_id_(0), batch_size_(DETERMINISTIC_BATCH_MAX_SIZE) {}
+
+void DeterministicTxnManager::SetBatchSize(const size_t batch_size) {
+  if (batch_size == 0 || batch_size > DETERMINISTIC_BATCH_MAX_SIZE) {
+    throw Exception("Invalid batch size :: " + std::to_string(batch_size));
+  }
+  batch_size_ = batch_size;
+}
+
+uint64_t DeterministicTxnManager::GetBatchCount() {
+  std::lock_guard<std::mutex> lock(sequencer_mutex_);
+  return open_batch_id_;
+}
+
+// no other transaction should write the tuple. The CAS is still taken, so
+// that a transaction that did not declare the key aborts instead of
+// overwriting another one. The version is only recorded now, as it is not
+// recorded when read.
+bool DeterministicTxnManager::AcquireOwnership(
+    const storage::TileGroupHeader *const tile_group_header,
+    const oid_t &tile_group_id, const oid_t &tuple_id) {
+  auto txn_id = current_txn->GetTransactionId();
+  if (tile_group_header->SetAtomicTransactionId(tuple_id, txn_id) == false) {
+    LOG_TRACE("Txn %lu wrote an undeclared key", txn_id);
+    SetTransactionResult(Result::RESULT_FAILURE);
+    return false;
+  }
+  // a transaction without the lock of the key updated it meanwhile
+  if (tile_group_header->GetEndCommitId(tuple_id) != MAX_CID) {
+    LOG_TRACE("Txn %lu wrote an undeclared key", txn_id);
+    tile_group_header->SetAtomicTransactionId(tuple_id, txn_id,
+                                              INITIAL_TXN_ID);
+    SetTransactionResult(Result::RESULT_FAILURE);
+    return false;
+  }
+  current_txn->RecordRead(ItemPointer(tile_group_id, tuple_id));
+  return true;
+}
+
+// reads need no validation, they are not recorded.
+bool DeterministicTxnManager::PerformRead(const ItemPointer &location
+                                          __attribute__((unused))) {
+  return true;
+}
+
+Transaction *DeterministicTxnManager::BeginTransaction() {
+  return BeginDeterministicTransaction({}, {});
+}
+
+Transaction *DeterministicTxnManager::BeginDeterministicTransaction(
+    const std::vector<oid_t> &read_keys, const std::vector<oid_t> &write_keys) {
+  auto &request = current_request;
+  assert(request.keys.empty() == true);
+
+  // A key that is both read and written is locked exclusively
+  for (auto key : write_keys) {
+    request.keys.emplace_back(key, true);
+  }
+  for (auto key : read_keys) {
+    request.keys.emplace_back(key, false);
+  }
+  std::sort(request.keys.begin(), request.keys.end(),
+            [](const std::pair<oid_t, bool> &lhs,
+               const std::pair<oid_t, bool> &rhs) {
+              return (lhs.first < rhs.first) ||
+                     (lhs.first == rhs.first && lhs.second > rhs.second);
+            });
+  request.keys.erase(
+      std::unique(request.keys.begin(), request.keys.end(),
+                  [](const std::pair<oid_t, bool> &lhs,
+                     const std::pair<oid_t, bool> &rhs) {
+                    return lhs.first == rhs.first;
+                  }),
+      request.keys.end());
+
+  if (request.keys.empty() == true) {
+    for (oid_t stripe = 0; stripe < DETERMINISTIC_LOCK_SHARD_COUNT; stripe++) {
+      request.keys.emplace_back(DETERMINISTIC_STRIPE_KEY(stripe), true);
+    }
+  } else {
+    auto stripe = request.keys.front().first % DETERMINISTIC_LOCK_SHARD_COUNT;
+    request.keys.emplace_back(DETERMINISTIC_STRIPE_KEY(stripe), false);
+  }
+  request.is_sequenced = false;
+
+  return Sequence(request);
+}
+
+Transaction *DeterministicTxnManager::Sequence(DeterministicRequest &request) {
+  uint64_t batch_id = 0;
+  std::chrono::steady_clock::time_point deadline;
+  {
+    std::lock_guard<std::mutex> lock(sequencer_mutex_);
+    if (open_batch_.empty() == true) {
+      open_batch_deadline_ =
+          std::chrono::steady_clock::now() +
+          std::chrono::microseconds(DETERMINISTIC_BATCH_INTERVAL);
+    }
+    open_batch_.push_back(&request);
+    batch_id = open_batch_id_;
+    deadline = open_batch_deadline_;
+
+    if (open_batch_.size() >= batch_size_) {
+      CloseBatch();
+    }
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(request.mutex);
+    while (request.is_sequenced == false || request.waiting_count > 0) {
+      if (request.is_sequenced == true) {
+        request.cv.wait(lock);
+        continue;
+      }
+
+      // The first transaction to see the batch expire closes it
+      if (request.cv.wait_until(lock, deadline) == std::cv_status::timeout &&
+          request.is_sequenced == false) {
+        lock.unlock();
+        {
+          std::lock_guard<std::mutex> sequencer_lock(sequencer_mutex_);
+          if (open_batch_id_ == batch_id) {
+            CloseBatch();
+          }
+        }
+        lock.lock();
+      }
+    }
+  }
+
+  txn_id_t txn_id = INVALID_TXN_ID;
+  cid_t begin_cid = INVALID_CID;
+  {
+    std::lock_guard<std::mutex> lock(running_mutex_);
+    txn_id = GetNextTransactionId();
+    begin_cid = GetNextCommitId();
+    running_cids_.insert(begin_cid);
+  }
+
+  // The waiting is over before the transaction holds back the reclamation
+  EpochManagerFactory::GetInstance().EnterEpoch();
+
+  Transaction *txn = Transaction::Acquire(txn_id, begin_cid);
+  current_txn = txn;
+
+  LOG_TRACE("Txn %lu locks %lu keys", txn_id, request.keys.size());
+  return txn;
+}
+
+// The locks of the batch are queued while the sequencer mutex is held, so
+// every queue is in the order of the batches, and of the transactions in
+// them, even though the shards are locked one at a time. A transaction is
+// woken up once it is granted its last lock, it may run and end before its
+// batch is closed, so the request is not touched after that.
+void DeterministicTxnManager::CloseBatch() {
+  for (auto request : open_batch_) {
+    size_t key_count = request->keys.size();
+    request->waiting_count = key_count;
+    request->is_sequenced = true;
+    for (size_t key_itr = 0; key_itr < key_count; key_itr++) {
+      auto &key = request->keys[key_itr];
+      auto &shard = GetLockShard(key.first);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto &queue = shard.queues[key.first];
+      queue.entries.push_back({request, key.second});
+      GrantLocks(queue);
+    }
+  }
+
+  LOG_TRACE("Batch %lu holds %lu txns", open_batch_id_, open_batch_.size());
+  open_batch_.clear();
+  open_batch_id_++;
+}
+
+void DeterministicTxnManager::GrantLocks(LockQueue &queue) {
+  while (queue.granted_count < queue.entries.size()) {
+    auto &entry = queue.entries[queue.granted_count];
+    if (queue.granted_count > 0 &&
+        (entry.is_exclusive == true ||
+         queue.entries.front().is_exclusive == true)) {
+      break;
+    }
+    queue.granted_count++;
+    if (--entry.request->waiting_count == 0) {
+      WakeUp(entry.request);
+    }
+  }
+}
+
+void DeterministicTxnManager::ReleaseLock(const oid_t key,
+                                          DeterministicRequest *request) {
+  auto &shard = GetLockShard(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto queue_itr = shard.queues.find(key);
+  assert(queue_itr != shard.queues.end());
+
+  auto &queue = queue_itr->second;
+  for (size_t i = 0; i < queue.granted_count; i++) {
+    if (queue.entries[i].request == request) {
+      queue.entries.erase(queue.entries.begin() + i);
+      queue.granted_count--;
+      break;
+    }
+  }
+
+  if (queue.entries.empty() == true) {
+    shard.queues.erase(queue_itr);
+  } else {
+    GrantLocks(queue);
+  }
+}
+
+void DeterministicTxnManager::EndTransaction() {
+  cid_t begin_cid = current_txn->GetBeginCommitId();
+  if (gc::GCManagerFactory::GetGCType() == GC_TYPE_COOPERATIVE) {
+    // If cooperative mode, then just call perform GC
+    gc::GCManagerFactory::GetInstance().PerformGC();
+  }
+
+  Transaction::Release(current_txn);
+  current_txn = nullptr;
+
+  // in epoch mode, this is where the retired versions get reclaimed
+  EpochManagerFactory::GetInstance().ExitEpoch();
+
+  // The commit is installed, the next transactions of the keys see it
+  auto &request = current_request;
+  {
+    std::lock_guard<std::mutex> lock(running_mutex_);
+    running_cids_.erase(running_cids_.find(begin_cid));
+  }
+  for (auto &key : request.keys) {
+    ReleaseLock(key.first, &request);
+  }
+  request.keys.clear();
+}
+
+cid_t DeterministicTxnManager::GetMaxCommittedCidOfRunningTxns() {
+  std::lock_guard<std::mutex> lock(running_mutex_);
+  if (running_cids_.empty() == true) {
+    return MAX_CID;
+  }
+  return *running_cids_.begin() - 1;
+}
+
+}  // End concurrency namespace
+}  // End peloton namespace
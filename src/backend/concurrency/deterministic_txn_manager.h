@@ -0,0 +1,163 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// deterministic_txn_manager.h
+//
+// Identification: src/backend/concurrency/deterministic_txn_manager.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "backend/concurrency/optimistic_txn_manager.h"
+
+namespace peloton {
+namespace concurrency {
+
+// Longest time a batch stays open, in microseconds
+#define DETERMINISTIC_BATCH_INTERVAL 1000
+
+// Most transactions a batch can hold
+#define DETERMINISTIC_BATCH_MAX_SIZE 1024
+
+// # of shards of the lock table
+#define DETERMINISTIC_LOCK_SHARD_COUNT 64
+
+struct DeterministicRequest;
+
+//===--------------------------------------------------------------------===//
+// deterministic concurrency control
+//===--------------------------------------------------------------------===//
+
+/**
+ * Deterministic execution in the style of Calvin.
+ *
+ * A transaction declares the keys it reads and writes when it begins, and the
+ * sequencer adds it to the open batch. The batch is closed once it is full or
+ * DETERMINISTIC_BATCH_INTERVAL has passed since it was opened. Its order is
+ * the order the transactions arrived in, and it comes after the batches
+ * closed before it. When a batch is closed, the locks of its transactions
+ * are queued on their keys in that order, and a transaction runs once it is
+ * granted all of them. Readers of a key share it.
+ *
+ * As the locks are taken in one global order, the transactions neither
+ * deadlock nor abort on conflicts. They do not check or record what they
+ * read. A transaction can still abort itself, its writes are then undone
+ * like in the optimistic protocol, and one that writes a key it did not
+ * declare aborts when it cannot own the version. A transaction that declares
+ * no keys runs alone.
+ *
+ * The lock table is sharded by key, and every transaction waits for its own
+ * locks, so that transactions of unrelated keys do not meet in the lock
+ * layer.
+ *
+ * Durability is unchanged from the optimistic protocol: the batch inputs are
+ * not logged, so recovery replays the logged writes and does not re-execute
+ * batches. Commits wait for their log records, the transactions of a batch
+ * share the flushes of the group commit.
+ */
+class DeterministicTxnManager : public OptimisticTxnManager {
+ public:
+  DeterministicTxnManager();
+
+  virtual ~DeterministicTxnManager() {}
+
+  static DeterministicTxnManager &GetInstance();
+
+  virtual bool AcquireOwnership(
+      const storage::TileGroupHeader *const tile_group_header,
+      const oid_t &tile_group_id, const oid_t &tuple_id);
+
+  virtual bool PerformRead(const ItemPointer &location);
+
+  virtual Transaction *BeginTransaction();
+
+  virtual Transaction *BeginDeterministicTransaction(
+      const std::vector<oid_t> &read_keys, const std::vector<oid_t> &write_keys);
+
+  virtual void EndTransaction();
+
+  // Only while no transaction is running
+  void SetBatchSize(const size_t batch_size);
+
+  size_t GetBatchSize() const { return batch_size_; }
+
+  // # of batches closed so far
+  uint64_t GetBatchCount();
+
+ protected:
+  virtual cid_t GetMaxCommittedCidOfRunningTxns();
+
+ private:
+  struct LockEntry {
+    DeterministicRequest *request;
+
+    bool is_exclusive;
+  };
+
+  // The granted locks are the front of the queue, either one exclusive lock
+  // or shared ones
+  struct LockQueue {
+    std::deque<LockEntry> entries;
+
+    size_t granted_count = 0;
+  };
+
+  // Adds the transaction to the open batch, and waits until it is granted
+  // its locks
+  Transaction *Sequence(DeterministicRequest &request);
+
+  // Queues the locks of the open batch in order, and opens the next one.
+  // The sequencer mutex is held.
+  void CloseBatch();
+
+  // The mutex of the shard of the queue is held
+  void GrantLocks(LockQueue &queue);
+
+  void ReleaseLock(const oid_t key, DeterministicRequest *request);
+
+  struct LockShard {
+    std::mutex mutex;
+
+    std::unordered_map<oid_t, LockQueue> queues;
+  };
+
+  LockShard &GetLockShard(const oid_t key) {
+    return lock_shards_[key % DETERMINISTIC_LOCK_SHARD_COUNT];
+  }
+
+  // Sequencer
+
+  std::mutex sequencer_mutex_;
+
+  std::vector<DeterministicRequest *> open_batch_;
+
+  uint64_t open_batch_id_;
+
+  std::chrono::steady_clock::time_point open_batch_deadline_;
+
+  size_t batch_size_;
+
+  // Locks
+
+  LockShard lock_shards_[DETERMINISTIC_LOCK_SHARD_COUNT];
+
+  // begin cids of the running transactions
+
+  std::mutex running_mutex_;
+
+  std::multiset<cid_t> running_cids_;
+};
+}
+}
@@ -96,24 +96,16 @@ void EagerWriteTxnManager::RemoveReader() {
   auto txn = current_txn;
   auto &rw_set = txn->GetRWSet();
 
-  for (auto &tile_group_entry : rw_set) {
-    oid_t tile_group_id = tile_group_entry.first;
-    auto &manager = catalog::Manager::GetInstance();
-    auto tile_group = manager.GetTileGroup(tile_group_id);
-    if (tile_group == nullptr) continue;
-
-    auto tile_group_header = tile_group->GetHeader();
-    for (auto &tuple_entry : tile_group_entry.second) {
-      auto tuple_slot = tuple_entry.first;
-
-      // we don't have reader lock on insert
-      if (tuple_entry.second == RW_TYPE_INSERT ||
-          tuple_entry.second == RW_TYPE_INS_DEL) {
-        continue;
-      }
+  for (auto &entry : rw_set) {
+    auto tile_group_header = entry.GetTileGroupHeader();
+    auto tuple_slot = entry.location.offset;
 
-      RemoveReader(tile_group_header, tuple_slot, txn->GetTransactionId());
+    // we don't have reader lock on insert
+    if (entry.type == RW_TYPE_INSERT || entry.type == RW_TYPE_INS_DEL) {
+      continue;
     }
+
+    RemoveReader(tile_group_header, tuple_slot, txn->GetTransactionId());
   }
   LOG_INFO("release EWreader finish");
 }
@@ -208,12 +200,9 @@ bool EagerWriteTxnManager::PerformRead(const ItemPointer &location) {
   auto tile_group_header = tile_group->GetHeader();
 
   auto &rw_set = current_txn->GetRWSet();
-  auto tuple_map = rw_set.find(tile_group_id);
-  if (tuple_map != rw_set.end()) {
-    if (tuple_map->second.find(tuple_id) != tuple_map->second.end()) {
-      // It was already accessed, don't acquire read lock again
-      return true;
-    }
+  if (rw_set.Find(location) != nullptr) {
+    // It was already accessed, don't acquire read lock again
+    return true;
   }
 
   if (IsOwner(tile_group_header, tuple_id)) {
@@ -235,7 +224,7 @@ bool EagerWriteTxnManager::PerformRead(const ItemPointer &location) {
 
   AddReader(tile_group_header, tuple_id);
   ReleaseEwReaderLock(tile_group_header, tuple_id);
-  current_txn->RecordRead(location);
+  current_txn->RecordRead(location, tile_group);
 
   return true;
 }
@@ -247,7 +236,8 @@ bool EagerWriteTxnManager::PerformInsert(const ItemPointer &location) {
   LOG_INFO("Perform insert");
 
   auto &manager = catalog::Manager::GetInstance();
-  auto tile_group_header = manager.GetTileGroup(tile_group_id)->GetHeader();
+  auto tile_group = manager.GetTileGroup(tile_group_id);
+  auto tile_group_header = tile_group->GetHeader();
   auto transaction_id = current_txn->GetTransactionId();
 
   // Set MVCC info
@@ -262,7 +252,7 @@ bool EagerWriteTxnManager::PerformInsert(const ItemPointer &location) {
   // no need to set next item pointer.
 
   // Add the new tuple into the insert set
-  current_txn->RecordInsert(location);
+  current_txn->RecordInsert(location, tile_group);
   InitTupleReserved(tile_group_id, tuple_id);
   return true;
 }
@@ -299,7 +289,7 @@ void EagerWriteTxnManager::PerformUpdate(const ItemPointer &old_location,
   InitTupleReserved(new_location.block, new_location.offset);
 
   // Add the old tuple into the update set
-  current_txn->RecordUpdate(old_location);
+  current_txn->RecordUpdate(old_location, new_tile_group_header);
 }
 
 void EagerWriteTxnManager::PerformUpdate(const ItemPointer &location) {
@@ -351,7 +341,7 @@ void EagerWriteTxnManager::PerformDelete(const ItemPointer &old_location,
   new_tile_group_header->SetEndCommitId(new_location.offset, INVALID_CID);
   InitTupleReserved(new_location.block, new_location.offset);
 
-  current_txn->RecordDelete(old_location);
+  current_txn->RecordDelete(old_location, new_tile_group_header);
 }
 
 void EagerWriteTxnManager::PerformDelete(const ItemPointer &location) {
@@ -383,8 +373,6 @@ void EagerWriteTxnManager::PerformDelete(const ItemPointer &location) {
 Result EagerWriteTxnManager::CommitTransaction() {
   LOG_INFO("Committing peloton txn : %lu ", current_txn->GetTransactionId());
 
-  auto &manager = catalog::Manager::GetInstance();
-
   auto &rw_set = current_txn->GetRWSet();
 
   //*****************************************************
@@ -423,88 +411,85 @@ Result EagerWriteTxnManager::CommitTransaction() {
   log_manager.LogBeginTransaction(end_commit_id);
 
   // install everything.
-  for (auto &tile_group_entry : rw_set) {
-    oid_t tile_group_id = tile_group_entry.first;
-    auto tile_group = manager.GetTileGroup(tile_group_id);
-    auto tile_group_header = tile_group->GetHeader();
-    for (auto &tuple_entry : tile_group_entry.second) {
-      auto tuple_slot = tuple_entry.first;
-      if (tuple_entry.second == RW_TYPE_UPDATE) {
-        // we must guarantee that, at any time point, only one version is
-        // visible.
-        ItemPointer new_version =
-            tile_group_header->GetNextItemPointer(tuple_slot);
-        ItemPointer old_version(tile_group_id, tuple_slot);
+  for (auto &entry : rw_set) {
+    oid_t tile_group_id = entry.location.block;
+    auto tile_group_header = entry.GetTileGroupHeader();
+    auto tuple_slot = entry.location.offset;
+    if (entry.type == RW_TYPE_UPDATE) {
+      // we must guarantee that, at any time point, only one version is
+      // visible.
+      ItemPointer new_version =
+          tile_group_header->GetNextItemPointer(tuple_slot);
+      ItemPointer old_version(tile_group_id, tuple_slot);
 
-        // logging.
-        log_manager.LogUpdate(current_txn, end_commit_id, old_version,
-                              new_version);
+      // logging.
+      log_manager.LogUpdate(current_txn, end_commit_id, old_version,
+                            new_version);
 
-        auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
+      auto new_tile_group_header =
+          entry.GetNewTileGroupHeader(new_version);
 
-        new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
-        new_tile_group_header->SetBeginCommitId(new_version.offset,
-                                                end_commit_id);
+      new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
+      new_tile_group_header->SetBeginCommitId(new_version.offset,
+                                              end_commit_id);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        tile_group_header->SetEndCommitId(tuple_slot, end_commit_id);
+      tile_group_header->SetEndCommitId(tuple_slot, end_commit_id);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        new_tile_group_header->SetTransactionId(new_version.offset,
-                                                INITIAL_TXN_ID);
+      new_tile_group_header->SetTransactionId(new_version.offset,
+                                              INITIAL_TXN_ID);
 
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
 
-      } else if (tuple_entry.second == RW_TYPE_DELETE) {
-        ItemPointer new_version =
-            tile_group_header->GetNextItemPointer(tuple_slot);
-        ItemPointer delete_location(tile_group_id, tuple_slot);
+    } else if (entry.type == RW_TYPE_DELETE) {
+      ItemPointer new_version =
+          tile_group_header->GetNextItemPointer(tuple_slot);
+      ItemPointer delete_location(tile_group_id, tuple_slot);
 
-        // logging.
-        log_manager.LogDelete(end_commit_id, delete_location);
+      // logging.
+      log_manager.LogDelete(end_commit_id, delete_location);
 
-        // we do not change begin cid for old tuple.
-        auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
+      // we do not change begin cid for old tuple.
+      auto new_tile_group_header =
+          entry.GetNewTileGroupHeader(new_version);
 
-        new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
-        new_tile_group_header->SetBeginCommitId(new_version.offset,
-                                                end_commit_id);
+      new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
+      new_tile_group_header->SetBeginCommitId(new_version.offset,
+                                              end_commit_id);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        tile_group_header->SetEndCommitId(tuple_slot, end_commit_id);
+      tile_group_header->SetEndCommitId(tuple_slot, end_commit_id);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        new_tile_group_header->SetTransactionId(new_version.offset,
-                                                INVALID_TXN_ID);
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+      new_tile_group_header->SetTransactionId(new_version.offset,
+                                              INVALID_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
 
-      } else if (tuple_entry.second == RW_TYPE_INSERT) {
-        // set the begin commit id to persist insert
-        ItemPointer insert_location(tile_group_id, tuple_slot);
-        log_manager.LogInsert(current_txn, end_commit_id, insert_location);
+    } else if (entry.type == RW_TYPE_INSERT) {
+      // set the begin commit id to persist insert
+      ItemPointer insert_location(tile_group_id, tuple_slot);
+      log_manager.LogInsert(current_txn, end_commit_id, insert_location);
 
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-        tile_group_header->SetBeginCommitId(tuple_slot, end_commit_id);
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetBeginCommitId(tuple_slot, end_commit_id);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
 
-      } else if (tuple_entry.second == RW_TYPE_INS_DEL) {
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-        tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
+    } else if (entry.type == RW_TYPE_INS_DEL) {
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        // set the begin commit id to persist insert
-        tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
-      }
+      // set the begin commit id to persist insert
+      tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
     }
   }
   log_manager.LogCommitTransaction(end_commit_id);
@@ -516,71 +501,65 @@ Result EagerWriteTxnManager::CommitTransaction() {
 
 Result EagerWriteTxnManager::AbortTransaction() {
   LOG_INFO("Aborting peloton txn : %lu ", current_txn->GetTransactionId());
-  auto &manager = catalog::Manager::GetInstance();
 
   auto &rw_set = current_txn->GetRWSet();
 
-  for (auto &tile_group_entry : rw_set) {
-    oid_t tile_group_id = tile_group_entry.first;
-    auto tile_group = manager.GetTileGroup(tile_group_id);
-    auto tile_group_header = tile_group->GetHeader();
+  for (auto &entry : rw_set) {
+    auto tile_group_header = entry.GetTileGroupHeader();
+    auto tuple_slot = entry.location.offset;
+    if (entry.type == RW_TYPE_UPDATE) {
+      ItemPointer new_version =
+          tile_group_header->GetNextItemPointer(tuple_slot);
+      auto new_tile_group_header =
+          entry.GetNewTileGroupHeader(new_version);
+      new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
+      new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
 
-    for (auto &tuple_entry : tile_group_entry.second) {
-      auto tuple_slot = tuple_entry.first;
-      if (tuple_entry.second == RW_TYPE_UPDATE) {
-        ItemPointer new_version =
-            tile_group_header->GetNextItemPointer(tuple_slot);
-        auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
-        new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
-        new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
+      COMPILER_MEMORY_FENCE;
 
-        COMPILER_MEMORY_FENCE;
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
 
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+      COMPILER_MEMORY_FENCE;
 
-        COMPILER_MEMORY_FENCE;
+      new_tile_group_header->SetTransactionId(new_version.offset,
+                                              INVALID_TXN_ID);
+      // AtomicSetOnlyTxnId(tile_group_header, tuple_slot, INITIAL_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+    } else if (entry.type == RW_TYPE_DELETE) {
+      ItemPointer new_version =
+          tile_group_header->GetNextItemPointer(tuple_slot);
 
-        new_tile_group_header->SetTransactionId(new_version.offset,
-                                                INVALID_TXN_ID);
-        // AtomicSetOnlyTxnId(tile_group_header, tuple_slot, INITIAL_TXN_ID);
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
-      } else if (tuple_entry.second == RW_TYPE_DELETE) {
-        ItemPointer new_version =
-            tile_group_header->GetNextItemPointer(tuple_slot);
+      auto new_tile_group_header =
+          entry.GetNewTileGroupHeader(new_version);
 
-        auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
+      new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
+      new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
 
-        new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
-        new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
+      COMPILER_MEMORY_FENCE;
 
-        COMPILER_MEMORY_FENCE;
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
 
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+      COMPILER_MEMORY_FENCE;
 
-        COMPILER_MEMORY_FENCE;
+      new_tile_group_header->SetTransactionId(new_version.offset,
+                                              INVALID_TXN_ID);
+      // AtomicSetOnlyTxnId(tile_group_header, tuple_slot, INITIAL_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
 
-        new_tile_group_header->SetTransactionId(new_version.offset,
-                                                INVALID_TXN_ID);
-        // AtomicSetOnlyTxnId(tile_group_header, tuple_slot, INITIAL_TXN_ID);
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+    } else if (entry.type == RW_TYPE_INSERT) {
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
 
-      } else if (tuple_entry.second == RW_TYPE_INSERT) {
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-        tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
+      COMPILER_MEMORY_FENCE;
 
-        COMPILER_MEMORY_FENCE;
+      tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
+    } else if (entry.type == RW_TYPE_INS_DEL) {
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
 
-        tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
-      } else if (tuple_entry.second == RW_TYPE_INS_DEL) {
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-        tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
+      COMPILER_MEMORY_FENCE;
 
-        COMPILER_MEMORY_FENCE;
-
-        tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
-      }
+      tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
     }
   }
 
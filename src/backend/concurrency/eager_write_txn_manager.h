@@ -15,6 +15,7 @@
 #include <unordered_set>
 #include <queue>
 #include <atomic>
+#include "backend/common/object_pool.h"
 #include "backend/concurrency/transaction_manager.h"
 
 namespace peloton {
@@ -39,6 +40,13 @@ struct EagerWriteTxnContext {
   EagerWriteTxnContext()
       : wait_for_counter_(0), wait_list_(), begin_cid_(INVALID_CID) {}
   ~EagerWriteTxnContext() {}
+
+  // Contexts are pooled
+  void Reset(const cid_t begin_cid) {
+    wait_for_counter_ = 0;
+    wait_list_.clear();
+    begin_cid_ = begin_cid;
+  }
 };
 
 extern thread_local EagerWriteTxnContext *current_txn_ctx;
@@ -87,15 +95,18 @@ class EagerWriteTxnManager : public TransactionManager {
   virtual Result AbortTransaction();
 
   virtual Transaction *BeginTransaction() {
+    EpochManagerFactory::GetInstance().EnterEpoch();
+
     txn_id_t txn_id = GetNextTransactionId();
     cid_t begin_cid = GetNextCommitId();
 
-    Transaction *txn = new Transaction(txn_id, begin_cid);
+    Transaction *txn = Transaction::Acquire(txn_id, begin_cid);
     current_txn = txn;
 
-    EagerWriteTxnContext *txn_ctx = new EagerWriteTxnContext();
+    EagerWriteTxnContext *txn_ctx =
+        ObjectPool<EagerWriteTxnContext>::GetInstance().Acquire();
     current_txn_ctx = txn_ctx;
-    txn_ctx->begin_cid_ = begin_cid;
+    txn_ctx->Reset(begin_cid);
 
     {
       std::lock_guard<std::mutex> lock(running_txn_map_mutex_);
@@ -126,13 +137,15 @@ class EagerWriteTxnManager : public TransactionManager {
     }
 
 
-    delete current_txn;
-    delete current_txn_ctx;
+    Transaction::Release(current_txn);
+    ObjectPool<EagerWriteTxnContext>::GetInstance().Release(current_txn_ctx);
     current_txn = nullptr;
     current_txn_ctx = nullptr;
+
+    EpochManagerFactory::GetInstance().ExitEpoch();
   }
 
-  virtual cid_t GetMaxCommittedCid() {
+  virtual cid_t GetMaxCommittedCidOfRunningTxns() {
     cid_t min_running_cid = MAX_CID;
     {
       std::lock_guard<std::mutex> lock(running_txn_map_mutex_);
@@ -194,7 +207,8 @@ class EagerWriteTxnManager : public TransactionManager {
     auto txn_id = current_txn->GetTransactionId();
     LOG_INFO("Add reader %lu, tuple_id = %u", txn_id, tuple_id);
 
-    TxnList *reader = new TxnList(txn_id);
+    TxnList *reader = ObjectPool<TxnList>::GetInstance().Acquire();
+    reader->txn_id_ = txn_id;
 
     // GetEwReaderLock(tile_group_header, tuple_id);
     TxnList *headp = (TxnList *)(
@@ -220,7 +234,7 @@ class EagerWriteTxnManager : public TransactionManager {
       if (next->txn_id_ == txn_id) {
         find = true;
         prev->next = next->next;
-        delete next;
+        ObjectPool<TxnList>::GetInstance().Release(next);
         break;
       }
       prev = next;
@@ -10,13 +10,254 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "backend/concurrency/epoch_manager.h"
 
-#include "epoch_manager.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <limits>
+
+#include "backend/common/exception.h"
+#include "backend/common/logger.h"
+#include "backend/gc/gc_manager_factory.h"
 
 namespace peloton {
 namespace concurrency {
 
-  volatile cid_t EpochManager::curr_epoch_ = 1;
+// 0 is left for threads that are in no epoch
+std::atomic<uint64_t> EpochManager::curr_epoch_(1);
+
+thread_local EpochManager::ThreadContext EpochManager::thread_context_;
+
+EpochManager::ThreadContext::~ThreadContext() {
+  if (slot == nullptr && retire_list.GetSize() == 0) {
+    return;
+  }
+
+  auto &epoch_manager = EpochManagerFactory::GetInstance();
+  epoch_manager.AddOrphans(retire_list);
+
+  if (slot != nullptr) {
+    slot->epoch = 0;
+    slot->snapshot_cid = INVALID_CID;
+    slot->is_used = false;
+    slot = nullptr;
+  }
+}
+
+EpochManager::EpochManager() : slot_count_(0), orphan_count_(0) {
+  for (auto &epoch_slot : epoch_slots_) {
+    epoch_slot.epoch = 0;
+    epoch_slot.snapshot_cid = INVALID_CID;
+    epoch_slot.is_used = false;
+  }
+
+  ts_thread_.reset(new std::thread(&EpochManager::Start, this));
+  ts_thread_->detach();
+}
+
+EpochManager::~EpochManager() {
+  // no thread is running anymore, the versions are dropped with their tables
+  for (auto &retired_object : orphans_.objects) {
+    retired_object.deleter(retired_object.object);
+  }
+}
+
+void EpochManager::Start() {
+  while (true) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(EPOCH_LENGTH));
+    AdvanceEpoch();
+  }
+}
+
+void EpochManager::EnterEpoch() {
+  auto &context = thread_context_;
+  if (context.depth++ > 0) {
+    return;
+  }
+
+  if (context.slot == nullptr) {
+    context.slot = AcquireSlot();
+  }
+
+  // The reads of the transaction must not move above this store
+  context.slot->epoch.store(GetEpoch());
+}
+
+void EpochManager::ExitEpoch() {
+  auto &context = thread_context_;
+  assert(context.depth > 0);
+  if (--context.depth > 0) {
+    return;
+  }
+
+  context.slot->epoch.store(0);
+  context.slot->snapshot_cid.store(INVALID_CID);
+
+  // Reclaim in batches. Small lists are reclaimed at most once per epoch, so
+  // that short transactions do not scan the slots every time.
+  auto retired_count = context.retire_list.GetSize();
+  if (retired_count >= EPOCH_RECLAIM_BATCH_SIZE ||
+      (retired_count > 0 && context.reclaimed_epoch != GetEpoch())) {
+    Reclaim();
+  }
+}
+
+void EpochManager::SetSnapshotCid(const cid_t snapshot_cid) {
+  assert(IsInEpoch() == true);
+  thread_context_.slot->snapshot_cid.store(snapshot_cid);
+}
+
+void EpochManager::Retire(void *object, void (*deleter)(void *)) {
+  RetiredObject retired_object;
+  retired_object.epoch = GetEpoch();
+  retired_object.object = object;
+  retired_object.deleter = deleter;
+  thread_context_.retire_list.objects.push_back(retired_object);
+}
+
+void EpochManager::RetireTupleSlot(const TupleMetadata &tuple_metadata) {
+  RetiredTupleSlot retired_tuple_slot;
+  retired_tuple_slot.epoch = GetEpoch();
+  retired_tuple_slot.tuple_metadata = tuple_metadata;
+  thread_context_.retire_list.tuple_slots.push_back(retired_tuple_slot);
+}
+
+size_t EpochManager::Reclaim() {
+  auto &context = thread_context_;
+  if (context.is_reclaiming == true) {
+    return 0;
+  }
+
+  context.is_reclaiming = true;
+  context.reclaimed_epoch = GetEpoch();
+  uint64_t safe_epoch = GetSafeEpoch();
+
+  size_t reclaimed_count = Reclaim(context.retire_list, safe_epoch);
+
+  if (orphan_count_ > 0) {
+    std::unique_lock<std::mutex> lock(orphans_mutex_, std::try_to_lock);
+    if (lock.owns_lock() == true) {
+      reclaimed_count += Reclaim(orphans_, safe_epoch);
+      orphan_count_ = orphans_.GetSize();
+    }
+  }
+
+  context.is_reclaiming = false;
+  return reclaimed_count;
+}
+
+size_t EpochManager::Reclaim(RetireList &retire_list,
+                             const uint64_t safe_epoch) {
+  // Take the entries out of the list first, reclaiming the tuple slots
+  // retires more entries into it
+  auto object_itr = std::partition(
+      retire_list.objects.begin(), retire_list.objects.end(),
+      [safe_epoch](const RetiredObject &retired_object) {
+        return retired_object.epoch < safe_epoch;
+      });
+  std::vector<RetiredObject> objects(retire_list.objects.begin(), object_itr);
+  retire_list.objects.erase(retire_list.objects.begin(), object_itr);
 
+  // Read-only transactions may read a snapshot older than their epoch, the
+  // versions they can still see stay in the list, like in the vacuum GC.
+  // Their index entries go with them.
+  cid_t oldest_snapshot_cid = GetOldestSnapshotCid();
+  auto tuple_slot_itr = std::partition(
+      retire_list.tuple_slots.begin(), retire_list.tuple_slots.end(),
+      [safe_epoch, oldest_snapshot_cid](
+          const RetiredTupleSlot &retired_tuple_slot) {
+        return retired_tuple_slot.epoch < safe_epoch &&
+               (oldest_snapshot_cid == MAX_CID ||
+                retired_tuple_slot.tuple_metadata.tuple_end_cid <=
+                    oldest_snapshot_cid);
+      });
+  std::vector<TupleMetadata> garbage;
+  garbage.reserve(tuple_slot_itr - retire_list.tuple_slots.begin());
+  for (auto itr = retire_list.tuple_slots.begin(); itr != tuple_slot_itr;
+       itr++) {
+    garbage.push_back(itr->tuple_metadata);
+  }
+  retire_list.tuple_slots.erase(retire_list.tuple_slots.begin(),
+                                tuple_slot_itr);
+
+  if (garbage.empty() == false) {
+    gc::GCManagerFactory::GetInstance().PerformGC(garbage);
+  }
+
+  for (auto &retired_object : objects) {
+    retired_object.deleter(retired_object.object);
+  }
+
+  return objects.size() + garbage.size();
 }
-}
\ No newline at end of file
+
+size_t EpochManager::GetRetiredCount() const {
+  return thread_context_.retire_list.GetSize();
+}
+
+uint64_t EpochManager::GetSafeEpoch() const {
+  // Threads that enter from now on cannot reach what was retired before
+  uint64_t safe_epoch = std::numeric_limits<uint64_t>::max();
+
+  size_t slot_count = slot_count_;
+  for (size_t slot_itr = 0; slot_itr < slot_count; slot_itr++) {
+    uint64_t epoch = epoch_slots_[slot_itr].epoch.load();
+    if (epoch != 0 && epoch < safe_epoch) {
+      safe_epoch = epoch;
+    }
+  }
+
+  return safe_epoch;
+}
+
+cid_t EpochManager::GetOldestSnapshotCid() const {
+  cid_t oldest_snapshot_cid = MAX_CID;
+
+  size_t slot_count = slot_count_;
+  for (size_t slot_itr = 0; slot_itr < slot_count; slot_itr++) {
+    cid_t snapshot_cid = epoch_slots_[slot_itr].snapshot_cid.load();
+    if (snapshot_cid != INVALID_CID && snapshot_cid < oldest_snapshot_cid) {
+      oldest_snapshot_cid = snapshot_cid;
+    }
+  }
+
+  return oldest_snapshot_cid;
+}
+
+EpochManager::EpochSlot *EpochManager::AcquireSlot() {
+  // reuse the slot of a thread that exited
+  for (size_t slot_itr = 0; slot_itr < EPOCH_MAX_THREAD_COUNT; slot_itr++) {
+    auto &epoch_slot = epoch_slots_[slot_itr];
+    bool is_used = false;
+    if (epoch_slot.is_used.compare_exchange_strong(is_used, true) == true) {
+      // make the slot visible to GetSafeEpoch
+      size_t slot_count = slot_count_;
+      while (slot_count <= slot_itr &&
+             slot_count_.compare_exchange_weak(slot_count, slot_itr + 1) ==
+                 false) {
+      }
+      return &epoch_slot;
+    }
+  }
+
+  LOG_ERROR("More than %d threads in epochs", EPOCH_MAX_THREAD_COUNT);
+  throw Exception("Out of epoch slots");
+}
+
+void EpochManager::AddOrphans(RetireList &retire_list) {
+  std::lock_guard<std::mutex> lock(orphans_mutex_);
+  orphans_.objects.insert(orphans_.objects.end(),
+                          retire_list.objects.begin(),
+                          retire_list.objects.end());
+  orphans_.tuple_slots.insert(orphans_.tuple_slots.end(),
+                              retire_list.tuple_slots.begin(),
+                              retire_list.tuple_slots.end());
+  orphan_count_ = orphans_.GetSize();
+
+  retire_list.objects.clear();
+  retire_list.tuple_slots.clear();
+}
+
+}  // End concurrency namespace
+}  // End peloton namespace
@@ -10,49 +10,174 @@
 //
 //===----------------------------------------------------------------------===//
 
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include "backend/common/types.h"
-#include "backend/common/platform.h"
 
 namespace peloton {
 namespace concurrency {
 
-  class EpochManager {
-  public:
-    EpochManager() {
-      ts_thread_.reset(new std::thread(&EpochManager::Start, this));
-      ts_thread_->detach();
-    }
-
-    ~EpochManager() {}
-
-    static uint64_t GetEpoch() {
-
-      COMPILER_MEMORY_FENCE;
-      
-      uint64_t ret_ts = curr_epoch_;
-      
-      COMPILER_MEMORY_FENCE;
-      
-      return ret_ts;
-    }
-
-  private:
-    void Start() {
-      while (true) {
-        // the epoch advances every 40 milliseconds.
-        std::this_thread::sleep_for(std::chrono::milliseconds(40));
-        ++curr_epoch_;
-      }
-    }
-
-  private:
-    static volatile cid_t curr_epoch_;
-    std::unique_ptr<std::thread> ts_thread_;
+// # of threads that can be in an epoch at the same time
+#define EPOCH_MAX_THREAD_COUNT 1024
+
+// A thread reclaims right away once it retired this much, and otherwise at
+// most once per epoch
+#define EPOCH_RECLAIM_BATCH_SIZE 256
+
+// Time between two epochs, in milliseconds
+#define EPOCH_LENGTH 40
+
+//===--------------------------------------------------------------------===//
+// Epoch Manager
+//===--------------------------------------------------------------------===//
+
+/**
+ * Epoch based reclamation of memory that running transactions might still be
+ * reading, like the versions and index entries removed by the GC.
+ *
+ * The global epoch advances every EPOCH_LENGTH milliseconds. A thread
+ * publishes the epoch it is in through its own slot while it runs a
+ * transaction, and clears the slot when it is done. Memory that is no longer
+ * reachable is retired into the lists of the retiring thread, tagged with the
+ * epoch, and reclaimed in batches once every thread has left that epoch.
+ *
+ * Entering and leaving an epoch only write the slot of the thread, nothing is
+ * allocated or shared per transaction. The index, the catalog and the varlen
+ * pools can retire their memory the same way the GC retires versions.
+ */
+class EpochManager {
+  EpochManager(EpochManager const &) = delete;
+
+ public:
+  EpochManager();
+
+  ~EpochManager();
+
+  static uint64_t GetEpoch() { return curr_epoch_.load(); }
+
+  // Done by the epoch thread, and by tests that do not want to wait for it
+  static void AdvanceEpoch() { curr_epoch_++; }
+
+  // Enter and leave the current epoch. Only the outermost pair counts.
+  void EnterEpoch();
+  void ExitEpoch();
+
+  bool IsInEpoch() const { return (thread_context_.depth > 0); }
+
+  // Publish the snapshot of the read-only transaction the thread runs, the
+  // GC keeps the versions it can see. Cleared when the thread leaves its
+  // epoch.
+  void SetSnapshotCid(const cid_t snapshot_cid);
+
+  // Oldest snapshot a thread reads, MAX_CID if there is none
+  cid_t GetOldestSnapshotCid() const;
+
+  // Free the object with the deleter once no thread can hold it anymore
+  void Retire(void *object, void (*deleter)(void *));
+
+  template <typename T>
+  void Retire(T *object) {
+    Retire(static_cast<void *>(object),
+           [](void *object) { delete static_cast<T *>(object); });
+  }
+
+  // Hand the tuple slot to the GC once no thread can read the version anymore
+  void RetireTupleSlot(const TupleMetadata &tuple_metadata);
+
+  // Reclaim what the calling thread retired before the oldest epoch a thread
+  // is in, along with what exited threads left behind. Returns the # of
+  // objects and tuple slots reclaimed.
+  size_t Reclaim();
+
+  // # of objects and tuple slots the calling thread retired and did not
+  // reclaim yet
+  size_t GetRetiredCount() const;
+
+  // Oldest epoch a thread is in. Everything retired before it can be
+  // reclaimed, and everything at all if no thread is in an epoch.
+  uint64_t GetSafeEpoch() const;
+
+ private:
+  struct RetiredObject {
+    uint64_t epoch;
+    void *object;
+    void (*deleter)(void *);
+  };
+
+  struct RetiredTupleSlot {
+    uint64_t epoch;
+    TupleMetadata tuple_metadata;
   };
 
-  
+  struct RetireList {
+    size_t GetSize() const { return objects.size() + tuple_slots.size(); }
+
+    std::vector<RetiredObject> objects;
+    std::vector<RetiredTupleSlot> tuple_slots;
+  };
+
+  // Slot of a thread, on a cache line of its own
+  struct EpochSlot {
+    // epoch the thread is in, 0 if it is in none
+    std::atomic<uint64_t> epoch;
+    // snapshot the thread reads, INVALID_CID if it reads none
+    std::atomic<cid_t> snapshot_cid;
+    std::atomic<bool> is_used;
+  } __attribute__((__aligned__(64)));
+
+  struct ThreadContext {
+    ~ThreadContext();
+
+    EpochSlot *slot = nullptr;
+
+    // # of nested EnterEpoch calls
+    size_t depth = 0;
+
+    // epoch of the last reclaim
+    uint64_t reclaimed_epoch = 0;
+
+    // reclaiming versions retires their index entries, which have to wait
+    bool is_reclaiming = false;
+
+    RetireList retire_list;
+  };
+
+  // The epoch thread
+  void Start();
+
+  EpochSlot *AcquireSlot();
+
+  // Reclaims the entries of the list retired before the safe epoch
+  size_t Reclaim(RetireList &retire_list, const uint64_t safe_epoch);
+
+  // Keeps what an exiting thread did not reclaim
+  void AddOrphans(RetireList &retire_list);
+
+  static std::atomic<uint64_t> curr_epoch_;
+
+  static thread_local ThreadContext thread_context_;
+
+  std::unique_ptr<std::thread> ts_thread_;
+
+  EpochSlot epoch_slots_[EPOCH_MAX_THREAD_COUNT];
+
+  // # of slots ever used
+  std::atomic<size_t> slot_count_;
+
+  // Retired by threads that exited
+  RetireList orphans_;
+
+  std::atomic<size_t> orphan_count_;
+
+  std::mutex orphans_mutex_;
+};
+
 class EpochManagerFactory {
  public:
   static EpochManager &GetInstance() {
@@ -61,5 +186,5 @@ class EpochManagerFactory {
   }
 };
 
-}
-}
\ No newline at end of file
+}  // End concurrency namespace
+}  // End peloton namespace
@@ -0,0 +1,244 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// hybrid_txn_manager.cpp
+//
+// Identification: src/backend/concurrency/hybrid_txn_manager.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "hybrid_txn_manager.h"
+
+#include <algorithm>
+
+#include "backend/concurrency/transaction.h"
+#include "backend/concurrency/transaction_manager_factory.h"
+#include "backend/catalog/manager.h"
+#include "backend/common/logger.h"
+#include "backend/storage/tile_group.h"
+#include "backend/storage/tile_group_header.h"
+
+namespace peloton {
+namespace concurrency {
+
+thread_local HybridTxnContext hybrid_txn_context;
+
+HybridTxnManager &HybridTxnManager::GetInstance() {
+  static HybridTxnManager txn_manager;
+  return txn_manager;
+}
+
+HybridTxnManager::~HybridTxnManager() {
+  auto table_stats = table_stats_.lock_table();
+  for (auto &item : table_stats) {
+    delete item.second;
+  }
+}
+
+// in a locked table, the tuple is locked exclusively before it is owned.
+bool HybridTxnManager::AcquireOwnership(
+    const storage::TileGroupHeader *const tile_group_header,
+    const oid_t &tile_group_id, const oid_t &tuple_id) {
+  ItemPointer location(tile_group_id, tuple_id);
+  auto table_id = GetTableId(location);
+
+  if (IsLocked(table_id) == true &&
+      AcquireLock(location, table_id, LOCK_MODE_EXCLUSIVE) == false) {
+    SetTransactionResult(Result::RESULT_FAILURE);
+    return false;
+  }
+
+  if (OptimisticTxnManager::AcquireOwnership(tile_group_header, tile_group_id,
+                                             tuple_id) == false) {
+    RecordConflict(table_id);
+    return false;
+  }
+  return true;
+}
+
+// in a locked table, the tuple is locked shared before it is read.
+bool HybridTxnManager::PerformRead(const ItemPointer &location) {
+  auto &rw_set = current_txn->GetRWSet();
+  if (rw_set.Find(location) != nullptr) {
+    // It was already accessed, and locked if it had to be
+    return true;
+  }
+
+  current_txn->RecordRead(location);
+
+  auto table_id = rw_set.Find(location)->tile_group->GetTableId();
+  if (IsLocked(table_id) == true &&
+      AcquireLock(location, table_id, LOCK_MODE_SHARED) == false) {
+    return false;
+  }
+  return true;
+}
+
+Result HybridTxnManager::AbortTransaction() {
+  // a read that would fail the validation is a conflict on its table. The
+  // versions are looked at before the aborted writes are undone.
+  auto txn_id = current_txn->GetTransactionId();
+  for (auto &entry : current_txn->GetRWSet()) {
+    if (entry.type != RW_TYPE_READ) {
+      continue;
+    }
+    auto tile_group_header = entry.GetTileGroupHeader();
+    auto tuple_slot = entry.location.offset;
+    auto tuple_txn_id = tile_group_header->GetTransactionId(tuple_slot);
+    if ((tuple_txn_id != INITIAL_TXN_ID && tuple_txn_id != txn_id) ||
+        tile_group_header->GetEndCommitId(tuple_slot) != MAX_CID) {
+      RecordConflict(entry.tile_group->GetTableId());
+    }
+  }
+
+  return OptimisticTxnManager::AbortTransaction();
+}
+
+void HybridTxnManager::EndTransaction() {
+  UpdateTableStats();
+
+  // The writes of the transaction are installed, or undone
+  ReleaseLocks();
+
+  OptimisticTxnManager::EndTransaction();
+}
+
+ConcurrencyType HybridTxnManager::GetTableMode(const oid_t table_id) {
+  return GetTableStats(table_id)->mode;
+}
+
+void HybridTxnManager::SetTableMode(const oid_t table_id,
+                                    const ConcurrencyType mode) {
+  auto stats = GetTableStats(table_id);
+  stats->mode = mode;
+  stats->txn_count = 0;
+  stats->conflict_count = 0;
+}
+
+HybridTableStats *HybridTxnManager::GetTableStats(const oid_t table_id) {
+  HybridTableStats *stats = nullptr;
+  if (table_stats_.find(table_id, stats) == true) {
+    return stats;
+  }
+
+  stats = new HybridTableStats();
+  if (table_stats_.insert(table_id, stats) == false) {
+    // another thread was faster
+    delete stats;
+    table_stats_.find(table_id, stats);
+  }
+  return stats;
+}
+
+oid_t HybridTxnManager::GetTableId(const ItemPointer &location) {
+  auto entry = current_txn->GetRWSet().Find(location);
+  if (entry != nullptr) {
+    return entry->tile_group->GetTableId();
+  }
+
+  auto &manager = catalog::Manager::GetInstance();
+  return manager.GetTileGroup(location.block)->GetTableId();
+}
+
+bool HybridTxnManager::AcquireLock(const ItemPointer &location,
+                                   const oid_t table_id, const LockMode mode) {
+  auto &tuple_locks = hybrid_txn_context.locks[location.block];
+  auto held_lock = tuple_locks.find(location.offset);
+  if (held_lock != tuple_locks.end() &&
+      (held_lock->second == LOCK_MODE_EXCLUSIVE || mode == LOCK_MODE_SHARED)) {
+    return true;
+  }
+
+  auto &lock_manager = LockManager::GetInstance();
+  if (lock_manager.AcquireLock(current_txn, location, mode,
+                               TransactionManagerFactory::GetLockPolicy(),
+                               nullptr) == false) {
+    LOG_TRACE("Txn %lu fails to lock %u %u", current_txn->GetTransactionId(),
+              location.block, location.offset);
+    RecordConflict(table_id);
+    return false;
+  }
+
+  if (held_lock != tuple_locks.end()) {
+    // the shared lock was upgraded, it is granted before the exclusive one
+    // and goes first
+    lock_manager.ReleaseLock(current_txn->GetTransactionId(), location);
+    held_lock->second = mode;
+  } else {
+    tuple_locks.emplace(location.offset, mode);
+  }
+  return true;
+}
+
+void HybridTxnManager::ReleaseLocks() {
+  auto &lock_manager = LockManager::GetInstance();
+  auto txn_id = current_txn->GetTransactionId();
+  for (auto &tile_group_locks : hybrid_txn_context.locks) {
+    for (auto &tuple_lock : tile_group_locks.second) {
+      lock_manager.ReleaseLock(
+          txn_id, ItemPointer(tile_group_locks.first, tuple_lock.first));
+    }
+  }
+  hybrid_txn_context.locks.clear();
+}
+
+void HybridTxnManager::RecordConflict(const oid_t table_id) {
+  auto &conflict_tables = hybrid_txn_context.conflict_tables;
+  if (std::find(conflict_tables.begin(), conflict_tables.end(), table_id) ==
+      conflict_tables.end()) {
+    conflict_tables.push_back(table_id);
+  }
+}
+
+void HybridTxnManager::UpdateTableStats() {
+  auto &conflict_tables = hybrid_txn_context.conflict_tables;
+  auto &table_ids = hybrid_txn_context.table_ids;
+
+  // A conflict on ownership may be on a tuple that was never read
+  table_ids = conflict_tables;
+  for (auto &entry : current_txn->GetRWSet()) {
+    auto table_id = entry.tile_group->GetTableId();
+    if (std::find(table_ids.begin(), table_ids.end(), table_id) ==
+        table_ids.end()) {
+      table_ids.push_back(table_id);
+    }
+  }
+
+  for (auto table_id : table_ids) {
+    auto stats = GetTableStats(table_id);
+    if (std::find(conflict_tables.begin(), conflict_tables.end(), table_id) !=
+        conflict_tables.end()) {
+      stats->conflict_count++;
+    }
+
+    // Only the transaction that closes the window decides. The transactions
+    // counted meanwhile by other threads may go to the next window.
+    if (++stats->txn_count != HYBRID_STATS_WINDOW) {
+      continue;
+    }
+    size_t conflict_count = stats->conflict_count.exchange(0);
+    stats->txn_count = 0;
+
+    auto mode = stats->mode.load();
+    if (mode == CONCURRENCY_TYPE_OPTIMISTIC &&
+        conflict_count * 100 >= HYBRID_LOCK_THRESHOLD * HYBRID_STATS_WINDOW) {
+      LOG_INFO("Table %u is locked, %lu conflicts in %d txns", table_id,
+               conflict_count, HYBRID_STATS_WINDOW);
+      stats->mode = CONCURRENCY_TYPE_PESSIMISTIC;
+    } else if (mode == CONCURRENCY_TYPE_PESSIMISTIC &&
+               conflict_count * 100 <=
+                   HYBRID_UNLOCK_THRESHOLD * HYBRID_STATS_WINDOW) {
+      LOG_INFO("Table %u is optimistic, %lu conflicts in %d txns", table_id,
+               conflict_count, HYBRID_STATS_WINDOW);
+      stats->mode = CONCURRENCY_TYPE_OPTIMISTIC;
+    }
+  }
+
+  conflict_tables.clear();
+}
+
+}  // End concurrency namespace
+}  // End peloton namespace
@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// hybrid_txn_manager.h
+//
+// Identification: src/backend/concurrency/hybrid_txn_manager.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+
+#include "backend/concurrency/optimistic_txn_manager.h"
+#include "backend/concurrency/lock_manager.h"
+#include "libcuckoo/cuckoohash_map.hh"
+
+namespace peloton {
+namespace concurrency {
+
+// # of transactions that touch a table between two decisions on its mode
+#define HYBRID_STATS_WINDOW 256
+
+// % of the transactions that conflict on an optimistic table before it is
+// locked
+#define HYBRID_LOCK_THRESHOLD 5
+
+// % of the transactions that conflict on a locked table before it goes back
+// to optimistic
+#define HYBRID_UNLOCK_THRESHOLD 1
+
+struct HybridTableStats {
+  std::atomic<size_t> txn_count{0};
+  std::atomic<size_t> conflict_count{0};
+
+  // CONCURRENCY_TYPE_OPTIMISTIC or CONCURRENCY_TYPE_PESSIMISTIC
+  std::atomic<ConcurrencyType> mode{CONCURRENCY_TYPE_OPTIMISTIC};
+};
+
+struct HybridTxnContext {
+  // strongest lock held on each tuple, by tile group
+  std::unordered_map<oid_t, std::unordered_map<oid_t, LockMode>> locks;
+
+  // tables the transaction ran into another one on
+  std::vector<oid_t> conflict_tables;
+
+  // tables the transaction touched, reused by every transaction
+  std::vector<oid_t> table_ids;
+};
+
+extern thread_local HybridTxnContext hybrid_txn_context;
+
+//===--------------------------------------------------------------------===//
+// hybrid concurrency control
+//===--------------------------------------------------------------------===//
+
+/**
+ * Optimistic concurrency control, that locks the tuples of contended tables.
+ *
+ * Each table is either optimistic or locked. The tuples of a locked table are
+ * locked in the lock manager before they are read or written, so that a
+ * transaction waits or aborts as soon as it runs into another one, instead of
+ * failing the validation at commit time. The commit is the one of the
+ * optimistic protocol for every table, the locks come on top of it. So a
+ * transaction can touch tables in both modes, and a table can change its mode
+ * while transactions are running.
+ *
+ * The mode of a table is chosen from the share of the transactions touching
+ * it that conflicted on it, over the last HYBRID_STATS_WINDOW of them.
+ */
+class HybridTxnManager : public OptimisticTxnManager {
+ public:
+  HybridTxnManager() {}
+
+  virtual ~HybridTxnManager();
+
+  static HybridTxnManager &GetInstance();
+
+  virtual bool AcquireOwnership(
+      const storage::TileGroupHeader *const tile_group_header,
+      const oid_t &tile_group_id, const oid_t &tuple_id);
+
+  virtual bool PerformRead(const ItemPointer &location);
+
+  virtual Result AbortTransaction();
+
+  virtual void EndTransaction();
+
+  ConcurrencyType GetTableMode(const oid_t table_id);
+
+  // The statistics of the table start over
+  void SetTableMode(const oid_t table_id, const ConcurrencyType mode);
+
+ private:
+  HybridTableStats *GetTableStats(const oid_t table_id);
+
+  oid_t GetTableId(const ItemPointer &location);
+
+  bool IsLocked(const oid_t table_id) {
+    return GetTableMode(table_id) == CONCURRENCY_TYPE_PESSIMISTIC;
+  }
+
+  // Returns false if the transaction has to abort
+  bool AcquireLock(const ItemPointer &location, const oid_t table_id,
+                   const LockMode mode);
+
+  void ReleaseLocks();
+
+  void RecordConflict(const oid_t table_id);
+
+  // Counts the transaction in the statistics of the tables it touched, and
+  // changes their mode at the end of a window
+  void UpdateTableStats();
+
+  cuckoohash_map<oid_t, HybridTableStats *> table_stats_;
+};
+}
+}
@@ -0,0 +1,208 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// lock_manager.cpp
+//
+// Identification: src/backend/concurrency/lock_manager.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "backend/concurrency/lock_manager.h"
+
+#include <cassert>
+#include <chrono>
+
+#include "backend/common/logger.h"
+#include "backend/concurrency/transaction.h"
+
+namespace peloton {
+namespace concurrency {
+
+LockManager &LockManager::GetInstance() {
+  static LockManager lock_manager;
+  return lock_manager;
+}
+
+bool LockManager::AcquireLock(Transaction *txn, const ItemPointer &location,
+                              const LockMode mode, const LockPolicyType policy,
+                              const std::function<bool()> &try_lock) {
+  if (txn->IsWounded() == true) {
+    LOG_TRACE("Txn %lu was wounded", txn->GetTransactionId());
+    return false;
+  }
+
+  LockRequest request;
+  request.txn = txn;
+  request.txn_id = txn->GetTransactionId();
+  request.mode = mode;
+
+  auto key = GetKey(location);
+  auto &shard = GetShard(key);
+  std::unique_lock<std::mutex> lock(shard.mutex);
+  auto queue_itr = shard.queues.emplace(key, LockQueue()).first;
+  auto &queue = queue_itr->second;
+
+  // Requests do not overtake the waiters, so that readers cannot starve a
+  // writer
+  if (queue.waiters.empty() == true &&
+      TryLock(queue, request, try_lock) == true) {
+    queue.holders.push_back(request);
+    return true;
+  }
+
+  if (ShouldWait(queue, request, policy) == false) {
+    if (queue.holders.empty() == true && queue.waiters.empty() == true) {
+      shard.queues.erase(queue_itr);
+    }
+    return false;
+  }
+
+  queue.waiters.push_back(request);
+
+  // wounded waiters of this shard leave right away
+  if (policy == LOCK_POLICY_WOUND_WAIT) {
+    shard.cv.notify_all();
+  }
+
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::milliseconds(LOCK_WAIT_TIMEOUT);
+  bool is_granted = false;
+  while (true) {
+    if (queue.waiters.front().txn_id == request.txn_id &&
+        TryLock(queue, request, try_lock) == true) {
+      is_granted = true;
+      break;
+    }
+
+    // Waiters wounded while waiting for a lock of another shard are not
+    // woken up, so they look again after a while
+    if (txn->IsWounded() == true ||
+        std::chrono::steady_clock::now() >= deadline) {
+      LOG_TRACE("Txn %lu gives up waiting", request.txn_id);
+      break;
+    }
+    shard.cv.wait_for(lock, std::chrono::microseconds(LOCK_WAIT_SLICE));
+  }
+
+  for (auto itr = queue.waiters.begin(); itr != queue.waiters.end(); itr++) {
+    if (itr->txn_id == request.txn_id) {
+      queue.waiters.erase(itr);
+      break;
+    }
+  }
+
+  if (is_granted == true) {
+    queue.holders.push_back(request);
+  } else if (queue.holders.empty() == true && queue.waiters.empty() == true) {
+    shard.queues.erase(queue_itr);
+    return false;
+  }
+
+  // The next waiter is at the front now, and readers can share the lock
+  if (queue.waiters.empty() == false) {
+    shard.cv.notify_all();
+  }
+
+  return is_granted;
+}
+
+void LockManager::ReleaseLock(const txn_id_t &txn_id,
+                              const ItemPointer &location) {
+  auto key = GetKey(location);
+  auto &shard = GetShard(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  auto queue_itr = shard.queues.find(key);
+  assert(queue_itr != shard.queues.end());
+  if (queue_itr == shard.queues.end()) {
+    LOG_ERROR("Releasing lock on %u %u that is not held", location.block,
+              location.offset);
+    return;
+  }
+
+  auto &queue = queue_itr->second;
+  for (auto itr = queue.holders.begin(); itr != queue.holders.end(); itr++) {
+    if (itr->txn_id == txn_id) {
+      queue.holders.erase(itr);
+      break;
+    }
+  }
+
+  if (queue.waiters.empty() == false) {
+    shard.cv.notify_all();
+  } else if (queue.holders.empty() == true) {
+    shard.queues.erase(queue_itr);
+  }
+}
+
+size_t LockManager::GetLockCount() {
+  size_t lock_count = 0;
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    lock_count += shard.queues.size();
+  }
+  return lock_count;
+}
+
+bool LockManager::IsCompatible(const LockQueue &queue,
+                               const LockRequest &request) const {
+  for (auto &holder : queue.holders) {
+    if (holder.txn_id == request.txn_id) {
+      continue;
+    }
+    if (request.mode == LOCK_MODE_EXCLUSIVE ||
+        holder.mode == LOCK_MODE_EXCLUSIVE) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool LockManager::ShouldWait(LockQueue &queue, const LockRequest &request,
+                             const LockPolicyType policy) {
+  if (policy == LOCK_POLICY_NO_WAIT) {
+    return false;
+  }
+
+  if (queue.waiters.size() >= LOCK_MAX_WAITER_COUNT) {
+    LOG_TRACE("Too many waiters, txn %lu aborts", request.txn_id);
+    return false;
+  }
+
+  // The request waits for the holders it conflicts with, and for every
+  // waiter ahead of it
+  bool is_oldest = true;
+  auto check_conflict = [&](const LockRequest &other) {
+    if (other.txn_id == request.txn_id) {
+      // the lock it upgrades
+      return;
+    } else if (other.txn_id < request.txn_id) {
+      is_oldest = false;
+    } else if (policy == LOCK_POLICY_WOUND_WAIT) {
+      other.txn->Wound();
+    }
+  };
+
+  for (auto &holder : queue.holders) {
+    if (request.mode == LOCK_MODE_SHARED && holder.mode == LOCK_MODE_SHARED) {
+      continue;
+    }
+    check_conflict(holder);
+  }
+  for (auto &waiter : queue.waiters) {
+    check_conflict(waiter);
+  }
+
+  // Under wound-wait the younger ones abort, and the request waits for the
+  // older ones
+  if (policy == LOCK_POLICY_WAIT_DIE) {
+    return is_oldest;
+  }
+  return true;
+}
+
+}  // End concurrency namespace
+}  // End peloton namespace
@@ -0,0 +1,145 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// lock_manager.h
+//
+// Identification: src/backend/concurrency/lock_manager.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "backend/common/types.h"
+
+namespace peloton {
+namespace concurrency {
+
+class Transaction;
+
+// # of shards of the lock table
+#define LOCK_TABLE_SHARD_COUNT 256
+
+// # of transactions that can wait for a tuple. Requests beyond that abort
+// right away, like they do without waiting.
+#define LOCK_MAX_WAITER_COUNT 16
+
+// Time a request waits at most before it gives up, in milliseconds
+#define LOCK_WAIT_TIMEOUT 100
+
+// Time a waiting request sleeps before it checks whether it was wounded, in
+// microseconds
+#define LOCK_WAIT_SLICE 500
+
+enum LockMode {
+  LOCK_MODE_SHARED,
+  LOCK_MODE_EXCLUSIVE
+};
+
+//===--------------------------------------------------------------------===//
+// Lock Manager
+//===--------------------------------------------------------------------===//
+
+/**
+ * Waiting queues for the tuple locks of the pessimistic transaction manager.
+ *
+ * The locks themselves stay in the transaction id of the tuple header. The
+ * lock manager latches the tuple, takes the lock in the header through the
+ * given function and remembers the holders. A request that conflicts is
+ * queued behind the waiters of the tuple, and granted in order once the
+ * holders release the lock.
+ *
+ * Deadlocks are prevented with the age of the transactions, older ones have
+ * smaller transaction ids. Under wait-die a request only waits if it is older
+ * than the holders and the waiters of the tuple, and aborts otherwise. Under
+ * wound-wait a request wounds the younger ones and waits, a wounded
+ * transaction aborts at its next lock request.
+ *
+ * The hybrid transaction manager keeps its locks in the lock table only,
+ * those are shared or exclusive, and a transaction can upgrade its own shared
+ * lock.
+ *
+ * The queues are bounded, and so is the time a request waits.
+ */
+class LockManager {
+  LockManager(LockManager const &) = delete;
+
+ public:
+  LockManager() {}
+
+  static LockManager &GetInstance();
+
+  // Lock the tuple for the transaction. try_lock takes the lock in the tuple
+  // header, and is called with the tuple latched. Without try_lock the lock
+  // is only held in the lock table. Returns false if the transaction has to
+  // abort.
+  bool AcquireLock(Transaction *txn, const ItemPointer &location,
+                   const LockMode mode, const LockPolicyType policy,
+                   const std::function<bool()> &try_lock);
+
+  // Forget the lock of the transaction and wake up the waiters of the tuple.
+  // The lock in the tuple header must have been released already.
+  void ReleaseLock(const txn_id_t &txn_id, const ItemPointer &location);
+
+  // # of tuples that are locked or waited for
+  size_t GetLockCount();
+
+ private:
+  struct LockRequest {
+    Transaction *txn;
+    txn_id_t txn_id;
+    LockMode mode;
+  };
+
+  struct LockQueue {
+    std::vector<LockRequest> holders;
+
+    // in the order they are granted
+    std::vector<LockRequest> waiters;
+  };
+
+  struct LockShard {
+    std::mutex mutex;
+
+    // woken up whenever a lock of the shard is released
+    std::condition_variable cv;
+
+    std::unordered_map<uint64_t, LockQueue> queues;
+  } __attribute__((__aligned__(64)));
+
+  static uint64_t GetKey(const ItemPointer &location) {
+    return (static_cast<uint64_t>(location.block) << 32) |
+           static_cast<uint64_t>(location.offset);
+  }
+
+  LockShard &GetShard(const uint64_t key) {
+    return shards_[(key ^ (key >> 32)) % LOCK_TABLE_SHARD_COUNT];
+  }
+
+  // Whether the request can share the lock with the other holders
+  bool IsCompatible(const LockQueue &queue, const LockRequest &request) const;
+
+  // Grants the request if the lock is free
+  bool TryLock(const LockQueue &queue, const LockRequest &request,
+               const std::function<bool()> &try_lock) const {
+    return try_lock ? try_lock() : IsCompatible(queue, request);
+  }
+
+  // Applies the policy to a request that conflicts with the queue. Returns
+  // false if the request has to abort.
+  bool ShouldWait(LockQueue &queue, const LockRequest &request,
+                  const LockPolicyType policy);
+
+  LockShard shards_[LOCK_TABLE_SHARD_COUNT];
+};
+
+}  // End concurrency namespace
+}  // End peloton namespace
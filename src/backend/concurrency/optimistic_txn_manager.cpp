@@ -116,6 +116,16 @@ bool OptimisticTxnManager::AcquireOwnership(
     SetTransactionResult(Result::RESULT_FAILURE);
     return false;
   }
+
+  // Another transaction may have updated the tuple and committed since it
+  // was checked to be ownable, then this version is no longer the latest.
+  if (tile_group_header->GetEndCommitId(tuple_id) != MAX_CID) {
+    LOG_TRACE("Tuple was updated before it was acquired. Set txn failure.");
+    tile_group_header->SetAtomicTransactionId(tuple_id, txn_id,
+                                              INITIAL_TXN_ID);
+    SetTransactionResult(Result::RESULT_FAILURE);
+    return false;
+  }
   return true;
 }
 
@@ -129,7 +139,8 @@ bool OptimisticTxnManager::PerformInsert(const ItemPointer &location) {
   oid_t tuple_id = location.offset;
 
   auto &manager = catalog::Manager::GetInstance();
-  auto tile_group_header = manager.GetTileGroup(tile_group_id)->GetHeader();
+  auto tile_group = manager.GetTileGroup(tile_group_id);
+  auto tile_group_header = tile_group->GetHeader();
   auto transaction_id = current_txn->GetTransactionId();
 
   // Set MVCC info
@@ -141,7 +152,7 @@ bool OptimisticTxnManager::PerformInsert(const ItemPointer &location) {
   // no need to set next item pointer.
 
   // Add the new tuple into the insert set
-  current_txn->RecordInsert(location);
+  current_txn->RecordInsert(location, tile_group);
   return true;
 }
 
@@ -176,7 +187,7 @@ void OptimisticTxnManager::PerformUpdate(const ItemPointer &old_location,
   new_tile_group_header->SetTransactionId(new_location.offset, transaction_id);
 
   // Add the old tuple into the update set
-  current_txn->RecordUpdate(old_location);
+  current_txn->RecordUpdate(old_location, new_tile_group_header);
 }
 
 // this function is invoked when it is NOT the first time to update the tuple.
@@ -230,7 +241,7 @@ void OptimisticTxnManager::PerformDelete(const ItemPointer &old_location,
   new_tile_group_header->SetEndCommitId(new_location.offset, INVALID_CID);
 
   // Add the old tuple into the delete set
-  current_txn->RecordDelete(old_location);
+  current_txn->RecordDelete(old_location, new_tile_group_header);
 }
 
 void OptimisticTxnManager::PerformDelete(const ItemPointer &location) {
@@ -260,36 +271,31 @@ void OptimisticTxnManager::PerformDelete(const ItemPointer &location) {
 Result OptimisticTxnManager::CommitTransaction() {
   LOG_TRACE("Committing peloton txn : %lu ", current_txn->GetTransactionId());
 
-  auto &manager = catalog::Manager::GetInstance();
-
   auto &rw_set = current_txn->GetRWSet();
 
   //*****************************************************
   // we can optimize read-only transaction.
   if (current_txn->IsReadOnly() == true) {
     // validate read set.
-    for (auto &tile_group_entry : rw_set) {
-      oid_t tile_group_id = tile_group_entry.first;
-      auto tile_group = manager.GetTileGroup(tile_group_id);
-      auto tile_group_header = tile_group->GetHeader();
-      for (auto &tuple_entry : tile_group_entry.second) {
-        auto tuple_slot = tuple_entry.first;
-        // if this tuple is not newly inserted.
-        if (tuple_entry.second == RW_TYPE_READ) {
-          if (tile_group_header->GetTransactionId(tuple_slot) ==
-                  INITIAL_TXN_ID &&
-              tile_group_header->GetBeginCommitId(tuple_slot) <=
-                  current_txn->GetBeginCommitId() &&
-              tile_group_header->GetEndCommitId(tuple_slot) >=
-                  current_txn->GetBeginCommitId()) {
-            // the version is not owned by other txns and is still visible.
-            continue;
-          }
-          // otherwise, validation fails. abort transaction.
-          return AbortTransaction();
-        } else {
-          assert(tuple_entry.second == RW_TYPE_INS_DEL);
+    for (auto &entry : rw_set) {
+      auto tile_group_header = entry.GetTileGroupHeader();
+      auto tuple_slot = entry.location.offset;
+      // if this tuple is not newly inserted.
+      if (entry.type == RW_TYPE_READ) {
+        if (tile_group_header->GetTransactionId(tuple_slot) ==
+                INITIAL_TXN_ID &&
+            tile_group_header->GetBeginCommitId(tuple_slot) <=
+                current_txn->GetBeginCommitId() &&
+            tile_group_header->GetEndCommitId(tuple_slot) >=
+                current_txn->GetBeginCommitId()) {
+          // the version is not owned by other txns and is still visible.
+          continue;
         }
+        // otherwise, validation fails. abort transaction.
+        RecordConflict(entry.location);
+        return AbortTransaction();
+      } else {
+        assert(entry.type == RW_TYPE_INS_DEL);
       }
     }
     // is it always true???
@@ -303,39 +309,35 @@ Result OptimisticTxnManager::CommitTransaction() {
   cid_t end_commit_id = GetNextCommitId();
 
   // validate read set.
-  for (auto &tile_group_entry : rw_set) {
-    oid_t tile_group_id = tile_group_entry.first;
-    auto tile_group = manager.GetTileGroup(tile_group_id);
-    auto tile_group_header = tile_group->GetHeader();
-    for (auto &tuple_entry : tile_group_entry.second) {
-      auto tuple_slot = tuple_entry.first;
-      // if this tuple is not newly inserted.
-      if (tuple_entry.second != RW_TYPE_INSERT &&
-          tuple_entry.second != RW_TYPE_INS_DEL) {
-        // if this tuple is owned by this txn, then it is safe.
+  for (auto &entry : rw_set) {
+    auto tile_group_header = entry.GetTileGroupHeader();
+    auto tuple_slot = entry.location.offset;
+    // if this tuple is not newly inserted.
+    if (entry.type != RW_TYPE_INSERT && entry.type != RW_TYPE_INS_DEL) {
+      // if this tuple is owned by this txn, then it is safe.
+      if (tile_group_header->GetTransactionId(tuple_slot) ==
+          current_txn->GetTransactionId()) {
+        // the version is owned by the transaction.
+        continue;
+      } else {
         if (tile_group_header->GetTransactionId(tuple_slot) ==
-            current_txn->GetTransactionId()) {
-          // the version is owned by the transaction.
+                INITIAL_TXN_ID &&
+            tile_group_header->GetBeginCommitId(tuple_slot) <=
+                end_commit_id &&
+            tile_group_header->GetEndCommitId(tuple_slot) >= end_commit_id) {
+          // the version is not owned by other txns and is still visible.
           continue;
-        } else {
-          if (tile_group_header->GetTransactionId(tuple_slot) ==
-                  INITIAL_TXN_ID &&
-              tile_group_header->GetBeginCommitId(tuple_slot) <=
-                  end_commit_id &&
-              tile_group_header->GetEndCommitId(tuple_slot) >= end_commit_id) {
-            // the version is not owned by other txns and is still visible.
-            continue;
-          }
         }
-        LOG_TRACE("transaction id=%lu",
-                  tile_group_header->GetTransactionId(tuple_slot));
-        LOG_TRACE("begin commit id=%lu",
-                  tile_group_header->GetBeginCommitId(tuple_slot));
-        LOG_TRACE("end commit id=%lu",
-                  tile_group_header->GetEndCommitId(tuple_slot));
-        // otherwise, validation fails. abort transaction.
-        return AbortTransaction();
       }
+      LOG_TRACE("transaction id=%lu",
+                tile_group_header->GetTransactionId(tuple_slot));
+      LOG_TRACE("begin commit id=%lu",
+                tile_group_header->GetBeginCommitId(tuple_slot));
+      LOG_TRACE("end commit id=%lu",
+                tile_group_header->GetEndCommitId(tuple_slot));
+      // otherwise, validation fails. abort transaction.
+      RecordConflict(entry.location);
+      return AbortTransaction();
     }
   }
   //////////////////////////////////////////////////////////
@@ -343,103 +345,100 @@ Result OptimisticTxnManager::CommitTransaction() {
   auto &log_manager = logging::LogManager::GetInstance();
   log_manager.LogBeginTransaction(end_commit_id);
   // install everything.
-  for (auto &tile_group_entry : rw_set) {
-    oid_t tile_group_id = tile_group_entry.first;
-    auto tile_group = manager.GetTileGroup(tile_group_id);
-    auto tile_group_header = tile_group->GetHeader();
-    for (auto &tuple_entry : tile_group_entry.second) {
-      auto tuple_slot = tuple_entry.first;
-      if (tuple_entry.second == RW_TYPE_UPDATE) {
-        // logging.
-        ItemPointer new_version =
-            tile_group_header->GetNextItemPointer(tuple_slot);
-        ItemPointer old_version(tile_group_id, tuple_slot);
-
-        // logging.
-        log_manager.LogUpdate(current_txn, end_commit_id, old_version,
-                              new_version);
-
-        // we must guarantee that, at any time point, AT LEAST ONE version is
-        // visible.
-        // we do not change begin cid for old tuple.
-        auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
-
-        new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
-        new_tile_group_header->SetBeginCommitId(new_version.offset,
-                                                end_commit_id);
-
-        COMPILER_MEMORY_FENCE;
-
-        tile_group_header->SetEndCommitId(tuple_slot, end_commit_id);
-
-        COMPILER_MEMORY_FENCE;
-
-        new_tile_group_header->SetTransactionId(new_version.offset,
-                                                INITIAL_TXN_ID);
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+  for (auto &entry : rw_set) {
+    oid_t tile_group_id = entry.location.block;
+    auto tile_group_header = entry.GetTileGroupHeader();
+    auto tuple_slot = entry.location.offset;
+    if (entry.type == RW_TYPE_UPDATE) {
+      // logging.
+      ItemPointer new_version =
+          tile_group_header->GetNextItemPointer(tuple_slot);
+      ItemPointer old_version(tile_group_id, tuple_slot);
+
+      // logging.
+      log_manager.LogUpdate(current_txn, end_commit_id, old_version,
+                            new_version);
+
+      // we must guarantee that, at any time point, AT LEAST ONE version is
+      // visible.
+      // we do not change begin cid for old tuple.
+      auto new_tile_group_header =
+          entry.GetNewTileGroupHeader(new_version);
+
+      new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
+      new_tile_group_header->SetBeginCommitId(new_version.offset,
+                                              end_commit_id);
+
+      COMPILER_MEMORY_FENCE;
+
+      tile_group_header->SetEndCommitId(tuple_slot, end_commit_id);
+
+      COMPILER_MEMORY_FENCE;
+
+      new_tile_group_header->SetTransactionId(new_version.offset,
+                                              INITIAL_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
 
 		// recycle the older version
 		RecycleTupleSlot(tile_group_id, tuple_slot, end_commit_id);
 
-      } else if (tuple_entry.second == RW_TYPE_DELETE) {
-        ItemPointer new_version =
-            tile_group_header->GetNextItemPointer(tuple_slot);
-        ItemPointer delete_location(tile_group_id, tuple_slot);
+    } else if (entry.type == RW_TYPE_DELETE) {
+      ItemPointer new_version =
+          tile_group_header->GetNextItemPointer(tuple_slot);
+      ItemPointer delete_location(tile_group_id, tuple_slot);
 
-        // logging.
-        log_manager.LogDelete(end_commit_id, delete_location);
+      // logging.
+      log_manager.LogDelete(end_commit_id, delete_location);
 
-        // we do not change begin cid for old tuple.
-        auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
+      // we do not change begin cid for old tuple.
+      auto new_tile_group_header =
+          entry.GetNewTileGroupHeader(new_version);
 
-        new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
-        new_tile_group_header->SetBeginCommitId(new_version.offset,
-                                                end_commit_id);
+      new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
+      new_tile_group_header->SetBeginCommitId(new_version.offset,
+                                              end_commit_id);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        tile_group_header->SetEndCommitId(tuple_slot, end_commit_id);
+      tile_group_header->SetEndCommitId(tuple_slot, end_commit_id);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        new_tile_group_header->SetTransactionId(new_version.offset,
-                                                INVALID_TXN_ID);
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+      new_tile_group_header->SetTransactionId(new_version.offset,
+                                              INVALID_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
 
 		// recycle the older version
 		RecycleTupleSlot(tile_group_id, tuple_slot, end_commit_id);
 
-      } else if (tuple_entry.second == RW_TYPE_INSERT) {
-        assert(tile_group_header->GetTransactionId(tuple_slot) ==
-               current_txn->GetTransactionId());
-        // set the begin commit id to persist insert
-        ItemPointer insert_location(tile_group_id, tuple_slot);
-        log_manager.LogInsert(current_txn, end_commit_id, insert_location);
+    } else if (entry.type == RW_TYPE_INSERT) {
+      assert(tile_group_header->GetTransactionId(tuple_slot) ==
+             current_txn->GetTransactionId());
+      // set the begin commit id to persist insert
+      ItemPointer insert_location(tile_group_id, tuple_slot);
+      log_manager.LogInsert(current_txn, end_commit_id, insert_location);
 
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-        tile_group_header->SetBeginCommitId(tuple_slot, end_commit_id);
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetBeginCommitId(tuple_slot, end_commit_id);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
 
-      } else if (tuple_entry.second == RW_TYPE_INS_DEL) {
-        assert(tile_group_header->GetTransactionId(tuple_slot) ==
-               current_txn->GetTransactionId());
+    } else if (entry.type == RW_TYPE_INS_DEL) {
+      assert(tile_group_header->GetTransactionId(tuple_slot) ==
+             current_txn->GetTransactionId());
 
-        // set the begin commit id to persist insert
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-        tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
+      // set the begin commit id to persist insert
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
 
 		// recycle the older version
 		RecycleTupleSlot(tile_group_id, tuple_slot, START_OID);
-      }
     }
   }
   log_manager.LogCommitTransaction(end_commit_id);
@@ -451,82 +450,77 @@ Result OptimisticTxnManager::CommitTransaction() {
 
 Result OptimisticTxnManager::AbortTransaction() {
   LOG_TRACE("Aborting peloton txn : %lu ", current_txn->GetTransactionId());
-  auto &manager = catalog::Manager::GetInstance();
 
   auto &rw_set = current_txn->GetRWSet();
 
-  for (auto &tile_group_entry : rw_set) {
-    oid_t tile_group_id = tile_group_entry.first;
-    auto tile_group = manager.GetTileGroup(tile_group_id);
-    auto tile_group_header = tile_group->GetHeader();
-
-    for (auto &tuple_entry : tile_group_entry.second) {
-      auto tuple_slot = tuple_entry.first;
-      if (tuple_entry.second == RW_TYPE_UPDATE) {
-        // we do not set begin cid for old tuple.
-        ItemPointer new_version =
-            tile_group_header->GetNextItemPointer(tuple_slot);
+  for (auto &entry : rw_set) {
+    oid_t tile_group_id = entry.location.block;
+    auto tile_group_header = entry.GetTileGroupHeader();
+    auto tuple_slot = entry.location.offset;
+    if (entry.type == RW_TYPE_UPDATE) {
+      // we do not set begin cid for old tuple.
+      ItemPointer new_version =
+          tile_group_header->GetNextItemPointer(tuple_slot);
 
-        auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
-        new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
-        new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
+      auto new_tile_group_header =
+          entry.GetNewTileGroupHeader(new_version);
+      new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
+      new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        new_tile_group_header->SetTransactionId(new_version.offset,
-                                                INVALID_TXN_ID);
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+      new_tile_group_header->SetTransactionId(new_version.offset,
+                                              INVALID_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
 
 		// recycle the newer version
 		RecycleTupleSlot(new_version.block, new_version.offset, START_OID);
-      } else if (tuple_entry.second == RW_TYPE_DELETE) {
-        ItemPointer new_version =
-            tile_group_header->GetNextItemPointer(tuple_slot);
+    } else if (entry.type == RW_TYPE_DELETE) {
+      ItemPointer new_version =
+          tile_group_header->GetNextItemPointer(tuple_slot);
 
-        auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
+      auto new_tile_group_header =
+          entry.GetNewTileGroupHeader(new_version);
 
-        new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
-        new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
+      new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
+      new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        new_tile_group_header->SetTransactionId(new_version.offset,
-                                                INVALID_TXN_ID);
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+      new_tile_group_header->SetTransactionId(new_version.offset,
+                                              INVALID_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
 
-        // recycle the newer version.
-        RecycleTupleSlot(new_version.block, new_version.offset, START_OID);
-      } else if (tuple_entry.second == RW_TYPE_INSERT) {
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-        tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
+      // recycle the newer version.
+      RecycleTupleSlot(new_version.block, new_version.offset, START_OID);
+    } else if (entry.type == RW_TYPE_INSERT) {
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
 
-        // recycle the newer version.
-        RecycleTupleSlot(tile_group_id, tuple_slot, START_OID);
-      } else if (tuple_entry.second == RW_TYPE_INS_DEL) {
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-        tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
+      // recycle the newer version.
+      RecycleTupleSlot(tile_group_id, tuple_slot, START_OID);
+    } else if (entry.type == RW_TYPE_INS_DEL) {
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
 
-        // recycle the newer version.
-        RecycleTupleSlot(tile_group_id, tuple_slot, START_OID);
-      }
+      // recycle the newer version.
+      RecycleTupleSlot(tile_group_id, tuple_slot, START_OID);
     }
   }
 
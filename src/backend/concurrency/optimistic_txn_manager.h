@@ -66,6 +66,8 @@ class OptimisticTxnManager : public TransactionManager {
   virtual Result AbortTransaction();
 
   virtual Transaction *BeginTransaction() {
+    EpochManagerFactory::GetInstance().EnterEpoch();
+
     txn_id_t txn_id = GetNextTransactionId();
     cid_t begin_cid = INVALID_CID;
     {
@@ -75,14 +77,8 @@ class OptimisticTxnManager : public TransactionManager {
           txn_id;
     }
 
-    Transaction *txn = new Transaction(txn_id, begin_cid);
+    Transaction *txn = Transaction::Acquire(txn_id, begin_cid);
     current_txn = txn;
-    if (gc::GCManagerFactory::GetGCType() == GC_TYPE_EPOCH) {
-      // create epoch with id same as this transactions begin_cid
-      current_epoch = new Epoch(begin_cid);
-      // current thread joins epoch for executing transaction
-      current_epoch->Join();
-    }
 
     return txn;
   }
@@ -92,29 +88,21 @@ class OptimisticTxnManager : public TransactionManager {
     if (gc::GCManagerFactory::GetGCType() == GC_TYPE_COOPERATIVE) {
       // If cooperative mode, then just call perform GC
       gc::GCManagerFactory::GetInstance().PerformGC();
-    } else if (gc::GCManagerFactory::GetGCType() == GC_TYPE_EPOCH) {
-      // order is important - first add to map, then call Leave();
-      AddEpochToMap(begin_cid, current_epoch);
     }
     {
       std::lock_guard<boost::detail::spinlock> guard(lock);
       running_txn_buckets_[begin_cid % RUNNING_TXN_BUCKET_NUM].erase(begin_cid);
     }
 
-    if (gc::GCManagerFactory::GetGCType() == GC_TYPE_EPOCH) {
-      if (current_epoch->Leave()) {
-        // if Leave() returns true, we can safely delete current_epoch
-        delete current_epoch;
-      }
-    }
-
-    current_epoch = nullptr;
-    delete current_txn;
+    Transaction::Release(current_txn);
     current_txn = nullptr;
+
+    // in epoch mode, this is where the retired versions get reclaimed
+    EpochManagerFactory::GetInstance().ExitEpoch();
   }
 
   // Returns the largest CID committed when this function was called
-  virtual cid_t GetMaxCommittedCid() {
+  virtual cid_t GetMaxCommittedCidOfRunningTxns() {
     cid_t min_running_cid = MAX_CID;
     for (size_t i = 0; i < RUNNING_TXN_BUCKET_NUM; ++i) {
       {
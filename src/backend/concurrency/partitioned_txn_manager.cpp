@@ -0,0 +1,200 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// partitioned_txn_manager.cpp
+//
+// Identification: src/backend/concurrency/partitioned_txn_manager.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "partitioned_txn_manager.h"
+
+#include <algorithm>
+
+#include "backend/concurrency/transaction.h"
+#include "backend/catalog/manager.h"
+#include "backend/common/exception.h"
+#include "backend/common/logger.h"
+#include "backend/common/value_peeker.h"
+#include "backend/storage/tile_group.h"
+#include "backend/storage/tile_group_header.h"
+
+namespace peloton {
+namespace concurrency {
+
+// Partitions owned by the transaction of the thread, in order
+thread_local std::vector<oid_t> owned_partition_ids;
+
+PartitionedTxnManager &PartitionedTxnManager::GetInstance() {
+  static PartitionedTxnManager txn_manager;
+  return txn_manager;
+}
+
+PartitionedTxnManager::PartitionedTxnManager() : partition_count_(1) {
+  for (auto &partition : partitions_) {
+    partition.begin_cid = MAX_CID;
+  }
+}
+
+void PartitionedTxnManager::SetPartitionCount(const size_t partition_count) {
+  if (partition_count == 0 || partition_count > PARTITION_MAX_COUNT) {
+    throw Exception("Invalid partition count :: " +
+                    std::to_string(partition_count));
+  }
+  partition_count_ = partition_count;
+}
+
+void PartitionedTxnManager::SetPartitionColumn(const oid_t table_id,
+                                               const oid_t column_id) {
+  partition_columns_[table_id] = column_id;
+}
+
+bool PartitionedTxnManager::IsInOwnedPartitions(const oid_t &tile_group_id,
+                                                const oid_t &tuple_id) {
+  if (owned_partition_ids.size() == partition_count_ ||
+      partition_columns_.empty() == true) {
+    return true;
+  }
+
+  auto tile_group = catalog::Manager::GetInstance().GetTileGroup(tile_group_id);
+  auto column_itr = partition_columns_.find(tile_group->GetTableId());
+  if (column_itr == partition_columns_.end()) {
+    return true;
+  }
+
+  auto partition_key = ValuePeeker::PeekAsBigInt(
+      tile_group->GetValue(tuple_id, column_itr->second));
+  return std::binary_search(owned_partition_ids.begin(),
+                            owned_partition_ids.end(),
+                            GetPartitionId((oid_t)partition_key));
+}
+
+// no other transaction should write the tuple. The CAS is still taken, so
+// that a transaction that declared the wrong partitions aborts instead of
+// overwriting another one. The version is only recorded now, as it is not
+// recorded when read.
+bool PartitionedTxnManager::AcquireOwnership(
+    const storage::TileGroupHeader *const tile_group_header,
+    const oid_t &tile_group_id, const oid_t &tuple_id) {
+  auto txn_id = current_txn->GetTransactionId();
+  if (IsInOwnedPartitions(tile_group_id, tuple_id) == false) {
+    LOG_TRACE("Txn %lu wrote an undeclared partition", txn_id);
+    SetTransactionResult(Result::RESULT_FAILURE);
+    return false;
+  }
+  if (tile_group_header->SetAtomicTransactionId(tuple_id, txn_id) == false) {
+    LOG_TRACE("Txn %lu wrote outside of its partitions", txn_id);
+    SetTransactionResult(Result::RESULT_FAILURE);
+    return false;
+  }
+  // a transaction outside of the partitions updated it meanwhile
+  if (tile_group_header->GetEndCommitId(tuple_id) != MAX_CID) {
+    LOG_TRACE("Txn %lu wrote outside of its partitions", txn_id);
+    tile_group_header->SetAtomicTransactionId(tuple_id, txn_id,
+                                              INITIAL_TXN_ID);
+    SetTransactionResult(Result::RESULT_FAILURE);
+    return false;
+  }
+  current_txn->RecordRead(ItemPointer(tile_group_id, tuple_id));
+  return true;
+}
+
+// reads need no validation, they are not recorded. Only the partition is
+// checked.
+bool PartitionedTxnManager::PerformRead(const ItemPointer &location) {
+  if (IsInOwnedPartitions(location.block, location.offset) == false) {
+    LOG_TRACE("Txn %lu read an undeclared partition",
+              current_txn->GetTransactionId());
+    return false;
+  }
+  return true;
+}
+
+Transaction *PartitionedTxnManager::BeginTransaction() {
+  std::vector<oid_t> partition_ids;
+  for (oid_t partition_id = 0; partition_id < partition_count_;
+       partition_id++) {
+    partition_ids.push_back(partition_id);
+  }
+  return BeginInPartitions(partition_ids);
+}
+
+Transaction *PartitionedTxnManager::BeginPartitionedTransaction(
+    const std::vector<oid_t> &partition_keys) {
+  if (partition_keys.empty() == true) {
+    return BeginTransaction();
+  }
+
+  std::vector<oid_t> partition_ids;
+  for (auto partition_key : partition_keys) {
+    partition_ids.push_back(GetPartitionId(partition_key));
+  }
+  std::sort(partition_ids.begin(), partition_ids.end());
+  partition_ids.erase(std::unique(partition_ids.begin(), partition_ids.end()),
+                      partition_ids.end());
+  return BeginInPartitions(partition_ids);
+}
+
+Transaction *PartitionedTxnManager::BeginInPartitions(
+    std::vector<oid_t> &partition_ids) {
+  assert(owned_partition_ids.empty() == true);
+  for (auto partition_id : partition_ids) {
+    partitions_[partition_id].mutex.lock();
+  }
+
+  // The waiting is over before the transaction holds back the reclamation
+  EpochManagerFactory::GetInstance().EnterEpoch();
+
+  txn_id_t txn_id = GetNextTransactionId();
+  cid_t begin_cid = GetNextCommitId();
+  for (auto partition_id : partition_ids) {
+    partitions_[partition_id].begin_cid = begin_cid;
+  }
+
+  Transaction *txn = Transaction::Acquire(txn_id, begin_cid);
+  current_txn = txn;
+  owned_partition_ids.swap(partition_ids);
+
+  LOG_TRACE("Txn %lu owns %lu partitions", txn_id, owned_partition_ids.size());
+  return txn;
+}
+
+void PartitionedTxnManager::EndTransaction() {
+  if (gc::GCManagerFactory::GetGCType() == GC_TYPE_COOPERATIVE) {
+    // If cooperative mode, then just call perform GC
+    gc::GCManagerFactory::GetInstance().PerformGC();
+  }
+
+  Transaction::Release(current_txn);
+  current_txn = nullptr;
+
+  // in epoch mode, this is where the retired versions get reclaimed
+  EpochManagerFactory::GetInstance().ExitEpoch();
+
+  // The commit is installed, the next transaction of the partitions sees it
+  for (auto itr = owned_partition_ids.rbegin();
+       itr != owned_partition_ids.rend(); itr++) {
+    partitions_[*itr].begin_cid = MAX_CID;
+    partitions_[*itr].mutex.unlock();
+  }
+  owned_partition_ids.clear();
+}
+
+cid_t PartitionedTxnManager::GetMaxCommittedCidOfRunningTxns() {
+  cid_t min_running_cid = MAX_CID;
+  for (oid_t partition_id = 0; partition_id < partition_count_;
+       partition_id++) {
+    min_running_cid =
+        std::min(min_running_cid, partitions_[partition_id].begin_cid.load());
+  }
+  if (min_running_cid == MAX_CID) {
+    return MAX_CID;
+  }
+  return min_running_cid - 1;
+}
+
+}  // End concurrency namespace
+}  // End peloton namespace
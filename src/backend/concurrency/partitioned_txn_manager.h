@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// partitioned_txn_manager.h
+//
+// Identification: src/backend/concurrency/partitioned_txn_manager.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "backend/concurrency/optimistic_txn_manager.h"
+
+namespace peloton {
+namespace concurrency {
+
+// # of partitions the data can be split into
+#define PARTITION_MAX_COUNT 1024
+
+//===--------------------------------------------------------------------===//
+// partitioned concurrency control
+//===--------------------------------------------------------------------===//
+
+/**
+ * Partitioned execution in the style of H-Store.
+ *
+ * The rows of every table are hash-partitioned by a partitioning key, like
+ * the warehouse in TPC-C, and a transaction declares the keys it touches when
+ * it begins. It then owns their partitions exclusively until it ends, so the
+ * transactions of a partition run one after the other. When each backend
+ * only runs the transactions of its own partitions, a single-partition
+ * transaction never waits, and multi-partition ones wait for the backends
+ * owning the other partitions. Partitions are taken in order, so that they
+ * cannot deadlock.
+ *
+ * As no other transaction can touch the rows of its partitions, a
+ * transaction neither checks nor records what it reads, owns the versions it
+ * writes without a CAS, and has nothing to validate at commit. The versions
+ * and the commit of the optimistic protocol are kept for the writes, they are
+ * the undo log of an abort. A transaction that declares no keys owns every
+ * partition.
+ *
+ * The partition of a row is that of the value of its table's partition
+ * column. A transaction that reads or writes a row of a partition it did not
+ * declare fails. Rows of tables without a partition column are not checked.
+ */
+class PartitionedTxnManager : public OptimisticTxnManager {
+ public:
+  PartitionedTxnManager();
+
+  virtual ~PartitionedTxnManager() {}
+
+  static PartitionedTxnManager &GetInstance();
+
+  virtual bool AcquireOwnership(
+      const storage::TileGroupHeader *const tile_group_header,
+      const oid_t &tile_group_id, const oid_t &tuple_id);
+
+  virtual bool PerformRead(const ItemPointer &location);
+
+  virtual Transaction *BeginTransaction();
+
+  virtual Transaction *BeginPartitionedTransaction(
+      const std::vector<oid_t> &partition_keys);
+
+  virtual void EndTransaction();
+
+  // Only while no transaction is running
+  void SetPartitionCount(const size_t partition_count);
+
+  size_t GetPartitionCount() const { return partition_count_; }
+
+  oid_t GetPartitionId(const oid_t partition_key) const {
+    return partition_key % partition_count_;
+  }
+
+  // Only while no transaction is running
+  void SetPartitionColumn(const oid_t table_id, const oid_t column_id);
+
+ protected:
+  virtual cid_t GetMaxCommittedCidOfRunningTxns();
+
+ private:
+  struct Partition {
+    std::mutex mutex;
+
+    // begin cid of the transaction that owns the partition, MAX_CID if none
+    std::atomic<cid_t> begin_cid;
+  } __attribute__((__aligned__(64)));
+
+  // Takes the partitions in order, and begins the transaction in them
+  Transaction *BeginInPartitions(std::vector<oid_t> &partition_ids);
+
+  // Whether the transaction owns the partition of the tuple
+  bool IsInOwnedPartitions(const oid_t &tile_group_id, const oid_t &tuple_id);
+
+  Partition partitions_[PARTITION_MAX_COUNT];
+
+  size_t partition_count_;
+
+  // partition column of every partitioned table
+  std::unordered_map<oid_t, oid_t> partition_columns_;
+};
+}
+}
@@ -16,6 +16,7 @@
 #include "backend/logging/log_manager.h"
 #include "backend/logging/records/transaction_record.h"
 #include "backend/concurrency/transaction.h"
+#include "backend/concurrency/transaction_manager_factory.h"
 #include "backend/catalog/manager.h"
 #include "backend/common/exception.h"
 #include "backend/common/logger.h"
@@ -108,6 +109,11 @@ bool PessimisticTxnManager::IsOwnable(
   auto tuple_txn_id = tile_group_header->GetTransactionId(tuple_id);
   auto tuple_end_cid = tile_group_header->GetEndCommitId(tuple_id);
   LOG_INFO("IsOwnable txnid: %lx end_cid: %lx", tuple_txn_id, tuple_end_cid);
+  if (TransactionManagerFactory::GetLockPolicy() != LOCK_POLICY_NO_WAIT) {
+    // AcquireOwnership waits for the holders of the lock
+    return EXTRACT_TXNID(tuple_txn_id) != INVALID_TXN_ID &&
+           tuple_end_cid == MAX_CID;
+  }
   // FIXME: actually when read count is not 0 this tuple is not accessable
   return EXTRACT_TXNID(tuple_txn_id) == INITIAL_TXN_ID &&
          tuple_end_cid == MAX_CID;
@@ -121,29 +127,78 @@ bool PessimisticTxnManager::AcquireOwnership(
 
   // First release read lock that is acquired before, the executor will always
   // read the tuple before calling AcquireOwnership().
-  ReleaseReadLock(tile_group_header, tuple_id);
+  ReleaseReadLock(tile_group_header, tile_group_id, tuple_id);
 
   // Mark the tuple as released
   pessimistic_released_rdlock[tile_group_id].insert(tuple_id);
 
   // Acquire write lock
   auto current_txn_id = current_txn->GetTransactionId();
-  bool res = tile_group_header->SetAtomicTransactionId(
-      tuple_id, PACK_TXNID(current_txn_id, 0));
-
-  if (res) {
-    return true;
+  auto lock_policy = TransactionManagerFactory::GetLockPolicy();
+  bool res = false;
+  if (lock_policy == LOCK_POLICY_NO_WAIT) {
+    res = tile_group_header->SetAtomicTransactionId(
+        tuple_id, PACK_TXNID(current_txn_id, 0));
   } else {
+    res = LockManager::GetInstance().AcquireLock(
+        current_txn, ItemPointer(tile_group_id, tuple_id), LOCK_MODE_EXCLUSIVE,
+        lock_policy, [&]() {
+          return tile_group_header->SetAtomicTransactionId(
+              tuple_id, PACK_TXNID(current_txn_id, 0));
+        });
+  }
+
+  if (res == false) {
     LOG_INFO("Fail to acquire write lock. Set txn failure.");
     return false;
   }
+
+  // The read lock was given up for a moment, another transaction may have
+  // updated the tuple in between
+  if (tile_group_header->GetEndCommitId(tuple_id) != MAX_CID) {
+    LOG_INFO("Tuple was updated before the write lock was acquired.");
+    tile_group_header->SetAtomicTransactionId(
+        tuple_id, PACK_TXNID(current_txn_id, 0), INITIAL_TXN_ID);
+    NotifyLockRelease(tile_group_id, tuple_id);
+    return false;
+  }
+
+  return true;
 }
 
-void PessimisticTxnManager::ReleaseReadLock(
+bool PessimisticTxnManager::AcquireReadLock(
     const storage::TileGroupHeader *const tile_group_header,
     const oid_t &tuple_id) {
   auto old_txn_id = tile_group_header->GetTransactionId(tuple_id);
 
+  // No one is holding the write lock
+  while (EXTRACT_TXNID(old_txn_id) == INITIAL_TXN_ID) {
+    LOG_TRACE("Current read count is %lu", EXTRACT_READ_COUNT(old_txn_id));
+    if (EXTRACT_READ_COUNT(old_txn_id) == READ_COUNT_MASK) {
+      LOG_TRACE("Reader limit reached, read failed");
+      return false;
+    }
+    auto new_read_count = EXTRACT_READ_COUNT(old_txn_id) + 1;
+    // Try add read count
+    auto new_txn_id = PACK_TXNID(INITIAL_TXN_ID, new_read_count);
+    LOG_TRACE("New txn id %lx", new_txn_id);
+    txn_id_t real_txn_id = tile_group_header->SetAtomicTransactionId(
+        tuple_id, old_txn_id, new_txn_id);
+    if (real_txn_id == old_txn_id) {
+      return true;
+    }
+    // See if there's writer
+    old_txn_id = real_txn_id;
+  }
+
+  return false;
+}
+
+void PessimisticTxnManager::ReleaseReadLock(
+    const storage::TileGroupHeader *const tile_group_header,
+    const oid_t &tile_group_id, const oid_t &tuple_id) {
+  auto old_txn_id = tile_group_header->GetTransactionId(tuple_id);
+
   LOG_TRACE("ReleaseReadLock on %lx", old_txn_id);
 
   if (EXTRACT_TXNID(old_txn_id) != INITIAL_TXN_ID) {
@@ -161,10 +216,21 @@ void PessimisticTxnManager::ReleaseReadLock(
     if (real_txn_id != old_txn_id) {
       // Assert there's no other writer
       assert(EXTRACT_TXNID(real_txn_id) == INITIAL_TXN_ID);
+      old_txn_id = real_txn_id;
     } else {
       break;
     }
   }
+
+  NotifyLockRelease(tile_group_id, tuple_id);
+}
+
+void PessimisticTxnManager::NotifyLockRelease(const oid_t &tile_group_id,
+                                              const oid_t &tuple_id) {
+  if (TransactionManagerFactory::GetLockPolicy() != LOCK_POLICY_NO_WAIT) {
+    LockManager::GetInstance().ReleaseLock(current_txn->GetTransactionId(),
+                                           ItemPointer(tile_group_id, tuple_id));
+  }
 }
 
 bool PessimisticTxnManager::PerformRead(const ItemPointer &location) {
@@ -177,12 +243,9 @@ bool PessimisticTxnManager::PerformRead(const ItemPointer &location) {
   auto tile_group_header = tile_group->GetHeader();
 
   auto &rw_set = current_txn->GetRWSet();
-  auto tuple_map = rw_set.find(tile_group_id);
-  if (tuple_map != rw_set.end()) {
-    if (tuple_map->second.find(tuple_id) != tuple_map->second.end()) {
-      // It was already accessed, don't acquire read lock again
-      return true;
-    }
+  if (rw_set.Find(location) != nullptr) {
+    // It was already accessed, don't acquire read lock again
+    return true;
   }
 
   if (IsOwner(tile_group_header, tuple_id)) {
@@ -190,34 +253,21 @@ bool PessimisticTxnManager::PerformRead(const ItemPointer &location) {
   }
 
   // Try to acquire read lock.
-  auto old_txn_id = tile_group_header->GetTransactionId(tuple_id);
-  // No one is holding the write lock
-  if (EXTRACT_TXNID(old_txn_id) == INITIAL_TXN_ID) {
-    LOG_TRACE("No one holding the lock");
-    while (true) {
-      LOG_TRACE("Current read count is %lu", EXTRACT_READ_COUNT(old_txn_id));
-      if (old_txn_id == 0xFF) {
-        LOG_TRACE("Reader limit reached, read failed");
-        return false;
-      }
-      auto new_read_count = EXTRACT_READ_COUNT(old_txn_id) + 1;
-      // Try add read count
-      auto new_txn_id = PACK_TXNID(INITIAL_TXN_ID, new_read_count);
-      LOG_TRACE("New txn id %lx", new_txn_id);
-      txn_id_t real_txn_id = tile_group_header->SetAtomicTransactionId(
-          tuple_id, old_txn_id, new_txn_id);
-      if (real_txn_id != old_txn_id) {
-        // See if there's writer
-        if (EXTRACT_TXNID(real_txn_id) != INITIAL_TXN_ID) return false;
-      } else {
-        break;
-      }
-    }
+  auto lock_policy = TransactionManagerFactory::GetLockPolicy();
+  bool res = false;
+  if (lock_policy == LOCK_POLICY_NO_WAIT) {
+    res = AcquireReadLock(tile_group_header, tuple_id);
   } else {
+    res = LockManager::GetInstance().AcquireLock(
+        current_txn, location, LOCK_MODE_SHARED, lock_policy,
+        [&]() { return AcquireReadLock(tile_group_header, tuple_id); });
+  }
+
+  if (res == false) {
     return false;
   }
 
-  current_txn->RecordRead(location);
+  current_txn->RecordRead(location, tile_group);
 
   return true;
 }
@@ -227,7 +277,8 @@ bool PessimisticTxnManager::PerformInsert(const ItemPointer &location) {
   oid_t tuple_id = location.offset;
 
   auto &manager = catalog::Manager::GetInstance();
-  auto tile_group_header = manager.GetTileGroup(tile_group_id)->GetHeader();
+  auto tile_group = manager.GetTileGroup(tile_group_id);
+  auto tile_group_header = tile_group->GetHeader();
   auto transaction_id = current_txn->GetTransactionId();
 
   // Set MVCC info
@@ -242,7 +293,7 @@ bool PessimisticTxnManager::PerformInsert(const ItemPointer &location) {
   // no need to set next item pointer.
 
   // Add the new tuple into the insert set
-  current_txn->RecordInsert(location);
+  current_txn->RecordInsert(location, tile_group);
   return true;
 }
 
@@ -280,7 +331,7 @@ void PessimisticTxnManager::PerformUpdate(const ItemPointer &old_location,
   new_tile_group_header->SetTransactionId(new_location.offset, transaction_id);
 
   // Add the old tuple into the update set
-  current_txn->RecordUpdate(old_location);
+  current_txn->RecordUpdate(old_location, new_tile_group_header);
 }
 
 void PessimisticTxnManager::PerformUpdate(const ItemPointer &location) {
@@ -330,7 +381,7 @@ void PessimisticTxnManager::PerformDelete(const ItemPointer &old_location,
   new_tile_group_header->SetTransactionId(new_location.offset, transaction_id);
   new_tile_group_header->SetEndCommitId(new_location.offset, INVALID_CID);
 
-  current_txn->RecordDelete(old_location);
+  current_txn->RecordDelete(old_location, new_tile_group_header);
 }
 
 void PessimisticTxnManager::PerformDelete(const ItemPointer &location) {
@@ -361,33 +412,28 @@ void PessimisticTxnManager::PerformDelete(const ItemPointer &location) {
 Result PessimisticTxnManager::CommitTransaction() {
   LOG_TRACE("Committing peloton txn : %lu ", current_txn->GetTransactionId());
 
-  auto &manager = catalog::Manager::GetInstance();
-
   auto &rw_set = current_txn->GetRWSet();
 
   //*****************************************************
   // we can optimize read-only transaction.
   if (current_txn->IsReadOnly() == true) {
     // validate read set.
-    for (auto &tile_group_entry : rw_set) {
-      oid_t tile_group_id = tile_group_entry.first;
-      auto tile_group = manager.GetTileGroup(tile_group_id);
-      auto tile_group_header = tile_group->GetHeader();
-      for (auto &tuple_entry : tile_group_entry.second) {
-        auto tuple_slot = tuple_entry.first;
-        // if this tuple is not newly inserted.
-        if (tuple_entry.second == RW_TYPE_READ) {
-          // Release read locks
-          if (pessimistic_released_rdlock.find(tile_group_id) ==
-                  pessimistic_released_rdlock.end() ||
-              pessimistic_released_rdlock[tile_group_id].find(tuple_slot) ==
-                  pessimistic_released_rdlock[tile_group_id].end()) {
-            ReleaseReadLock(tile_group_header, tuple_slot);
-            pessimistic_released_rdlock[tile_group_id].insert(tuple_slot);
-          }
-        } else {
-          assert(tuple_entry.second == RW_TYPE_INS_DEL);
+    for (auto &entry : rw_set) {
+      oid_t tile_group_id = entry.location.block;
+      auto tile_group_header = entry.GetTileGroupHeader();
+      auto tuple_slot = entry.location.offset;
+      // if this tuple is not newly inserted.
+      if (entry.type == RW_TYPE_READ) {
+        // Release read locks
+        if (pessimistic_released_rdlock.find(tile_group_id) ==
+                pessimistic_released_rdlock.end() ||
+            pessimistic_released_rdlock[tile_group_id].find(tuple_slot) ==
+                pessimistic_released_rdlock[tile_group_id].end()) {
+          ReleaseReadLock(tile_group_header, tile_group_id, tuple_slot);
+          pessimistic_released_rdlock[tile_group_id].insert(tuple_slot);
         }
+      } else {
+        assert(entry.type == RW_TYPE_INS_DEL);
       }
     }
     // is it always true???
@@ -404,101 +450,100 @@ Result PessimisticTxnManager::CommitTransaction() {
   log_manager.LogBeginTransaction(end_commit_id);
 
   // install everything.
-  for (auto &tile_group_entry : rw_set) {
-    oid_t tile_group_id = tile_group_entry.first;
-    auto tile_group = manager.GetTileGroup(tile_group_id);
-    auto tile_group_header = tile_group->GetHeader();
-    for (auto &tuple_entry : tile_group_entry.second) {
-      auto tuple_slot = tuple_entry.first;
-      if (tuple_entry.second == RW_TYPE_READ) {
-        // Release read locks
-        if (pessimistic_released_rdlock.find(tile_group_id) ==
-                pessimistic_released_rdlock.end() ||
-            pessimistic_released_rdlock[tile_group_id].find(tuple_slot) ==
-                pessimistic_released_rdlock[tile_group_id].end()) {
-          ReleaseReadLock(tile_group_header, tuple_slot);
-          pessimistic_released_rdlock[tile_group_id].insert(tuple_slot);
-        }
-      } else if (tuple_entry.second == RW_TYPE_UPDATE) {
-        // we must guarantee that, at any time point, only one version is
-        // visible.
-        ItemPointer new_version =
-            tile_group_header->GetNextItemPointer(tuple_slot);
-        ItemPointer old_version(tile_group_id, tuple_slot);
+  for (auto &entry : rw_set) {
+    oid_t tile_group_id = entry.location.block;
+    auto tile_group_header = entry.GetTileGroupHeader();
+    auto tuple_slot = entry.location.offset;
+    if (entry.type == RW_TYPE_READ) {
+      // Release read locks
+      if (pessimistic_released_rdlock.find(tile_group_id) ==
+              pessimistic_released_rdlock.end() ||
+          pessimistic_released_rdlock[tile_group_id].find(tuple_slot) ==
+              pessimistic_released_rdlock[tile_group_id].end()) {
+        ReleaseReadLock(tile_group_header, tile_group_id, tuple_slot);
+        pessimistic_released_rdlock[tile_group_id].insert(tuple_slot);
+      }
+    } else if (entry.type == RW_TYPE_UPDATE) {
+      // we must guarantee that, at any time point, only one version is
+      // visible.
+      ItemPointer new_version =
+          tile_group_header->GetNextItemPointer(tuple_slot);
+      ItemPointer old_version(tile_group_id, tuple_slot);
 
-        // logging.
-        log_manager.LogUpdate(current_txn, end_commit_id, old_version,
-                              new_version);
+      // logging.
+      log_manager.LogUpdate(current_txn, end_commit_id, old_version,
+                            new_version);
 
-        auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
+      auto new_tile_group_header =
+          entry.GetNewTileGroupHeader(new_version);
 
-        new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
-        new_tile_group_header->SetBeginCommitId(new_version.offset,
-                                                end_commit_id);
+      new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
+      new_tile_group_header->SetBeginCommitId(new_version.offset,
+                                              end_commit_id);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        tile_group_header->SetEndCommitId(tuple_slot, end_commit_id);
+      tile_group_header->SetEndCommitId(tuple_slot, end_commit_id);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        new_tile_group_header->SetTransactionId(new_version.offset,
-                                                INITIAL_TXN_ID);
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+      new_tile_group_header->SetTransactionId(new_version.offset,
+                                              INITIAL_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+      NotifyLockRelease(tile_group_id, tuple_slot);
 
-      } else if (tuple_entry.second == RW_TYPE_DELETE) {
-        ItemPointer new_version =
-            tile_group_header->GetNextItemPointer(tuple_slot);
-        ItemPointer delete_location(tile_group_id, tuple_slot);
+    } else if (entry.type == RW_TYPE_DELETE) {
+      ItemPointer new_version =
+          tile_group_header->GetNextItemPointer(tuple_slot);
+      ItemPointer delete_location(tile_group_id, tuple_slot);
 
-        // logging.
-        log_manager.LogDelete(end_commit_id, delete_location);
+      // logging.
+      log_manager.LogDelete(end_commit_id, delete_location);
 
-        // we do not change begin cid for old tuple.
-        auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
+      // we do not change begin cid for old tuple.
+      auto new_tile_group_header =
+          entry.GetNewTileGroupHeader(new_version);
 
-        new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
-        new_tile_group_header->SetBeginCommitId(new_version.offset,
-                                                end_commit_id);
+      new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
+      new_tile_group_header->SetBeginCommitId(new_version.offset,
+                                              end_commit_id);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        tile_group_header->SetEndCommitId(tuple_slot, end_commit_id);
+      tile_group_header->SetEndCommitId(tuple_slot, end_commit_id);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        new_tile_group_header->SetTransactionId(new_version.offset,
-                                                INVALID_TXN_ID);
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+      new_tile_group_header->SetTransactionId(new_version.offset,
+                                              INVALID_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+      NotifyLockRelease(tile_group_id, tuple_slot);
 
-      } else if (tuple_entry.second == RW_TYPE_INSERT) {
-        assert(tile_group_header->GetTransactionId(tuple_slot) ==
-               current_txn->GetTransactionId());
-        // set the begin commit id to persist insert
-        ItemPointer insert_location(tile_group_id, tuple_slot);
-        log_manager.LogInsert(current_txn, end_commit_id, insert_location);
+    } else if (entry.type == RW_TYPE_INSERT) {
+      assert(tile_group_header->GetTransactionId(tuple_slot) ==
+             current_txn->GetTransactionId());
+      // set the begin commit id to persist insert
+      ItemPointer insert_location(tile_group_id, tuple_slot);
+      log_manager.LogInsert(current_txn, end_commit_id, insert_location);
 
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-        tile_group_header->SetBeginCommitId(tuple_slot, end_commit_id);
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetBeginCommitId(tuple_slot, end_commit_id);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
 
-      } else if (tuple_entry.second == RW_TYPE_INS_DEL) {
-        assert(tile_group_header->GetTransactionId(tuple_slot) ==
-               current_txn->GetTransactionId());
+    } else if (entry.type == RW_TYPE_INS_DEL) {
+      assert(tile_group_header->GetTransactionId(tuple_slot) ==
+             current_txn->GetTransactionId());
 
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-        tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        // set the begin commit id to persist insert
-        tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
-      }
+      // set the begin commit id to persist insert
+      tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
     }
   }
   log_manager.LogCommitTransaction(end_commit_id);
@@ -512,78 +557,75 @@ Result PessimisticTxnManager::CommitTransaction() {
 
 Result PessimisticTxnManager::AbortTransaction() {
   LOG_TRACE("Aborting peloton txn : %lu ", current_txn->GetTransactionId());
-  auto &manager = catalog::Manager::GetInstance();
 
   auto &rw_set = current_txn->GetRWSet();
 
-  for (auto &tile_group_entry : rw_set) {
-    oid_t tile_group_id = tile_group_entry.first;
-    auto tile_group = manager.GetTileGroup(tile_group_id);
-    auto tile_group_header = tile_group->GetHeader();
-
-    for (auto &tuple_entry : tile_group_entry.second) {
-      auto tuple_slot = tuple_entry.first;
-      if (tuple_entry.second == RW_TYPE_READ) {
-        if (pessimistic_released_rdlock.find(tile_group_id) ==
-                pessimistic_released_rdlock.end() ||
-            pessimistic_released_rdlock[tile_group_id].find(tuple_slot) ==
-                pessimistic_released_rdlock[tile_group_id].end()) {
-          ReleaseReadLock(tile_group_header, tuple_slot);
-          pessimistic_released_rdlock[tile_group_id].insert(tuple_slot);
-        }
-      } else if (tuple_entry.second == RW_TYPE_UPDATE) {
-        ItemPointer new_version =
-            tile_group_header->GetNextItemPointer(tuple_slot);
-        auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
-        new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
-        new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
+  for (auto &entry : rw_set) {
+    oid_t tile_group_id = entry.location.block;
+    auto tile_group_header = entry.GetTileGroupHeader();
+    auto tuple_slot = entry.location.offset;
+    if (entry.type == RW_TYPE_READ) {
+      if (pessimistic_released_rdlock.find(tile_group_id) ==
+              pessimistic_released_rdlock.end() ||
+          pessimistic_released_rdlock[tile_group_id].find(tuple_slot) ==
+              pessimistic_released_rdlock[tile_group_id].end()) {
+        ReleaseReadLock(tile_group_header, tile_group_id, tuple_slot);
+        pessimistic_released_rdlock[tile_group_id].insert(tuple_slot);
+      }
+    } else if (entry.type == RW_TYPE_UPDATE) {
+      ItemPointer new_version =
+          tile_group_header->GetNextItemPointer(tuple_slot);
+      auto new_tile_group_header =
+          entry.GetNewTileGroupHeader(new_version);
+      new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
+      new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        new_tile_group_header->SetTransactionId(new_version.offset,
-                                                INVALID_TXN_ID);
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+      new_tile_group_header->SetTransactionId(new_version.offset,
+                                              INVALID_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+      NotifyLockRelease(tile_group_id, tuple_slot);
 
-      } else if (tuple_entry.second == RW_TYPE_DELETE) {
-        ItemPointer new_version =
-            tile_group_header->GetNextItemPointer(tuple_slot);
+    } else if (entry.type == RW_TYPE_DELETE) {
+      ItemPointer new_version =
+          tile_group_header->GetNextItemPointer(tuple_slot);
 
-        auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
+      auto new_tile_group_header =
+          entry.GetNewTileGroupHeader(new_version);
 
-        new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
-        new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
+      new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
+      new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        new_tile_group_header->SetTransactionId(new_version.offset,
-                                                INVALID_TXN_ID);
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+      new_tile_group_header->SetTransactionId(new_version.offset,
+                                              INVALID_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+      NotifyLockRelease(tile_group_id, tuple_slot);
 
-      } else if (tuple_entry.second == RW_TYPE_INSERT) {
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-        tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
+    } else if (entry.type == RW_TYPE_INSERT) {
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
-      } else if (tuple_entry.second == RW_TYPE_INS_DEL) {
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-        tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
+    } else if (entry.type == RW_TYPE_INS_DEL) {
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
 
-        COMPILER_MEMORY_FENCE;
+      COMPILER_MEMORY_FENCE;
 
-        tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
-      }
+      tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
     }
   }
 
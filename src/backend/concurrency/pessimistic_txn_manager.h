@@ -13,6 +13,7 @@
 #pragma once
 
 #include "backend/concurrency/transaction_manager.h"
+#include "backend/concurrency/lock_manager.h"
 
 namespace peloton {
 namespace concurrency {
@@ -64,9 +65,11 @@ class PessimisticTxnManager : public TransactionManager {
   virtual Result AbortTransaction();
 
   virtual Transaction *BeginTransaction() {
+    EpochManagerFactory::GetInstance().EnterEpoch();
+
     txn_id_t txn_id = GetNextTransactionId();
     cid_t begin_cid = GetNextCommitId();
-    Transaction *txn = new Transaction(txn_id, begin_cid);
+    Transaction *txn = Transaction::Acquire(txn_id, begin_cid);
     current_txn = txn;
 
     running_txn_buckets_[txn_id % RUNNING_TXN_BUCKET_NUM][txn_id] = begin_cid;
@@ -80,11 +83,13 @@ class PessimisticTxnManager : public TransactionManager {
     running_txn_buckets_[txn_id % RUNNING_TXN_BUCKET_NUM].erase(txn_id);
 
 
-    delete current_txn;
+    Transaction::Release(current_txn);
     current_txn = nullptr;
+
+    EpochManagerFactory::GetInstance().ExitEpoch();
   }
 
-  virtual cid_t GetMaxCommittedCid() {
+  virtual cid_t GetMaxCommittedCidOfRunningTxns() {
     cid_t min_running_cid = MAX_CID;
     for (size_t i = 0; i < RUNNING_TXN_BUCKET_NUM; ++i) {
       {
@@ -111,9 +116,16 @@ class PessimisticTxnManager : public TransactionManager {
     return (txn_id >> 56) & READ_COUNT_MASK;
   }
 
-  void ReleaseReadLock(const storage::TileGroupHeader *const tile_group_header,
+  bool AcquireReadLock(const storage::TileGroupHeader *const tile_group_header,
                        const oid_t &tuple_id);
 
+  void ReleaseReadLock(const storage::TileGroupHeader *const tile_group_header,
+                       const oid_t &tile_group_id, const oid_t &tuple_id);
+
+  // Hands the lock of the tuple to its waiters, once it is released in the
+  // tuple header
+  void NotifyLockRelease(const oid_t &tile_group_id, const oid_t &tuple_id);
+
   cuckoohash_map<txn_id_t, cid_t> running_txn_buckets_[RUNNING_TXN_BUCKET_NUM];
 };
 }
@@ -0,0 +1,183 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// rw_set.cpp
+//
+// Identification: src/backend/concurrency/rw_set.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "backend/concurrency/rw_set.h"
+
+#include <cassert>
+
+#include "backend/catalog/manager.h"
+#include "backend/storage/tile_group.h"
+
+namespace peloton {
+namespace concurrency {
+
+RWSetEntry::RWSetEntry(const ItemPointer &location, const RWType type,
+                       const std::shared_ptr<storage::TileGroup> &tile_group)
+    : location(location),
+      type(type),
+      tile_group(tile_group),
+      tile_group_header(tile_group->GetHeader()) {}
+
+storage::TileGroupHeader *RWSetEntry::GetTileGroupHeader() {
+  if (tile_group->IsReplaced() == true) {
+    auto &manager = catalog::Manager::GetInstance();
+    auto current_tile_group = manager.GetTileGroup(location.block);
+    if (current_tile_group != nullptr) {
+      tile_group = current_tile_group;
+      tile_group_header = tile_group->GetHeader();
+    }
+  }
+
+  return tile_group_header;
+}
+
+storage::TileGroupHeader *RWSetEntry::GetNewTileGroupHeader(
+    const ItemPointer &new_version) const {
+  if (new_tile_group_header != nullptr) {
+    return new_tile_group_header;
+  }
+
+  auto &manager = catalog::Manager::GetInstance();
+  return manager.GetTileGroup(new_version.block)->GetHeader();
+}
+
+thread_local std::vector<std::unique_ptr<RWSet::Buffer>> RWSet::cached_buffers;
+
+std::atomic<size_t> RWSet::allocation_count(0);
+
+RWSet::RWSet() {
+  if (cached_buffers.empty() == false) {
+    buffer = std::move(cached_buffers.back());
+    cached_buffers.pop_back();
+  } else {
+    buffer.reset(new Buffer());
+    buffer->slots.resize(RW_SET_INITIAL_SLOT_COUNT, 0);
+    allocation_count++;
+  }
+}
+
+RWSet::~RWSet() {
+  if (cached_buffers.size() >= RW_SET_CACHED_BUFFER_COUNT ||
+      buffer->entries.capacity() > RW_SET_MAX_CACHED_ENTRY_COUNT) {
+    return;
+  }
+
+  Clear();
+  cached_buffers.push_back(std::move(buffer));
+}
+
+void RWSet::Clear() {
+  // A buffer that grew too big is not kept
+  if (buffer->entries.capacity() > RW_SET_MAX_CACHED_ENTRY_COUNT) {
+    buffer.reset(new Buffer());
+    buffer->slots.resize(RW_SET_INITIAL_SLOT_COUNT, 0);
+    allocation_count++;
+    return;
+  }
+
+  // Only the slots that are in use need to be cleared. The probe sequence of
+  // an entry only runs over entries added before it, so going backwards
+  // finds each entry where it is.
+  auto &entries = buffer->entries;
+  while (entries.empty() == false) {
+    buffer->slots[Probe(entries.back().location)] = 0;
+    entries.pop_back();
+  }
+}
+
+RWSetEntry *RWSet::Find(const ItemPointer &location) {
+  auto slot = buffer->slots[Probe(location)];
+  if (slot == 0) {
+    return nullptr;
+  }
+  return &buffer->entries[slot - 1];
+}
+
+const RWSetEntry *RWSet::Find(const ItemPointer &location) const {
+  auto slot = buffer->slots[Probe(location)];
+  if (slot == 0) {
+    return nullptr;
+  }
+  return &buffer->entries[slot - 1];
+}
+
+RWSetEntry &RWSet::Add(const ItemPointer &location, const RWType type,
+                       const std::shared_ptr<storage::TileGroup> &tile_group) {
+  assert(Find(location) == nullptr);
+
+  // Keep at least half of the slots empty
+  if ((buffer->entries.size() + 1) * 2 > buffer->slots.size()) {
+    Grow();
+  }
+
+  buffer->entries.emplace_back(location, type, tile_group);
+  buffer->slots[Probe(location)] = buffer->entries.size();
+
+  return buffer->entries.back();
+}
+
+std::shared_ptr<storage::TileGroup> RWSet::GetRecentTileGroup(
+    const oid_t tile_group_id) const {
+  if (buffer->entries.empty() == false &&
+      buffer->entries.back().location.block == tile_group_id &&
+      buffer->entries.back().tile_group->IsReplaced() == false) {
+    return buffer->entries.back().tile_group;
+  }
+
+  return nullptr;
+}
+
+uint64_t RWSet::Hash(const ItemPointer &location) {
+  uint64_t key = (static_cast<uint64_t>(location.block) << 32) |
+                 static_cast<uint64_t>(location.offset);
+
+  // finalizer of MurmurHash3
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ULL;
+  key ^= key >> 33;
+
+  return key;
+}
+
+size_t RWSet::Probe(const ItemPointer &location) const {
+  auto &slots = buffer->slots;
+  size_t mask = slots.size() - 1;
+  size_t slot_itr = Hash(location) & mask;
+
+  // linear probing, there is always an empty slot
+  while (slots[slot_itr] != 0) {
+    auto &entry = buffer->entries[slots[slot_itr] - 1];
+    if (entry.location.block == location.block &&
+        entry.location.offset == location.offset) {
+      break;
+    }
+    slot_itr = (slot_itr + 1) & mask;
+  }
+
+  return slot_itr;
+}
+
+void RWSet::Grow() {
+  auto &slots = buffer->slots;
+  auto slot_count = slots.size() * 2;
+  slots.assign(slot_count, 0);
+
+  for (size_t entry_itr = 0; entry_itr < buffer->entries.size();
+       entry_itr++) {
+    slots[Probe(buffer->entries[entry_itr].location)] = entry_itr + 1;
+  }
+}
+
+}  // End concurrency namespace
+}  // End peloton namespace
@@ -0,0 +1,166 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// rw_set.h
+//
+// Identification: src/backend/concurrency/rw_set.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "backend/common/types.h"
+
+namespace peloton {
+
+namespace storage {
+class TileGroup;
+class TileGroupHeader;
+}
+
+namespace concurrency {
+
+enum RWType {
+  RW_TYPE_READ,
+  RW_TYPE_UPDATE,
+  RW_TYPE_INSERT,
+  RW_TYPE_DELETE,
+  RW_TYPE_INS_DEL  // delete after insert.
+};
+
+// # of hash slots a read/write set starts with
+#define RW_SET_INITIAL_SLOT_COUNT 64
+
+// Read/write sets of a thread kept around for its next transactions
+#define RW_SET_CACHED_BUFFER_COUNT 4
+
+// Buffers that grew bigger than this are not kept around
+#define RW_SET_MAX_CACHED_ENTRY_COUNT 64 * 1024
+
+//===--------------------------------------------------------------------===//
+// Read/Write Set Entry
+//===--------------------------------------------------------------------===//
+
+struct RWSetEntry {
+  RWSetEntry(const ItemPointer &location, const RWType type,
+             const std::shared_ptr<storage::TileGroup> &tile_group);
+
+  // Header of the tile group the version is in. The cached header is only
+  // out of date if the tile group was swapped for a copy, then the catalog
+  // is asked once.
+  storage::TileGroupHeader *GetTileGroupHeader();
+
+  // Header of the tile group of the new version the entry points to
+  storage::TileGroupHeader *GetNewTileGroupHeader(
+      const ItemPointer &new_version) const;
+
+  ItemPointer location;
+
+  RWType type;
+
+  // keeps the tile group alive for as long as the transaction runs
+  std::shared_ptr<storage::TileGroup> tile_group;
+
+  storage::TileGroupHeader *tile_group_header;
+
+  // tile group of the new version, for updates and deletes. Versions owned
+  // by the transaction are never swapped, so no reference is kept.
+  storage::TileGroupHeader *new_tile_group_header = nullptr;
+};
+
+//===--------------------------------------------------------------------===//
+// Read/Write Set
+//===--------------------------------------------------------------------===//
+
+/**
+ * Versions read and written by a transaction, in the order they were first
+ * accessed.
+ *
+ * The entries are appended to a flat array and found again through a small
+ * open addressing table. Both come from a per-thread cache and go back to it
+ * when the transaction is done, so after warming up a transaction allocates
+ * nothing for its read/write set.
+ *
+ * NOTE : Adding an entry moves the others, do not hold on to entries.
+ */
+class RWSet {
+  RWSet(RWSet const &) = delete;
+
+ public:
+  typedef std::vector<RWSetEntry>::iterator iterator;
+  typedef std::vector<RWSetEntry>::const_iterator const_iterator;
+
+  RWSet();
+
+  ~RWSet();
+
+  // Removes every entry, the set can be used again
+  void Clear();
+
+  // # of buffers allocated so far
+  static size_t GetAllocationCount() { return allocation_count.load(); }
+
+  // nullptr if the version is not in the set
+  RWSetEntry *Find(const ItemPointer &location);
+
+  const RWSetEntry *Find(const ItemPointer &location) const;
+
+  // The version must not be in the set yet
+  RWSetEntry &Add(const ItemPointer &location, const RWType type,
+                  const std::shared_ptr<storage::TileGroup> &tile_group);
+
+  // Tile group of the last entry that is in the given tile group, so that
+  // versions next to each other do not each ask the catalog
+  std::shared_ptr<storage::TileGroup> GetRecentTileGroup(
+      const oid_t tile_group_id) const;
+
+  size_t GetSize() const { return buffer->entries.size(); }
+
+  bool IsEmpty() const { return buffer->entries.empty(); }
+
+  iterator begin() { return buffer->entries.begin(); }
+
+  iterator end() { return buffer->entries.end(); }
+
+  const_iterator begin() const { return buffer->entries.begin(); }
+
+  const_iterator end() const { return buffer->entries.end(); }
+
+ private:
+  struct Buffer {
+    std::vector<RWSetEntry> entries;
+
+    // index + 1 of the entry in each slot, 0 if the slot is empty
+    std::vector<uint32_t> slots;
+  };
+
+  static uint64_t Hash(const ItemPointer &location);
+
+  // Slot of the location, or the empty slot it would go to
+  size_t Probe(const ItemPointer &location) const;
+
+  // Double the # of slots and put the entries back
+  void Grow();
+
+  // Buffers of the transactions that ended on this thread
+  static thread_local std::vector<std::unique_ptr<Buffer>> cached_buffers;
+
+  static std::atomic<size_t> allocation_count;
+
+  //===--------------------------------------------------------------------===//
+  // Data members
+  //===--------------------------------------------------------------------===//
+
+  std::unique_ptr<Buffer> buffer;
+};
+
+}  // End concurrency namespace
+}  // End peloton namespace
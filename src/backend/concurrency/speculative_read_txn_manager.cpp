@@ -135,8 +135,9 @@ bool SpeculativeReadTxnManager::PerformInsert(const ItemPointer &location) {
   oid_t tile_group_id = location.block;
   oid_t tuple_id = location.offset;
 
-  auto tile_group_header =
-      catalog::Manager::GetInstance().GetTileGroup(tile_group_id)->GetHeader();
+  auto tile_group =
+      catalog::Manager::GetInstance().GetTileGroup(tile_group_id);
+  auto tile_group_header = tile_group->GetHeader();
   auto transaction_id = current_txn->GetTransactionId();
   auto txn_begin_id = current_txn->GetBeginCommitId();
 
@@ -150,7 +151,7 @@ bool SpeculativeReadTxnManager::PerformInsert(const ItemPointer &location) {
 
   tile_group_header->SetTransactionId(tuple_id, transaction_id);
   // no need to set next item pointer.
-  current_txn->RecordInsert(location);
+  current_txn->RecordInsert(location, tile_group);
   return true;
 }
 
@@ -196,7 +197,7 @@ void SpeculativeReadTxnManager::PerformUpdate(const ItemPointer &old_location,
   // before changing the end_cid of the older version.
   tile_group_header->SetEndCommitId(old_location.offset, txn_begin_id);
 
-  current_txn->RecordUpdate(old_location);
+  current_txn->RecordUpdate(old_location, new_tile_group_header);
 }
 
 // this function is invoked when it is NOT the first time to update the tuple.
@@ -260,7 +261,7 @@ void SpeculativeReadTxnManager::PerformDelete(const ItemPointer &old_location,
 
   tile_group_header->SetEndCommitId(old_location.offset, txn_begin_id);
 
-  current_txn->RecordDelete(old_location);
+  current_txn->RecordDelete(old_location, new_tile_group_header);
 }
 
 void SpeculativeReadTxnManager::PerformDelete(const ItemPointer &location) {
@@ -292,8 +293,6 @@ void SpeculativeReadTxnManager::PerformDelete(const ItemPointer &location) {
 Result SpeculativeReadTxnManager::CommitTransaction() {
   LOG_INFO("Committing peloton txn : %lu ", current_txn->GetTransactionId());
 
-  auto &manager = catalog::Manager::GetInstance();
-
   auto &rw_set = current_txn->GetRWSet();
 
   // generate transaction id.
@@ -301,28 +300,24 @@ Result SpeculativeReadTxnManager::CommitTransaction() {
 
   // validation must be performed. otherwise, deadlock can occur.
   // validate read set.
-  for (auto &tile_group_entry : rw_set) {
-    oid_t tile_group_id = tile_group_entry.first;
-    auto tile_group = manager.GetTileGroup(tile_group_id);
-    auto tile_group_header = tile_group->GetHeader();
-    for (auto &tuple_entry : tile_group_entry.second) {
-      auto tuple_slot = tuple_entry.first;
-      if (tuple_entry.second != RW_TYPE_INSERT &&
-          tuple_entry.second != RW_TYPE_INS_DEL) {
-        if (tile_group_header->GetTransactionId(tuple_slot) ==
-            current_txn->GetTransactionId()) {
-          // the version is owned by the transaction.
+  for (auto &entry : rw_set) {
+    auto tile_group_header = entry.GetTileGroupHeader();
+    auto tuple_slot = entry.location.offset;
+    if (entry.type != RW_TYPE_INSERT && entry.type != RW_TYPE_INS_DEL) {
+      if (tile_group_header->GetTransactionId(tuple_slot) ==
+          current_txn->GetTransactionId()) {
+        // the version is owned by the transaction.
+        continue;
+      } else {
+        if (tile_group_header->GetBeginCommitId(tuple_slot) <=
+                end_commit_id &&
+            tile_group_header->GetEndCommitId(tuple_slot) >= end_commit_id) {
+          // the version is still visible.
           continue;
         } else {
-          if (tile_group_header->GetBeginCommitId(tuple_slot) <=
-                  end_commit_id &&
-              tile_group_header->GetEndCommitId(tuple_slot) >= end_commit_id) {
-            // the version is still visible.
-            continue;
-          } else {
-            // otherwise, validation fails. abort transaction.
-            return AbortTransaction();
-          }
+          // otherwise, validation fails. abort transaction.
+          RecordConflict(entry.location);
+          return AbortTransaction();
         }
       }
     }
@@ -336,70 +331,66 @@ Result SpeculativeReadTxnManager::CommitTransaction() {
   //////////////////////////////////////////////////////////
 
   // install everything.
-  for (auto &tile_group_entry : rw_set) {
-    oid_t tile_group_id = tile_group_entry.first;
-    auto tile_group = manager.GetTileGroup(tile_group_id);
-    auto tile_group_header = tile_group->GetHeader();
-    for (auto &tuple_entry : tile_group_entry.second) {
-      auto tuple_slot = tuple_entry.first;
-      if (tuple_entry.second == RW_TYPE_UPDATE) {
-        // we must guarantee that, at any time point, only one version is
-        // visible.
-        // we do not change begin cid for old tuple.
-        tile_group_header->SetEndCommitId(tuple_slot, end_commit_id);
-        ItemPointer new_version =
-            tile_group_header->GetNextItemPointer(tuple_slot);
-
-        auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
-        new_tile_group_header->SetBeginCommitId(new_version.offset,
-                                                end_commit_id);
-        new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
-
-        COMPILER_MEMORY_FENCE;
-
-        new_tile_group_header->SetTransactionId(new_version.offset,
-                                                INITIAL_TXN_ID);
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
-      } else if (tuple_entry.second == RW_TYPE_DELETE) {
-        // we do not change begin cid for old tuple.
-        tile_group_header->SetEndCommitId(tuple_slot, end_commit_id);
-        ItemPointer new_version =
-            tile_group_header->GetNextItemPointer(tuple_slot);
-
-        auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
-        new_tile_group_header->SetBeginCommitId(new_version.offset,
-                                                end_commit_id);
-        new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
-
-        COMPILER_MEMORY_FENCE;
-
-        new_tile_group_header->SetTransactionId(new_version.offset,
-                                                INVALID_TXN_ID);
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
-
-      } else if (tuple_entry.second == RW_TYPE_INSERT) {
-        assert(tile_group_header->GetTransactionId(tuple_slot) ==
-               current_txn->GetTransactionId());
-        // set the begin commit id to persist insert
-        tile_group_header->SetBeginCommitId(tuple_slot, end_commit_id);
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-
-        COMPILER_MEMORY_FENCE;
-
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
-      } else if (tuple_entry.second == RW_TYPE_INS_DEL) {
-        assert(tile_group_header->GetTransactionId(tuple_slot) ==
-               current_txn->GetTransactionId());
-        // set the begin commit id to persist insert
-        tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-
-        COMPILER_MEMORY_FENCE;
-
-        tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
-      }
+  for (auto &entry : rw_set) {
+    auto tile_group_header = entry.GetTileGroupHeader();
+    auto tuple_slot = entry.location.offset;
+    if (entry.type == RW_TYPE_UPDATE) {
+      // we must guarantee that, at any time point, only one version is
+      // visible.
+      // we do not change begin cid for old tuple.
+      tile_group_header->SetEndCommitId(tuple_slot, end_commit_id);
+      ItemPointer new_version =
+          tile_group_header->GetNextItemPointer(tuple_slot);
+
+      auto new_tile_group_header =
+          entry.GetNewTileGroupHeader(new_version);
+      new_tile_group_header->SetBeginCommitId(new_version.offset,
+                                              end_commit_id);
+      new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
+
+      COMPILER_MEMORY_FENCE;
+
+      new_tile_group_header->SetTransactionId(new_version.offset,
+                                              INITIAL_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+    } else if (entry.type == RW_TYPE_DELETE) {
+      // we do not change begin cid for old tuple.
+      tile_group_header->SetEndCommitId(tuple_slot, end_commit_id);
+      ItemPointer new_version =
+          tile_group_header->GetNextItemPointer(tuple_slot);
+
+      auto new_tile_group_header =
+          entry.GetNewTileGroupHeader(new_version);
+      new_tile_group_header->SetBeginCommitId(new_version.offset,
+                                              end_commit_id);
+      new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
+
+      COMPILER_MEMORY_FENCE;
+
+      new_tile_group_header->SetTransactionId(new_version.offset,
+                                              INVALID_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+
+    } else if (entry.type == RW_TYPE_INSERT) {
+      assert(tile_group_header->GetTransactionId(tuple_slot) ==
+             current_txn->GetTransactionId());
+      // set the begin commit id to persist insert
+      tile_group_header->SetBeginCommitId(tuple_slot, end_commit_id);
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+
+      COMPILER_MEMORY_FENCE;
+
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+    } else if (entry.type == RW_TYPE_INS_DEL) {
+      assert(tile_group_header->GetTransactionId(tuple_slot) ==
+             current_txn->GetTransactionId());
+      // set the begin commit id to persist insert
+      tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+
+      COMPILER_MEMORY_FENCE;
+
+      tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
     }
   }
 
@@ -414,62 +405,56 @@ Result SpeculativeReadTxnManager::CommitTransaction() {
 
 Result SpeculativeReadTxnManager::AbortTransaction() {
   LOG_INFO("Aborting peloton txn : %lu ", current_txn->GetTransactionId());
-  auto &manager = catalog::Manager::GetInstance();
 
   auto &rw_set = current_txn->GetRWSet();
 
-  for (auto &tile_group_entry : rw_set) {
-    oid_t tile_group_id = tile_group_entry.first;
-    auto tile_group = manager.GetTileGroup(tile_group_id);
-    auto tile_group_header = tile_group->GetHeader();
-
-    for (auto &tuple_entry : tile_group_entry.second) {
-      auto tuple_slot = tuple_entry.first;
-      if (tuple_entry.second == RW_TYPE_UPDATE) {
-        // we do not set begin cid for old tuple.
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-        ItemPointer new_version =
-            tile_group_header->GetNextItemPointer(tuple_slot);
-        auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
-        new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
-        new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
-
-        COMPILER_MEMORY_FENCE;
-
-        new_tile_group_header->SetTransactionId(new_version.offset,
-                                                INVALID_TXN_ID);
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
-
-      } else if (tuple_entry.second == RW_TYPE_DELETE) {
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-        ItemPointer new_version =
-            tile_group_header->GetNextItemPointer(tuple_slot);
-        auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
-        new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
-        new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
-
-        COMPILER_MEMORY_FENCE;
-
-        new_tile_group_header->SetTransactionId(new_version.offset,
-                                                INVALID_TXN_ID);
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
-      } else if (tuple_entry.second == RW_TYPE_INSERT) {
-        tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-
-        COMPILER_MEMORY_FENCE;
-
-        tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
-      } else if (tuple_entry.second == RW_TYPE_INS_DEL) {
-        tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-
-        COMPILER_MEMORY_FENCE;
-
-        tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
-      }
+  for (auto &entry : rw_set) {
+    auto tile_group_header = entry.GetTileGroupHeader();
+    auto tuple_slot = entry.location.offset;
+    if (entry.type == RW_TYPE_UPDATE) {
+      // we do not set begin cid for old tuple.
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+      ItemPointer new_version =
+          tile_group_header->GetNextItemPointer(tuple_slot);
+      auto new_tile_group_header =
+          entry.GetNewTileGroupHeader(new_version);
+      new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
+      new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
+
+      COMPILER_MEMORY_FENCE;
+
+      new_tile_group_header->SetTransactionId(new_version.offset,
+                                              INVALID_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+
+    } else if (entry.type == RW_TYPE_DELETE) {
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+      ItemPointer new_version =
+          tile_group_header->GetNextItemPointer(tuple_slot);
+      auto new_tile_group_header =
+          entry.GetNewTileGroupHeader(new_version);
+      new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
+      new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
+
+      COMPILER_MEMORY_FENCE;
+
+      new_tile_group_header->SetTransactionId(new_version.offset,
+                                              INVALID_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+    } else if (entry.type == RW_TYPE_INSERT) {
+      tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+
+      COMPILER_MEMORY_FENCE;
+
+      tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
+    } else if (entry.type == RW_TYPE_INS_DEL) {
+      tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+
+      COMPILER_MEMORY_FENCE;
+
+      tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
     }
   }
 
@@ -102,10 +102,12 @@ class SpeculativeReadTxnManager : public TransactionManager {
   virtual void PerformDelete(const ItemPointer &location);
 
   virtual Transaction *BeginTransaction() {
+    EpochManagerFactory::GetInstance().EnterEpoch();
+
     txn_id_t txn_id = GetNextTransactionId();
     cid_t begin_cid = GetNextCommitId();
 
-    Transaction *txn = new Transaction(txn_id, begin_cid);
+    Transaction *txn = Transaction::Acquire(txn_id, begin_cid);
     current_txn = txn;
     spec_txn_context.SetBeginCid(begin_cid);
 
@@ -126,11 +128,13 @@ class SpeculativeReadTxnManager : public TransactionManager {
     spec_txn_context.Clear();
 
 
-    delete current_txn;
+    Transaction::Release(current_txn);
     current_txn = nullptr;
+
+    EpochManagerFactory::GetInstance().ExitEpoch();
   }
 
-  virtual cid_t GetMaxCommittedCid() {
+  virtual cid_t GetMaxCommittedCidOfRunningTxns() {
     cid_t min_running_cid = MAX_CID;
     for (size_t i = 0; i < RUNNING_TXN_BUCKET_NUM; ++i) {
       {
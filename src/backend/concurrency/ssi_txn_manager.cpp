@@ -20,12 +20,26 @@
 #include "backend/common/exception.h"
 #include "backend/common/logger.h"
 
+#include <algorithm>
+#include <limits>
 #include <set>
 namespace peloton {
 namespace concurrency {
 
 thread_local SsiTxnContext *current_ssi_txn_ctx;
 
+// The context and its transaction go back to their pools once no thread can
+// hold them anymore
+static void RetireContext(EpochManager &epoch_manager, SsiTxnContext *ctx) {
+  epoch_manager.Retire(ctx->GetTransaction(), [](void *object) {
+    Transaction::Release(static_cast<Transaction *>(object));
+  });
+  epoch_manager.Retire(ctx, [](void *object) {
+    ObjectPool<SsiTxnContext>::GetInstance().Release(
+        static_cast<SsiTxnContext *>(object));
+  });
+}
+
 SsiTxnManager &SsiTxnManager::GetInstance() {
   static SsiTxnManager txn_manager;
   return txn_manager;
@@ -133,14 +147,14 @@ bool SsiTxnManager::AcquireOwnership(
         continue;
       }
 
-      auto end_cid = owner_ctx->transaction_->GetEndCommitId();
+      auto end_cid = owner_ctx->GetTransaction()->GetEndCommitId();
 
       // Owner is running, then siread lock owner has an out edge to me
       if (end_cid == INVALID_TXN_ID) {
         SetInConflict(current_ssi_txn_ctx);
         SetOutConflict(owner_ctx);
         LOG_INFO("set %ld in, set %ld out", txn_id,
-                 owner_ctx->transaction_->GetTransactionId());
+                 owner_ctx->GetTransaction()->GetTransactionId());
       } else {
         // Owner has commited and ownner commit after I start, then I must abort
         if (end_cid > current_txn->GetBeginCommitId() &&
@@ -178,8 +192,7 @@ bool SsiTxnManager::PerformRead(const ItemPointer &location) {
   auto txn_id = current_txn->GetTransactionId();
 
   auto &rw_set = current_txn->GetRWSet();
-  if (rw_set.count(tile_group_id) == 0 ||
-      rw_set.at(tile_group_id).count(tuple_id) == 0) {
+  if (rw_set.Find(location) == nullptr) {
     LOG_INFO("Not read before");
     // Previously, this tuple hasn't been read, add the txn to the reader list
     // of the tuple
@@ -187,32 +200,24 @@ bool SsiTxnManager::PerformRead(const ItemPointer &location) {
 
     auto writer = tile_group_header->GetTransactionId(tuple_id);
     // Another transaction is writting this tuple, add an edge
+    SsiTxnContext *writer_ctx = nullptr;
     if (writer != INVALID_TXN_ID && writer != INITIAL_TXN_ID &&
-        writer != txn_id) {
-      txn_manager_mutex_.ReadLock();
-
-      if (txn_table_.count(writer) != 0) {
-        // The writer have not been removed from the txn table
-        LOG_INFO("Writer %lu has no entry in txn table when read %u", writer,
-                 tuple_id);
-        SetInConflict(txn_table_.at(writer));
-        SetOutConflict(current_ssi_txn_ctx);
-      }
-
-      txn_manager_mutex_.Unlock();
+        writer != txn_id && FindContext(writer, writer_ctx) == true) {
+      // The writer have not been removed from the txn table
+      LOG_INFO("Writer %lu has an entry in txn table when read %u", writer,
+               tuple_id);
+      SetInConflict(writer_ctx);
+      SetOutConflict(current_ssi_txn_ctx);
     }
   }
 
   // existing SI code
-  current_txn->RecordRead(location);
+  current_txn->RecordRead(location, tile_group);
 
   // For each new version of the tuple
   {
-    // read only section
-    // read-lock
-    // This is a potential big overhead for read operations
-    txn_manager_mutex_.ReadLock();
-
+    // The contexts found in the txn table stay around until this
+    // transaction leaves its epoch, no lock is needed to look at them
     LOG_INFO("SI read phase 2");
 
     ItemPointer next_item = tile_group_header->GetNextItemPointer(tuple_id);
@@ -226,19 +231,15 @@ bool SsiTxnManager::PerformRead(const ItemPointer &location) {
 
       // Check creator status, skip if creator has commited before I start
       // or self is creator
+      SsiTxnContext *creator_ctx = nullptr;
       auto should_skip = false;
-      if (txn_table_.count(creator) == 0)
+      if (creator == txn_id || FindContext(creator, creator_ctx) == false)
         should_skip = true;
       else {
-        if (creator == txn_id)
+        auto end_cid = creator_ctx->GetTransaction()->GetEndCommitId();
+        if (end_cid != INVALID_TXN_ID &&
+            end_cid < current_txn->GetBeginCommitId()) {
           should_skip = true;
-        else {
-          auto ctx = txn_table_.at(creator);
-          if (ctx->transaction_->GetEndCommitId() != INVALID_TXN_ID &&
-              ctx->transaction_->GetEndCommitId() <
-                  current_txn->GetBeginCommitId()) {
-            should_skip = true;
-          }
         }
       }
 
@@ -248,19 +249,17 @@ bool SsiTxnManager::PerformRead(const ItemPointer &location) {
         continue;
       }
 
-      auto creator_ctx = txn_table_.at(creator);
       // Lock the transaction context
       creator_ctx->lock_.Lock();
 
       if (creator_ctx->is_abort_ == false) {
         // If creator committed and has out_confict, since creator has commited,
         // I must abort
-        if (creator_ctx->transaction_->GetEndCommitId() != INVALID_TXN_ID &&
+        if (creator_ctx->GetTransaction()->GetEndCommitId() != INVALID_TXN_ID &&
             creator_ctx->out_conflict_) {
           LOG_INFO("abort in read");
           // Unlock the transaction context
           creator_ctx->lock_.Unlock();
-          txn_manager_mutex_.Unlock();
           return false;
         }
         // Creator not commited, add an edge
@@ -273,7 +272,6 @@ bool SsiTxnManager::PerformRead(const ItemPointer &location) {
 
       next_item = tile_group->GetHeader()->GetNextItemPointer(next_item.offset);
     }
-    txn_manager_mutex_.Unlock();
   }
 
   return true;
@@ -285,8 +283,9 @@ bool SsiTxnManager::PerformInsert(const ItemPointer &location) {
 
   LOG_INFO("Perform insert %u %u", tile_group_id, tuple_id);
 
-  auto tile_group_header =
-      catalog::Manager::GetInstance().GetTileGroup(tile_group_id)->GetHeader();
+  auto tile_group =
+      catalog::Manager::GetInstance().GetTileGroup(tile_group_id);
+  auto tile_group_header = tile_group->GetHeader();
   auto transaction_id = current_txn->GetTransactionId();
 
   // Set MVCC info
@@ -297,7 +296,7 @@ bool SsiTxnManager::PerformInsert(const ItemPointer &location) {
   tile_group_header->SetTransactionId(tuple_id, transaction_id);
 
   // No need to set next item pointer.
-  current_txn->RecordInsert(location);
+  current_txn->RecordInsert(location, tile_group);
   // Init the creator of this tuple
   InitTupleReserved(current_txn->GetTransactionId(), tile_group_id, tuple_id);
   return true;
@@ -324,7 +323,7 @@ void SsiTxnManager::PerformUpdate(const ItemPointer &old_location,
   new_tile_group_header->SetBeginCommitId(new_location.offset, MAX_CID);
   new_tile_group_header->SetEndCommitId(new_location.offset, MAX_CID);
 
-  current_txn->RecordUpdate(old_location);
+  current_txn->RecordUpdate(old_location, new_tile_group_header);
 
   InitTupleReserved(transaction_id, new_location.block, new_location.offset);
   return true;
@@ -372,7 +371,7 @@ void SsiTxnManager::PerformDelete(const ItemPointer &old_location,
   new_tile_group_header->SetEndCommitId(new_location.offset, INVALID_CID);
 
   // Add the old tuple into the delete set
-  current_txn->RecordDelete(old_location);
+  current_txn->RecordDelete(old_location, new_tile_group_header);
   InitTupleReserved(transaction_id, new_location.block, new_location.offset);
   return true;
 }
@@ -403,7 +402,6 @@ void SsiTxnManager::PerformDelete(const ItemPointer &location) {
 Result SsiTxnManager::CommitTransaction() {
   LOG_INFO("Committing peloton txn : %lu ", current_txn->GetTransactionId());
 
-  auto &manager = catalog::Manager::GetInstance();
   auto &rw_set = current_txn->GetRWSet();
   cid_t end_commit_id = GetNextCommitId();
   Result ret;
@@ -435,84 +433,83 @@ Result SsiTxnManager::CommitTransaction() {
   auto &log_manager = logging::LogManager::GetInstance();
   log_manager.LogBeginTransaction(end_commit_id);
   // install everything.
-  for (auto &tile_group_entry : rw_set) {
-    oid_t tile_group_id = tile_group_entry.first;
-    auto tile_group = manager.GetTileGroup(tile_group_id);
-    auto tile_group_header = tile_group->GetHeader();
-    for (auto &tuple_entry : tile_group_entry.second) {
-      auto tuple_slot = tuple_entry.first;
-      if (tuple_entry.second == RW_TYPE_UPDATE) {
-        // we must guarantee that, at any time point, only one version is
-        // visible.
-        // we do not change begin cid for old tuple.
-        tile_group_header->SetEndCommitId(tuple_slot, end_commit_id);
-        ItemPointer new_version =
-            tile_group_header->GetNextItemPointer(tuple_slot);
-        ItemPointer old_version(tile_group_id, tuple_slot);
-        log_manager.LogUpdate(current_txn, end_commit_id, old_version,
-                              new_version);
-
-        auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
-        new_tile_group_header->SetBeginCommitId(new_version.offset,
-                                                end_commit_id);
-        new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
-
-        COMPILER_MEMORY_FENCE;
-
-        new_tile_group_header->SetTransactionId(new_version.offset,
-                                                INITIAL_TXN_ID);
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
-      } else if (tuple_entry.second == RW_TYPE_DELETE) {
-        // we do not change begin cid for old tuple.
-        tile_group_header->SetEndCommitId(tuple_slot, end_commit_id);
-        ItemPointer new_version =
-            tile_group_header->GetNextItemPointer(tuple_slot);
-        ItemPointer delete_location(tile_group_id, tuple_slot);
-        log_manager.LogDelete(end_commit_id, delete_location);
-        auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
-        new_tile_group_header->SetBeginCommitId(new_version.offset,
-                                                end_commit_id);
-        new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
-
-        COMPILER_MEMORY_FENCE;
-
-        new_tile_group_header->SetTransactionId(new_version.offset,
-                                                INVALID_TXN_ID);
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
-
-      } else if (tuple_entry.second == RW_TYPE_INSERT) {
-        assert(tile_group_header->GetTransactionId(tuple_slot) ==
-               current_txn->GetTransactionId());
-        // set the begin commit id to persist insert
-        ItemPointer insert_location(tile_group_id, tuple_slot);
-        log_manager.LogInsert(current_txn, end_commit_id, insert_location);
-
-        tile_group_header->SetBeginCommitId(tuple_slot, end_commit_id);
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-
-        COMPILER_MEMORY_FENCE;
-
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
-      } else if (tuple_entry.second == RW_TYPE_INS_DEL) {
-        assert(tile_group_header->GetTransactionId(tuple_slot) ==
-               current_txn->GetTransactionId());
-
-        // set the begin commit id to persist insert
-        tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-
-        COMPILER_MEMORY_FENCE;
-
-        tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
-      }
+  for (auto &entry : rw_set) {
+    oid_t tile_group_id = entry.location.block;
+    auto tile_group_header = entry.GetTileGroupHeader();
+    auto tuple_slot = entry.location.offset;
+    if (entry.type == RW_TYPE_UPDATE) {
+      // we must guarantee that, at any time point, only one version is
+      // visible.
+      // we do not change begin cid for old tuple.
+      tile_group_header->SetEndCommitId(tuple_slot, end_commit_id);
+      ItemPointer new_version =
+          tile_group_header->GetNextItemPointer(tuple_slot);
+      ItemPointer old_version(tile_group_id, tuple_slot);
+      log_manager.LogUpdate(current_txn, end_commit_id, old_version,
+                            new_version);
+
+      auto new_tile_group_header =
+          entry.GetNewTileGroupHeader(new_version);
+      new_tile_group_header->SetBeginCommitId(new_version.offset,
+                                              end_commit_id);
+      new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
+
+      COMPILER_MEMORY_FENCE;
+
+      new_tile_group_header->SetTransactionId(new_version.offset,
+                                              INITIAL_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+    } else if (entry.type == RW_TYPE_DELETE) {
+      // we do not change begin cid for old tuple.
+      tile_group_header->SetEndCommitId(tuple_slot, end_commit_id);
+      ItemPointer new_version =
+          tile_group_header->GetNextItemPointer(tuple_slot);
+      ItemPointer delete_location(tile_group_id, tuple_slot);
+      log_manager.LogDelete(end_commit_id, delete_location);
+      auto new_tile_group_header =
+          entry.GetNewTileGroupHeader(new_version);
+      new_tile_group_header->SetBeginCommitId(new_version.offset,
+                                              end_commit_id);
+      new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
+
+      COMPILER_MEMORY_FENCE;
+
+      new_tile_group_header->SetTransactionId(new_version.offset,
+                                              INVALID_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+
+    } else if (entry.type == RW_TYPE_INSERT) {
+      assert(tile_group_header->GetTransactionId(tuple_slot) ==
+             current_txn->GetTransactionId());
+      // set the begin commit id to persist insert
+      ItemPointer insert_location(tile_group_id, tuple_slot);
+      log_manager.LogInsert(current_txn, end_commit_id, insert_location);
+
+      tile_group_header->SetBeginCommitId(tuple_slot, end_commit_id);
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+
+      COMPILER_MEMORY_FENCE;
+
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+    } else if (entry.type == RW_TYPE_INS_DEL) {
+      assert(tile_group_header->GetTransactionId(tuple_slot) ==
+             current_txn->GetTransactionId());
+
+      // set the begin commit id to persist insert
+      tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+
+      COMPILER_MEMORY_FENCE;
+
+      tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
     }
   }
   log_manager.LogCommitTransaction(end_commit_id);
   current_txn = nullptr;
   current_ssi_txn_ctx->is_finish_ = true;
 
+  EpochManagerFactory::GetInstance().ExitEpoch();
+
   return ret;
 }
 
@@ -526,64 +523,57 @@ Result SsiTxnManager::AbortTransaction() {
     current_ssi_txn_ctx->lock_.Unlock();
   }
 
-  auto &manager = catalog::Manager::GetInstance();
-
   auto &rw_set = current_txn->GetRWSet();
 
-  for (auto &tile_group_entry : rw_set) {
-    oid_t tile_group_id = tile_group_entry.first;
-    auto tile_group = manager.GetTileGroup(tile_group_id);
-    auto tile_group_header = tile_group->GetHeader();
-
-    for (auto &tuple_entry : tile_group_entry.second) {
-      auto tuple_slot = tuple_entry.first;
-      if (tuple_entry.second == RW_TYPE_UPDATE) {
-        // we do not set begin cid for old tuple.
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-        ItemPointer new_version =
-            tile_group_header->GetNextItemPointer(tuple_slot);
-        auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
-        new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
-        new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
-
-        COMPILER_MEMORY_FENCE;
-
-        new_tile_group_header->SetTransactionId(new_version.offset,
-                                                INVALID_TXN_ID);
-        LOG_INFO("Txn %lu free %u", current_txn->GetTransactionId(),
-                 tuple_slot);
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
-
-      } else if (tuple_entry.second == RW_TYPE_DELETE) {
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-        ItemPointer new_version =
-            tile_group_header->GetNextItemPointer(tuple_slot);
-        auto new_tile_group_header =
-            manager.GetTileGroup(new_version.block)->GetHeader();
-        new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
-        new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
-
-        COMPILER_MEMORY_FENCE;
-
-        new_tile_group_header->SetTransactionId(new_version.offset,
-                                                INVALID_TXN_ID);
-        tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
-      } else if (tuple_entry.second == RW_TYPE_INSERT) {
-        tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-
-        COMPILER_MEMORY_FENCE;
-
-        tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
-      } else if (tuple_entry.second == RW_TYPE_INS_DEL) {
-        tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
-        tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
-
-        COMPILER_MEMORY_FENCE;
-
-        tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
-      }
+  for (auto &entry : rw_set) {
+    auto tile_group_header = entry.GetTileGroupHeader();
+    auto tuple_slot = entry.location.offset;
+    if (entry.type == RW_TYPE_UPDATE) {
+      // we do not set begin cid for old tuple.
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+      ItemPointer new_version =
+          tile_group_header->GetNextItemPointer(tuple_slot);
+      auto new_tile_group_header =
+          entry.GetNewTileGroupHeader(new_version);
+      new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
+      new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
+
+      COMPILER_MEMORY_FENCE;
+
+      new_tile_group_header->SetTransactionId(new_version.offset,
+                                              INVALID_TXN_ID);
+      LOG_INFO("Txn %lu free %u", current_txn->GetTransactionId(),
+               tuple_slot);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+
+    } else if (entry.type == RW_TYPE_DELETE) {
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+      ItemPointer new_version =
+          tile_group_header->GetNextItemPointer(tuple_slot);
+      auto new_tile_group_header =
+          entry.GetNewTileGroupHeader(new_version);
+      new_tile_group_header->SetBeginCommitId(new_version.offset, MAX_CID);
+      new_tile_group_header->SetEndCommitId(new_version.offset, MAX_CID);
+
+      COMPILER_MEMORY_FENCE;
+
+      new_tile_group_header->SetTransactionId(new_version.offset,
+                                              INVALID_TXN_ID);
+      tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+    } else if (entry.type == RW_TYPE_INSERT) {
+      tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+
+      COMPILER_MEMORY_FENCE;
+
+      tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
+    } else if (entry.type == RW_TYPE_INS_DEL) {
+      tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+
+      COMPILER_MEMORY_FENCE;
+
+      tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
     }
   }
 
@@ -592,17 +582,17 @@ Result SsiTxnManager::AbortTransaction() {
   // firstly, let's remove reader
   RemoveReader(current_txn);
 
-  // then, we can erase context safely
-  {
-    txn_manager_mutex_.WriteLock();
-    txn_table_.erase(txn_id);
-    txn_manager_mutex_.Unlock();
-  }
+  // then, we can erase context safely. Other transactions might have found
+  // it in the table already, it is freed once they are done.
+  EraseContext(txn_id);
 
-  delete current_ssi_txn_ctx;
-  delete current_txn;
+  auto &epoch_manager = EpochManagerFactory::GetInstance();
+  RetireContext(epoch_manager, current_ssi_txn_ctx);
+  current_ssi_txn_ctx = nullptr;
   current_txn = nullptr;
 
+  epoch_manager.ExitEpoch();
+
   return Result::RESULT_ABORTED;
 }
 
@@ -612,25 +602,38 @@ void SsiTxnManager::RemoveReader(Transaction *txn) {
   // Remove from the read list of accessed tuples
   auto &rw_set = txn->GetRWSet();
 
-  for (auto &tile_group_entry : rw_set) {
-    oid_t tile_group_id = tile_group_entry.first;
-    auto &manager = catalog::Manager::GetInstance();
-    auto tile_group = manager.GetTileGroup(tile_group_id);
-    if (tile_group == nullptr) continue;
+  for (auto &entry : rw_set) {
+    auto tile_group_header = entry.GetTileGroupHeader();
+    auto tuple_slot = entry.location.offset;
 
-    auto tile_group_header = tile_group->GetHeader();
-    for (auto &tuple_entry : tile_group_entry.second) {
-      auto tuple_slot = tuple_entry.first;
+    // we don't have reader lock on insert
+    if (entry.type == RW_TYPE_INSERT || entry.type == RW_TYPE_INS_DEL) {
+      continue;
+    }
+    RemoveSIReader(tile_group_header, tuple_slot, txn->GetTransactionId());
+  }
+  LOG_INFO("release SILock finish");
+}
 
-      // we don't have reader lock on insert
-      if (tuple_entry.second == RW_TYPE_INSERT ||
-          tuple_entry.second == RW_TYPE_INS_DEL) {
-        continue;
+cid_t SsiTxnManager::GetReadOnlySnapshotCid() {
+  // Transactions that did not get their commit id yet commit after it
+  cid_t snapshot_cid = GetCurrentCommitId() - 1;
+
+  // Transactions registered after their shard was scanned begin after it too
+  for (auto &shard : txn_table_) {
+    shard.lock_.Lock();
+    for (auto &item : shard.contexts_) {
+      auto ctx = item.second;
+      auto txn = ctx->GetTransaction();
+      // a transaction that is still beginning cannot be committing
+      if (txn != nullptr && ctx->is_finish_ == false) {
+        snapshot_cid = std::min(snapshot_cid, txn->GetBeginCommitId() - 1);
       }
-      RemoveSIReader(tile_group_header, tuple_slot, txn->GetTransactionId());
     }
+    shard.lock_.Unlock();
   }
-  LOG_INFO("release SILock finish");
+
+  return snapshot_cid;
 }
 
 // Clean obsolete txn record
@@ -639,65 +642,62 @@ void SsiTxnManager::RemoveReader(Transaction *txn) {
 void SsiTxnManager::CleanUp() {
   std::lock_guard<std::mutex> lock(clean_mutex_);
 
-  std::unordered_set<SsiTxnContext *> garbage_ctx;
+  std::vector<SsiTxnContext *> garbage_ctx;
   {
-    txn_manager_mutex_.ReadLock();
-
-    // init it as max() for the case that all transactions are committed
-    cid_t min_begin = std::numeric_limits<cid_t>::max();
-
-    for (auto &item : txn_table_) {
-      // find smallest begin cid of the running transaction
-      auto &ctx = item.second;
-      if (ctx->transaction_->GetEndCommitId() == INVALID_TXN_ID) {
-        // txn_id_a > txn_id_b --> begin_cid_a > begin_cid_b
-        // so the first running transaction's begin_cid must be the smallest
-        // see BeginTransaction()
-        min_begin = ctx->transaction_->GetBeginCommitId();
-        break;
-      }
-    }
+    // Transactions registered after their shard was scanned begin after the
+    // cids handed out so far
+    cid_t min_begin = GetCurrentCommitId();
+    std::vector<SsiTxnContext *> finished_ctx;
+
+    for (auto &shard : txn_table_) {
+      shard.lock_.Lock();
+      for (auto &item : shard.contexts_) {
+        auto ctx = item.second;
+        auto txn = ctx->GetTransaction();
+        if (txn == nullptr) {
+          // the transaction is beginning and its begin cid is not known yet,
+          // it is no smaller than the floor it registered with
+          min_begin = std::min(min_begin, ctx->begin_floor_);
+          continue;
+        }
 
-    // remove committed transactions, whose end_cid < min_begin
-    for (auto itr = txn_table_.begin(); itr != txn_table_.end(); itr++) {
-      auto &ctx = itr->second;
-      auto end_cid = ctx->transaction_->GetEndCommitId();
-      if (end_cid == INVALID_TXN_ID) {
-        // running transaction
-        // then we know that the subsequent txn's end_cid > min_begin
-        // so just break
-        break;
+        // find smallest begin cid of the running transactions
+        if (txn->GetEndCommitId() == INVALID_TXN_ID) {
+          min_begin = std::min(min_begin, txn->GetBeginCommitId());
+        } else if (ctx->is_finish_) {
+          finished_ctx.push_back(ctx);
+        }
       }
+      shard.lock_.Unlock();
+    }
 
-      // record garbage
-      if (end_cid < min_begin && ctx->is_finish_) {
-        // we can safely remove it from table
-        LOG_INFO("remove %ld in table", ctx->transaction_->GetTransactionId());
-        garbage_ctx.insert(ctx);
+    // committed transactions whose end_cid < min_begin are garbage
+    for (auto ctx : finished_ctx) {
+      if (ctx->GetTransaction()->GetEndCommitId() < min_begin) {
+        garbage_ctx.push_back(ctx);
       }
     }
-    txn_manager_mutex_.Unlock();
   }
 
   // remove garbage from table
-  {
-    txn_manager_mutex_.WriteLock();
-    for (auto ctx : garbage_ctx) {
-      txn_table_.erase(ctx->transaction_->GetTransactionId());
-    }
-    txn_manager_mutex_.Unlock();
+  for (auto ctx : garbage_ctx) {
+    auto txn_id = ctx->GetTransaction()->GetTransactionId();
+    LOG_INFO("remove %ld in table", txn_id);
+    EraseContext(txn_id);
   }
 
-  // remove txn's reader list firstly
+  // remove txn's reader list firstly, running transactions might still look
+  // at the contexts they found in the table
+  auto &epoch_manager = EpochManagerFactory::GetInstance();
   for (auto ctx : garbage_ctx) {
-    RemoveReader(ctx->transaction_);
-    delete ctx->transaction_;
-    delete ctx;
+    RemoveReader(ctx->GetTransaction());
+    RetireContext(epoch_manager, ctx);
   }
+  epoch_manager.Reclaim();
 }
 
 void SsiTxnManager::CleanUpBg() {
-  while (!this->stopped || txn_table_.size() != 0) {
+  while (!this->stopped || IsTxnTableEmpty() == false) {
     // GC periodically
     std::chrono::milliseconds sleep_time(50);
     std::this_thread::sleep_for(sleep_time);
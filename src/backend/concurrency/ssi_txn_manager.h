@@ -12,24 +12,52 @@
 
 #pragma once
 
+#include <atomic>
+#include <unordered_map>
+
+#include "backend/common/object_pool.h"
 #include "backend/concurrency/transaction_manager.h"
 #include "backend/storage/tile_group.h"
 #include "backend/catalog/manager.h"
-#include "libcuckoo/cuckoohash_map.hh"
 
-#include <map>
 
 namespace peloton {
 namespace concurrency {
 
+// # of shards of the transaction context table
+#define SSI_TXN_TABLE_SHARD_COUNT 64
+
 struct SsiTxnContext {
-  SsiTxnContext(Transaction *t)
+  SsiTxnContext(Transaction *t = nullptr)
       : transaction_(t),
+        begin_floor_(INVALID_CID),
         in_conflict_(false),
         out_conflict_(false),
         is_abort_(false),
         is_finish_(false) {}
-  Transaction *transaction_;
+
+  // Contexts are pooled
+  void Reset(Transaction *t, const cid_t begin_floor) {
+    transaction_.store(t, std::memory_order_release);
+    begin_floor_ = begin_floor;
+    in_conflict_ = false;
+    out_conflict_ = false;
+    is_abort_ = false;
+    is_finish_ = false;
+  }
+
+  // nullptr while the transaction is still beginning
+  Transaction *GetTransaction() const {
+    return transaction_.load(std::memory_order_acquire);
+  }
+
+  void SetTransaction(Transaction *t) {
+    transaction_.store(t, std::memory_order_release);
+  }
+
+  std::atomic<Transaction *> transaction_;
+  // no larger than the begin cid, known before the transaction is
+  cid_t begin_floor_;
   bool in_conflict_;
   bool out_conflict_;
   bool is_abort_;
@@ -46,17 +74,12 @@ struct ReadList {
   ReadList(SsiTxnContext *t) : txn_ctx(t), next(nullptr) {}
 };
 
-struct SIReadLock {
-  SIReadLock() : list(nullptr){};
-  ReadList *list;
-  std::mutex mutex;
-  void Lock() { mutex.lock(); }
-  void Unlock() { mutex.unlock(); }
-};
-
 class SsiTxnManager : public TransactionManager {
  public:
   SsiTxnManager() : stopped(false), cleaned(false) {
+    // The vacuum thread retires contexts until it is stopped, so the epoch
+    // manager has to outlive this one
+    EpochManagerFactory::GetInstance();
     vacuum = std::thread(&SsiTxnManager::CleanUpBg, this);
   }
 
@@ -98,20 +121,24 @@ class SsiTxnManager : public TransactionManager {
   virtual void PerformDelete(const ItemPointer &location);
 
   virtual Transaction *BeginTransaction() {
-    txn_manager_mutex_.WriteLock();
+    EpochManagerFactory::GetInstance().EnterEpoch();
 
-    // protect beginTransaction with a global lock
-    // to ensure that:
-    //    txn_id_a > txn_id_b --> begin_cid_a > begin_cid_b
+    // The context is registered before the transaction gets its begin cid,
+    // so that the clean up never misses a transaction that might still need
+    // the contexts of the transactions that committed before it began
     txn_id_t txn_id = GetNextTransactionId();
-    cid_t begin_cid = GetNextCommitId();
+    current_ssi_txn_ctx = ObjectPool<SsiTxnContext>::GetInstance().Acquire();
+    current_ssi_txn_ctx->Reset(nullptr, GetCurrentCommitId());
+    bool ret = InsertContext(txn_id, current_ssi_txn_ctx);
+    if (ret == false) {
+      assert(false);
+    }
 
-    Transaction *txn = new Transaction(txn_id, begin_cid);
-    assert(txn_table_.find(txn->GetTransactionId()) == txn_table_.end());
-    current_ssi_txn_ctx = new SsiTxnContext(txn);
+    cid_t begin_cid = GetNextCommitId();
+    Transaction *txn = Transaction::Acquire(txn_id, begin_cid);
     current_txn = txn;
-    txn_table_[txn->GetTransactionId()] = current_ssi_txn_ctx;
-    txn_manager_mutex_.Unlock();
+
+    current_ssi_txn_ctx->SetTransaction(txn);
     LOG_INFO("Begin txn %lu", txn->GetTransactionId());
     return txn;
   }
@@ -123,28 +150,75 @@ class SsiTxnManager : public TransactionManager {
 
   virtual void EndTransaction() { assert(false); }
 
-  virtual cid_t GetMaxCommittedCid() { return 1; }
+  virtual cid_t GetMaxCommittedCidOfRunningTxns() { return 1; }
 
   virtual Result CommitTransaction();
 
   virtual Result AbortTransaction();
 
  private:
-  // Mutex to protect txn_table_ and sireadlocks
-  RWLock txn_manager_mutex_;
   // mutex to avoid re-enter clean up
   std::mutex clean_mutex_;
-  // Transaction contexts
-  std::map<txn_id_t, SsiTxnContext *> txn_table_;
-  // SIReadLocks
-  typedef std::map<oid_t, std::unique_ptr<SIReadLock>> TupleReadlocks;
-  std::map<std::pair<oid_t, oid_t>, std::unique_ptr<SIReadLock>> sireadlocks;
+  // Transaction contexts, by transaction id. The SIREAD locks are kept in
+  // the reserved field of the tuples they are on.
+  // Contexts removed from the table are retired to the epoch manager, as
+  // running transactions may still look at them.
+  // The table is sharded by transaction id, so that the clean up scans one
+  // shard at a time instead of locking out every transaction.
+  struct TxnTableShard {
+    Spinlock lock_;
+    std::unordered_map<txn_id_t, SsiTxnContext *> contexts_;
+  };
+  TxnTableShard txn_table_[SSI_TXN_TABLE_SHARD_COUNT];
   // Used to make the vacuum thread stop
   bool stopped;
   bool cleaned;
   // Vacuum thread, GC over 20 ms
   std::thread vacuum;
 
+  TxnTableShard &GetTxnTableShard(const txn_id_t &txn_id) {
+    return txn_table_[txn_id % SSI_TXN_TABLE_SHARD_COUNT];
+  }
+
+  bool InsertContext(const txn_id_t &txn_id, SsiTxnContext *ctx) {
+    auto &shard = GetTxnTableShard(txn_id);
+    shard.lock_.Lock();
+    bool ret = shard.contexts_.emplace(txn_id, ctx).second;
+    shard.lock_.Unlock();
+    return ret;
+  }
+
+  bool FindContext(const txn_id_t &txn_id, SsiTxnContext *&ctx) {
+    auto &shard = GetTxnTableShard(txn_id);
+    shard.lock_.Lock();
+    auto itr = shard.contexts_.find(txn_id);
+    bool ret = (itr != shard.contexts_.end());
+    if (ret == true) {
+      ctx = itr->second;
+    }
+    shard.lock_.Unlock();
+    return ret;
+  }
+
+  void EraseContext(const txn_id_t &txn_id) {
+    auto &shard = GetTxnTableShard(txn_id);
+    shard.lock_.Lock();
+    shard.contexts_.erase(txn_id);
+    shard.lock_.Unlock();
+  }
+
+  bool IsTxnTableEmpty() {
+    for (auto &shard : txn_table_) {
+      shard.lock_.Lock();
+      bool is_empty = shard.contexts_.empty();
+      shard.lock_.Unlock();
+      if (is_empty == false) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   // init reserved area of a tuple
   // creator txnid | lock (for read list) | read list head
   // The txn_id could only be the cur_txn's txn id.
@@ -191,7 +265,8 @@ class SsiTxnManager : public TransactionManager {
 
   // Add the current txn into the reader list of a tuple
   void AddSIReader(storage::TileGroup *tile_group, const oid_t &tuple_id) {
-    ReadList *reader = new ReadList(current_ssi_txn_ctx);
+    ReadList *reader = ObjectPool<ReadList>::GetInstance().Acquire();
+    reader->txn_ctx = current_ssi_txn_ctx;
 
     GetReadLock(tile_group->GetHeader(), tuple_id);
     ReadList **headp =
@@ -220,10 +295,10 @@ class SsiTxnManager : public TransactionManager {
     bool find = false;
 
     while (next != nullptr) {
-      if (next->txn_ctx->transaction_->GetTransactionId() == txn_id) {
+      if (next->txn_ctx->GetTransaction()->GetTransactionId() == txn_id) {
         find = true;
         prev->next = next->next;
-        delete next;
+        ObjectPool<ReadList>::GetInstance().Release(next);
         break;
       }
       prev = next;
@@ -258,19 +333,24 @@ class SsiTxnManager : public TransactionManager {
   inline void SetInConflict(SsiTxnContext *txn_ctx) {
     // assert(txn_table_.count(txn_id) != 0);
 
-    LOG_INFO("Set in conflict %lu", txn_ctx->transaction_->GetTransactionId());
+    LOG_INFO("Set in conflict %lu",
+             txn_ctx->GetTransaction()->GetTransactionId());
     txn_ctx->in_conflict_ = true;
   }
 
   inline void SetOutConflict(SsiTxnContext *txn_ctx) {
     // assert(txn_table_.count(txn_id) != 0);
 
-    LOG_INFO("Set out conflict %lu", txn_ctx->transaction_->GetTransactionId());
+    LOG_INFO("Set out conflict %lu",
+             txn_ctx->GetTransaction()->GetTransactionId());
     txn_ctx->out_conflict_ = true;
   }
 
   void RemoveReader(Transaction *txn);
 
+  // The GC is off, the snapshot comes from the contexts
+  virtual cid_t GetReadOnlySnapshotCid();
+
   // Free contexts for SSI manager
   void CleanUpBg();
   void CleanUp();
@@ -12,41 +12,70 @@
 
 #include "backend/concurrency/transaction.h"
 
+#include "backend/catalog/manager.h"
 #include "backend/common/logger.h"
+#include "backend/common/object_pool.h"
 #include "backend/common/platform.h"
+#include "backend/storage/tile_group.h"
 
+#include <algorithm>
 #include <chrono>
+#include <iterator>
 #include <thread>
 #include <iomanip>
 
 namespace peloton {
 namespace concurrency {
 
-void Transaction::RecordRead(const ItemPointer &location) {
+Transaction *Transaction::Acquire(const txn_id_t &txn_id,
+                                  const cid_t &begin_cid) {
+  auto txn = ObjectPool<Transaction>::GetInstance().Acquire();
+  txn->Reset(txn_id, begin_cid);
+  return txn;
+}
+
+void Transaction::Release(Transaction *txn) {
+  txn->rw_set_.Clear();
+  ObjectPool<Transaction>::GetInstance().Release(txn);
+}
 
-  oid_t tile_group_id = location.block;
-  oid_t tuple_id = location.offset;
+void Transaction::Reset(const txn_id_t &txn_id, const cid_t &begin_cid) {
+  txn_id_ = txn_id;
+  begin_cid_ = begin_cid;
+  end_cid_ = START_CID;
+  updated_columns_.clear();
+  result_ = peloton::RESULT_SUCCESS;
+  is_written_ = false;
+  insert_count_ = 0;
+  is_wounded_ = false;
+  snapshot_cid_ = INVALID_CID;
+  is_declared_read_only_ = false;
+}
 
-  if (rw_set_.find(tile_group_id) != rw_set_.end() &&
-      rw_set_.at(tile_group_id).find(tuple_id) !=
-          rw_set_.at(tile_group_id).end()) {
-    assert(rw_set_.at(tile_group_id).at(tuple_id) != RW_TYPE_DELETE &&
-           rw_set_.at(tile_group_id).at(tuple_id) != RW_TYPE_INS_DEL);
+void Transaction::RecordRead(
+    const ItemPointer &location,
+    const std::shared_ptr<storage::TileGroup> &tile_group) {
+  auto entry = rw_set_.Find(location);
+  if (entry != nullptr) {
+    assert(entry->type != RW_TYPE_DELETE && entry->type != RW_TYPE_INS_DEL);
     return;
-  } else {
-    rw_set_[tile_group_id][tuple_id] = RW_TYPE_READ;
   }
-}
 
-void Transaction::RecordUpdate(const ItemPointer &location) {
+  rw_set_.Add(location, RW_TYPE_READ,
+              (tile_group != nullptr) ? tile_group
+                                      : GetTileGroup(location.block));
+}
 
-  oid_t tile_group_id = location.block;
-  oid_t tuple_id = location.offset;
+void Transaction::RecordUpdate(
+    const ItemPointer &location,
+    storage::TileGroupHeader *new_tile_group_header) {
+  auto entry = rw_set_.Find(location);
+  if (entry != nullptr) {
+    if (new_tile_group_header != nullptr) {
+      entry->new_tile_group_header = new_tile_group_header;
+    }
 
-  if (rw_set_.find(tile_group_id) != rw_set_.end() &&
-      rw_set_.at(tile_group_id).find(tuple_id) !=
-          rw_set_.at(tile_group_id).end()) {
-    RWType &type = rw_set_.at(tile_group_id).at(tuple_id);
+    RWType &type = entry->type;
     if (type == RW_TYPE_READ) {
       type = RW_TYPE_UPDATE;
       // record write.
@@ -69,31 +98,30 @@ void Transaction::RecordUpdate(const ItemPointer &location) {
   }
 }
 
-void Transaction::RecordInsert(const ItemPointer &location) {
-
-  oid_t tile_group_id = location.block;
-  oid_t tuple_id = location.offset;
-
-  if (rw_set_.find(tile_group_id) != rw_set_.end() &&
-      rw_set_.at(tile_group_id).find(tuple_id) !=
-          rw_set_.at(tile_group_id).end()) {
-    // RWType &type = rw_set_.at(tile_group_id).at(tuple_id);
+void Transaction::RecordInsert(
+    const ItemPointer &location,
+    const std::shared_ptr<storage::TileGroup> &tile_group) {
+  auto entry = rw_set_.Find(location);
+  if (entry != nullptr) {
     assert(false);
   } else {
-    rw_set_[tile_group_id][tuple_id] = RW_TYPE_INSERT;
+    rw_set_.Add(location, RW_TYPE_INSERT,
+                (tile_group != nullptr) ? tile_group
+                                        : GetTileGroup(location.block));
     ++insert_count_;
   }
 }
 
-void Transaction::RecordDelete(const ItemPointer &location) {
-
-  oid_t tile_group_id = location.block;
-  oid_t tuple_id = location.offset;
+void Transaction::RecordDelete(
+    const ItemPointer &location,
+    storage::TileGroupHeader *new_tile_group_header) {
+  auto entry = rw_set_.Find(location);
+  if (entry != nullptr) {
+    if (new_tile_group_header != nullptr) {
+      entry->new_tile_group_header = new_tile_group_header;
+    }
 
-  if (rw_set_.find(tile_group_id) != rw_set_.end() &&
-      rw_set_.at(tile_group_id).find(tuple_id) !=
-          rw_set_.at(tile_group_id).end()) {
-    RWType &type = rw_set_.at(tile_group_id).at(tuple_id);
+    RWType &type = entry->type;
     if (type == RW_TYPE_READ) {
       type = RW_TYPE_DELETE;
       // record write.
@@ -119,8 +147,45 @@ void Transaction::RecordDelete(const ItemPointer &location) {
   }
 }
 
-const std::map<oid_t, std::map<oid_t, RWType>> &Transaction::GetRWSet() {
-  return rw_set_;
+RWSet &Transaction::GetRWSet() { return rw_set_; }
+
+std::shared_ptr<storage::TileGroup> Transaction::GetTileGroup(
+    const oid_t tile_group_id) {
+  // Scans read the versions of a tile group one after the other
+  auto tile_group = rw_set_.GetRecentTileGroup(tile_group_id);
+  if (tile_group != nullptr) {
+    return tile_group;
+  }
+
+  auto &manager = catalog::Manager::GetInstance();
+  return manager.GetTileGroup(tile_group_id);
+}
+
+void Transaction::RecordUpdatedColumns(const ItemPointer &location,
+                                       const std::vector<oid_t> &columns) {
+  auto &recorded = updated_columns_[location.block][location.offset];
+
+  // Updating the same version twice touches the union of both column sets
+  std::vector<oid_t> merged;
+  merged.reserve(recorded.size() + columns.size());
+  std::set_union(recorded.begin(), recorded.end(), columns.begin(),
+                 columns.end(), std::back_inserter(merged));
+  recorded.swap(merged);
+}
+
+const std::vector<oid_t> *Transaction::GetUpdatedColumns(
+    const ItemPointer &location) const {
+  auto tile_group_itr = updated_columns_.find(location.block);
+  if (tile_group_itr == updated_columns_.end()) {
+    return nullptr;
+  }
+
+  auto tuple_itr = tile_group_itr->second.find(location.offset);
+  if (tuple_itr == tile_group_itr->second.end()) {
+    return nullptr;
+  }
+
+  return &tuple_itr->second;
 }
 
 const std::string Transaction::GetInfo() const {
@@ -16,13 +16,14 @@
 #include <atomic>
 #include <vector>
 #include <map>
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 
 #include "backend/common/printable.h"
 #include "backend/common/types.h"
 #include "backend/common/exception.h"
-#include "backend/common/epoch.h"
+#include "backend/concurrency/rw_set.h"
 
 namespace peloton {
 namespace concurrency {
@@ -31,14 +32,6 @@ namespace concurrency {
 // Transaction
 //===--------------------------------------------------------------------===//
 
-enum RWType {
-  RW_TYPE_READ,
-  RW_TYPE_UPDATE,
-  RW_TYPE_INSERT,
-  RW_TYPE_DELETE,
-  RW_TYPE_INS_DEL  // delete after insert.
-};
-
 class Transaction : public Printable {
   Transaction(Transaction const &) = delete;
 
@@ -48,24 +41,35 @@ class Transaction : public Printable {
         begin_cid_(INVALID_CID),
         end_cid_(START_CID),
         is_written_(false),
-        insert_count_(0) {}
+        insert_count_(0),
+        is_wounded_(false) {}
 
   Transaction(const txn_id_t &txn_id)
       : txn_id_(txn_id),
         begin_cid_(INVALID_CID),
         end_cid_(START_CID),
         is_written_(false),
-        insert_count_(0) {}
+        insert_count_(0),
+        is_wounded_(false) {}
 
   Transaction(const txn_id_t &txn_id, const cid_t &begin_cid)
       : txn_id_(txn_id),
         begin_cid_(begin_cid),
         end_cid_(START_CID),
         is_written_(false),
-        insert_count_(0) {}
+        insert_count_(0),
+        is_wounded_(false) {}
 
   ~Transaction() {}
 
+  // Transactions are kept in a pool along with their read/write sets, and
+  // reset when they are taken out
+  static Transaction *Acquire(const txn_id_t &txn_id, const cid_t &begin_cid);
+
+  // The read/write set is emptied right away, so that it does not keep the
+  // tile groups alive
+  static void Release(Transaction *txn);
+
   //===--------------------------------------------------------------------===//
   // Mutators and Accessors
   //===--------------------------------------------------------------------===//
@@ -78,15 +82,31 @@ class Transaction : public Printable {
 
   inline void SetEndCommitId(cid_t eid) { end_cid_ = eid; }
 
-  void RecordRead(const ItemPointer &);
+  // The tile group of a version seen for the first time is looked up in the
+  // catalog, unless it is passed in
+  void RecordRead(const ItemPointer &,
+                  const std::shared_ptr<storage::TileGroup> &tile_group =
+                      nullptr);
+
+  // The tile group header of the new version is kept for the commit
+  void RecordUpdate(const ItemPointer &,
+                    storage::TileGroupHeader *new_tile_group_header = nullptr);
 
-  void RecordUpdate(const ItemPointer &);
+  void RecordInsert(const ItemPointer &,
+                    const std::shared_ptr<storage::TileGroup> &tile_group =
+                        nullptr);
 
-  void RecordInsert(const ItemPointer &);
+  void RecordDelete(const ItemPointer &,
+                    storage::TileGroupHeader *new_tile_group_header = nullptr);
 
-  void RecordDelete(const ItemPointer &);
+  RWSet &GetRWSet();
 
-  const std::map<oid_t, std::map<oid_t, RWType>> &GetRWSet();
+  // Remember which columns an update modified in the given new version,
+  // so that the log manager can emit a delta record at commit time.
+  void RecordUpdatedColumns(const ItemPointer &, const std::vector<oid_t> &);
+
+  // Returns nullptr if no column information was recorded for the version
+  const std::vector<oid_t> *GetUpdatedColumns(const ItemPointer &) const;
 
   // Get a string representation for debugging
   const std::string GetInfo() const;
@@ -101,7 +121,29 @@ class Transaction : public Printable {
     return is_written_ == false && insert_count_ == 0;
   }
 
+  // Done by an older transaction that waits for a lock of this one under the
+  // wound-wait policy. The transaction aborts at its next lock request.
+  inline void Wound() { is_wounded_ = true; }
+
+  inline bool IsWounded() const { return is_wounded_; }
+
+  // Set at begin for a transaction that is declared read-only. It reads the
+  // snapshot at the given commit id and records no reads.
+  inline void SetSnapshotCommitId(const cid_t &snapshot_cid) {
+    snapshot_cid_ = snapshot_cid;
+    is_declared_read_only_ = true;
+  }
+
+  inline cid_t GetSnapshotCommitId() const { return snapshot_cid_; }
+
+  inline bool IsDeclaredReadOnly() const { return is_declared_read_only_; }
+
  private:
+  void Reset(const txn_id_t &txn_id, const cid_t &begin_cid);
+
+  // Tile group of a version that is not in the read/write set yet
+  std::shared_ptr<storage::TileGroup> GetTileGroup(const oid_t tile_group_id);
+
   //===--------------------------------------------------------------------===//
   // Data members
   //===--------------------------------------------------------------------===//
@@ -115,13 +157,23 @@ class Transaction : public Printable {
   // end commit id
   cid_t end_cid_;
 
-  std::map<oid_t, std::map<oid_t, RWType>> rw_set_;
+  RWSet rw_set_;
+
+  // modified columns (sorted) of each new version created by this txn
+  std::map<oid_t, std::map<oid_t, std::vector<oid_t>>> updated_columns_;
 
   // result of the transaction
   Result result_ = peloton::RESULT_SUCCESS;
 
   bool is_written_;
   size_t insert_count_;
+
+  // set by other threads
+  std::atomic<bool> is_wounded_;
+
+  // snapshot of a declared read-only transaction
+  cid_t snapshot_cid_ = INVALID_CID;
+  bool is_declared_read_only_ = false;
 };
 
 }  // End concurrency namespace
@@ -18,8 +18,24 @@ namespace concurrency {
 // Current transaction for the backend thread
 thread_local Transaction *current_txn;
 
-// Current epoch to which the backend thread belongs
-thread_local Epoch *current_epoch;
+Transaction *TransactionManager::BeginReadOnlyTransaction() {
+  Transaction *txn = BeginTransaction();
+  auto &epoch_manager = EpochManagerFactory::GetInstance();
+
+  // A floor no larger than the snapshot is published before the snapshot is
+  // taken, so that no GC pass reclaims past the snapshot in between. Passes
+  // that started before the floor was published reclaim no further than the
+  // snapshot either, as the oldest running transaction only moves forward.
+  epoch_manager.SetSnapshotCid(GetMaxCommittedCid());
+
+  cid_t snapshot_cid = GetReadOnlySnapshotCid();
+  txn->SetSnapshotCommitId(snapshot_cid);
+  epoch_manager.SetSnapshotCid(snapshot_cid);
+
+  LOG_TRACE("Txn %lu reads snapshot %lu", txn->GetTransactionId(),
+            snapshot_cid);
+  return txn;
+}
 
 bool TransactionManager::IsOccupied(const ItemPointer &position) {
   auto tile_group_header =
@@ -12,13 +12,16 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <unordered_map>
 #include <list>
+#include <vector>
 
 #include "backend/common/platform.h"
 #include "backend/common/types.h"
 #include "backend/concurrency/transaction.h"
+#include "backend/concurrency/contention_manager.h"
 #include "backend/concurrency/epoch_manager.h"
 #include "backend/storage/data_table.h"
 #include "backend/storage/tile_group.h"
@@ -27,7 +30,6 @@
 #include "backend/expression/container_tuple.h"
 #include "backend/storage/tuple.h"
 #include "backend/gc/gc_manager_factory.h"
-#include "backend/common/epoch.h"
 
 #include "libcuckoo/cuckoohash_map.hh"
 
@@ -35,7 +37,6 @@ namespace peloton {
 namespace concurrency {
 
 extern thread_local Transaction *current_txn;
-extern thread_local Epoch *current_epoch;
 
 #define RUNNING_TXN_BUCKET_NUM 10
 
@@ -44,7 +45,6 @@ class TransactionManager {
   TransactionManager() {
     next_txn_id_ = ATOMIC_VAR_INIT(START_TXN_ID);
     next_cid_ = ATOMIC_VAR_INIT(START_CID);
-    cid_of_smallest_epoch_cleaned_ = ATOMIC_VAR_INIT(START_CID);
   }
 
   virtual ~TransactionManager() {}
@@ -53,7 +53,9 @@ class TransactionManager {
 
   cid_t GetNextCommitId() { return next_cid_++; }
 
-  oid_t GetNextEpochId() { return next_epoch_id_++; }
+  // commit id the next committing transaction will get
+  cid_t GetCurrentCommitId() { return next_cid_.load(); }
+
   bool IsOccupied(const ItemPointer &position);
 
   virtual bool IsVisible(
@@ -120,6 +122,17 @@ class TransactionManager {
     }
   }
 
+  // Visibility for declared read-only transactions, which read the committed
+  // versions of their snapshot whoever owns them
+  bool IsVisibleInSnapshot(
+      const storage::TileGroupHeader *const tile_group_header,
+      const oid_t &tuple_id) {
+    cid_t snapshot_cid = current_txn->GetSnapshotCommitId();
+    return (tile_group_header->GetTransactionId(tuple_id) != INVALID_TXN_ID &&
+            tile_group_header->GetBeginCommitId(tuple_id) <= snapshot_cid &&
+            tile_group_header->GetEndCommitId(tuple_id) > snapshot_cid);
+  }
+
   virtual bool IsOwner(const storage::TileGroupHeader *const tile_group_header,
                        const oid_t &tuple_id) = 0;
 
@@ -169,11 +182,36 @@ class TransactionManager {
     current_txn->SetResult(result);
   }
 
+  // The current transaction has to abort because of the tuple
+  void RecordConflict(const ItemPointer &location) {
+    ContentionManager::GetInstance().RecordConflict(location);
+  }
+
   // for use by recovery
   void SetNextCid(cid_t cid) { next_cid_ = cid; }
 
   virtual Transaction *BeginTransaction() = 0;
 
+  // Begin a transaction that only reads. It reads a snapshot older than the
+  // running transactions, so it records no reads, takes no locks and cannot
+  // fail the validation at commit.
+  Transaction *BeginReadOnlyTransaction();
+
+  // Begin a transaction that only touches the rows of the given partitioning
+  // keys. Protocols that do not partition the data ignore them.
+  virtual Transaction *BeginPartitionedTransaction(
+      const std::vector<oid_t> &partition_keys __attribute__((unused))) {
+    return BeginTransaction();
+  }
+
+  // Begin a transaction that only reads and writes the given keys.
+  // Protocols that do not order the transactions up front ignore them.
+  virtual Transaction *BeginDeterministicTransaction(
+      const std::vector<oid_t> &read_keys __attribute__((unused)),
+      const std::vector<oid_t> &write_keys __attribute__((unused))) {
+    return BeginTransaction();
+  }
+
   virtual void EndTransaction() = 0;
 
   virtual Result CommitTransaction() = 0;
@@ -188,39 +226,32 @@ class TransactionManager {
   // this function generates the maximum commit id of committed transactions.
   // please note that this function only returns a "safe" value instead of a
   // precise value.
-  virtual cid_t GetMaxCommittedCid() = 0;
-
-  bool PerformEpochCAS(cid_t old_val, cid_t new_val) {
-    bool retval = false;
-    retval = cid_of_smallest_epoch_cleaned_.compare_exchange_strong(old_val,
-                                                                    new_val);
-    return retval;
-  }
-
-  oid_t GetCurrentEpochId() { return next_cid_.load(); }
-
-  cid_t GetSmallestEpochCleanedCid() {
-    return cid_of_smallest_epoch_cleaned_.load();
-  }
-
-  Epoch *GetEpoch(oid_t e) {
-    Epoch *epoch = nullptr;
-    if (epoch_map_.find(e, epoch)) {
-      return epoch;
+  cid_t GetMaxCommittedCid() {
+    cid_t max_committed_cid = GetMaxCommittedCidOfRunningTxns();
+
+    // Read-only transactions read snapshots older than their begin cid
+    cid_t snapshot_cid =
+        EpochManagerFactory::GetInstance().GetOldestSnapshotCid();
+    if (snapshot_cid < max_committed_cid) {
+      return snapshot_cid;
     }
-    return nullptr;
+    return max_committed_cid;
   }
 
-  void EraseEpoch(oid_t e) { epoch_map_.erase(e); }
+ protected:
+  // the maximum commit id the running transactions cannot see past
+  virtual cid_t GetMaxCommittedCidOfRunningTxns() = 0;
 
-  void AddEpochToMap(cid_t key, Epoch *e) { epoch_map_[key] = e; }
+  // Snapshot of a read-only transaction that began already. Every transaction
+  // that has not finished committing commits after it.
+  virtual cid_t GetReadOnlySnapshotCid() {
+    return std::min(GetCurrentCommitId() - 1,
+                    GetMaxCommittedCidOfRunningTxns());
+  }
 
  private:
   std::atomic<txn_id_t> next_txn_id_;
   std::atomic<cid_t> next_cid_;
-  std::atomic<oid_t> next_epoch_id_;
-  std::atomic<cid_t> cid_of_smallest_epoch_cleaned_;
-  cuckoohash_map<cid_t, Epoch *> epoch_map_;
 };
 }  // End storage namespace
 }  // End peloton namespace
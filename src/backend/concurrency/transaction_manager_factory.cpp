@@ -18,5 +18,6 @@ ConcurrencyType TransactionManagerFactory::protocol_ =
     CONCURRENCY_TYPE_OPTIMISTIC;
 IsolationLevelType TransactionManagerFactory::isolation_level_ =
     ISOLATION_LEVEL_TYPE_FULL;
+LockPolicyType TransactionManagerFactory::lock_policy_ = LOCK_POLICY_NO_WAIT;
 }
 }
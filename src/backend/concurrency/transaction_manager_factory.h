@@ -18,6 +18,9 @@
 #include "backend/concurrency/eager_write_txn_manager.h"
 #include "backend/concurrency/ts_order_txn_manager.h"
 #include "backend/concurrency/ssi_txn_manager.h"
+#include "backend/concurrency/hybrid_txn_manager.h"
+#include "backend/concurrency/partitioned_txn_manager.h"
+#include "backend/concurrency/deterministic_txn_manager.h"
 
 namespace peloton {
 namespace concurrency {
@@ -37,24 +40,47 @@ class TransactionManagerFactory {
         return SsiTxnManager::GetInstance();
       case CONCURRENCY_TYPE_TO:
         return TsOrderTxnManager::GetInstance();
+      case CONCURRENCY_TYPE_HYBRID:
+        return HybridTxnManager::GetInstance();
+      case CONCURRENCY_TYPE_PARTITIONED:
+        return PartitionedTxnManager::GetInstance();
+      case CONCURRENCY_TYPE_DETERMINISTIC:
+        return DeterministicTxnManager::GetInstance();
       default:
         return OptimisticTxnManager::GetInstance();
     }
   }
 
   static void Configure(ConcurrencyType protocol,
-                        IsolationLevelType level = ISOLATION_LEVEL_TYPE_FULL) {
+                        IsolationLevelType level = ISOLATION_LEVEL_TYPE_FULL,
+                        LockPolicyType lock_policy = LOCK_POLICY_NO_WAIT) {
     protocol_ = protocol;
     isolation_level_ = level;
+    lock_policy_ = lock_policy;
   }
 
   static ConcurrencyType GetProtocol() { return protocol_; }
 
+  // # of transactions, protocol contexts and read/write sets allocated so
+  // far. They are pooled, so it stops growing once the pools are warm.
+  static size_t GetAllocationCount() {
+    return ObjectPool<Transaction>::GetInstance().GetAllocationCount() +
+           ObjectPool<SsiTxnContext>::GetInstance().GetAllocationCount() +
+           ObjectPool<ReadList>::GetInstance().GetAllocationCount() +
+           ObjectPool<EagerWriteTxnContext>::GetInstance().GetAllocationCount() +
+           ObjectPool<TxnList>::GetInstance().GetAllocationCount() +
+           RWSet::GetAllocationCount();
+  }
+
   static IsolationLevelType GetIsolationLevel() { return isolation_level_; }
 
+  // Only the pessimistic and hybrid protocols wait for locks
+  static LockPolicyType GetLockPolicy() { return lock_policy_; }
+
  private:
   static ConcurrencyType protocol_;
   static IsolationLevelType isolation_level_;
+  static LockPolicyType lock_policy_;
 };
 }
 }
@@ -64,10 +64,12 @@ class TsOrderTxnManager : public TransactionManager {
   virtual Result AbortTransaction();
 
   virtual Transaction *BeginTransaction() {
+    EpochManagerFactory::GetInstance().EnterEpoch();
+
     txn_id_t txn_id = GetNextTransactionId();
     cid_t begin_cid = GetNextCommitId();
 
-    Transaction *txn = new Transaction(txn_id, begin_cid);
+    Transaction *txn = Transaction::Acquire(txn_id, begin_cid);
     current_txn = txn;
 
     running_txn_buckets_[txn_id % RUNNING_TXN_BUCKET_NUM][txn_id] = begin_cid;
@@ -81,11 +83,13 @@ class TsOrderTxnManager : public TransactionManager {
     running_txn_buckets_[txn_id % RUNNING_TXN_BUCKET_NUM].erase(txn_id);
 
 
-    delete current_txn;
+    Transaction::Release(current_txn);
     current_txn = nullptr;
+
+    EpochManagerFactory::GetInstance().ExitEpoch();
   }
 
-  virtual cid_t GetMaxCommittedCid() {
+  virtual cid_t GetMaxCommittedCidOfRunningTxns() {
     cid_t min_running_cid = MAX_CID;
     for (size_t i = 0; i < RUNNING_TXN_BUCKET_NUM; ++i) {
       {
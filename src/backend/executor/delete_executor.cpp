@@ -83,6 +83,15 @@ bool DeleteExecutor::DExecute() {
   auto &transaction_manager =
       concurrency::TransactionManagerFactory::GetInstance();
 
+  // Declared read-only transactions cannot write
+  auto current_txn = executor_context_->GetTransaction();
+  if (current_txn != nullptr && current_txn->IsDeclaredReadOnly() == true) {
+    LOG_TRACE("Read-only txn %lu cannot write",
+              current_txn->GetTransactionId());
+    transaction_manager.SetTransactionResult(RESULT_FAILURE);
+    return false;
+  }
+
   LOG_TRACE("Source tile : %p Tuples : %lu ", source_tile.get(),
             source_tile->GetTupleCount());
 
@@ -112,6 +121,17 @@ bool DeleteExecutor::DExecute() {
 
       if (transaction_manager.AcquireOwnership(tile_group_header, tile_group_id,
                                                physical_tuple_id) == false) {
+        transaction_manager.RecordConflict(old_location);
+        transaction_manager.SetTransactionResult(RESULT_FAILURE);
+        return false;
+      }
+
+      // The tile group was transformed since the child read it, and the
+      // version now lives in the header of the new tile group. The ownership
+      // taken on the stale header guards nothing, so give up.
+      if (tile_group->IsReplaced() == true) {
+        LOG_TRACE("Tile group %u was replaced. Set txn failure.",
+                  tile_group_id);
         transaction_manager.SetTransactionResult(RESULT_FAILURE);
         return false;
       }
@@ -138,6 +158,7 @@ bool DeleteExecutor::DExecute() {
     } else {
       // transaction should be aborted as we cannot update the latest version.
       LOG_TRACE("Fail to update tuple. Set txn failure.");
+      transaction_manager.RecordConflict(old_location);
       transaction_manager.SetTransactionResult(Result::RESULT_FAILURE);
       return false;
     }
@@ -154,6 +154,11 @@ bool IndexScanExecutor::ExecPrimaryIndexLookup() {
   auto &transaction_manager =
       concurrency::TransactionManagerFactory::GetInstance();
 
+  // Declared read-only transactions read their snapshot and record nothing
+  auto current_txn = executor_context_->GetTransaction();
+  bool is_snapshot_read =
+      (current_txn != nullptr && current_txn->IsDeclaredReadOnly() == true);
+
   std::map<oid_t, std::vector<oid_t>> visible_tuples;
   // for every tuple that is found in the index.
   for (auto tuple_location_ptr : tuple_location_ptrs) {
@@ -170,8 +175,13 @@ bool IndexScanExecutor::ExecPrimaryIndexLookup() {
       ++chain_length;
 
       // if the tuple is visible.
-      if (transaction_manager.IsVisible(tile_group_header,
-                                        tuple_location.offset)) {
+      bool is_visible =
+          (is_snapshot_read == true)
+              ? transaction_manager.IsVisibleInSnapshot(tile_group_header,
+                                                        tuple_location.offset)
+              : transaction_manager.IsVisible(tile_group_header,
+                                              tuple_location.offset);
+      if (is_visible) {
 
         LOG_INFO("traverse chain length : %lu", chain_length);
         LOG_INFO("perform read: %u, %u", tuple_location.block,
@@ -181,10 +191,11 @@ bool IndexScanExecutor::ExecPrimaryIndexLookup() {
         if (predicate_ == nullptr) {
           visible_tuples[tuple_location.block].push_back(tuple_location.offset);
 
-          auto res = transaction_manager.PerformRead(tuple_location);
-          if (!res) {
+          if (is_snapshot_read == false &&
+              transaction_manager.PerformRead(tuple_location) == false) {
+            transaction_manager.RecordConflict(tuple_location);
             transaction_manager.SetTransactionResult(RESULT_FAILURE);
-            return res;
+            return false;
           }
         } else {
           expression::ContainerTuple<storage::TileGroup> tuple(
@@ -195,10 +206,11 @@ bool IndexScanExecutor::ExecPrimaryIndexLookup() {
             visible_tuples[tuple_location.block]
                 .push_back(tuple_location.offset);
 
-            auto res = transaction_manager.PerformRead(tuple_location);
-            if (!res) {
+            if (is_snapshot_read == false &&
+                transaction_manager.PerformRead(tuple_location) == false) {
+              transaction_manager.RecordConflict(tuple_location);
               transaction_manager.SetTransactionResult(RESULT_FAILURE);
-              return res;
+              return false;
             }
           }
         }
@@ -210,6 +222,10 @@ bool IndexScanExecutor::ExecPrimaryIndexLookup() {
         cid_t old_end_cid = tile_group_header->GetEndCommitId(old_item.offset);
 
         tuple_location = tile_group_header->GetNextItemPointer(old_item.offset);
+        // a snapshot can be older than the tuple
+        if (tuple_location.IsNull() == true && is_snapshot_read == true) {
+          break;
+        }
         // there must exist a visible version.
         assert(tuple_location.IsNull() == false);
 
@@ -223,7 +239,9 @@ bool IndexScanExecutor::ExecPrimaryIndexLookup() {
 
 
             // atomically swap item pointer held in the index bucket.
-            AtomicUpdateItemPointer(tuple_location_ptr, tuple_location);
+            // the garbage collector may have already moved it forward.
+            AtomicCompareAndSwapItemPointer(tuple_location_ptr, old_item,
+                                            tuple_location);
 
             // currently, let's assume only primary index exists.
             gc::GCManagerFactory::GetInstance().RecycleTupleSlot(
@@ -283,6 +301,11 @@ bool IndexScanExecutor::ExecSecondaryIndexLookup() {
   auto &transaction_manager =
       concurrency::TransactionManagerFactory::GetInstance();
 
+  // Declared read-only transactions read their snapshot and record nothing
+  auto current_txn = executor_context_->GetTransaction();
+  bool is_snapshot_read =
+      (current_txn != nullptr && current_txn->IsDeclaredReadOnly() == true);
+
   std::map<oid_t, std::vector<oid_t>> visible_tuples;
   // for every tuple that is found in the index.
   for (auto tuple_location : tuple_locations) {
@@ -293,14 +316,20 @@ bool IndexScanExecutor::ExecSecondaryIndexLookup() {
     auto tuple_id = tuple_location.offset;
 
     // if the tuple is visible.
-    if (transaction_manager.IsVisible(tile_group_header, tuple_id)) {
+    bool is_visible =
+        (is_snapshot_read == true)
+            ? transaction_manager.IsVisibleInSnapshot(tile_group_header,
+                                                      tuple_id)
+            : transaction_manager.IsVisible(tile_group_header, tuple_id);
+    if (is_visible) {
       // perform predicate evaluation.
       if (predicate_ == nullptr) {
         visible_tuples[tile_group_id].push_back(tuple_id);
-        auto res = transaction_manager.PerformRead(tuple_location);
-        if (!res) {
+        if (is_snapshot_read == false &&
+            transaction_manager.PerformRead(tuple_location) == false) {
+          transaction_manager.RecordConflict(tuple_location);
           transaction_manager.SetTransactionResult(RESULT_FAILURE);
-          return res;
+          return false;
         }
       } else {
         expression::ContainerTuple<storage::TileGroup> tuple(tile_group.get(),
@@ -309,10 +338,11 @@ bool IndexScanExecutor::ExecSecondaryIndexLookup() {
             predicate_->Evaluate(&tuple, nullptr, executor_context_).IsTrue();
         if (eval == true) {
           visible_tuples[tile_group_id].push_back(tuple_id);
-          auto res = transaction_manager.PerformRead(tuple_location);
-          if (!res) {
+          if (is_snapshot_read == false &&
+              transaction_manager.PerformRead(tuple_location) == false) {
+            transaction_manager.RecordConflict(tuple_location);
             transaction_manager.SetTransactionResult(RESULT_FAILURE);
-            return res;
+            return false;
           }
         }
       }
@@ -65,6 +65,15 @@ bool InsertExecutor::DExecute() {
       concurrency::TransactionManagerFactory::GetInstance();
   auto executor_pool = executor_context_->GetExecutorContextPool();
 
+  // Declared read-only transactions cannot write
+  auto current_txn = executor_context_->GetTransaction();
+  if (current_txn != nullptr && current_txn->IsDeclaredReadOnly() == true) {
+    LOG_TRACE("Read-only txn %lu cannot write",
+              current_txn->GetTransactionId());
+    transaction_manager.SetTransactionResult(RESULT_FAILURE);
+    return false;
+  }
+
   // Inserting a logical tile.
   if (children_.size() == 1) {
     LOG_TRACE("Insert executor :: 1 child ");
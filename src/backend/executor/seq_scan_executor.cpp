@@ -16,15 +16,21 @@
 #include <utility>
 #include <vector>
 
+#include "backend/brain/layout_tuner.h"
 #include "backend/common/types.h"
+#include "backend/common/value_peeker.h"
 #include "backend/executor/logical_tile.h"
 #include "backend/executor/logical_tile_factory.h"
 #include "backend/executor/executor_context.h"
 #include "backend/expression/abstract_expression.h"
 #include "backend/expression/container_tuple.h"
+#include "backend/expression/tuple_value_expression.h"
+#include "backend/storage/compressed_column.h"
 #include "backend/storage/data_table.h"
+#include "backend/storage/tile_group.h"
 #include "backend/storage/tile_group_header.h"
 #include "backend/storage/tile.h"
+#include "backend/storage/zone_map.h"
 #include "backend/concurrency/transaction_manager_factory.h"
 #include "backend/common/logger.h"
 
@@ -56,12 +62,20 @@ bool SeqScanExecutor::DInit() {
   current_tile_group_offset_ = START_OID;
 
   if (target_table_ != nullptr) {
-    table_tile_group_count_ = target_table_->GetTileGroupCount();
+    table_tile_group_ids_ = target_table_->GetTileGroupIds();
+    table_tile_group_count_ = table_tile_group_ids_.size();
 
     if (column_ids_.empty()) {
       column_ids_.resize(target_table_->GetSchema()->GetColumnCount());
       std::iota(column_ids_.begin(), column_ids_.end(), 0);
     }
+
+    brain::LayoutTuner::GetInstance().RecordScan(target_table_, column_ids_,
+                                                 predicate_);
+
+    if (predicate_ != nullptr) {
+      SplitPredicate();
+    }
   }
 
   return true;
@@ -114,14 +128,33 @@ bool SeqScanExecutor::DExecute() {
 
     auto &transaction_manager =
         concurrency::TransactionManagerFactory::GetInstance();
+
+    // Declared read-only transactions read their snapshot and record nothing
+    auto current_txn = executor_context_->GetTransaction();
+    bool is_snapshot_read =
+        (current_txn != nullptr && current_txn->IsDeclaredReadOnly() == true);
+
     // Retrieve next tile group.
     while (current_tile_group_offset_ < table_tile_group_count_) {
-      auto tile_group =
-          target_table_->GetTileGroup(current_tile_group_offset_++);
+      auto tile_group = target_table_->GetTileGroupById(
+          table_tile_group_ids_[current_tile_group_offset_++]);
+      // the tile group was compacted and dropped after we started
+      if (tile_group == nullptr) {
+        continue;
+      }
+      if (CanSkipTileGroup(tile_group.get()) == true) {
+        continue;
+      }
       auto tile_group_header = tile_group->GetHeader();
 
       oid_t active_tuple_count = tile_group->GetNextTupleSlot();
 
+      // Filter a column at a time, without building a Value for every tuple
+      std::vector<bool> column_matches;
+      bool is_column_evaluated =
+          (predicate_ != nullptr &&
+           EvaluateColumnPredicate(tile_group.get(), active_tuple_count,
+                                   column_matches) == true);
 
       // Construct position list by looping through tile group
       // and applying the predicate.
@@ -131,26 +164,38 @@ bool SeqScanExecutor::DExecute() {
         ItemPointer location(tile_group->GetTileGroupId(), tuple_id);
 
         // check transaction visibility
-        if (transaction_manager.IsVisible(tile_group_header, tuple_id)) {
+        bool is_visible =
+            (is_snapshot_read == true)
+                ? transaction_manager.IsVisibleInSnapshot(tile_group_header,
+                                                          tuple_id)
+                : transaction_manager.IsVisible(tile_group_header, tuple_id);
+        if (is_visible) {
           // if the tuple is visible, then perform predicate evaluation.
           if (predicate_ == nullptr) {
             position_list.push_back(tuple_id);
-            auto res = transaction_manager.PerformRead(location);
-            if (!res) {
+            if (is_snapshot_read == false &&
+                transaction_manager.PerformRead(location) == false) {
+              transaction_manager.RecordConflict(location);
               transaction_manager.SetTransactionResult(RESULT_FAILURE);
-              return res;
+              return false;
             }
           } else {
-            expression::ContainerTuple<storage::TileGroup> tuple(
-                tile_group.get(), tuple_id);
-            auto eval = predicate_->Evaluate(&tuple, nullptr, executor_context_)
-                            .IsTrue();
+            bool eval;
+            if (is_column_evaluated == true) {
+              eval = column_matches[tuple_id];
+            } else {
+              expression::ContainerTuple<storage::TileGroup> tuple(
+                  tile_group.get(), tuple_id);
+              eval = predicate_->Evaluate(&tuple, nullptr, executor_context_)
+                         .IsTrue();
+            }
             if (eval == true) {
               position_list.push_back(tuple_id);
-              auto res = transaction_manager.PerformRead(location);
-              if (!res) {
+              if (is_snapshot_read == false &&
+                  transaction_manager.PerformRead(location) == false) {
+                transaction_manager.RecordConflict(location);
                 transaction_manager.SetTransactionResult(RESULT_FAILURE);
-                return res;
+                return false;
               }
             }
           }
@@ -175,5 +220,251 @@ bool SeqScanExecutor::DExecute() {
   return false;
 }
 
+// Puts the column on the left of a comparison between a column and a
+// constant. Returns false for any other expression.
+static bool IsColumnComparison(ExpressionType &comparison_type,
+                               const expression::AbstractExpression *&left,
+                               const expression::AbstractExpression *&right) {
+  switch (comparison_type) {
+    case EXPRESSION_TYPE_COMPARE_EQUAL:
+    case EXPRESSION_TYPE_COMPARE_NOTEQUAL:
+    case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+    case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+    case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+    case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+      break;
+    default:
+      return false;
+  }
+  if (left == nullptr || right == nullptr) {
+    return false;
+  }
+
+  auto is_constant = [](const expression::AbstractExpression *expression) {
+    return (expression->GetExpressionType() == EXPRESSION_TYPE_VALUE_CONSTANT ||
+            expression->GetExpressionType() == EXPRESSION_TYPE_VALUE_PARAMETER);
+  };
+
+  if (is_constant(left) == true &&
+      right->GetExpressionType() == EXPRESSION_TYPE_VALUE_TUPLE) {
+    std::swap(left, right);
+    if (comparison_type == EXPRESSION_TYPE_COMPARE_LESSTHAN) {
+      comparison_type = EXPRESSION_TYPE_COMPARE_GREATERTHAN;
+    } else if (comparison_type == EXPRESSION_TYPE_COMPARE_GREATERTHAN) {
+      comparison_type = EXPRESSION_TYPE_COMPARE_LESSTHAN;
+    } else if (comparison_type == EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO) {
+      comparison_type = EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO;
+    } else if (comparison_type ==
+               EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO) {
+      comparison_type = EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO;
+    }
+  }
+  if (left->GetExpressionType() != EXPRESSION_TYPE_VALUE_TUPLE ||
+      is_constant(right) == false) {
+    return false;
+  }
+
+  auto tuple_value =
+      static_cast<const expression::TupleValueExpression *>(left);
+  return (tuple_value->GetTupleIdx() == 0);
+}
+
+void SeqScanExecutor::SplitPredicate() {
+  column_comparisons_.clear();
+  is_column_comparison_predicate_ = true;
+
+  // Split up the conjunction
+  std::vector<const expression::AbstractExpression *> expressions = {
+      predicate_};
+  while (expressions.empty() == false) {
+    auto expression = expressions.back();
+    expressions.pop_back();
+    if (expression->GetExpressionType() == EXPRESSION_TYPE_CONJUNCTION_AND) {
+      expressions.push_back(expression->GetLeft());
+      expressions.push_back(expression->GetRight());
+      continue;
+    }
+
+    auto comparison_type = expression->GetExpressionType();
+    auto left = expression->GetLeft(), right = expression->GetRight();
+    if (IsColumnComparison(comparison_type, left, right) == false) {
+      is_column_comparison_predicate_ = false;
+      continue;
+    }
+
+    auto tuple_value =
+        static_cast<const expression::TupleValueExpression *>(left);
+    column_comparisons_.push_back(
+        {static_cast<oid_t>(tuple_value->GetColumnId()), comparison_type,
+         right->Evaluate(nullptr, nullptr, executor_context_)});
+  }
+}
+
+bool SeqScanExecutor::CanSkipTileGroup(storage::TileGroup *tile_group) const {
+  auto zone_map = tile_group->GetZoneMap();
+  for (auto &comparison : column_comparisons_) {
+    if (zone_map->MightMatch(comparison.column_id, comparison.comparison_type,
+                             comparison.constant) == false) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Keeps the matches whose value satisfies the comparison, NULLs never do
+template <typename T, class Comparison>
+static void FilterColumn(const storage::ColumnSpan<T> &column,
+                         Comparison comparison, std::vector<bool> &matches) {
+  for (oid_t tuple_itr = 0; tuple_itr < column.GetSize(); tuple_itr++) {
+    if (matches[tuple_itr] == true) {
+      T value = column[tuple_itr];
+      matches[tuple_itr] =
+          (storage::IsNullStorage(value) == false && comparison(value));
+    }
+  }
+}
+
+// Compares the values of the column, widened to type C, with the constant
+template <typename T, typename C>
+static bool CompareColumn(const storage::ColumnSpan<T> &column,
+                          ExpressionType comparison_type, const C constant,
+                          std::vector<bool> &matches) {
+  if (column.IsEmpty() == true) {
+    return false;
+  }
+
+  switch (comparison_type) {
+    case EXPRESSION_TYPE_COMPARE_EQUAL:
+      FilterColumn(column, [constant](T value) {
+        return static_cast<C>(value) == constant;
+      }, matches);
+      break;
+    case EXPRESSION_TYPE_COMPARE_NOTEQUAL:
+      FilterColumn(column, [constant](T value) {
+        return static_cast<C>(value) != constant;
+      }, matches);
+      break;
+    case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+      FilterColumn(column, [constant](T value) {
+        return static_cast<C>(value) < constant;
+      }, matches);
+      break;
+    case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+      FilterColumn(column, [constant](T value) {
+        return static_cast<C>(value) <= constant;
+      }, matches);
+      break;
+    case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+      FilterColumn(column, [constant](T value) {
+        return static_cast<C>(value) > constant;
+      }, matches);
+      break;
+    case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+      FilterColumn(column, [constant](T value) {
+        return static_cast<C>(value) >= constant;
+      }, matches);
+      break;
+    default:
+      return false;
+  }
+
+  return true;
+}
+
+// Compares a fixed length column of a tile that is not frozen with the
+// constant. Returns false if the column or the constant has a type that is
+// not handled here.
+static bool CompareTileColumn(storage::Tile *tile,
+                              const oid_t tile_column_offset,
+                              const oid_t tuple_count,
+                              ExpressionType comparison_type,
+                              const Value &constant,
+                              std::vector<bool> &matches) {
+  bool is_integer_constant = false;
+  switch (constant.GetValueType()) {
+    case VALUE_TYPE_TINYINT:
+    case VALUE_TYPE_SMALLINT:
+    case VALUE_TYPE_INTEGER:
+    case VALUE_TYPE_BIGINT:
+      is_integer_constant = true;
+      break;
+    case VALUE_TYPE_DOUBLE:
+      break;
+    default:
+      return false;
+  }
+
+  switch (tile->GetSchema()->GetType(tile_column_offset)) {
+    case VALUE_TYPE_TINYINT:
+    case VALUE_TYPE_SMALLINT:
+    case VALUE_TYPE_INTEGER:
+    case VALUE_TYPE_BIGINT: {
+      if (is_integer_constant == false) {
+        return false;
+      }
+      int64_t integer_constant = ValuePeeker::PeekAsBigInt(constant);
+      return CompareColumn(
+                 tile->GetColumnSpan<int8_t>(tile_column_offset, tuple_count),
+                 comparison_type, integer_constant, matches) ||
+             CompareColumn(
+                 tile->GetColumnSpan<int16_t>(tile_column_offset, tuple_count),
+                 comparison_type, integer_constant, matches) ||
+             CompareColumn(
+                 tile->GetColumnSpan<int32_t>(tile_column_offset, tuple_count),
+                 comparison_type, integer_constant, matches) ||
+             CompareColumn(
+                 tile->GetColumnSpan<int64_t>(tile_column_offset, tuple_count),
+                 comparison_type, integer_constant, matches);
+    }
+    case VALUE_TYPE_DOUBLE: {
+      if (is_integer_constant == true) {
+        return false;
+      }
+      return CompareColumn(
+          tile->GetColumnSpan<double>(tile_column_offset, tuple_count),
+          comparison_type, ValuePeeker::PeekDouble(constant), matches);
+    }
+    default:
+      return false;
+  }
+}
+
+bool SeqScanExecutor::EvaluateColumnPredicate(
+    storage::TileGroup *tile_group, const oid_t tuple_count,
+    std::vector<bool> &matches) const {
+  if (is_column_comparison_predicate_ == false) {
+    return false;
+  }
+
+  matches.assign(tile_group->GetAllocatedTupleCount(), true);
+
+  for (auto &comparison : column_comparisons_) {
+    auto &column_location = tile_group->GetColumnLocation(comparison.column_id);
+    auto tile = column_location.tile;
+
+    // Comparing with NULL is never true
+    if (comparison.constant.IsNull() == true) {
+      std::fill(matches.begin(), matches.end(), false);
+      return true;
+    }
+
+    // a writer may thaw the tile at any time, the compressed columns stay
+    if (tile->IsFrozen() == true) {
+      tile->GetCompressedColumn(column_location.tile_column_offset)
+          ->EvaluateComparison(comparison.comparison_type, comparison.constant,
+                               matches);
+      continue;
+    }
+
+    if (CompareTileColumn(tile, column_location.tile_column_offset,
+                          tuple_count, comparison.comparison_type,
+                          comparison.constant, matches) == false) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 }  // namespace executor
 }  // namespace peloton
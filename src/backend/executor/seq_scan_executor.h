@@ -34,6 +34,21 @@ class SeqScanExecutor : public AbstractScanExecutor {
   bool DExecute();
 
  private:
+  // Collects the comparisons between columns and constants the predicate is
+  // a conjunction of
+  void SplitPredicate();
+
+  // Whether the zone map rules out every tuple of the tile group
+  bool CanSkipTileGroup(storage::TileGroup *tile_group) const;
+
+  // Evaluates the predicate a column at a time, on the compressed columns of
+  // frozen tiles and on the raw fixed length columns of the others. Returns
+  // false if the predicate is not a conjunction of comparisons between such
+  // columns and constants.
+  bool EvaluateColumnPredicate(storage::TileGroup *tile_group,
+                               const oid_t tuple_count,
+                               std::vector<bool> &matches) const;
+
   //===--------------------------------------------------------------------===//
   // Executor State
   //===--------------------------------------------------------------------===//
@@ -44,6 +59,23 @@ class SeqScanExecutor : public AbstractScanExecutor {
   /** @brief Keeps track of the number of tile groups to scan. */
   oid_t table_tile_group_count_ = INVALID_OID;
 
+  /** @brief Ids of the tile groups to scan. Offsets into the table shift
+   *  when the compactor drops a tile group. */
+  std::vector<oid_t> table_tile_group_ids_;
+
+  /** @brief "column <comparison> constant" terms of the predicate. */
+  struct ColumnComparison {
+    oid_t column_id;
+    ExpressionType comparison_type;
+    Value constant;
+  };
+
+  std::vector<ColumnComparison> column_comparisons_;
+
+  /** @brief Whether the predicate is made up of the column comparisons
+   *  only. */
+  bool is_column_comparison_predicate_ = false;
+
   //===--------------------------------------------------------------------===//
   // Plan Info
   //===--------------------------------------------------------------------===//
@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+
 #include "backend/executor/update_executor.h"
 #include "backend/planner/update_plan.h"
 #include "backend/common/logger.h"
@@ -19,6 +21,7 @@
 #include "backend/expression/container_tuple.h"
 #include "backend/concurrency/transaction.h"
 #include "backend/concurrency/transaction_manager_factory.h"
+#include "backend/logging/log_manager.h"
 #include "backend/storage/data_table.h"
 #include "backend/storage/tile_group_header.h"
 #include "backend/storage/tile.h"
@@ -51,6 +54,22 @@ bool UpdateExecutor::DInit() {
   assert(target_table_);
   assert(project_info_);
 
+  // Columns in the target list are recomputed; a direct map only modifies
+  // the column if it is a reorder of the source tuple.
+  for (auto &target : project_info_->GetTargetList()) {
+    updated_columns_.push_back(target.first);
+  }
+  for (auto &direct_map : project_info_->GetDirectMapList()) {
+    if (direct_map.second.first != 0 ||
+        direct_map.first != direct_map.second.second) {
+      updated_columns_.push_back(direct_map.first);
+    }
+  }
+  std::sort(updated_columns_.begin(), updated_columns_.end());
+  updated_columns_.erase(
+      std::unique(updated_columns_.begin(), updated_columns_.end()),
+      updated_columns_.end());
+
   return true;
 }
 
@@ -80,6 +99,20 @@ bool UpdateExecutor::DExecute() {
   auto &transaction_manager =
       concurrency::TransactionManagerFactory::GetInstance();
 
+  // Declared read-only transactions cannot write
+  auto current_txn = executor_context_->GetTransaction();
+  if (current_txn != nullptr && current_txn->IsDeclaredReadOnly() == true) {
+    LOG_TRACE("Read-only txn %lu cannot write",
+              current_txn->GetTransactionId());
+    transaction_manager.SetTransactionResult(RESULT_FAILURE);
+    return false;
+  }
+
+  // Column info is only needed to emit delta update records
+  bool record_columns =
+      current_txn != nullptr &&
+      logging::LogManager::GetInstance().IsInLoggingMode();
+
   // Update tuples in given table
   for (oid_t visible_tuple_id : *source_tile) {
     oid_t physical_tuple_id = pos_lists[0][visible_tuple_id];
@@ -104,6 +137,10 @@ bool UpdateExecutor::DExecute() {
 
       transaction_manager.PerformUpdate(old_location);
 
+      if (record_columns) {
+        current_txn->RecordUpdatedColumns(old_location, updated_columns_);
+      }
+
 
     } else if (transaction_manager.IsOwnable(tile_group_header,
                                              physical_tuple_id) == true) {
@@ -113,6 +150,17 @@ bool UpdateExecutor::DExecute() {
       if (transaction_manager.AcquireOwnership(tile_group_header, tile_group_id,
                                                physical_tuple_id) == false) {
         LOG_TRACE("Fail to insert new tuple. Set txn failure.");
+        transaction_manager.RecordConflict(old_location);
+        transaction_manager.SetTransactionResult(Result::RESULT_FAILURE);
+        return false;
+      }
+
+      // The tile group was transformed since the child read it, and the
+      // version now lives in the header of the new tile group. The ownership
+      // taken on the stale header guards nothing, so give up.
+      if (tile_group->IsReplaced() == true) {
+        LOG_TRACE("Tile group %u was replaced. Set txn failure.",
+                  tile_group_id);
         transaction_manager.SetTransactionResult(Result::RESULT_FAILURE);
         return false;
       }
@@ -143,11 +191,16 @@ bool UpdateExecutor::DExecute() {
       LOG_INFO("perform update new location: %u, %u", new_location.block, new_location.offset);
       transaction_manager.PerformUpdate(old_location, new_location);
 
+      if (record_columns) {
+        current_txn->RecordUpdatedColumns(new_location, updated_columns_);
+      }
+
       executor_context_->num_processed += 1;  // updated one
 
     } else {
       // transaction should be aborted as we cannot update the latest version.
       LOG_TRACE("Fail to update tuple. Set txn failure.");
+      transaction_manager.RecordConflict(old_location);
       transaction_manager.SetTransactionResult(Result::RESULT_FAILURE);
       return false;
     }
@@ -37,6 +37,9 @@ class UpdateExecutor : public AbstractExecutor {
  private:
   storage::DataTable *target_table_ = nullptr;
   const planner::ProjectInfo *project_info_ = nullptr;
+
+  // Sorted ids of the columns the projection actually modifies
+  std::vector<oid_t> updated_columns_;
 };
 
 }  // namespace executor
@@ -10,23 +10,74 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <chrono>
+#include <map>
+
 #include "backend/common/types.h"
 #include "backend/gc/gc_manager.h"
 #include "backend/index/index.h"
+#include "backend/storage/data_table.h"
+#include "backend/storage/tile_group.h"
+#include "backend/storage/tile_group_header.h"
+#include "backend/storage/tuple.h"
+#include "backend/concurrency/epoch_manager.h"
 #include "backend/concurrency/transaction_manager_factory.h"
 #include "backend/concurrency/transaction_manager.h"
 namespace peloton {
 namespace gc {
 
+// Deleter of a batch of item pointers retired from the indexes
+static void FreeItemPointers(void *retired) {
+  auto item_pointers = static_cast<std::vector<ItemPointer *> *>(retired);
+  for (auto item_pointer : *item_pointers) {
+    delete item_pointer;
+  }
+  delete item_pointers;
+}
+
+GCManager::GCManager(const GCType type, size_t max_tuples,
+                     unsigned int sleep_time_, size_t thread_count)
+    : is_running_(true),
+      gc_type_(type),
+      max_tuples_per_gc(max_tuples),
+      vacuum_thread_sleep_time_(sleep_time_),
+      reclaimed_index_entry_count_(0),
+      reclaimed_index_memory_(0) {
+  // only the parallel vacuum mode shards the possibly free list
+  size_t shard_count = 1;
+  if (type == GC_TYPE_PARALLEL_VACUUM && thread_count > 1) {
+    shard_count = thread_count;
+  }
+
+  for (size_t shard_id = 0; shard_id < shard_count; shard_id++) {
+    possibly_free_lists_.emplace_back(
+        new LockfreeQueue<TupleMetadata>(FREE_LIST_LENGTH));
+  }
+
+  // The GC threads hand what they retired to the epoch manager when they
+  // exit, so it has to outlive this one
+  concurrency::EpochManagerFactory::GetInstance();
+}
+
+GCManager::~GCManager() { StopGC(); }
+
 // Starts the GC based on the GC mode
 void GCManager::StartGC() {
   if (this->gc_type_ == GC_TYPE_OFF) {
     return;
   }
+  this->is_running_ = true;
   if (this->gc_type_ == GC_TYPE_VACUUM) {
     std::thread(&GCManager::Poll, this).detach();
+  } else if (this->gc_type_ == GC_TYPE_PARALLEL_VACUUM &&
+             gc_threads_.empty() == true) {
+    // one worker per shard of the possibly free list
+    for (size_t worker_id = 0; worker_id < possibly_free_lists_.size();
+         worker_id++) {
+      gc_threads_.emplace_back(&GCManager::ParallelPoll, this, worker_id);
+    }
   }
-  this->is_running_ = true;
 }
 
 // Stops the GC
@@ -35,6 +86,11 @@ void GCManager::StopGC() {
     return;
   }
   this->is_running_ = false;
+
+  for (auto &gc_thread : gc_threads_) {
+    gc_thread.join();
+  }
+  gc_threads_.clear();
 }
 
 // Moves tuples from the possibly free list to the actually free list for the
@@ -42,8 +98,15 @@ void GCManager::StopGC() {
 // free list
 void GCManager::RefurbishTuple(TupleMetadata tuple_metadata) {
   auto &manager = catalog::Manager::GetInstance();
-  auto tile_group_header =
-      manager.GetTileGroup(tuple_metadata.tile_group_id)->GetHeader();
+  auto tile_group = manager.GetTileGroup(tuple_metadata.tile_group_id);
+  // the tile group was compacted and dropped in the meantime
+  if (tile_group == nullptr) {
+    return;
+  }
+  // No transaction can read the version anymore, hand its varlens back
+  tile_group->FreeUninlinedData(tuple_metadata.tuple_slot_id);
+
+  auto tile_group_header = tile_group->GetHeader();
   // Set the values for the tuple slot such that when this
   // can be returned by ReturnFreeSlow and used as a new tuple slot
   // by the calling function
@@ -52,62 +115,106 @@ void GCManager::RefurbishTuple(TupleMetadata tuple_metadata) {
   tile_group_header->SetBeginCommitId(tuple_metadata.tuple_slot_id, MAX_CID);
   tile_group_header->SetEndCommitId(tuple_metadata.tuple_slot_id, MAX_CID);
 
-  std::pair<size_t, std::shared_ptr<LockfreeQueue<TupleMetadata>>> free_list;
+  // count the slot before publishing it, so that the count never drops
+  // below the number of refurbished slots actually in the free list
+  refurbished_slot_counts_.upsert(tuple_metadata.tile_group_id,
+                                  [](size_t &count) { count++; }, 1);
 
-  // if the entry for table_id exists.
-  if (free_map_.find(tuple_metadata.table_id, free_list) == true) {
-    // if the entry for tuple_metadata.table_id exists.
-    free_map_.erase(tuple_metadata.table_id);
-    // update the free list and its size
-    free_list.second->TryPush(tuple_metadata);
-    free_list.first = free_list.first + 1;
-  } else {
-    // if the entry for tuple_metadata.table_id does not exist
-    // create a new free list and initialize its size
-    free_list.second.reset(new LockfreeQueue<TupleMetadata>(max_tuples_per_gc));
-    free_list.second->TryPush(tuple_metadata);
-    free_list.first = 1;
+  GetFreeList(tuple_metadata.table_id)->TryPush(tuple_metadata);
+}
+
+// Returns the free list of the table. Free lists are never replaced once
+// they are in the map, so concurrent users always share the same queue.
+std::shared_ptr<LockfreeQueue<TupleMetadata>> GCManager::GetFreeList(
+    const oid_t &table_id) {
+  std::shared_ptr<LockfreeQueue<TupleMetadata>> free_list;
+
+  if (free_map_.find(table_id, free_list) == false) {
+    free_list.reset(new LockfreeQueue<TupleMetadata>(max_tuples_per_gc));
+    // if another thread created the free list first, use that one
+    if (free_map_.insert(table_id, free_list) == false) {
+      free_map_.find(table_id, free_list);
+    }
   }
-  // Update the map corresponding to the table to now have
-  // the updates list
-  free_map_[tuple_metadata.table_id] = free_list;
+
+  return free_list;
+}
+
+LockfreeQueue<TupleMetadata> &GCManager::GetPossiblyFreeList(
+    const oid_t &tile_group_id) {
+  // shard by tile group, so that a worker keeps refurbishing the same blocks
+  return *possibly_free_lists_[tile_group_id % possibly_free_lists_.size()];
 }
 
 // GC for epoch based scheme
-void GCManager::PerformGC(Epoch *e) {
-  TupleMetadata tuple_metadata;
-  // Refurbish tuples from the epoch
-  while (e->possibly_free_list_.TryPop(tuple_metadata)) {
-    RefurbishTuple(tuple_metadata);
-  }
+void GCManager::PerformGC(const std::vector<TupleMetadata> &garbage) {
+  ReclaimTuples(garbage);
 }
 
 // GC for vacuum and cooperative schemes
 void GCManager::PerformGC() {
-  // Check if we can move anything from the possibly free list to the free list.
-  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
-  auto max_cid = txn_manager.GetMaxCommittedCid();
   // if GC is not running, return without doing anything
   if (is_running_ == false) {
     LOG_INFO("returning");
     return;
   }
-  // every time we garbage collect at most max_tuples_per_gc tuples.
-  for (size_t i = 0; i < max_tuples_per_gc; ++i) {
+  // every time we garbage collect at most max_tuples_per_gc tuples per shard.
+  for (size_t shard_id = 0; shard_id < possibly_free_lists_.size();
+       shard_id++) {
+    PerformGC(shard_id, max_tuples_per_gc);
+  }
+}
+
+// GC for one shard of the possibly free list
+size_t GCManager::PerformGC(const size_t &shard_id, const size_t &budget) {
+  auto &possibly_free_list = *possibly_free_lists_[shard_id];
+  // Check if we can move anything from the possibly free list to the free list.
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto max_cid = txn_manager.GetMaxCommittedCid();
+
+  size_t reclaimed_count = 0;
+  std::vector<TupleMetadata> garbage;
+  for (size_t i = 0; i < budget; ++i) {
     TupleMetadata tuple_metadata;
     // if there's no more tuples in the queue, then break.
-    if (possibly_free_list_.TryPop(tuple_metadata) == false) {
+    if (possibly_free_list.TryPop(tuple_metadata) == false) {
       break;
     }
     // if there are no transactions running or if this tuple is not visible to
     // any of the running transactions
     if (max_cid == MAX_CID || tuple_metadata.tuple_end_cid <= max_cid) {
-      RefurbishTuple(tuple_metadata);
+      garbage.push_back(tuple_metadata);
+      // reclaim in batches of max_tuples_per_gc tuples
+      if (garbage.size() == max_tuples_per_gc) {
+        ReclaimTuples(garbage);
+        reclaimed_count += garbage.size();
+        garbage.clear();
+      }
     } else {
       // if a tuple can't be refurbished, add it back to the list.
-      possibly_free_list_.TryPush(tuple_metadata);
+      possibly_free_list.TryPush(tuple_metadata);
     }
   }  // end for
+
+  ReclaimTuples(garbage);
+  reclaimed_count += garbage.size();
+
+  return reclaimed_count;
+}
+
+// Reclaims a batch of versions. The index entries have to go first, as the
+// keys are read from the versions before their slots are handed out again.
+void GCManager::ReclaimTuples(const std::vector<TupleMetadata> &garbage) {
+  if (garbage.empty() == false) {
+    DeleteTupleFromIndexes(garbage);
+
+    for (auto &tuple_metadata : garbage) {
+      RefurbishTuple(tuple_metadata);
+    }
+  }
+
+  // free the index entries retired by earlier rounds
+  concurrency::EpochManagerFactory::GetInstance().Reclaim();
 }
 
 // Called by start GC as the thread function when mode is vacuum
@@ -121,6 +228,46 @@ void GCManager::Poll() {
   }
 }
 
+// Called by start GC as the thread function of every worker when mode is
+// parallel vacuum. The work done per round follows the backlog of the shard:
+// workers clean bigger rounds back to back while garbage piles up, and back
+// off exponentially while there is nothing to reclaim.
+void GCManager::ParallelPoll(const size_t worker_id) {
+  auto &possibly_free_list = *possibly_free_lists_[worker_id];
+  size_t max_budget = max_tuples_per_gc * PARALLEL_GC_MAX_BATCHES;
+  size_t max_sleep_time = std::max<size_t>(vacuum_thread_sleep_time_ * 1000,
+                                           PARALLEL_GC_MIN_SLEEP_TIME);
+  size_t sleep_time = PARALLEL_GC_MIN_SLEEP_TIME;
+
+  while (this->is_running_) {
+    size_t backlog = possibly_free_list.GetApproximateSize();
+    size_t budget =
+        std::min(std::max(backlog, max_tuples_per_gc), max_budget);
+
+    size_t reclaimed_count = PerformGC(worker_id, budget);
+
+    // there is more garbage waiting, continue right away
+    if (reclaimed_count == budget) {
+      sleep_time = PARALLEL_GC_MIN_SLEEP_TIME;
+      continue;
+    }
+
+    if (reclaimed_count == 0) {
+      sleep_time = std::min(sleep_time * 2, max_sleep_time);
+    } else {
+      sleep_time = PARALLEL_GC_MIN_SLEEP_TIME;
+    }
+
+    // sleep in short steps, so that StopGC does not wait for long
+    auto wake_time = std::chrono::steady_clock::now() +
+                     std::chrono::milliseconds(sleep_time);
+    while (this->is_running_ && std::chrono::steady_clock::now() < wake_time) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(
+          std::min<size_t>(sleep_time, 10 * PARALLEL_GC_MIN_SLEEP_TIME)));
+    }
+  }
+}
+
 // called by transaction manager.
 void GCManager::RecycleTupleSlot(const oid_t &table_id,
                                  const oid_t &tile_group_id,
@@ -132,12 +279,13 @@ void GCManager::RecycleTupleSlot(const oid_t &table_id,
   // Populate the tuple metadata structure
   TupleMetadata tuple_metadata(table_id, tile_group_id, tuple_id,
                                tuple_end_cid);
-  // if epoch scheme, then add to the epoch specific possibly free list
+  // if epoch scheme, then retire it until no transaction can read it anymore
   // else add to the global possibly free list
   if (this->gc_type_ == GC_TYPE_EPOCH) {
-    peloton::concurrency::current_epoch->AddToPossiblyFreeList(tuple_metadata);
+    concurrency::EpochManagerFactory::GetInstance().RetireTupleSlot(
+        tuple_metadata);
   } else {
-    possibly_free_list_.TryPush(tuple_metadata);
+    GetPossiblyFreeList(tile_group_id).TryPush(tuple_metadata);
   }
 }
 
@@ -147,54 +295,158 @@ ItemPointer GCManager::ReturnFreeSlot(const oid_t &table_id) {
     return ItemPointer();
   }
 
-  std::pair<size_t, std::shared_ptr<LockfreeQueue<TupleMetadata>>> free_list;
+  std::shared_ptr<LockfreeQueue<TupleMetadata>> free_list;
   // if there exists free_list
   if (free_map_.find(table_id, free_list) == true) {
     TupleMetadata tuple_metadata;
-    if (free_list.second->TryPop(tuple_metadata) == true) {
-      free_list.first = free_list.first - 1;
-      free_map_[table_id] = free_list;
-      return ItemPointer(tuple_metadata.tile_group_id,
-                         tuple_metadata.tuple_slot_id);
+    std::vector<TupleMetadata> skipped_slots;
+    ItemPointer free_slot;
+    while (skipped_slots.size() < MAX_SKIPPED_FREE_SLOTS &&
+           free_list->TryPop(tuple_metadata) == true) {
+      // keep the slots of tile groups that are being compacted, the
+      // compaction may still give up on them. Only the slots of tile groups
+      // that are gone for good are dropped.
+      if (slot_reuse_disabled_.empty() == false &&
+          slot_reuse_disabled_.contains(tuple_metadata.tile_group_id)) {
+        if (catalog::Manager::GetInstance().GetTileGroup(
+                tuple_metadata.tile_group_id) != nullptr) {
+          skipped_slots.push_back(tuple_metadata);
+          continue;
+        }
+        refurbished_slot_counts_.erase(tuple_metadata.tile_group_id);
+        continue;
+      }
+      refurbished_slot_counts_.update_fn(tuple_metadata.tile_group_id,
+                                         [](size_t &count) { count--; });
+      free_slot = ItemPointer(tuple_metadata.tile_group_id,
+                              tuple_metadata.tuple_slot_id);
+      break;
+    }
+
+    for (auto &skipped_slot : skipped_slots) {
+      free_list->TryPush(skipped_slot);
     }
+    return free_slot;
   }
   return ItemPointer();
 }
 
-// delete a tuple from all its indexes it belongs to.
-// TODO: we do not perform this function,
-// as we do not have concurrent bw tree right now.
-void GCManager::DeleteTupleFromIndexes(const TupleMetadata &tuple_metadata
-                                       __attribute__((unused))) {}
+bool GCManager::DisableSlotReuse(const oid_t &tile_group_id) {
+  return slot_reuse_disabled_.insert(tile_group_id, true);
+}
+
+void GCManager::EnableSlotReuse(const oid_t &tile_group_id) {
+  slot_reuse_disabled_.erase(tile_group_id);
+}
+
+// delete a batch of tuples from all the indexes they belong to.
+// Every version has its own entry in the secondary indexes, which is removed.
+// The primary index only refers to the oldest version of a tuple. That entry
+// is moved forward to the next version, the same way index scans do it, and
+// only removed if there is no newer version.
+void GCManager::DeleteTupleFromIndexes(
+    const std::vector<TupleMetadata> &garbage) {
+  auto &manager = catalog::Manager::GetInstance();
+
+  // group the versions by table, so that every index is latched once
+  std::map<oid_t, std::vector<TupleMetadata>> table_garbage;
+  for (auto &tuple_metadata : garbage) {
+    table_garbage[tuple_metadata.table_id].push_back(tuple_metadata);
+  }
+
+  std::vector<ItemPointer *> retired;
+  size_t reclaimed_memory = 0;
+
+  for (auto &table_entry : table_garbage) {
+    auto &tuples = table_entry.second;
+    // find the table through any of its tile groups that still exists
+    std::shared_ptr<storage::TileGroup> tile_group;
+    for (auto &tuple_metadata : tuples) {
+      tile_group = manager.GetTileGroup(tuple_metadata.tile_group_id);
+      if (tile_group != nullptr) {
+        break;
+      }
+    }
+    if (tile_group == nullptr) {
+      continue;
+    }
+
+    auto table = dynamic_cast<storage::DataTable *>(
+        tile_group->GetAbstractTable());
+    if (table == nullptr) {
+      continue;
+    }
+
+    oid_t index_count = table->GetIndexCount();
+    for (oid_t index_itr = 0; index_itr < index_count; index_itr++) {
+      auto index = table->GetIndex(index_itr);
+      auto index_schema = index->GetKeySchema();
+      auto indexed_columns = index_schema->GetIndexedColumns();
+      bool is_primary =
+          (index->GetIndexType() == INDEX_CONSTRAINT_TYPE_PRIMARY_KEY);
+
+      std::vector<std::unique_ptr<storage::Tuple>> keys;
+      std::vector<index::GarbageEntry> entries;
+
+      for (auto &tuple_metadata : tuples) {
+        tile_group = manager.GetTileGroup(tuple_metadata.tile_group_id);
+        if (tile_group == nullptr) {
+          continue;
+        }
+        auto tuple_id = tuple_metadata.tuple_slot_id;
+
+        // construct the key from the reclaimed version
+        std::unique_ptr<storage::Tuple> key(
+            new storage::Tuple(index_schema, true));
+        for (oid_t column_itr = 0; column_itr < indexed_columns.size();
+             column_itr++) {
+          key->SetValue(column_itr, tile_group->GetValue(
+                                        tuple_id, indexed_columns[column_itr]),
+                        index->GetPool());
+        }
+
+        index::GarbageEntry entry;
+        entry.key = key.get();
+        entry.location = ItemPointer(tuple_metadata.tile_group_id, tuple_id);
+        if (is_primary == true) {
+          entry.next_location =
+              tile_group->GetHeader()->GetNextItemPointer(tuple_id);
+        }
+
+        entries.push_back(entry);
+        keys.push_back(std::move(key));
+      }
+
+      size_t retired_count = retired.size();
+      reclaimed_memory += index->ReclaimEntries(entries, retired);
+      index->DecreaseNumberOfTuplesBy(retired.size() - retired_count);
+    }
+  }
+
+  if (retired.empty() == true) {
+    return;
+  }
+
+  reclaimed_index_entry_count_ += retired.size();
+  reclaimed_index_memory_ +=
+      reclaimed_memory + retired.size() * sizeof(ItemPointer);
+
+  // Index scans hold on to raw item pointers, they are only freed once every
+  // transaction running at this time is done
+  concurrency::EpochManagerFactory::GetInstance().Retire(
+      new std::vector<ItemPointer *>(std::move(retired)), FreeItemPointers);
+}
 
 // Get the number of tuples refurbished in a tile group in a table
 size_t GCManager::GetRefurbishedTupleSlotCountPerTileGroup(
-    const oid_t &table_id, const oid_t &tile_group_id) {
+    const oid_t &table_id __attribute__((unused)),
+    const oid_t &tile_group_id) {
   // if GC mode is off, return 0
   if (this->gc_type_ == GC_TYPE_OFF) {
     return 0;
   }
   size_t count = 0;
-  {
-    std::lock_guard<std::mutex> lock(free_map_mutex);
-    std::pair<size_t, std::shared_ptr<LockfreeQueue<TupleMetadata>>> free_list;
-    // if there exists free_list for this table
-    if (free_map_.find(table_id, free_list)) {
-      size_t size = free_list.first;
-      // iterate over the free list
-      for (unsigned i = 0; i < size; ++i) {
-        // pop the queue and then later push it back
-        TupleMetadata tuple_metadata;
-        if (free_list.second->TryPop(tuple_metadata)) {
-          // check whether the tuple belongs to this tile group
-          if (tuple_metadata.tile_group_id == tile_group_id) {
-            count++;
-          }
-          free_list.second->TryPush(tuple_metadata);
-        }
-      }
-    }
-  }
+  refurbished_slot_counts_.find(tile_group_id, count);
 
   return count;
 }
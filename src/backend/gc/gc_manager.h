@@ -12,13 +12,15 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "backend/common/types.h"
 #include "backend/common/lockfree_queue.h"
 #include "backend/common/logger.h"
-#include "backend/common/epoch.h"
 #include "libcuckoo/cuckoohash_map.hh"
 
 namespace peloton {
@@ -30,6 +32,13 @@ namespace gc {
 
 #define MAX_TUPLES_PER_GC 1000
 #define VACUUM_THREAD_SLEEP_TIME 5
+#define PARALLEL_GC_THREAD_COUNT 4
+// Upper bound on the batches a parallel GC worker cleans in one round
+#define PARALLEL_GC_MAX_BATCHES 64
+// Shortest sleep of an idle parallel GC worker, in milliseconds
+#define PARALLEL_GC_MIN_SLEEP_TIME 1
+// Most slots of tile groups being compacted a free slot lookup passes over
+#define MAX_SKIPPED_FREE_SLOTS 16
 
 class GCManager {
  public:
@@ -39,14 +48,10 @@ class GCManager {
   GCManager &operator=(GCManager &&) = delete;
 
   GCManager(const GCType type, size_t max_tuples = MAX_TUPLES_PER_GC,
-            unsigned int sleep_time_ = VACUUM_THREAD_SLEEP_TIME)
-      : is_running_(true),
-        gc_type_(type),
-        possibly_free_list_(FREE_LIST_LENGTH),
-        max_tuples_per_gc(max_tuples),
-        vacuum_thread_sleep_time_(sleep_time_) {}
+            unsigned int sleep_time_ = VACUUM_THREAD_SLEEP_TIME,
+            size_t thread_count = PARALLEL_GC_THREAD_COUNT);
 
-  ~GCManager() { StopGC(); }
+  ~GCManager();
 
   // Get status of whether GC thread is running or not
   bool GetStatus() { return this->is_running_; }
@@ -62,12 +67,18 @@ class GCManager {
     this->vacuum_thread_sleep_time_ = sleep_time;
   }
 
+  // Get number of GC worker threads (and possibly free list shards)
+  size_t GetThreadCount() { return this->possibly_free_lists_.size(); }
+
   // PerformGC function used by vacuum and cooperative mode. Uses global
   // possibly and actual free list
   void PerformGC();
-  // PerformGC function used by epoch mode. Uses epoch specific possibly and
-  // actual free list
-  void PerformGC(Epoch *e);
+  // PerformGC function used by the parallel vacuum workers. Cleans at most
+  // budget tuples from the given shard and returns the number reclaimed
+  size_t PerformGC(const size_t &shard_id, const size_t &budget);
+  // PerformGC function used by epoch mode. Reclaims the versions the epoch
+  // manager found no running transaction can read anymore
+  void PerformGC(const std::vector<TupleMetadata> &garbage);
   // Start and Stop the GC
   void StartGC();
   void StopGC();
@@ -83,11 +94,34 @@ class GCManager {
   // Gets the item pointer for a tuple slot from the actually free list
   ItemPointer ReturnFreeSlot(const oid_t &table_id);
 
+  // Stops (and resumes) handing out the free slots of a tile group. Used by
+  // the compactor while it empties a tile group and by the layout transform.
+  // Returns false if slot reuse is disabled already.
+  bool DisableSlotReuse(const oid_t &tile_group_id);
+  void EnableSlotReuse(const oid_t &tile_group_id);
+
+  // Number of index entries removed for reclaimed versions
+  size_t GetReclaimedIndexEntryCount() const {
+    return reclaimed_index_entry_count_;
+  }
+  // Bytes of index memory released for reclaimed versions
+  size_t GetReclaimedIndexMemory() const { return reclaimed_index_memory_; }
+
  private:
   // Infinite poll used by the vacuum thread
   void Poll();
-  // TODO Delete the refurbished tuples from the indexes as well
-  void DeleteTupleFromIndexes(const TupleMetadata &);
+  // Infinite poll used by the parallel vacuum worker threads
+  void ParallelPoll(const size_t worker_id);
+  // Returns the shard of the possibly free list a tuple belongs to
+  LockfreeQueue<TupleMetadata> &GetPossiblyFreeList(const oid_t &tile_group_id);
+  // Returns the free list of a table, creating it if necessary
+  std::shared_ptr<LockfreeQueue<TupleMetadata>> GetFreeList(
+      const oid_t &table_id);
+  // Reclaims a batch of versions, their index entries first
+  void ReclaimTuples(const std::vector<TupleMetadata> &garbage);
+  // Deletes the index entries of a batch of reclaimed versions, latching each
+  // index once per table in the batch
+  void DeleteTupleFromIndexes(const std::vector<TupleMetadata> &garbage);
 
  private:
   //===--------------------------------------------------------------------===//
@@ -98,16 +132,23 @@ class GCManager {
   volatile bool is_running_;
   // GC mode
   GCType gc_type_;
-  // The global possibly free list used by vacuum and cooperative modes
-  LockfreeQueue<TupleMetadata> possibly_free_list_;
+  // The global possibly free list used by vacuum and cooperative modes.
+  // In parallel vacuum mode it is sharded by tile group across the workers.
+  std::vector<std::unique_ptr<LockfreeQueue<TupleMetadata>>>
+      possibly_free_lists_;
   // Maps table ids to the list of free tuples in the table
   // We are using the third-party cuckoohash_map, as our look-free concurrent
   // hashmap. Source code: https://github.com/efficient/libcuckoo
-  cuckoohash_map<
-      oid_t, std::pair<size_t, std::shared_ptr<LockfreeQueue<TupleMetadata>>>>
+  // The free lists are created once and never replaced, so that refurbishing
+  // and reusing a slot only take a lookup and a lockfree queue operation.
+  cuckoohash_map<oid_t, std::shared_ptr<LockfreeQueue<TupleMetadata>>>
       free_map_;
-  // mutex to access the free map
-  std::mutex free_map_mutex;
+  // Maps tile group ids to the number of refurbished slots in the tile group
+  cuckoohash_map<oid_t, size_t> refurbished_slot_counts_;
+  // Tile groups whose free slots must not be reused
+  cuckoohash_map<oid_t, bool> slot_reuse_disabled_;
+  // Parallel vacuum worker threads
+  std::vector<std::thread> gc_threads_;
   // Moves the tuple from possibly free list to the free map
   void RefurbishTuple(const TupleMetadata tuple_metadata);
 
@@ -115,6 +156,10 @@ class GCManager {
   size_t max_tuples_per_gc;
   // Seconds to sleep for the vacuum thread
   unsigned int vacuum_thread_sleep_time_;
+
+  // Index GC stats
+  std::atomic<size_t> reclaimed_index_entry_count_;
+  std::atomic<size_t> reclaimed_index_memory_;
 };
 
 }  // namespace gc
@@ -13,5 +13,8 @@
 #include "gc_manager_factory.h"
 
 namespace peloton {
-namespace gc { GCType GCManagerFactory::gc_type_ = GC_TYPE_OFF; }
+namespace gc {
+GCType GCManagerFactory::gc_type_ = GC_TYPE_OFF;
+size_t GCManagerFactory::gc_thread_count_ = PARALLEL_GC_THREAD_COUNT;
+}
 }
@@ -19,16 +19,26 @@ namespace gc {
 class GCManagerFactory {
  public:
   static GCManager &GetInstance() {
-    static GCManager gc_manager(gc_type_);
+    static GCManager gc_manager(gc_type_, MAX_TUPLES_PER_GC,
+                                VACUUM_THREAD_SLEEP_TIME, gc_thread_count_);
     return gc_manager;
   }
 
-  static void Configure(GCType gc_type) { gc_type_ = gc_type; }
+  static void Configure(GCType gc_type,
+                        size_t gc_thread_count = PARALLEL_GC_THREAD_COUNT) {
+    gc_type_ = gc_type;
+    gc_thread_count_ = gc_thread_count;
+  }
 
   static GCType GetGCType() { return gc_type_; }
 
+  static size_t GetGCThreadCount() { return gc_thread_count_; }
+
  private:
   static GCType gc_type_;
+
+  // Number of GC worker threads in parallel vacuum mode
+  static size_t gc_thread_count_;
 };
 }
 }
@@ -0,0 +1,382 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// tile_group_compactor.cpp
+//
+// Identification: src/backend/gc/tile_group_compactor.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>
+#include <memory>
+
+#include "backend/catalog/manager.h"
+#include "backend/common/logger.h"
+#include "backend/concurrency/transaction.h"
+#include "backend/concurrency/transaction_manager_factory.h"
+#include "backend/gc/gc_manager_factory.h"
+#include "backend/gc/tile_group_compactor.h"
+#include "backend/index/index.h"
+#include "backend/storage/data_table.h"
+#include "backend/storage/database.h"
+#include "backend/storage/tile_group.h"
+#include "backend/storage/tile_group_header.h"
+#include "backend/storage/tuple.h"
+#include "backend/storage/zone_map.h"
+
+namespace peloton {
+namespace gc {
+
+TileGroupCompactor::TileGroupCompactor(double threshold,
+                                       unsigned int sleep_time,
+                                       cid_t freeze_distance)
+    : is_running_(false),
+      threshold_(threshold),
+      sleep_time_(sleep_time),
+      freeze_distance_(freeze_distance),
+      dropped_tile_group_count_(0),
+      relocated_tuple_count_(0),
+      reclaimed_memory_(0),
+      frozen_tile_group_count_(0) {}
+
+TileGroupCompactor::~TileGroupCompactor() { StopCompaction(); }
+
+TileGroupCompactor &TileGroupCompactor::GetInstance() {
+  static TileGroupCompactor tile_group_compactor;
+  return tile_group_compactor;
+}
+
+void TileGroupCompactor::StartCompaction() {
+  // without GC nothing is ever drained
+  if (GCManagerFactory::GetGCType() == GC_TYPE_OFF ||
+      compaction_thread_.joinable() == true) {
+    return;
+  }
+  this->is_running_ = true;
+  compaction_thread_ = std::thread(&TileGroupCompactor::Poll, this);
+}
+
+void TileGroupCompactor::StopCompaction() {
+  this->is_running_ = false;
+  if (compaction_thread_.joinable() == true) {
+    compaction_thread_.join();
+  }
+}
+
+// Called by start compaction as the thread function
+void TileGroupCompactor::Poll() {
+  auto &manager = catalog::Manager::GetInstance();
+
+  while (this->is_running_) {
+    for (oid_t database_offset = 0;
+         database_offset < manager.GetDatabaseCount(); database_offset++) {
+      auto database = manager.GetDatabase(database_offset);
+      for (oid_t table_offset = 0; table_offset < database->GetTableCount();
+           table_offset++) {
+        CompactTable(database->GetTable(table_offset));
+        FreezeTable(database->GetTable(table_offset));
+      }
+    }
+
+    // sleep in short steps so that stopping does not wait for a whole round
+    for (unsigned int slept = 0; slept < sleep_time_ * 10 && this->is_running_;
+         slept++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+  }
+}
+
+size_t TileGroupCompactor::CompactTable(storage::DataTable *table) {
+  std::lock_guard<std::mutex> lock(compaction_mutex_);
+  auto &manager = catalog::Manager::GetInstance();
+  auto &gc_manager = GCManagerFactory::GetInstance();
+  auto &draining = draining_[table->GetOid()];
+
+  // Check on the tile groups drained since the last round
+  std::set<oid_t> drop_candidates;
+  for (auto itr = draining.begin(); itr != draining.end();) {
+    auto tile_group = manager.GetTileGroup(*itr);
+    if (tile_group == nullptr) {
+      itr = draining.erase(itr);
+      continue;
+    }
+    if (IsDrained(tile_group.get()) == true) {
+      drop_candidates.insert(*itr);
+    } else {
+      // versions inserted before reuse was disabled, or relocations that
+      // failed last round
+      RelocateTuples(table, tile_group.get());
+    }
+    ++itr;
+  }
+
+  // The GC swings the primary index to the new versions lazily
+  FilterReferencedTileGroups(table, drop_candidates);
+
+  size_t dropped_count = 0;
+  for (auto tile_group_id : drop_candidates) {
+    auto memory_footprint =
+        manager.GetTileGroup(tile_group_id)->GetMemoryFootprint(0);
+    if (table->DropTileGroup(tile_group_id) == false) {
+      continue;
+    }
+    // slot reuse stays disabled, the free list may still hold its slots
+    draining.erase(tile_group_id);
+    dropped_count++;
+    dropped_tile_group_count_++;
+    reclaimed_memory_ += memory_footprint;
+    LOG_INFO("Dropped tile group %u of table %u", tile_group_id,
+             table->GetOid());
+  }
+
+  // Start draining the new sparse tile groups. Disable all of them before
+  // moving tuples, so that one does not get refilled from another.
+  std::vector<std::shared_ptr<storage::TileGroup>> sparse_tile_groups;
+  for (auto tile_group_id : table->GetTileGroupIds()) {
+    if (draining.count(tile_group_id) != 0) {
+      continue;
+    }
+    auto tile_group = manager.GetTileGroup(tile_group_id);
+    // slot reuse is disabled already while the tile group is transformed
+    if (tile_group != nullptr && IsSparse(tile_group.get()) == true &&
+        gc_manager.DisableSlotReuse(tile_group_id) == true) {
+      sparse_tile_groups.push_back(tile_group);
+    }
+  }
+
+  // The last tile group is never dropped, keep it out of the way
+  if (sparse_tile_groups.empty() == false &&
+      table->GetTileGroupIds().back() ==
+          sparse_tile_groups.back()->GetTileGroupId()) {
+    gc_manager.EnableSlotReuse(sparse_tile_groups.back()->GetTileGroupId());
+    sparse_tile_groups.pop_back();
+  }
+
+  for (auto &tile_group : sparse_tile_groups) {
+    auto tile_group_id = tile_group->GetTileGroupId();
+    if (RelocateTuples(table, tile_group.get()) == true) {
+      draining.insert(tile_group_id);
+    } else {
+      gc_manager.EnableSlotReuse(tile_group_id);
+    }
+  }
+
+  // Reused slots only widen the zone maps, shrink them back to the values
+  // left in the slots of the full tile groups
+  for (auto tile_group_id : table->GetTileGroupIds()) {
+    auto tile_group = manager.GetTileGroup(tile_group_id);
+    if (tile_group == nullptr || draining.count(tile_group_id) != 0 ||
+        tile_group->GetNextTupleSlot() < tile_group->GetAllocatedTupleCount() ||
+        tile_group->GetZoneMap()->NeedsRecompute() == false) {
+      continue;
+    }
+    tile_group->GetZoneMap()->Recompute(tile_group.get());
+  }
+
+  return dropped_count;
+}
+
+size_t TileGroupCompactor::FreezeTable(storage::DataTable *table) {
+  std::lock_guard<std::mutex> lock(compaction_mutex_);
+  auto &manager = catalog::Manager::GetInstance();
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+
+  auto current_cid = txn_manager.GetCurrentCommitId();
+  if (current_cid <= freeze_distance_) {
+    return 0;
+  }
+  auto cold_cid = current_cid - freeze_distance_;
+
+  size_t frozen_count = 0;
+  for (auto tile_group_id : table->GetTileGroupIds()) {
+    auto tile_group = manager.GetTileGroup(tile_group_id);
+    if (tile_group == nullptr || tile_group->IsFrozen() == true ||
+        IsCold(tile_group.get(), cold_cid) == false) {
+      continue;
+    }
+
+    // tile groups being written are tried again next round
+    auto memory_footprint = tile_group->GetMemoryFootprint(0);
+    auto frozen_tile_group = table->FreezeTileGroupById(tile_group_id);
+    if (frozen_tile_group == nullptr) {
+      continue;
+    }
+
+    frozen_count++;
+    frozen_tile_group_count_++;
+    auto frozen_memory_footprint = frozen_tile_group->GetMemoryFootprint(0);
+    if (frozen_memory_footprint < memory_footprint) {
+      reclaimed_memory_ += memory_footprint - frozen_memory_footprint;
+    }
+    LOG_TRACE("Froze tile group %u of table %u", tile_group_id,
+              table->GetOid());
+  }
+
+  return frozen_count;
+}
+
+bool TileGroupCompactor::IsCold(storage::TileGroup *tile_group,
+                                cid_t cold_cid) const {
+  auto tile_group_header = tile_group->GetHeader();
+  auto allocated_count = tile_group->GetAllocatedTupleCount();
+
+  // still being filled
+  if (tile_group_header->GetCurrentNextTupleSlot() < allocated_count) {
+    return false;
+  }
+
+  // old versions are about to be recycled, which would thaw the tile group
+  for (oid_t tuple_id = 0; tuple_id < allocated_count; tuple_id++) {
+    if (tile_group_header->GetTransactionId(tuple_id) != INITIAL_TXN_ID ||
+        tile_group_header->GetEndCommitId(tuple_id) != MAX_CID ||
+        tile_group_header->GetBeginCommitId(tuple_id) >= cold_cid) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TileGroupCompactor::IsSparse(storage::TileGroup *tile_group) const {
+  auto tile_group_header = tile_group->GetHeader();
+  auto allocated_count = tile_group->GetAllocatedTupleCount();
+
+  // still being filled
+  if (tile_group_header->GetCurrentNextTupleSlot() < allocated_count) {
+    return false;
+  }
+
+  size_t live_count = 0;
+  for (oid_t tuple_id = 0; tuple_id < allocated_count; tuple_id++) {
+    auto txn_id = tile_group_header->GetTransactionId(tuple_id);
+    auto begin_cid = tile_group_header->GetBeginCommitId(tuple_id);
+    if (txn_id == INVALID_TXN_ID && begin_cid != MAX_CID) {
+      // delete marker
+      return false;
+    }
+    if (txn_id != INVALID_TXN_ID) {
+      live_count++;
+    }
+  }
+
+  return live_count <= threshold_ * allocated_count;
+}
+
+bool TileGroupCompactor::IsDrained(storage::TileGroup *tile_group) const {
+  auto tile_group_header = tile_group->GetHeader();
+
+  for (oid_t tuple_id = 0; tuple_id < tile_group->GetAllocatedTupleCount();
+       tuple_id++) {
+    if (tile_group_header->GetTransactionId(tuple_id) != INVALID_TXN_ID ||
+        tile_group_header->GetBeginCommitId(tuple_id) != MAX_CID) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TileGroupCompactor::RelocateTuples(storage::DataTable *table,
+                                        storage::TileGroup *tile_group) {
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto tile_group_header = tile_group->GetHeader();
+  auto tile_group_id = tile_group->GetTileGroupId();
+  size_t relocated_count = 0;
+
+  auto txn = txn_manager.BeginTransaction();
+
+  for (oid_t tuple_id = 0; tuple_id < tile_group->GetAllocatedTupleCount();
+       tuple_id++) {
+    // only move the latest committed versions
+    if (tile_group_header->GetTransactionId(tuple_id) != INITIAL_TXN_ID ||
+        tile_group_header->GetEndCommitId(tuple_id) != MAX_CID) {
+      continue;
+    }
+
+    ItemPointer old_location(tile_group_id, tuple_id);
+    // updates are only recorded on top of a read
+    if (txn_manager.PerformRead(old_location) == false ||
+        txn_manager.IsOwnable(tile_group_header, tuple_id) == false ||
+        txn_manager.AcquireOwnership(tile_group_header, tile_group_id,
+                                     tuple_id) == false) {
+      txn_manager.SetTransactionResult(Result::RESULT_FAILURE);
+      break;
+    }
+
+    std::unique_ptr<storage::Tuple> new_tuple(
+        new storage::Tuple(table->GetSchema(), true));
+    tile_group->CopyTuple(tuple_id, new_tuple.get());
+
+    ItemPointer new_location = table->InsertVersion(new_tuple.get());
+    if (new_location.IsNull() == true) {
+      // the tuple is owned, but not in the write set yet, so the abort does
+      // not release it
+      tile_group_header->SetTransactionId(tuple_id, INITIAL_TXN_ID);
+      txn_manager.SetTransactionResult(Result::RESULT_FAILURE);
+      break;
+    }
+
+    txn_manager.PerformUpdate(old_location, new_location);
+    relocated_count++;
+  }
+
+  if (txn->GetResult() != RESULT_SUCCESS) {
+    txn_manager.AbortTransaction();
+    LOG_INFO("Could not relocate the tuples of tile group %u", tile_group_id);
+    return false;
+  }
+
+  if (txn_manager.CommitTransaction() != RESULT_SUCCESS) {
+    LOG_INFO("Could not relocate the tuples of tile group %u", tile_group_id);
+    return false;
+  }
+
+  relocated_tuple_count_ += relocated_count;
+  return true;
+}
+
+void TileGroupCompactor::FilterReferencedTileGroups(
+    storage::DataTable *table, std::set<oid_t> &candidates) const {
+  if (candidates.empty() == true) {
+    return;
+  }
+
+  auto &manager = catalog::Manager::GetInstance();
+
+  for (oid_t index_offset = 0; index_offset < table->GetIndexCount();
+       index_offset++) {
+    auto index = table->GetIndex(index_offset);
+    bool is_primary =
+        (index->GetIndexType() == INDEX_CONSTRAINT_TYPE_PRIMARY_KEY);
+
+    std::vector<ItemPointer *> item_pointers;
+    index->ScanAllKeys(item_pointers);
+
+    for (auto item_pointer : item_pointers) {
+      ItemPointer location = *item_pointer;
+      candidates.erase(location.block);
+
+      // the primary index points to the oldest version of the chain
+      while (is_primary == true && location.IsNull() == false) {
+        auto tile_group = manager.GetTileGroup(location.block);
+        if (tile_group == nullptr) {
+          break;
+        }
+        candidates.erase(location.block);
+        auto tile_group_header = tile_group->GetHeader();
+        if (tile_group_header->GetEndCommitId(location.offset) == MAX_CID) {
+          break;
+        }
+        location = tile_group_header->GetNextItemPointer(location.offset);
+      }
+
+      if (candidates.empty() == true) {
+        return;
+      }
+    }
+  }
+}
+
+}  // namespace gc
+}  // namespace peloton
@@ -0,0 +1,168 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// tile_group_compactor.h
+//
+// Identification: src/backend/gc/tile_group_compactor.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "backend/common/types.h"
+
+namespace peloton {
+
+namespace storage {
+class DataTable;
+class TileGroup;
+}
+
+namespace gc {
+
+//===--------------------------------------------------------------------===//
+// Tile Group Compactor
+//===--------------------------------------------------------------------===//
+
+// Tile groups with at most this fraction of live tuples are compacted
+#define COMPACTION_THRESHOLD 0.1
+// Seconds to sleep for the compaction thread
+#define COMPACTION_THREAD_SLEEP_TIME 10
+// Tile groups not written in this many commits are frozen
+#define COMPACTION_FREEZE_DISTANCE 100000
+
+/**
+ * Reclaims mostly empty tile groups.
+ *
+ * The GC only recycles individual tuple slots, so a tile group that was filled
+ * once stays allocated forever. The compactor picks full tile groups whose live
+ * tuples make up at most the compaction threshold, stops the GC from handing
+ * out their free slots and moves the live versions out with regular updates.
+ * Once the GC has reclaimed the old versions (and with them the index entries
+ * pointing into the tile group) the tile group is dropped from the table and
+ * the catalog, which frees its memory as soon as the last reader lets go.
+ *
+ * Tile groups holding delete markers are left alone, the GC does not reclaim
+ * delete markers yet.
+ *
+ * Cold tile groups, whose versions are all current and were committed long
+ * enough ago, are frozen to take less space (see Tile::Freeze). The first
+ * write to a frozen tile group thaws it again.
+ *
+ * The compaction thread is opt-in, the postmaster only starts it when the
+ * peloton_compaction setting is on (and a GC mode is set).
+ */
+class TileGroupCompactor {
+ public:
+  TileGroupCompactor(const TileGroupCompactor &) = delete;
+  TileGroupCompactor &operator=(const TileGroupCompactor &) = delete;
+  TileGroupCompactor(TileGroupCompactor &&) = delete;
+  TileGroupCompactor &operator=(TileGroupCompactor &&) = delete;
+
+  TileGroupCompactor(double threshold = COMPACTION_THRESHOLD,
+                     unsigned int sleep_time = COMPACTION_THREAD_SLEEP_TIME,
+                     cid_t freeze_distance = COMPACTION_FREEZE_DISTANCE);
+
+  ~TileGroupCompactor();
+
+  static TileGroupCompactor &GetInstance();
+
+  // Start and Stop the compaction thread
+  void StartCompaction();
+  void StopCompaction();
+
+  // Get status of whether compaction thread is running or not
+  bool GetStatus() { return this->is_running_; }
+
+  // Get and Set the fraction of live tuples below which tile groups are
+  // compacted
+  double GetCompactionThreshold() { return this->threshold_; }
+  void SetCompactionThreshold(double threshold) {
+    this->threshold_ = threshold;
+  }
+  // Get and Set Sleep Time for compaction thread
+  unsigned int GetCompactionThreadSleepTime() { return this->sleep_time_; }
+  void SetCompactionThreadSleepTime(unsigned int sleep_time) {
+    this->sleep_time_ = sleep_time;
+  }
+  // Get and Set the number of commits after which tile groups are cold
+  cid_t GetFreezeDistance() { return this->freeze_distance_; }
+  void SetFreezeDistance(cid_t freeze_distance) {
+    this->freeze_distance_ = freeze_distance;
+  }
+
+  // Runs one compaction round over the table: drops the tile groups drained
+  // since the last round and starts draining the new sparse ones. Returns the
+  // number of tile groups dropped.
+  size_t CompactTable(storage::DataTable *table);
+
+  // Freezes the cold tile groups of the table. Returns the number of tile
+  // groups frozen.
+  size_t FreezeTable(storage::DataTable *table);
+
+  // Compaction stats
+  size_t GetDroppedTileGroupCount() const { return dropped_tile_group_count_; }
+  size_t GetRelocatedTupleCount() const { return relocated_tuple_count_; }
+  size_t GetReclaimedMemory() const { return reclaimed_memory_; }
+  size_t GetFrozenTileGroupCount() const { return frozen_tile_group_count_; }
+
+ private:
+  // Infinite poll used by the compaction thread
+  void Poll();
+
+  // Whether the tile group is worth compacting
+  bool IsSparse(storage::TileGroup *tile_group) const;
+
+  // Whether every version is current and committed before the given id
+  bool IsCold(storage::TileGroup *tile_group, cid_t cold_cid) const;
+
+  // Whether no slot of the tile group holds a version anymore
+  bool IsDrained(storage::TileGroup *tile_group) const;
+
+  // Moves the live versions out of the tile group in a single transaction
+  bool RelocateTuples(storage::DataTable *table,
+                      storage::TileGroup *tile_group);
+
+  // Removes the tile groups still referenced by an index from the candidates
+  void FilterReferencedTileGroups(storage::DataTable *table,
+                                  std::set<oid_t> &candidates) const;
+
+ private:
+  //===--------------------------------------------------------------------===//
+  // Data members
+  //===--------------------------------------------------------------------===//
+
+  // Is the compaction thread running
+  volatile bool is_running_;
+  // Fraction of live tuples below which tile groups are compacted
+  double threshold_;
+  // Seconds to sleep for the compaction thread
+  unsigned int sleep_time_;
+  // Commits after which a tile group that was not written is cold
+  cid_t freeze_distance_;
+  std::thread compaction_thread_;
+
+  // Tile groups being drained, per table
+  std::map<oid_t, std::set<oid_t>> draining_;
+  // Serializes compaction rounds
+  std::mutex compaction_mutex_;
+
+  // Compaction stats
+  std::atomic<size_t> dropped_tile_group_count_;
+  std::atomic<size_t> relocated_tuple_count_;
+  std::atomic<size_t> reclaimed_memory_;
+  std::atomic<size_t> frozen_tile_group_count_;
+};
+
+}  // namespace gc
+}  // namespace peloton
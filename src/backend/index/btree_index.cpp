@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+
 #include "backend/index/btree_index.h"
 #include "backend/index/index_key.h"
 #include "backend/common/logger.h"
@@ -40,6 +42,9 @@ BTreeIndex<KeyType, ValueType, KeyComparator,
     delete entry->second;
     entry->second = nullptr;
   }
+  for (auto &entry : bulk_load_entries) {
+    delete entry.second;
+  }
 }
 
 template <typename KeyType, typename ValueType, class KeyComparator,
@@ -127,6 +132,7 @@ bool BTreeIndex<KeyType, ValueType, KeyComparator,
 
       if (predicate(item_pointer)) {
         // this key is already visible or dirty in the index
+        index_lock.Unlock();
         return false;
       }
     }
@@ -141,6 +147,120 @@ bool BTreeIndex<KeyType, ValueType, KeyComparator,
   return true;
 }
 
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+size_t BTreeIndex<KeyType, ValueType, KeyComparator,
+                  KeyEqualityChecker>::ReclaimEntries(
+    const std::vector<GarbageEntry> &entries,
+    std::vector<ItemPointer *> &retired) {
+  KeyType index_key;
+  size_t footprint_before, footprint_after;
+
+  {
+    index_lock.WriteLock();
+
+    footprint_before = container.GetMemoryFootprint();
+
+    for (auto &garbage_entry : entries) {
+      index_key.SetFromKey(garbage_entry.key);
+
+      // find the < key, location > pair
+      auto range = container.equal_range(index_key);
+      for (auto iterator = range.first; iterator != range.second;
+           iterator++) {
+        ItemPointer *item_pointer = iterator->second;
+
+        if (garbage_entry.next_location.IsNull() == false) {
+          // Index scans swing this pointer without holding the latch, so only
+          // move it forward if it still refers to the reclaimed version
+          if (AtomicCompareAndSwapItemPointer(item_pointer,
+                                              garbage_entry.location,
+                                              garbage_entry.next_location)) {
+            break;
+          }
+          continue;
+        }
+
+        if ((item_pointer->block == garbage_entry.location.block) &&
+            (item_pointer->offset == garbage_entry.location.offset)) {
+          retired.push_back(item_pointer);
+          container.erase(iterator);
+          break;
+        }
+      }
+    }
+
+    footprint_after = container.GetMemoryFootprint();
+
+    index_lock.Unlock();
+  }
+
+  if (footprint_after >= footprint_before) {
+    return 0;
+  }
+  return footprint_before - footprint_after;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+void BTreeIndex<KeyType, ValueType, KeyComparator,
+                KeyEqualityChecker>::BulkLoadEntry(const storage::Tuple *key,
+                                                   const ItemPointer &location) {
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  bulk_load_entries.emplace_back(index_key, new ItemPointer(location));
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+bool BTreeIndex<KeyType, ValueType, KeyComparator,
+                KeyEqualityChecker>::FinishBulkLoad() {
+  auto entry_comparator = [this](const std::pair<KeyType, ValueType> &lhs,
+                                 const std::pair<KeyType, ValueType> &rhs) {
+    return comparator(lhs.first, rhs.first);
+  };
+  std::stable_sort(bulk_load_entries.begin(), bulk_load_entries.end(),
+                   entry_comparator);
+
+  index_lock.WriteLock();
+
+  bool status = true;
+  if (HasUniqueKeys() == true) {
+    for (size_t entry_itr = 0; entry_itr < bulk_load_entries.size();
+         entry_itr++) {
+      auto &index_key = bulk_load_entries[entry_itr].first;
+      if ((entry_itr > 0 &&
+           equals(bulk_load_entries[entry_itr - 1].first, index_key)) ||
+          container.find(index_key) != container.end()) {
+        status = false;
+        break;
+      }
+    }
+  }
+
+  if (status == false) {
+    LOG_ERROR("Duplicate key in bulk load of index %s", GetName().c_str());
+    for (auto &entry : bulk_load_entries) {
+      delete entry.second;
+    }
+  } else if (container.empty() == true) {
+    // Build the tree bottom-up
+    container.bulk_load(bulk_load_entries.begin(), bulk_load_entries.end());
+  } else {
+    for (auto &entry : bulk_load_entries) {
+      container.insert(entry);
+    }
+  }
+
+  index_lock.Unlock();
+
+  bulk_load_entries.clear();
+  bulk_load_entries.shrink_to_fit();
+
+  return status;
+}
+
 template <typename KeyType, typename ValueType, class KeyComparator,
           class KeyEqualityChecker>
 void BTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::Scan(
@@ -50,6 +50,13 @@ class BTreeIndex : public Index {
   bool CondInsertEntry(const storage::Tuple *key, const ItemPointer &location,
                        std::function<bool(const ItemPointer &)> predicate);
 
+  size_t ReclaimEntries(const std::vector<GarbageEntry> &entries,
+                        std::vector<ItemPointer *> &retired);
+
+  void BulkLoadEntry(const storage::Tuple *key, const ItemPointer &location);
+
+  bool FinishBulkLoad();
+
   void Scan(const std::vector<Value> &values,
             const std::vector<oid_t> &key_column_ids,
             const std::vector<ExpressionType> &expr_types,
@@ -86,6 +93,9 @@ class BTreeIndex : public Index {
 
   // synch helper
   RWLock index_lock;
+
+  // entries handed over for bulk loading
+  std::vector<std::pair<KeyType, ValueType>> bulk_load_entries;
 };
 
 }  // End index namespace
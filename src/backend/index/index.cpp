@@ -41,6 +41,41 @@ oid_t IndexMetadata::GetColumnCount() const {
   return GetKeySchema()->GetColumnCount();
 }
 
+size_t Index::ReclaimEntries(const std::vector<GarbageEntry> &entries,
+                             std::vector<ItemPointer *> &retired
+                             __attribute__((unused))) {
+  // Fallback for indexes without batched reclamation
+  for (auto &entry : entries) {
+    if (entry.next_location.IsNull() == true) {
+      DeleteEntry(entry.key, entry.location);
+    }
+  }
+
+  return 0;
+}
+
+void Index::BulkLoadEntry(const storage::Tuple *key,
+                          const ItemPointer &location) {
+  // Fallback for indexes without bulk loading, a unique key must not be in
+  // the index at all yet
+  bool status;
+  if (HasUniqueKeys() == true) {
+    status = CondInsertEntry(key, location,
+                             [](const ItemPointer &) { return true; });
+  } else {
+    status = InsertEntry(key, location);
+  }
+  if (status == false) {
+    bulk_load_failed = true;
+  }
+}
+
+bool Index::FinishBulkLoad() {
+  bool status = (bulk_load_failed == false);
+  bulk_load_failed = false;
+  return status;
+}
+
 bool Index::Compare(const AbstractTuple &index_key,
                     const std::vector<oid_t> &key_column_ids,
                     const std::vector<ExpressionType> &expr_types,
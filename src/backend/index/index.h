@@ -31,6 +31,23 @@ namespace storage { class Tuple; }
 
 namespace index {
 
+//===--------------------------------------------------------------------===//
+// GarbageEntry
+//===--------------------------------------------------------------------===//
+
+/**
+ * Index entry of a version reclaimed by the garbage collector. If
+ * next_location is set, a matching entry is redirected to the newer version
+ * instead of being removed.
+ */
+struct GarbageEntry {
+  const storage::Tuple *key;
+
+  ItemPointer location;
+
+  ItemPointer next_location;
+};
+
 //===--------------------------------------------------------------------===//
 // IndexMetadata
 //===--------------------------------------------------------------------===//
@@ -128,6 +145,22 @@ class Index : public Printable {
       const storage::Tuple *key, const ItemPointer &location,
       std::function<bool(const ItemPointer &)> predicate) = 0;
 
+  // Garbage collect the entries of a batch of reclaimed versions.
+  // Removed item pointers are appended to retired instead of being freed,
+  // since concurrent index scans may still dereference them.
+  // Returns the number of bytes the index structure shrank by.
+  virtual size_t ReclaimEntries(const std::vector<GarbageEntry> &entries,
+                                std::vector<ItemPointer *> &retired);
+
+  // Bulk loading for tables no transaction uses yet. The entries are handed
+  // over one at a time and put into the index all at once by FinishBulkLoad.
+  virtual void BulkLoadEntry(const storage::Tuple *key,
+                             const ItemPointer &location);
+
+  // Returns false if a unique key shows up twice. The entries inserted
+  // already (without bulk loading) are left for the caller to delete.
+  virtual bool FinishBulkLoad();
+
   //===--------------------------------------------------------------------===//
   // Accessors
   //===--------------------------------------------------------------------===//
@@ -246,6 +279,9 @@ class Index : public Printable {
 
   // pool
   VarlenPool *pool = nullptr;
+
+  // set once an entry of the bulk load fallback could not be inserted
+  bool bulk_load_failed = false;
 };
 
 }  // End index namespace
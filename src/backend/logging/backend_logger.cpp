@@ -19,7 +19,11 @@
 namespace peloton {
 namespace logging {
 
-BackendLogger::BackendLogger() {
+// Number of power-of-two buckets in the commit latency histogram
+#define COMMIT_LATENCY_BUCKET_COUNT 32
+
+BackendLogger::BackendLogger()
+    : commit_latency_histogram(COMMIT_LATENCY_BUCKET_COUNT, 0) {
   logger_type = LOGGER_TYPE_BACKEND;
 }
 
@@ -76,5 +80,16 @@ void BackendLogger::WaitForFlushing(void) {
   }
 }
 
+void BackendLogger::RecordCommitLatency(uint64_t latency_us) {
+  size_t bucket = 0;
+  while (latency_us != 0 && bucket < COMMIT_LATENCY_BUCKET_COUNT - 1) {
+    latency_us >>= 1;
+    bucket++;
+  }
+
+  std::lock_guard<std::mutex> lock(stats_mutex);
+  commit_latency_histogram[bucket]++;
+}
+
 }  // namespace logging
 }
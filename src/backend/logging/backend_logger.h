@@ -40,6 +40,15 @@ class BackendLogger : public Logger {
 
   void WaitForFlushing(void);
 
+  // Record the latency of a commit that waited for its log records
+  void RecordCommitLatency(uint64_t latency_us);
+
+  // Bucket i counts the commits that took less than 2^i us
+  std::vector<size_t> GetCommitLatencyHistogram() {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    return commit_latency_histogram;
+  }
+
   //===--------------------------------------------------------------------===//
   // Virtual Functions
   //===--------------------------------------------------------------------===//
@@ -64,6 +73,11 @@ class BackendLogger : public Logger {
   // Used for notify any waiting thread that backend is flushed
   std::mutex flush_notify_mutex;
   std::condition_variable flush_notify_cv;
+
+  // stats
+  std::mutex stats_mutex;
+
+  std::vector<size_t> commit_latency_histogram;
 };
 
 }  // namespace logging
@@ -237,6 +237,14 @@ cid_t SimpleCheckpoint::DoRecovery() {
     }
   }
 
+  for (auto table : recovered_tables_) {
+    if (table->BuildIndexes() == false) {
+      LOG_ERROR("Failed to build the indexes of table %s",
+                table->GetName().c_str());
+    }
+  }
+  recovered_tables_.clear();
+
   // After finishing recovery, set the next oid with maximum oid
   // observed during the recovery
   auto &manager = catalog::Manager::GetInstance();
@@ -277,7 +285,9 @@ void SimpleCheckpoint::InsertTuple(cid_t commit_id) {
   auto target_location = tuple_record.GetInsertLocation();
   auto tile_group_id = target_location.block;
   RecoverTuple(tuple.get(), table, target_location, commit_id);
-  RecoverIndex(tuple.get(), table, target_location);
+  // the indexes are built once all the tuples are in
+  table->AddBulkLoadedVersion(target_location);
+  recovered_tables_.insert(table);
   if (max_oid_ < target_location.block) {
     max_oid_ = tile_group_id;
   }
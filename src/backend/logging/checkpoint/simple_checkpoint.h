@@ -16,6 +16,7 @@
 #include "backend/logging/log_record.h"
 #include "backend/executor/seq_scan_executor.h"
 
+#include <set>
 #include <thread>
 
 namespace peloton {
@@ -84,6 +85,9 @@ class SimpleCheckpoint : public Checkpoint {
 
   // commit id of current checkpoint
   cid_t start_commit_id = 0;
+
+  // Tables whose indexes are rebuilt at the end of the recovery
+  std::set<storage::DataTable *> recovered_tables_;
 };
 
 }  // namespace logging
@@ -133,6 +133,20 @@ void FrontendLogger::MainLoop(void) {
   log_manager.SetLoggingStatus(LOGGING_STATUS_TYPE_SLEEP);
 }
 
+std::vector<size_t> FrontendLogger::GetCommitLatencyHistogram() const {
+  std::vector<size_t> histogram;
+
+  for (auto backend_logger : backend_loggers) {
+    auto backend_histogram = backend_logger->GetCommitLatencyHistogram();
+    histogram.resize(backend_histogram.size(), 0);
+    for (size_t bucket = 0; bucket < backend_histogram.size(); bucket++) {
+      histogram[bucket] += backend_histogram[bucket];
+    }
+  }
+
+  return histogram;
+}
+
 /**
  * @brief Collect the log records from BackendLoggers
  */
@@ -60,6 +60,9 @@ class FrontendLogger : public Logger {
 
   size_t GetFsyncCount() const { return fsync_count; }
 
+  // Commit latency histogram summed over all backend loggers
+  std::vector<size_t> GetCommitLatencyHistogram() const;
+
   void ReplayLog(const char *, size_t len);
 
  protected:
@@ -11,11 +11,13 @@
 //===----------------------------------------------------------------------===//
 
 #include <cassert>
+#include <chrono>
 #include <condition_variable>
 #include <memory>
 
 #include "backend/logging/log_manager.h"
 #include "backend/logging/records/transaction_record.h"
+#include "backend/logging/records/tuple_record.h"
 #include "backend/common/logger.h"
 #include "backend/executor/executor_context.h"
 #include "backend/catalog/manager.h"
@@ -142,18 +144,38 @@ void LogManager::LogUpdate(concurrency::Transaction* curr_txn, cid_t commit_id,
         manager.GetTableWithOid(new_tuple_tile_group->GetDatabaseId(),
                                 new_tuple_tile_group->GetTableId())->GetSchema();
 
+    // Log only the modified columns if the update touched a strict subset
+    const std::vector<oid_t> *delta_columns =
+        curr_txn->GetUpdatedColumns(new_version);
+    bool is_delta = (delta_columns != nullptr &&
+                     delta_columns->empty() == false &&
+                     delta_columns->size() < schema->GetColumnCount());
+
     std::unique_ptr<storage::Tuple> tuple(new storage::Tuple(schema, true));
-    for (oid_t col = 0; col < schema->GetColumnCount(); col++) {
-      tuple->SetValue(col, new_tuple_tile_group->GetValue(new_version.offset, col),
-                      executor_pool);
+    if (is_delta) {
+      for (auto col : *delta_columns) {
+        tuple->SetValue(col, new_tuple_tile_group->GetValue(new_version.offset, col),
+                        executor_pool);
+      }
+    } else {
+      for (oid_t col = 0; col < schema->GetColumnCount(); col++) {
+        tuple->SetValue(col, new_tuple_tile_group->GetValue(new_version.offset, col),
+                        executor_pool);
+      }
     }
-    auto record = logger->GetTupleRecord(LOGRECORD_TYPE_TUPLE_UPDATE,
+
+    auto record = logger->GetTupleRecord(is_delta ?
+                                         LOGRECORD_TYPE_TUPLE_DELTA_UPDATE :
+                                         LOGRECORD_TYPE_TUPLE_UPDATE,
                                          commit_id,
                                          new_tuple_tile_group->GetTableId(),
                                          new_tuple_tile_group->GetDatabaseId(),
                                          new_version,
                                          old_version,
                                          tuple.get());
+    if (is_delta) {
+      static_cast<TupleRecord *>(record)->SetDeltaColumns(*delta_columns);
+    }
 
     logger->Log(record);
     delete executor_context;
@@ -213,10 +235,16 @@ void LogManager::LogDelete(cid_t commit_id, ItemPointer &delete_location){
 void LogManager::LogCommitTransaction(cid_t commit_id){
   if (this->IsInLoggingMode()) {
     auto logger = this->GetBackendLogger();
+    auto commit_start = std::chrono::steady_clock::now();
+
     auto record = new TransactionRecord(
         LOGRECORD_TYPE_TRANSACTION_COMMIT, commit_id);
     logger->Log(record);
     logger->WaitForFlushing();
+
+    auto commit_latency = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - commit_start);
+    logger->RecordCommitLatency(commit_latency.count());
   }
 }
 
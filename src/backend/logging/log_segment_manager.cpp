@@ -0,0 +1,417 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// log_segment_manager.cpp
+//
+// Identification: src/backend/logging/log_segment_manager.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "backend/common/logger.h"
+#include "backend/logging/log_segment_manager.h"
+
+//===--------------------------------------------------------------------===//
+// GUC Variables
+//===--------------------------------------------------------------------===//
+
+// WAL segment size in MB (0 means growing log files)
+size_t peloton_log_segment_size = 0;
+
+// Open WAL segments with O_DIRECT
+bool peloton_log_direct_io = false;
+
+namespace peloton {
+namespace logging {
+
+#define SPARE_FILE_PREFIX "peloton_spare_"
+#define SPARE_FILE_SUFFIX ".seg"
+
+// size of the staging buffer
+#define SEGMENT_BUFFER_SIZE (256 * LogSegmentManager::block_size)
+
+const size_t LogSegmentManager::block_size;
+
+static inline size_t RoundDown(size_t value, size_t alignment) {
+  return value - (value % alignment);
+}
+
+static inline size_t RoundUp(size_t value, size_t alignment) {
+  return RoundDown(value + alignment - 1, alignment);
+}
+
+/**
+ * @brief pwrite the whole range, retrying on short writes
+ * @return true on success
+ */
+static bool WriteFully(int fd, const char *data, size_t length, size_t offset) {
+  while (length > 0) {
+    ssize_t ret = pwrite(fd, data, length, offset);
+    if (ret < 0) {
+      if (errno == EINTR) continue;
+      LOG_ERROR("Error occured in pwrite : %s", strerror(errno));
+      return false;
+    }
+    data += ret;
+    length -= ret;
+    offset += ret;
+  }
+  return true;
+}
+
+/**
+ * @brief make the directory entries of the log directory durable
+ */
+static void SyncDirectory(const std::string &directory) {
+  int dir_fd = open(directory.c_str(), O_RDONLY);
+  if (dir_fd == -1) {
+    LOG_ERROR("Could not open log directory %s : %s", directory.c_str(),
+              strerror(errno));
+    return;
+  }
+
+  if (fsync(dir_fd) != 0) {
+    LOG_ERROR("Error occured in fsync of log directory : %s", strerror(errno));
+  }
+  close(dir_fd);
+}
+
+LogSegmentManager::LogSegmentManager(const std::string &log_directory,
+                                     size_t segment_size, bool direct_io)
+    : log_directory(log_directory),
+      segment_size(RoundUp(segment_size, block_size)),
+      direct_io(direct_io),
+      buffer_capacity(SEGMENT_BUFFER_SIZE) {
+  assert(segment_size > 0);
+
+  if (posix_memalign((void **)&buffer, block_size, buffer_capacity) != 0) {
+    throw std::bad_alloc();
+  }
+  memset(buffer, 0, buffer_capacity);
+
+  InitSpareSegments();
+}
+
+LogSegmentManager::~LogSegmentManager() {
+  if (IsOpen()) {
+    Sync();
+    close(segment_fd);
+  }
+
+  free(buffer);
+}
+
+/**
+ * @brief pick up the spare segments left behind by an earlier run
+ */
+void LogSegmentManager::InitSpareSegments() {
+  DIR *dirp = opendir(log_directory.c_str());
+  if (dirp == nullptr) {
+    LOG_INFO("Opendir failed: Errno: %d, error: %s", errno, strerror(errno));
+    return;
+  }
+
+  std::string prefix = SPARE_FILE_PREFIX;
+  struct dirent *file;
+  while ((file = readdir(dirp)) != NULL) {
+    if (strncmp(file->d_name, prefix.c_str(), prefix.length()) != 0) {
+      continue;
+    }
+
+    size_t spare_number = atol(file->d_name + prefix.length());
+    if (spare_number >= next_spare_number) {
+      next_spare_number = spare_number + 1;
+    }
+    spare_segments.push_back(log_directory + "/" + file->d_name);
+  }
+  closedir(dirp);
+
+  LOG_INFO("Found %lu spare log segments", spare_segments.size());
+}
+
+std::string LogSegmentManager::GetSpareFileName(size_t spare_number) const {
+  return log_directory + "/" + SPARE_FILE_PREFIX +
+         std::to_string(spare_number) + SPARE_FILE_SUFFIX;
+}
+
+int LogSegmentManager::OpenFile(const std::string &file_name, int flags) {
+  int fd = -1;
+
+  if (direct_io) {
+    fd = open(file_name.c_str(), flags | O_DIRECT, 0600);
+    if (fd == -1 && errno == EINVAL) {
+      // e.g. tmpfs does not support direct IO
+      LOG_WARN("O_DIRECT not supported for %s, using buffered IO",
+               file_name.c_str());
+      direct_io = false;
+    }
+  }
+
+  if (direct_io == false) {
+    fd = open(file_name.c_str(), flags, 0600);
+  }
+
+  if (fd == -1) {
+    LOG_ERROR("Could not open log segment %s : %s", file_name.c_str(),
+              strerror(errno));
+  }
+
+  return fd;
+}
+
+/**
+ * @brief create a new segment with all of its blocks allocated and written
+ */
+int LogSegmentManager::AllocateSegment(const std::string &file_name) {
+  int fd = OpenFile(file_name, O_RDWR | O_CREAT | O_TRUNC);
+  if (fd == -1) {
+    return -1;
+  }
+
+  // Reserve the space up front so that the segment never grows
+  int ret = fallocate(fd, 0, 0, segment_size);
+  if (ret != 0) {
+    LOG_WARN("fallocate failed (%s), segment may be fragmented",
+             strerror(errno));
+  }
+
+  // fallocate leaves unwritten extents behind, and converting them on the
+  // first write is itself a metadata update. Zero-fill the segment once so
+  // that later group commits are pure overwrites. The staging buffer may
+  // still hold the tail of the current segment, so it is not used here.
+  char *zero_buffer = nullptr;
+  if (posix_memalign((void **)&zero_buffer, block_size, buffer_capacity) !=
+      0) {
+    close(fd);
+    return -1;
+  }
+  memset(zero_buffer, 0, buffer_capacity);
+  for (size_t offset = 0; offset < segment_size; offset += buffer_capacity) {
+    size_t length = std::min(buffer_capacity, segment_size - offset);
+    if (WriteFully(fd, zero_buffer, length, offset) == false) {
+      free(zero_buffer);
+      close(fd);
+      return -1;
+    }
+  }
+  free(zero_buffer);
+
+  // The file size changed, so this one needs a full fsync
+  if (fsync(fd) != 0) {
+    LOG_ERROR("Error occured in fsync(%s)", strerror(errno));
+  }
+
+  return fd;
+}
+
+int LogSegmentManager::OpenSegment(const std::string &file_name) {
+  assert(IsOpen() == false);
+
+  int fd = PrepareSegment(file_name);
+  if (fd == -1) {
+    return -1;
+  }
+
+  InstallSegment(fd);
+  return segment_fd;
+}
+
+int LogSegmentManager::SwitchSegment(const std::string &file_name,
+                                     txn_id_t max_commit_id) {
+  int fd = PrepareSegment(file_name);
+  if (fd == -1) {
+    return -1;
+  }
+
+  CloseSegment(max_commit_id);
+  InstallSegment(fd);
+  return segment_fd;
+}
+
+int LogSegmentManager::PrepareSegment(const std::string &file_name) {
+  int fd = -1;
+
+  // Reuse a spare segment if we have one
+  while (fd == -1 && spare_segments.empty() == false) {
+    std::string spare_file_name = spare_segments.back();
+    spare_segments.pop_back();
+
+    if (rename(spare_file_name.c_str(), file_name.c_str()) != 0) {
+      LOG_ERROR("Couldn't recycle log segment %s : %s",
+                spare_file_name.c_str(), strerror(errno));
+      continue;
+    }
+
+    fd = OpenFile(file_name, O_RDWR);
+    LOG_INFO("Recycled log segment %s as %s", spare_file_name.c_str(),
+             file_name.c_str());
+  }
+
+  if (fd == -1) {
+    fd = AllocateSegment(file_name);
+    if (fd == -1) {
+      return -1;
+    }
+    LOG_INFO("Allocated log segment %s", file_name.c_str());
+  }
+
+  SyncDirectory(log_directory);
+
+  return fd;
+}
+
+void LogSegmentManager::InstallSegment(int fd) {
+  assert(IsOpen() == false);
+  segment_fd = fd;
+
+  // The first block holds the (empty) max commit id header. Writing it out
+  // right away invalidates any records left over in a recycled segment.
+  memset(buffer, 0, buffer_capacity);
+  buffer_offset = 0;
+  write_offset = sizeof(txn_id_t);
+  Sync();
+}
+
+size_t LogSegmentManager::GetFileSize() const {
+  return std::max(segment_size, RoundUp(write_offset + 1, block_size));
+}
+
+bool LogSegmentManager::HasSpaceFor(size_t length) const {
+  // Leave room for the zero byte that terminates the segment
+  return write_offset + length + 1 <= segment_size;
+}
+
+void LogSegmentManager::Write(const char *data, size_t length) {
+  assert(IsOpen());
+
+  while (length > 0) {
+    // Always keep one block of headroom for padding the tail
+    size_t staged = write_offset - buffer_offset;
+    size_t available = buffer_capacity - block_size - staged;
+    if (available == 0) {
+      WriteBlocks(false);
+      continue;
+    }
+
+    size_t copy_length = std::min(length, available);
+    memcpy(buffer + staged, data, copy_length);
+    write_offset += copy_length;
+    data += copy_length;
+    length -= copy_length;
+  }
+}
+
+void LogSegmentManager::WriteBlocks(bool pad_tail) {
+  size_t staged = write_offset - buffer_offset;
+  size_t length;
+
+  if (pad_tail) {
+    // Pad with at least one zero byte to mark the end of the data
+    length = RoundUp(staged + 1, block_size);
+    memset(buffer + staged, 0, length - staged);
+  } else {
+    length = RoundDown(staged, block_size);
+  }
+
+  if (length == 0) {
+    return;
+  }
+
+  WriteFully(segment_fd, buffer, length, buffer_offset);
+
+  // Keep the partial tail block staged, it is rewritten by the next write
+  size_t tail_start = RoundDown(staged, block_size);
+  memmove(buffer, buffer + tail_start, staged - tail_start);
+  buffer_offset += tail_start;
+}
+
+void LogSegmentManager::Sync() {
+  // Nothing to do if no data was staged since the last sync
+  if (IsOpen() == false || write_offset == synced_offset) {
+    return;
+  }
+
+  WriteBlocks(true);
+
+  // The segment only grows with an oversized record, otherwise there is no
+  // metadata to flush
+  if (GetFileSize() > segment_size) {
+    if (fsync(segment_fd) != 0) {
+      LOG_ERROR("Error occured in fsync(%s)", strerror(errno));
+    }
+  } else {
+    if (fdatasync(segment_fd) != 0) {
+      LOG_ERROR("Error occured in fdatasync(%s)", strerror(errno));
+    }
+    fdatasync_count++;
+  }
+  synced_offset = write_offset;
+}
+
+void LogSegmentManager::CloseSegment(txn_id_t max_commit_id) {
+  if (IsOpen() == false) {
+    return;
+  }
+
+  Sync();
+
+  // Patch the max commit id into the header block
+  ssize_t ret = pread(segment_fd, buffer, block_size, 0);
+  if (ret != (ssize_t)block_size) {
+    LOG_ERROR("Could not read log segment header : %s", strerror(errno));
+  } else {
+    memcpy(buffer, &max_commit_id, sizeof(max_commit_id));
+    WriteFully(segment_fd, buffer, block_size, 0);
+    if (fdatasync(segment_fd) != 0) {
+      LOG_ERROR("Error occured in fdatasync(%s)", strerror(errno));
+    }
+    fdatasync_count++;
+  }
+
+  close(segment_fd);
+  segment_fd = -1;
+  buffer_offset = 0;
+  write_offset = 0;
+  synced_offset = 0;
+}
+
+void LogSegmentManager::RecycleSegment(const std::string &file_name) {
+  struct stat segment_stat;
+  bool recyclable = (spare_segments.size() < max_spare_segments &&
+                     stat(file_name.c_str(), &segment_stat) == 0 &&
+                     (size_t)segment_stat.st_size == segment_size);
+
+  if (recyclable) {
+    std::string spare_file_name = GetSpareFileName(next_spare_number++);
+    if (rename(file_name.c_str(), spare_file_name.c_str()) == 0) {
+      spare_segments.push_back(spare_file_name);
+      return;
+    }
+    LOG_ERROR("Couldn't recycle log segment %s : %s", file_name.c_str(),
+              strerror(errno));
+  }
+
+  if (remove(file_name.c_str()) != 0) {
+    LOG_ERROR("Couldn't delete log file: %s error: %s", file_name.c_str(),
+              strerror(errno));
+  }
+}
+
+}  // namespace logging
+}  // namespace peloton
@@ -0,0 +1,165 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// log_segment_manager.h
+//
+// Identification: src/backend/logging/log_segment_manager.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "backend/common/types.h"
+
+//===--------------------------------------------------------------------===//
+// GUC Variables
+//===--------------------------------------------------------------------===//
+
+// WAL segment size in MB (0 means growing log files)
+extern size_t peloton_log_segment_size;
+
+// Open WAL segments with O_DIRECT
+extern bool peloton_log_direct_io;
+
+namespace peloton {
+namespace logging {
+
+//===--------------------------------------------------------------------===//
+// Log Segment Manager
+//===--------------------------------------------------------------------===//
+
+/**
+ * Manages fixed-size, preallocated WAL segments.
+ *
+ * Each segment is allocated and zero-filled once, so that group commits only
+ * overwrite already allocated blocks and can be made durable with fdatasync
+ * instead of fsync. Writes are staged in an aligned buffer and issued as whole
+ * blocks, which also allows opening the segment with O_DIRECT. The byte after
+ * the last record in a segment is always zero, which recovery reads as the end
+ * of the segment. Truncated segments are renamed into a spare pool and reused
+ * for the next segment instead of being deleted.
+ *
+ * A segment has the same layout as a regular log file: an 8 byte max commit
+ * id header followed by the log records.
+ *
+ * Records are never split across segments. A record that does not even fit
+ * into an empty segment is written anyway, and that segment grows past the
+ * segment size. It is then synced with fsync, and deleted instead of being
+ * recycled.
+ */
+class LogSegmentManager {
+ public:
+  LogSegmentManager(const LogSegmentManager &) = delete;
+  LogSegmentManager &operator=(const LogSegmentManager &) = delete;
+
+  LogSegmentManager(const std::string &log_directory, size_t segment_size,
+                    bool direct_io);
+
+  ~LogSegmentManager();
+
+  // Open a segment under the given name, recycling a spare one if possible.
+  // Returns the file descriptor or -1.
+  int OpenSegment(const std::string &file_name);
+
+  // Stage data at the end of the current segment
+  void Write(const char *data, size_t length);
+
+  // Write out all staged data and make it durable
+  void Sync();
+
+  // Sync, store the max commit id in the header and close the segment
+  void CloseSegment(txn_id_t max_commit_id);
+
+  // Open the next segment, and only then close the current one with the
+  // given max commit id. If the next segment cannot be opened, the current
+  // one stays open. Returns the file descriptor or -1.
+  int SwitchSegment(const std::string &file_name, txn_id_t max_commit_id);
+
+  // Move a segment that is no longer needed into the spare pool
+  void RecycleSegment(const std::string &file_name);
+
+  // Whether a record of the given length still fits in the current segment
+  bool HasSpaceFor(size_t length) const;
+
+  bool IsOpen() const { return segment_fd != -1; }
+
+  // Logical end of the data in the current segment
+  size_t GetWriteOffset() const { return write_offset; }
+
+  size_t GetSegmentSize() const { return segment_size; }
+
+  // Size of the current segment file, past the segment size only if it holds
+  // an oversized record
+  size_t GetFileSize() const;
+
+  size_t GetSpareSegmentCount() const { return spare_segments.size(); }
+
+  size_t GetFdatasyncCount() const { return fdatasync_count; }
+
+  static const size_t block_size = 4096;
+
+ private:
+  int AllocateSegment(const std::string &file_name);
+
+  // Recycle or allocate the file of a segment, without touching the current
+  // one. Returns the file descriptor or -1.
+  int PrepareSegment(const std::string &file_name);
+
+  // Make the prepared segment the current one
+  void InstallSegment(int fd);
+
+  int OpenFile(const std::string &file_name, int flags);
+
+  // Issue the staged blocks, keeping the trailing partial block staged
+  void WriteBlocks(bool pad_tail);
+
+  void InitSpareSegments();
+
+  std::string GetSpareFileName(size_t spare_number) const;
+
+  //===--------------------------------------------------------------------===//
+  // Member Variables
+  //===--------------------------------------------------------------------===//
+
+  std::string log_directory;
+
+  size_t segment_size;
+
+  bool direct_io;
+
+  int segment_fd = -1;
+
+  // block aligned staging buffer
+  char *buffer = nullptr;
+
+  size_t buffer_capacity;
+
+  // file offset of the first byte in the buffer (block aligned)
+  size_t buffer_offset = 0;
+
+  // file offset of the end of the staged data
+  size_t write_offset = 0;
+
+  // file offset up to which the data is durable
+  size_t synced_offset = 0;
+
+  // spare segments that can be reused
+  std::vector<std::string> spare_segments;
+
+  size_t next_spare_number = 0;
+
+  // upper bound on the number of spare segments we keep around
+  size_t max_spare_segments = 4;
+
+  // stats
+  size_t fdatasync_count = 0;
+};
+
+}  // namespace logging
+}  // namespace peloton
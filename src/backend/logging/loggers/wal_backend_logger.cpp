@@ -57,6 +57,11 @@ LogRecord *WriteAheadBackendLogger::GetTupleRecord(LogRecordType log_record_type
       break;
     }
 
+    case LOGRECORD_TYPE_TUPLE_DELTA_UPDATE: {
+      log_record_type = LOGRECORD_TYPE_WAL_TUPLE_DELTA_UPDATE;
+      break;
+    }
+
     default: {
       assert(false);
       break;
@@ -19,6 +19,7 @@
 
 #include "backend/catalog/manager.h"
 #include "backend/catalog/schema.h"
+#include "backend/common/exception.h"
 #include "backend/common/pool.h"
 #include "backend/concurrency/transaction.h"
 #include "backend/concurrency/transaction_manager_factory.h"
@@ -59,6 +60,11 @@ bool ReadTupleRecordHeader(TupleRecord &tuple_record, FILE *log_file,
 storage::Tuple *ReadTupleRecordBody(catalog::Schema *schema, VarlenPool *pool,
                                     FILE *log_file, size_t log_file_size);
 
+storage::Tuple *ReadDeltaTupleRecordBody(catalog::Schema *schema,
+                                         VarlenPool *pool, FILE *log_file,
+                                         size_t log_file_size,
+                                         std::vector<oid_t> &delta_columns);
+
 void SkipTupleRecordBody(FILE *log_file, size_t log_file_size);
 
 LogRecordType GetNextLogRecordType(FILE *log_file, size_t log_file_size);
@@ -110,8 +116,15 @@ WriteAheadFrontendLogger::WriteAheadFrontendLogger(bool for_testing) {
     LOG_INFO("Log dir is %s", this->peloton_log_directory.c_str());
     this->InitLogDirectory();
     this->InitLogFilesList();
+    this->log_file = nullptr;
     this->log_file_fd = -1;   // this is a restart or a new start
     this->max_commit_id = 0;  // 0 is unused
+
+    if (peloton_log_segment_size != 0) {
+      segment_manager.reset(new LogSegmentManager(
+          this->peloton_log_directory, peloton_log_segment_size * 1024 * 1024,
+          peloton_log_direct_io));
+    }
   }
 }
 
@@ -150,6 +163,11 @@ void fflush_and_sync(FILE *log_file, int log_file_fd, size_t &fsync_count) {
  * @brief flush all the log records to the file
  */
 void WriteAheadFrontendLogger::FlushLogRecords(void) {
+  if (segment_manager != nullptr) {
+    FlushLogRecordsToSegments();
+    return;
+  }
+
   // First, write all the record in the queue
   if (global_queue.size() != 0 && this->log_file_fd == -1) {
     this->CreateNewLogFile(false);
@@ -187,6 +205,50 @@ void WriteAheadFrontendLogger::FlushLogRecords(void) {
   }
 }
 
+/**
+ * @brief flush all the log records to the current log segment
+ */
+void WriteAheadFrontendLogger::FlushLogRecordsToSegments(void) {
+  // First, write all the record in the queue
+  if (global_queue.size() != 0 && this->log_file_fd == -1) {
+    this->CreateNewLogFile(false);
+  }
+
+  for (auto &record : global_queue) {
+    // Switch to the next segment once the current one is full. A record that
+    // does not fit into an empty segment grows the segment it is written to.
+    auto record_length = record->GetMessageLength();
+    if (segment_manager->HasSpaceFor(record_length) == false &&
+        segment_manager->GetWriteOffset() > sizeof(txn_id_t)) {
+      this->CreateNewLogFile(true);
+    }
+    if (segment_manager->HasSpaceFor(record_length) == false) {
+      LOG_WARN("Log record of %lu bytes grows log segment %d", record_length,
+               log_file_counter_ - 1);
+    }
+
+    segment_manager->Write(record->GetMessage(), record->GetMessageLength());
+    if (record->GetTransactionId() > this->max_commit_id) {
+      this->max_commit_id = record->GetTransactionId();
+    }
+  }
+
+  if (global_queue.size() != 0) {
+    segment_manager->Sync();
+    fsync_count++;
+  }
+
+  // Clean up the frontend logger's queue
+  global_queue.clear();
+
+  // Commit each backend logger
+  {
+    for (auto backend_logger : backend_loggers) {
+      backend_logger->FinishedFlushing();
+    }
+  }
+}
+
 //===--------------------------------------------------------------------===//
 // Recovery
 //===--------------------------------------------------------------------===//
@@ -236,7 +298,8 @@ void WriteAheadFrontendLogger::DoRecovery() {
           break;
         }
         case LOGRECORD_TYPE_WAL_TUPLE_INSERT:
-        case LOGRECORD_TYPE_WAL_TUPLE_UPDATE: {
+        case LOGRECORD_TYPE_WAL_TUPLE_UPDATE:
+        case LOGRECORD_TYPE_WAL_TUPLE_DELTA_UPDATE: {
           tuple_record = new TupleRecord(record_type);
           // Check for torn log write
           if (ReadTupleRecordHeader(*tuple_record, log_file, log_file_size) ==
@@ -263,8 +326,16 @@ void WriteAheadFrontendLogger::DoRecovery() {
           }
 
           // Read off the tuple record body from the log
-          tuple_record->SetTuple(ReadTupleRecordBody(
-              table->GetSchema(), recovery_pool, log_file, log_file_size));
+          if (record_type == LOGRECORD_TYPE_WAL_TUPLE_DELTA_UPDATE) {
+            std::vector<oid_t> delta_columns;
+            tuple_record->SetTuple(ReadDeltaTupleRecordBody(
+                table->GetSchema(), recovery_pool, log_file, log_file_size,
+                delta_columns));
+            tuple_record->SetDeltaColumns(delta_columns);
+          } else {
+            tuple_record->SetTuple(ReadTupleRecordBody(
+                table->GetSchema(), recovery_pool, log_file, log_file_size));
+          }
           break;
         }
         case LOGRECORD_TYPE_WAL_TUPLE_DELETE: {
@@ -308,6 +379,7 @@ void WriteAheadFrontendLogger::DoRecovery() {
           case LOGRECORD_TYPE_WAL_TUPLE_INSERT:
           case LOGRECORD_TYPE_WAL_TUPLE_DELETE:
           case LOGRECORD_TYPE_WAL_TUPLE_UPDATE:
+          case LOGRECORD_TYPE_WAL_TUPLE_DELTA_UPDATE:
             recovery_txn_table[tuple_record->GetTransactionId()].push_back(
                 tuple_record);
             break;
@@ -370,6 +442,7 @@ void WriteAheadFrontendLogger::CommitTransactionRecovery(cid_t commit_id) {
         InsertTuple(curr);
         break;
       case LOGRECORD_TYPE_WAL_TUPLE_UPDATE:
+      case LOGRECORD_TYPE_WAL_TUPLE_DELTA_UPDATE:
         UpdateTuple(curr);
         break;
       case LOGRECORD_TYPE_WAL_TUPLE_DELETE:
@@ -464,6 +537,35 @@ void UpdateTupleHelper(oid_t &max_tg, cid_t commit_id, oid_t db_id,
   tile_group->UpdateTupleFromRecovery(commit_id, remove_loc.offset, insert_loc);
 }
 
+/**
+ * @brief complete a delta tuple with the unmodified columns of the prior
+ * version, which must already be recovered at prior_loc
+ * @return false if the prior version could not be found
+ */
+bool FillDeltaTupleHelper(const ItemPointer &prior_loc, storage::Tuple *tuple,
+                          const std::vector<oid_t> &delta_columns,
+                          VarlenPool *pool) {
+  auto &manager = catalog::Manager::GetInstance();
+  auto tile_group = manager.GetTileGroup(prior_loc.block);
+  if (tile_group == nullptr) {
+    return false;
+  }
+
+  auto schema = tuple->GetSchema();
+  std::vector<bool> is_delta_column(schema->GetColumnCount(), false);
+  for (auto column_id : delta_columns) {
+    is_delta_column[column_id] = true;
+  }
+
+  for (oid_t col = 0; col < schema->GetColumnCount(); col++) {
+    if (is_delta_column[col] == false) {
+      tuple->SetValue(col, tile_group->GetValue(prior_loc.offset, col), pool);
+    }
+  }
+
+  return true;
+}
+
 /**
  * @brief read tuple record from log file and add them tuples to recovery txn
  * @param recovery txn
@@ -490,6 +592,18 @@ void WriteAheadFrontendLogger::DeleteTuple(TupleRecord *record) {
  */
 
 void WriteAheadFrontendLogger::UpdateTuple(TupleRecord *record) {
+  // A delta record is applied against the prior version
+  if (record->IsDeltaRecord() &&
+      FillDeltaTupleHelper(record->GetDeleteLocation(), record->GetTuple(),
+                           record->GetDeltaColumns(),
+                           recovery_pool) == false) {
+    LOG_ERROR("Prior version of delta update (%u, %u) not found",
+              record->GetDeleteLocation().block,
+              record->GetDeleteLocation().offset);
+    delete record->GetTuple();
+    return;
+  }
+
   UpdateTupleHelper(max_oid, record->GetTransactionId(),
                     record->GetDatabaseOid(), record->GetTableId(),
                     record->GetDeleteLocation(), record->GetInsertLocation(),
@@ -615,7 +729,8 @@ LogRecordType WriteAheadFrontendLogger::GetNextLogRecordTypeForRecovery(
     ret = fread((void *)&buffer, 1, sizeof(char), log_file);
     if (ret <= 0) LOG_INFO("Failed an fread");
   }
-  if (is_truncated || ret <= 0) {
+  // A zero record type is the padding at the end of a preallocated segment
+  if (is_truncated || ret <= 0 || buffer == LOGRECORD_TYPE_INVALID) {
     LOG_INFO("Call OpenNextLogFile");
     this->OpenNextLogFile();
     if (this->log_file_fd == -1) return LOGRECORD_TYPE_INVALID;
@@ -725,6 +840,40 @@ storage::Tuple *ReadTupleRecordBody(catalog::Schema *schema, VarlenPool *pool,
   return tuple;
 }
 
+/**
+ * @brief Read the body of a delta update record. Only the columns returned
+ * in delta_columns are set in the tuple.
+ * @param schema
+ * @param pool
+ * @return tuple
+ */
+storage::Tuple *ReadDeltaTupleRecordBody(catalog::Schema *schema,
+                                         VarlenPool *pool, FILE *log_file,
+                                         size_t log_file_size,
+                                         std::vector<oid_t> &delta_columns) {
+  // Check if the frame is broken
+  size_t body_size = GetNextFrameSize(log_file, log_file_size);
+  if (body_size == 0) {
+    LOG_ERROR("Body size is zero ");
+    return nullptr;
+  }
+
+  // Read Body
+  char body[body_size];
+  int ret = fread(body, 1, sizeof(body), log_file);
+  if (ret <= 0) {
+    LOG_ERROR("Error occured in fread ");
+  }
+
+  CopySerializeInputBE tuple_body(body, body_size);
+
+  // We create a tuple based on the message
+  storage::Tuple *tuple = new storage::Tuple(schema, true);
+  tuple->DeserializeColumnsFrom(tuple_body, pool, delta_columns);
+
+  return tuple;
+}
+
 /**
  * @brief Read TupleRecordBody
  * @param schema
@@ -868,6 +1017,11 @@ void WriteAheadFrontendLogger::InitLogFilesList() {
 }
 
 void WriteAheadFrontendLogger::CreateNewLogFile(bool close_old_file) {
+  if (segment_manager != nullptr) {
+    CreateNewLogSegment(close_old_file);
+    return;
+  }
+
   int new_file_num;
   std::string new_file_name;
   txn_id_t default_commit_id = 0;
@@ -945,6 +1099,56 @@ void WriteAheadFrontendLogger::CreateNewLogFile(bool close_old_file) {
   LOG_INFO("log_file_counter is %d", log_file_counter_);
 }
 
+void WriteAheadFrontendLogger::CreateNewLogSegment(bool close_old_file) {
+  int new_file_num = log_file_counter_;
+  std::string new_file_name = this->GetFileNameFromVersion(new_file_num);
+
+  bool close_last_file = (close_old_file && this->log_files_.size() != 0 &&
+                          segment_manager->IsOpen());
+  size_t last_file_size = segment_manager->GetFileSize();
+
+  // The next segment is opened before the last one is closed, so that the
+  // logger never ends up without a segment to write to
+  int log_file_fd = -1;
+  if (close_last_file) {
+    // The segment manager writes the max commit id into the header
+    log_file_fd =
+        segment_manager->SwitchSegment(new_file_name, this->max_commit_id);
+  } else {
+    log_file_fd = segment_manager->OpenSegment(new_file_name);
+  }
+
+  // The records that are queued cannot be made durable anywhere else
+  if (log_file_fd == -1) {
+    LOG_ERROR("Could not open log segment %s", new_file_name.c_str());
+    throw Exception("Could not open log segment " + new_file_name);
+  }
+
+  if (close_last_file) {
+    auto last_log_file = this->log_files_.back();
+    last_log_file->SetMaxCommitId(this->max_commit_id);
+    LOG_INFO("MaxCommitID of the last closed segment is %d",
+             (int)this->max_commit_id);
+    this->max_commit_id = 0;  // reset
+
+    last_log_file->SetLogFileSize(last_file_size);
+    last_log_file->SetLogFileFD(-1);  // invalidate
+  }
+
+  this->log_file = nullptr;
+  this->log_file_fd = log_file_fd;
+  LOG_INFO("log_file_fd of newly opened segment is %d", this->log_file_fd);
+
+  LogFile *new_log_file_object =
+      new LogFile(nullptr, new_file_name, log_file_fd, new_file_num, 0);
+
+  this->log_files_.push_back(new_log_file_object);
+
+  this->log_file_size = 0;
+
+  log_file_counter_++;  // finally, increment log_file_counter_
+}
+
 bool WriteAheadFrontendLogger::FileSwitchCondIsTrue() {
   struct stat stat_buf;
   if (this->log_file_fd == -1) return false;
@@ -1027,6 +1231,16 @@ void WriteAheadFrontendLogger::TruncateLog(txn_id_t max_commit_id) {
   // delete stale log files except the one currently being used
   for (int i = 0; i < (int)this->log_files_.size() - 1; i++) {
     if (max_commit_id >= this->log_files_[i]->GetMaxCommitId()) {
+      if (segment_manager != nullptr) {
+        // Keep the segment around for reuse instead of deleting it
+        segment_manager->RecycleSegment(this->GetFileNameFromVersion(
+            this->log_files_[i]->GetLogNumber()));
+        delete this->log_files_[i];
+        this->log_files_.erase(this->log_files_.begin() + i);
+        i--;  // update cursor
+        continue;
+      }
+
       return_val = remove(this->log_files_[i]->GetLogFileName().c_str());
       if (return_val != 0) {
         LOG_ERROR("Couldn't delete log file: %s error: %s",
@@ -1139,6 +1353,24 @@ txn_id_t WriteAheadFrontendLogger::ExtractMaxCommitIdFromLogFileRecords(
 
         break;
       }
+      case LOGRECORD_TYPE_WAL_TUPLE_DELTA_UPDATE: {
+        tuple_record = new TupleRecord(record_type);
+        // Check for torn log write
+        if (ReadTupleRecordHeader(*tuple_record, log_file, log_file_size) ==
+            false) {
+          LOG_ERROR("Could not read tuple record header.");
+          delete tuple_record;
+          return UINT64_MAX;
+        }
+
+        auto cid = tuple_record->GetTransactionId();
+        if (cid > max_commit_id) max_commit_id = cid;
+
+        // Only the commit id is needed here
+        SkipTupleRecordBody(log_file, log_file_size);
+        delete tuple_record;
+        break;
+      }
       case LOGRECORD_TYPE_WAL_TUPLE_DELETE: {
         tuple_record = new TupleRecord(record_type);
         // Check for torn log write
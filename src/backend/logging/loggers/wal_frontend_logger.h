@@ -15,7 +15,9 @@
 #include "backend/logging/frontend_logger.h"
 #include "backend/logging/records/tuple_record.h"
 #include "backend/logging/log_file.h"
+#include "backend/logging/log_segment_manager.h"
 #include <dirent.h>
+#include <memory>
 #include <vector>
 
 namespace peloton {
@@ -83,6 +85,10 @@ class WriteAheadFrontendLogger : public FrontendLogger {
  private:
   std::string GetLogFileName(void);
 
+  void FlushLogRecordsToSegments(void);
+
+  void CreateNewLogSegment(bool);
+
   //===--------------------------------------------------------------------===//
   // Member Variables
   //===--------------------------------------------------------------------===//
@@ -123,6 +129,9 @@ class WriteAheadFrontendLogger : public FrontendLogger {
   std::string LOG_FILE_SUFFIX = ".log";
 
   txn_id_t max_commit_id;
+
+  // preallocated log segments (only if peloton_log_segment_size is set)
+  std::unique_ptr<LogSegmentManager> segment_manager;
 };
 
 }  // namespace logging
@@ -53,7 +53,9 @@ LogRecord *WriteBehindBackendLogger::GetTupleRecord(LogRecordType log_record_typ
       break;
     }
 
-    case LOGRECORD_TYPE_TUPLE_UPDATE: {
+    // WBL records carry no tuple image, so a delta is a plain update
+    case LOGRECORD_TYPE_TUPLE_UPDATE:
+    case LOGRECORD_TYPE_TUPLE_DELTA_UPDATE: {
       log_record_type = LOGRECORD_TYPE_WBL_TUPLE_UPDATE;
       break;
     }
@@ -37,6 +37,13 @@ bool TupleRecord::Serialize(CopySerializeOutput &output) {
       break;
     }
 
+    case LOGRECORD_TYPE_WAL_TUPLE_DELTA_UPDATE: {
+      // Only the modified columns go into the body
+      storage::Tuple *tuple = (storage::Tuple *)data;
+      tuple->SerializeColumnsTo(output, delta_columns);
+      break;
+    }
+
     case LOGRECORD_TYPE_WAL_TUPLE_DELETE:
       // Nothing to do here !
       break;
@@ -119,6 +126,10 @@ storage::Tuple *TupleRecord::GetTuple(){
   return tuple;
 }
 
+void TupleRecord::SetDeltaColumns(const std::vector<oid_t> &columns) {
+  delta_columns = columns;
+}
+
 const std::string TupleRecord::GetInfo() const {
   std::ostringstream os;
 
@@ -130,6 +141,13 @@ const std::string TupleRecord::GetInfo() const {
   os << " " << GetInsertLocation().offset << "\n";
   os << " #Delete Location :" << GetDeleteLocation().block;
   os << " " << GetDeleteLocation().offset << "\n";
+  if (IsDeltaRecord()) {
+    os << " #Delta Columns :";
+    for (auto column_id : delta_columns) {
+      os << " " << column_id;
+    }
+    os << "\n";
+  }
   os << "\n";
 
   return os.str();
@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "backend/logging/log_record.h"
 #include "backend/storage/tuple.h"
 #include "backend/common/serializer.h"
@@ -84,6 +86,13 @@ class TupleRecord : public LogRecord, Printable {
 
   storage::Tuple *GetTuple();
 
+  // Columns carried by a delta update record
+  void SetDeltaColumns(const std::vector<oid_t> &columns);
+
+  const std::vector<oid_t> &GetDeltaColumns() const { return delta_columns; }
+
+  bool IsDeltaRecord() const { return delta_columns.empty() == false; }
+
   static size_t GetTupleRecordSize(void);
 
   // Get a string representation for debugging
@@ -109,6 +118,9 @@ class TupleRecord : public LogRecord, Printable {
   // tuple (for deserialize
   storage::Tuple *tuple = nullptr;
 
+  // modified columns of a delta update, only these are set in the tuple
+  std::vector<oid_t> delta_columns;
+
   // database id
   oid_t db_oid;
 };
@@ -0,0 +1,415 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// compressed_column.cpp
+//
+// Identification: src/backend/storage/compressed_column.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <map>
+#include <memory>
+
+#include "backend/common/pool.h"
+#include "backend/common/value_peeker.h"
+#include "backend/storage/compressed_column.h"
+#include "backend/storage/tile.h"
+
+namespace peloton {
+namespace storage {
+
+// Bits needed to tell apart the numbers from 0 to max_value
+static size_t GetBitWidth(uint64_t max_value) {
+  size_t bit_width = 0;
+  while (max_value != 0) {
+    bit_width++;
+    max_value >>= 1;
+  }
+  return bit_width;
+}
+
+static size_t GetPackedSize(oid_t tuple_count, size_t bit_width) {
+  return (tuple_count * bit_width + 63) / 64 * sizeof(uint64_t);
+}
+
+// Integers are kept in the tuple storage with the width of their type
+static bool IsFrameOfReferenceType(ValueType value_type, size_t entry_length) {
+  switch (value_type) {
+    case VALUE_TYPE_TINYINT:
+    case VALUE_TYPE_SMALLINT:
+    case VALUE_TYPE_INTEGER:
+    case VALUE_TYPE_BIGINT:
+    case VALUE_TYPE_DATE:
+    case VALUE_TYPE_TIMESTAMP:
+      break;
+    default:
+      return false;
+  }
+  return (entry_length == 1 || entry_length == 2 || entry_length == 4 ||
+          entry_length == 8);
+}
+
+static int64_t ReadInteger(const char *location, size_t length) {
+  switch (length) {
+    case 1:
+      return *reinterpret_cast<const int8_t *>(location);
+    case 2:
+      return *reinterpret_cast<const int16_t *>(location);
+    case 4:
+      return *reinterpret_cast<const int32_t *>(location);
+    default:
+      return *reinterpret_cast<const int64_t *>(location);
+  }
+}
+
+static void WriteInteger(char *location, size_t length, int64_t value) {
+  switch (length) {
+    case 1:
+      *reinterpret_cast<int8_t *>(location) = static_cast<int8_t>(value);
+      break;
+    case 2:
+      *reinterpret_cast<int16_t *>(location) = static_cast<int16_t>(value);
+      break;
+    case 4:
+      *reinterpret_cast<int32_t *>(location) = static_cast<int32_t>(value);
+      break;
+    default:
+      *reinterpret_cast<int64_t *>(location) = value;
+      break;
+  }
+}
+
+// Whether "compare_result <comparison> 0" holds
+static bool IsMatch(ExpressionType comparison, int compare_result) {
+  switch (comparison) {
+    case EXPRESSION_TYPE_COMPARE_EQUAL:
+      return compare_result == 0;
+    case EXPRESSION_TYPE_COMPARE_NOTEQUAL:
+      return compare_result != 0;
+    case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+      return compare_result < 0;
+    case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+      return compare_result > 0;
+    case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+      return compare_result <= 0;
+    case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+      return compare_result >= 0;
+    default:
+      return false;
+  }
+}
+
+CompressedColumn::CompressedColumn(ValueType value_type, bool is_inlined,
+                                   size_t entry_length, size_t column_length,
+                                   oid_t tuple_count, VarlenPool *pool)
+    : encoding_type(ENCODING_TYPE_PLAIN),
+      value_type(value_type),
+      is_inlined(is_inlined),
+      entry_length(entry_length),
+      column_length(column_length),
+      tuple_count(tuple_count),
+      pool(pool) {}
+
+CompressedColumn *CompressedColumn::Compress(Tile *tile, const oid_t column_id,
+                                             const oid_t tuple_count) {
+  auto schema = tile->GetSchema();
+  std::unique_ptr<CompressedColumn> column(new CompressedColumn(
+      schema->GetType(column_id), schema->IsInlined(column_id),
+      schema->GetLength(column_id), schema->GetAppropriateLength(column_id),
+      tuple_count, tile->GetPool()));
+
+  std::vector<Value> values;
+  values.reserve(tuple_count);
+  for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+    values.push_back(tile->GetValue(tuple_itr, column_id));
+  }
+
+  // Bytes taken by a value, uninlined data included
+  auto get_value_size = [&column](const Value &value) {
+    size_t size = column->entry_length;
+    if (column->is_inlined == false && value.IsNull() == false) {
+      size += ValuePeeker::PeekObjectLengthWithoutNull(value);
+    }
+    return size;
+  };
+
+  // Find the distinct values and the runs
+  std::map<Value, oid_t, Value::ltValue> dictionary;
+  std::vector<Value> run_values;
+  std::vector<oid_t> run_ends;
+  size_t plain_size = 0, dictionary_size = 0, run_length_size = 0;
+
+  for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+    auto &value = values[tuple_itr];
+    auto value_size = get_value_size(value);
+    plain_size += value_size;
+
+    if (dictionary.count(value) == 0) {
+      dictionary.emplace(value, 0);
+      dictionary_size += value_size;
+    }
+
+    if (run_values.empty() == true || run_values.back().Compare(value) != 0) {
+      if (run_values.empty() == false) {
+        run_ends.push_back(tuple_itr);
+      }
+      run_values.push_back(value);
+      run_length_size += value_size + sizeof(oid_t);
+    }
+  }
+  run_ends.push_back(tuple_count);
+
+  size_t code_bit_width = GetBitWidth(dictionary.size() - 1);
+  dictionary_size += GetPackedSize(tuple_count, code_bit_width);
+
+  // Integers can go without any entries
+  size_t frame_size = plain_size + 1;
+  int64_t frame_min = 0, frame_max = 0;
+  if (IsFrameOfReferenceType(column->value_type, column->entry_length)) {
+    for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+      auto raw_value = ReadInteger(
+          tile->GetTupleLocation(tuple_itr) + schema->GetOffset(column_id),
+          column->entry_length);
+      if (tuple_itr == 0 || raw_value < frame_min) frame_min = raw_value;
+      if (tuple_itr == 0 || raw_value > frame_max) frame_max = raw_value;
+    }
+    auto frame_bit_width = GetBitWidth(static_cast<uint64_t>(frame_max) -
+                                       static_cast<uint64_t>(frame_min));
+    frame_size = GetPackedSize(tuple_count, frame_bit_width);
+  }
+
+  size_t smallest_size = std::min(
+      {plain_size, dictionary_size, run_length_size, frame_size});
+
+  if (frame_size == smallest_size) {
+    column->encoding_type = ENCODING_TYPE_FRAME_OF_REFERENCE;
+    column->frame_base = frame_min;
+    column->frame_max_offset =
+        static_cast<uint64_t>(frame_max) - static_cast<uint64_t>(frame_min);
+
+    std::vector<uint64_t> offsets;
+    offsets.reserve(tuple_count);
+    for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+      auto raw_value = ReadInteger(
+          tile->GetTupleLocation(tuple_itr) + schema->GetOffset(column_id),
+          column->entry_length);
+      auto offset = static_cast<uint64_t>(raw_value) -
+                    static_cast<uint64_t>(frame_min);
+      offsets.push_back(offset);
+      if (values[tuple_itr].IsNull() == true) {
+        column->frame_has_null = true;
+        column->frame_null_offset = offset;
+      }
+    }
+    column->Pack(offsets, GetBitWidth(column->frame_max_offset));
+  } else if (run_length_size == smallest_size) {
+    column->encoding_type = ENCODING_TYPE_RUN_LENGTH;
+    column->SetEntries(run_values);
+    column->run_ends = std::move(run_ends);
+  } else if (dictionary_size == smallest_size) {
+    column->encoding_type = ENCODING_TYPE_DICTIONARY;
+
+    std::vector<Value> entries;
+    for (auto &entry : dictionary) {
+      entry.second = entries.size();
+      entries.push_back(entry.first);
+    }
+    column->SetEntries(entries);
+
+    std::vector<uint64_t> codes;
+    codes.reserve(tuple_count);
+    for (auto &value : values) {
+      codes.push_back(dictionary[value]);
+    }
+    column->Pack(codes, code_bit_width);
+  } else {
+    column->encoding_type = ENCODING_TYPE_PLAIN;
+    column->SetEntries(values);
+  }
+
+  return column.release();
+}
+
+void CompressedColumn::SetEntries(const std::vector<Value> &values) {
+  entry_count = values.size();
+  entries.assign(entry_count * entry_length, 0);
+
+  const bool is_in_bytes = false;
+  for (oid_t entry_itr = 0; entry_itr < entry_count; entry_itr++) {
+    auto &value = values[entry_itr];
+    value.SerializeToTupleStorageAllocateForObjects(
+        entries.data() + entry_itr * entry_length, is_inlined, column_length,
+        is_in_bytes, pool);
+
+    if (is_inlined == false && value.IsNull() == false) {
+      uninlined_data_size += ValuePeeker::PeekObjectLengthWithoutNull(value);
+    }
+  }
+}
+
+Value CompressedColumn::GetEntry(const oid_t entry_offset) const {
+  assert(entry_offset < entry_count);
+  return Value::InitFromTupleStorage(entries.data() + entry_offset * entry_length,
+                                     value_type, is_inlined);
+}
+
+void CompressedColumn::Pack(const std::vector<uint64_t> &codes,
+                            size_t bit_width) {
+  this->bit_width = bit_width;
+  packed.assign(GetPackedSize(codes.size(), bit_width) / sizeof(uint64_t), 0);
+  if (bit_width == 0) {
+    return;
+  }
+
+  for (size_t code_itr = 0; code_itr < codes.size(); code_itr++) {
+    size_t bit_offset = code_itr * bit_width;
+    size_t word = bit_offset / 64, shift = bit_offset % 64;
+    packed[word] |= codes[code_itr] << shift;
+    if (shift + bit_width > 64) {
+      packed[word + 1] |= codes[code_itr] >> (64 - shift);
+    }
+  }
+}
+
+inline uint64_t CompressedColumn::Unpack(const oid_t tuple_offset) const {
+  if (bit_width == 0) {
+    return 0;
+  }
+
+  size_t bit_offset = tuple_offset * bit_width;
+  size_t word = bit_offset / 64, shift = bit_offset % 64;
+  uint64_t code = packed[word] >> shift;
+  if (shift + bit_width > 64) {
+    code |= packed[word + 1] << (64 - shift);
+  }
+  if (bit_width < 64) {
+    code &= (uint64_t(1) << bit_width) - 1;
+  }
+  return code;
+}
+
+Value CompressedColumn::GetFrameValue(uint64_t offset) const {
+  char storage[sizeof(int64_t)];
+  WriteInteger(storage, entry_length,
+               static_cast<int64_t>(static_cast<uint64_t>(frame_base) + offset));
+  return Value::InitFromTupleStorage(storage, value_type, true);
+}
+
+Value CompressedColumn::GetValue(const oid_t tuple_offset) const {
+  assert(tuple_offset < tuple_count);
+
+  switch (encoding_type) {
+    case ENCODING_TYPE_DICTIONARY:
+      return GetEntry(Unpack(tuple_offset));
+    case ENCODING_TYPE_RUN_LENGTH: {
+      auto run = std::upper_bound(run_ends.begin(), run_ends.end(),
+                                  tuple_offset) -
+                 run_ends.begin();
+      return GetEntry(run);
+    }
+    case ENCODING_TYPE_FRAME_OF_REFERENCE:
+      return GetFrameValue(Unpack(tuple_offset));
+    default:
+      return GetEntry(tuple_offset);
+  }
+}
+
+void CompressedColumn::EvaluateComparison(ExpressionType comparison,
+                                          const Value &constant,
+                                          std::vector<bool> &matches) const {
+  assert(matches.size() >= tuple_count);
+
+  if (constant.IsNull() == true) {
+    std::fill(matches.begin(), matches.begin() + tuple_count, false);
+    return;
+  }
+
+  // The offsets grow with the values, so the matching offsets make up a
+  // range, or all but a range for NOTEQUAL
+  if (encoding_type == ENCODING_TYPE_FRAME_OF_REFERENCE) {
+    auto find_first_offset = [this, &constant](bool greater) {
+      uint64_t low = 0, high = frame_max_offset + 1;
+      while (low < high) {
+        uint64_t middle = low + (high - low) / 2;
+        int compare_result =
+            GetFrameValue(middle).CompareWithoutNull(constant);
+        if (compare_result > 0 || (greater == false && compare_result == 0)) {
+          high = middle;
+        } else {
+          low = middle + 1;
+        }
+      }
+      return low;
+    };
+
+    // first offset whose value is >= the constant, and > the constant
+    uint64_t equal_begin = find_first_offset(false);
+    uint64_t equal_end = find_first_offset(true);
+
+    for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+      if (matches[tuple_itr] == false) {
+        continue;
+      }
+      uint64_t offset = Unpack(tuple_itr);
+      if (frame_has_null == true && offset == frame_null_offset) {
+        matches[tuple_itr] = false;
+        continue;
+      }
+      int compare_result =
+          (offset < equal_begin) ? -1 : ((offset < equal_end) ? 0 : 1);
+      matches[tuple_itr] = IsMatch(comparison, compare_result);
+    }
+    return;
+  }
+
+  // Every other encoding compares the entries once
+  std::vector<bool> entry_matches(entry_count);
+  for (oid_t entry_itr = 0; entry_itr < entry_count; entry_itr++) {
+    auto entry = GetEntry(entry_itr);
+    entry_matches[entry_itr] =
+        (entry.IsNull() == false &&
+         IsMatch(comparison, entry.CompareWithoutNull(constant)));
+  }
+
+  switch (encoding_type) {
+    case ENCODING_TYPE_DICTIONARY:
+      for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+        if (matches[tuple_itr] == true &&
+            entry_matches[Unpack(tuple_itr)] == false) {
+          matches[tuple_itr] = false;
+        }
+      }
+      break;
+    case ENCODING_TYPE_RUN_LENGTH: {
+      oid_t run_begin = 0;
+      for (oid_t run_itr = 0; run_itr < entry_count; run_itr++) {
+        if (entry_matches[run_itr] == false) {
+          std::fill(matches.begin() + run_begin,
+                    matches.begin() + run_ends[run_itr], false);
+        }
+        run_begin = run_ends[run_itr];
+      }
+    } break;
+    default:
+      for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+        if (entry_matches[tuple_itr] == false) {
+          matches[tuple_itr] = false;
+        }
+      }
+      break;
+  }
+}
+
+size_t CompressedColumn::GetSize() const {
+  return entries.size() + uninlined_data_size +
+         packed.size() * sizeof(uint64_t) + run_ends.size() * sizeof(oid_t);
+}
+
+}  // End storage namespace
+}  // End peloton namespace
@@ -0,0 +1,141 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// compressed_column.h
+//
+// Identification: src/backend/storage/compressed_column.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "backend/common/types.h"
+#include "backend/common/value.h"
+
+namespace peloton {
+
+class VarlenPool;
+
+namespace storage {
+
+class Tile;
+
+//===--------------------------------------------------------------------===//
+// Compressed Column
+//===--------------------------------------------------------------------===//
+
+/**
+ * One column of a frozen tile.
+ *
+ * Every column is encoded the way that takes the least space:
+ *
+ * DICTIONARY : the distinct values, and a bit-packed code per tuple
+ * RUN_LENGTH : one value per run of equal values, and where every run ends
+ * FRAME_OF_REFERENCE : integers as bit-packed offsets from the smallest one
+ * PLAIN : every value, when none of the others help
+ *
+ * Values are kept in the tuple storage format of the column, with the
+ * uninlined data in the pool of the tile, so decoding a value is the same as
+ * reading it from a tile. The column never changes once it is built.
+ */
+class CompressedColumn {
+  CompressedColumn() = delete;
+  CompressedColumn(CompressedColumn const &) = delete;
+
+ public:
+  enum EncodingType {
+    ENCODING_TYPE_PLAIN = 0,
+    ENCODING_TYPE_DICTIONARY = 1,
+    ENCODING_TYPE_RUN_LENGTH = 2,
+    ENCODING_TYPE_FRAME_OF_REFERENCE = 3
+  };
+
+  // Encodes the column of the first tuple_count slots of the tile
+  static CompressedColumn *Compress(Tile *tile, const oid_t column_id,
+                                    const oid_t tuple_count);
+
+  Value GetValue(const oid_t tuple_offset) const;
+
+  // Clears the matches of the tuples whose value is not "value <comparison>
+  // constant". The comparison is made once per distinct value or run, and
+  // on the offsets themselves for frame of reference. NULL never matches.
+  void EvaluateComparison(ExpressionType comparison, const Value &constant,
+                          std::vector<bool> &matches) const;
+
+  EncodingType GetEncodingType() const { return encoding_type; }
+
+  oid_t GetTupleCount() const { return tuple_count; }
+
+  // Bytes taken by the encoded column, uninlined data included
+  size_t GetSize() const;
+
+ private:
+  CompressedColumn(ValueType value_type, bool is_inlined, size_t entry_length,
+                   size_t column_length, oid_t tuple_count, VarlenPool *pool);
+
+  // Values are stored in the same format as in a tile
+  void SetEntries(const std::vector<Value> &values);
+  Value GetEntry(const oid_t entry_offset) const;
+
+  // Bit-packed codes and offsets
+  void Pack(const std::vector<uint64_t> &codes, size_t bit_width);
+  inline uint64_t Unpack(const oid_t tuple_offset) const;
+
+  // Offsets are read as raw integers from the tuple storage
+  Value GetFrameValue(uint64_t offset) const;
+
+  //===--------------------------------------------------------------------===//
+  // Data members
+  //===--------------------------------------------------------------------===//
+
+  EncodingType encoding_type;
+
+  ValueType value_type;
+
+  bool is_inlined;
+
+  // width of a value in the tuple storage
+  size_t entry_length;
+
+  // length of a value when serialized
+  size_t column_length;
+
+  oid_t tuple_count;
+
+  // pool of the tile, for the uninlined data of the entries
+  VarlenPool *pool;
+
+  // plain values, distinct values or values of the runs
+  std::vector<char> entries;
+
+  oid_t entry_count = 0;
+
+  size_t uninlined_data_size = 0;
+
+  // codes or frame of reference offsets
+  std::vector<uint64_t> packed;
+
+  size_t bit_width = 0;
+
+  // exclusive end of every run
+  std::vector<oid_t> run_ends;
+
+  // smallest integer of the frame of reference
+  int64_t frame_base = 0;
+
+  // largest offset in the frame
+  uint64_t frame_max_offset = 0;
+
+  // offset of the NULL integer, if the frame holds one
+  bool frame_has_null = false;
+  uint64_t frame_null_offset = 0;
+};
+
+}  // End storage namespace
+}  // End peloton namespace
@@ -10,7 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <mutex>
+#include <thread>
 #include <utility>
 
 #include "backend/brain/clusterer.h"
@@ -23,6 +25,7 @@
 #include "backend/index/index.h"
 #include "backend/storage/tile_group.h"
 #include "backend/storage/tuple.h"
+#include "backend/storage/zone_map.h"
 #include "backend/storage/tile.h"
 #include "backend/storage/tile_group_header.h"
 #include "backend/storage/tile_group_factory.h"
@@ -40,15 +43,27 @@ int peloton_num_groups;
 
 bool peloton_fsm;
 
+size_t peloton_active_tilegroup_count = 1;
+
 namespace peloton {
 namespace storage {
 
+// Hands out the active tile group slots to the inserting threads round robin
+static std::atomic<size_t> next_active_slot(0);
+
+static thread_local size_t active_slot_of_thread = next_active_slot++;
+
+// Owns an empty slot while a tuple is copied into it. The slot has no begin
+// cid yet, so no transaction sees it.
+static const txn_id_t FILLING_TXN_ID = MAX_TXN_ID;
+
 DataTable::DataTable(catalog::Schema *schema, const std::string &table_name,
                      const oid_t &database_oid, const oid_t &table_oid,
                      const size_t &tuples_per_tilegroup, const bool own_schema,
                      const bool adapt_table)
     : AbstractTable(database_oid, table_oid, table_name, schema, own_schema),
       tuples_per_tilegroup_(tuples_per_tilegroup),
+      active_tilegroup_count_(std::max<size_t>(peloton_active_tilegroup_count, 1)),
       adapt_table_(adapt_table) {
   // Init default partition
   auto col_count = schema->GetColumnCount();
@@ -58,9 +73,32 @@ DataTable::DataTable(catalog::Schema *schema, const std::string &table_name,
 
   // Create a tile group.
   AddDefaultTileGroup();
+
+  // Open the other tile groups that take inserts
+  if (active_tilegroup_count_ > 1) {
+    active_tile_groups_.push_back(GetTileGroup(0));
+    for (size_t active_slot = 1; active_slot < active_tilegroup_count_;
+         active_slot++) {
+      active_tile_groups_.push_back(GetTileGroupById(AddDefaultTileGroup()));
+    }
+    spare_tile_groups_.resize(active_tilegroup_count_);
+
+    is_preallocating_ = true;
+    preallocation_thread_ = std::thread(&DataTable::Preallocating, this);
+  }
 }
 
 DataTable::~DataTable() {
+  // stop the preallocation thread before the tile groups go away
+  if (preallocation_thread_.joinable() == true) {
+    {
+      std::lock_guard<std::mutex> lock(preallocation_mutex_);
+      is_preallocating_ = false;
+    }
+    preallocation_cv_.notify_one();
+    preallocation_thread_.join();
+  }
+
   // clean up tile groups by dropping the references in the catalog
   oid_t tile_group_count = GetTileGroupCount();
   for (oid_t tile_group_itr = 0; tile_group_itr < tile_group_count;
@@ -135,11 +173,19 @@ ItemPointer DataTable::GetEmptyTupleSlot(const storage::Tuple *tuple,
   // check if there are recycled tuple slots
   auto &gc_manager = gc::GCManagerFactory::GetInstance();
   auto free_item_pointer = gc_manager.ReturnFreeSlot(this->table_oid);
-  if (free_item_pointer.IsNull() == false) {
-    return free_item_pointer;
+  while (free_item_pointer.IsNull() == false) {
+    // the tile group of the slot may have been dropped since it was recycled
+    if (FillTupleSlot(free_item_pointer, tuple) == true) {
+      return free_item_pointer;
+    }
+    free_item_pointer = gc_manager.ReturnFreeSlot(this->table_oid);
   }
   //====================================================
 
+  if (active_tilegroup_count_ > 1) {
+    return GetActiveTupleSlot(tuple);
+  }
+
   std::shared_ptr<storage::TileGroup> tile_group;
   oid_t tuple_slot = INVALID_OID;
   oid_t tile_group_id = INVALID_OID;
@@ -148,21 +194,29 @@ ItemPointer DataTable::GetEmptyTupleSlot(const storage::Tuple *tuple,
   while (true) {
     // get the last tile group.
     tile_group = GetTileGroup(tile_group_count_ - 1);
+    // a tile group was dropped concurrently
+    if (tile_group == nullptr) {
+      continue;
+    }
 
-    tuple_slot = tile_group->InsertTuple(tuple);
+    tuple_slot = tile_group->GetHeader()->GetNextEmptyTupleSlot();
+    if (tuple_slot == INVALID_OID) {
+      continue;
+    }
+    tile_group_id = tile_group->GetTileGroupId();
+
+    // if this is the last tuple slot we can get
+    // then create a new tile group
+    if (tuple_slot == tile_group->GetAllocatedTupleCount() - 1) {
+      AddDefaultTileGroup();
+    }
 
     // now we have already obtained a new tuple slot.
-    if (tuple_slot != INVALID_OID) {
-      tile_group_id = tile_group->GetTileGroupId();
+    if (FillTupleSlot(ItemPointer(tile_group_id, tuple_slot), tuple) == true) {
       LOG_INFO("%s", GetInfo().c_str());
       break;
     }
   }
-  // if this is the last tuple slot we can get
-  // then create a new tile group
-  if (tuple_slot == tile_group->GetAllocatedTupleCount() - 1) {
-    AddDefaultTileGroup();
-  }
 
   LOG_TRACE("tile group count: %lu, tile group id: %u, address: %p",
             tile_group_count_.load(), tile_group->GetTileGroupId(), tile_group.get());
@@ -173,6 +227,134 @@ ItemPointer DataTable::GetEmptyTupleSlot(const storage::Tuple *tuple,
   return location;
 }
 
+// inserts are spread across several active tile groups, every thread
+// starting at its own one. the thread that claims the middle slot of an active
+// tile group asks the preallocation thread for its successor, and the one that
+// claims the last slot swaps the successor in, so that inserters neither share
+// one slot counter nor allocate tile groups. only when the preallocation
+// thread falls behind does the thread that claims the last slot allocate the
+// successor itself.
+ItemPointer DataTable::GetActiveTupleSlot(const storage::Tuple *tuple) {
+  size_t first_slot = active_slot_of_thread % active_tilegroup_count_;
+
+  while (true) {
+    for (size_t slot_itr = 0; slot_itr < active_tilegroup_count_; slot_itr++) {
+      size_t active_slot = (first_slot + slot_itr) % active_tilegroup_count_;
+      auto tile_group = std::atomic_load(&active_tile_groups_[active_slot]);
+
+      oid_t tuple_slot = tile_group->GetHeader()->GetNextEmptyTupleSlot();
+      // full, the thread that filled it is replacing it
+      if (tuple_slot == INVALID_OID) {
+        continue;
+      }
+
+      oid_t allocated_tuple_count = tile_group->GetAllocatedTupleCount();
+      if (tuple_slot == allocated_tuple_count / 2) {
+        RequestPreallocation(active_slot);
+      }
+      if (tuple_slot == allocated_tuple_count - 1) {
+        ReplaceActiveTileGroup(active_slot);
+      }
+
+      ItemPointer location(tile_group->GetTileGroupId(), tuple_slot);
+      if (FillTupleSlot(location, tuple) == true) {
+        return location;
+      }
+    }
+
+    // every active tile group is being replaced right now
+    std::this_thread::yield();
+  }
+}
+
+// the slot is claimed before the tuple is copied in, so that a swap of its
+// tile group either waits for the copy or has already put the new tile group
+// in the catalog, where the copy then goes.
+bool DataTable::FillTupleSlot(const ItemPointer &location,
+                              const storage::Tuple *tuple) {
+  auto &catalog_manager = catalog::Manager::GetInstance();
+
+  while (true) {
+    auto tile_group = catalog_manager.GetTileGroup(location.block);
+    if (tile_group == nullptr) {
+      return false;
+    }
+
+    auto tile_group_header = tile_group->GetHeader();
+    if (tile_group_header->SetAtomicTransactionId(
+            location.offset, INVALID_TXN_ID, FILLING_TXN_ID) ==
+        INVALID_TXN_ID) {
+      // swapped after we looked it up
+      if (tile_group->IsReplaced() == false) {
+        tile_group->CopyTuple(tuple, location.offset);
+
+        COMPILER_MEMORY_FENCE;
+
+        tile_group_header->SetTransactionId(location.offset, INVALID_TXN_ID);
+        return true;
+      }
+      tile_group_header->SetTransactionId(location.offset, INVALID_TXN_ID);
+    }
+
+    // a swap holds the slot
+    std::this_thread::yield();
+  }
+}
+
+void DataTable::RequestPreallocation(const size_t &active_slot) {
+  {
+    std::lock_guard<std::mutex> lock(preallocation_mutex_);
+    pending_preallocations_.push_back(active_slot);
+  }
+  preallocation_cv_.notify_one();
+}
+
+void DataTable::Preallocating() {
+  std::vector<size_t> active_slots;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(preallocation_mutex_);
+      preallocation_cv_.wait(lock, [this] {
+        return is_preallocating_ == false ||
+               pending_preallocations_.empty() == false;
+      });
+      if (is_preallocating_ == false) {
+        return;
+      }
+      active_slots.swap(pending_preallocations_);
+    }
+
+    for (auto active_slot : active_slots) {
+      PreallocateTileGroup(active_slot);
+    }
+    active_slots.clear();
+  }
+}
+
+void DataTable::PreallocateTileGroup(const size_t &active_slot) {
+  std::shared_ptr<TileGroup> tile_group(GetTileGroupWithLayout(
+      GetTileGroupLayout((LayoutType)peloton_layout_mode)));
+
+  // a late preallocation for the previous tile group may have left one behind
+  std::shared_ptr<TileGroup> no_tile_group;
+  std::atomic_compare_exchange_strong(&spare_tile_groups_[active_slot],
+                                      &no_tile_group, tile_group);
+}
+
+void DataTable::ReplaceActiveTileGroup(const size_t &active_slot) {
+  auto tile_group = std::atomic_exchange(&spare_tile_groups_[active_slot],
+                                         std::shared_ptr<TileGroup>());
+
+  // the successor is not ready yet, don't let the others wait for it
+  if (tile_group == nullptr) {
+    tile_group.reset(GetTileGroupWithLayout(
+        GetTileGroupLayout((LayoutType)peloton_layout_mode)));
+  }
+
+  AddTileGroup(tile_group);
+  std::atomic_store(&active_tile_groups_[active_slot], tile_group);
+}
+
 //===--------------------------------------------------------------------===//
 // INSERT
 //===--------------------------------------------------------------------===//
@@ -259,6 +441,182 @@ ItemPointer DataTable::InsertTuple(const storage::Tuple *tuple) {
   return location;
 }
 
+//===--------------------------------------------------------------------===//
+// BULK LOADING
+//===--------------------------------------------------------------------===//
+
+void DataTable::BulkInsertTuples(
+    const std::vector<std::unique_ptr<Tuple>> &tuples, const cid_t &commit_id) {
+  std::lock_guard<std::mutex> lock(bulk_load_mutex_);
+
+  for (auto &tuple : tuples) {
+    assert(tuple);
+    oid_t tuple_slot = INVALID_OID;
+    if (bulk_load_tile_group_ != nullptr) {
+      tuple_slot = bulk_load_tile_group_->InsertTuple(tuple.get());
+    }
+
+    // start a fresh tile group
+    if (tuple_slot == INVALID_OID) {
+      bulk_load_tile_group_.reset(GetTileGroupWithLayout(
+          GetTileGroupLayout((LayoutType)peloton_layout_mode)));
+      AddTileGroupBeforeLast(bulk_load_tile_group_);
+      tuple_slot = bulk_load_tile_group_->InsertTuple(tuple.get());
+      assert(tuple_slot != INVALID_OID);
+    }
+
+    // the version is committed right away
+    auto tile_group_header = bulk_load_tile_group_->GetHeader();
+    tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+    tile_group_header->SetBeginCommitId(tuple_slot, commit_id);
+    tile_group_header->SetInsertCommit(tuple_slot, false);
+    tile_group_header->SetDeleteCommit(tuple_slot, false);
+    tile_group_header->SetNextItemPointer(tuple_slot, INVALID_ITEMPOINTER);
+
+    COMPILER_MEMORY_FENCE;
+
+    tile_group_header->SetTransactionId(tuple_slot, INITIAL_TXN_ID);
+
+    RecordBulkLoadedVersion(
+        ItemPointer(bulk_load_tile_group_->GetTileGroupId(), tuple_slot));
+
+    if (tuple_slot == bulk_load_tile_group_->GetAllocatedTupleCount() - 1) {
+      bulk_load_tile_group_.reset();
+    }
+  }
+
+  IncreaseNumberOfTuplesBy(tuples.size());
+}
+
+void DataTable::AddBulkLoadedVersion(const ItemPointer &location) {
+  std::lock_guard<std::mutex> lock(bulk_load_mutex_);
+  RecordBulkLoadedVersion(location);
+}
+
+// The caller holds the bulk load mutex
+void DataTable::RecordBulkLoadedVersion(const ItemPointer &location) {
+  if (bulk_loaded_ranges_.empty() == false) {
+    auto &last_range = bulk_loaded_ranges_.back();
+    if (last_range.first.block == location.block &&
+        last_range.first.offset + last_range.second == location.offset) {
+      last_range.second++;
+      return;
+    }
+  }
+
+  bulk_loaded_ranges_.emplace_back(location, 1);
+}
+
+// Hands the key of every bulk loaded version to the function
+static void ForEachBulkLoadedKey(
+    index::Index *index,
+    const std::vector<std::pair<ItemPointer, oid_t>> &bulk_loaded_ranges,
+    const std::function<void(const storage::Tuple *, const ItemPointer &)> &
+        fn) {
+  auto &catalog_manager = catalog::Manager::GetInstance();
+  auto index_schema = index->GetKeySchema();
+  auto indexed_columns = index_schema->GetIndexedColumns();
+  std::unique_ptr<storage::Tuple> key(new storage::Tuple(index_schema, true));
+
+  for (auto &range : bulk_loaded_ranges) {
+    auto tile_group = catalog_manager.GetTileGroup(range.first.block);
+    // the tile group was dropped in the meantime
+    if (tile_group == nullptr) {
+      continue;
+    }
+    for (oid_t tuple_slot = range.first.offset;
+         tuple_slot < range.first.offset + range.second; tuple_slot++) {
+      for (oid_t column_itr = 0; column_itr < indexed_columns.size();
+           column_itr++) {
+        key->SetValue(
+            column_itr,
+            tile_group->GetValue(tuple_slot, indexed_columns[column_itr]),
+            index->GetPool());
+      }
+      fn(key.get(), ItemPointer(range.first.block, tuple_slot));
+    }
+  }
+}
+
+bool DataTable::BuildIndexes() {
+  std::vector<std::pair<ItemPointer, oid_t>> bulk_loaded_ranges;
+  {
+    std::lock_guard<std::mutex> lock(bulk_load_mutex_);
+    bulk_loaded_ranges.swap(bulk_loaded_ranges_);
+  }
+
+  oid_t version_count = 0;
+  for (auto &range : bulk_loaded_ranges) {
+    version_count += range.second;
+  }
+
+  oid_t index_count = GetIndexCount();
+  std::vector<std::thread> index_threads;
+  std::unique_ptr<bool[]> index_status(new bool[index_count]);
+
+  for (oid_t index_itr = 0; index_itr < index_count; index_itr++) {
+    auto index = GetIndex(index_itr);
+    index_threads.push_back(std::thread([&, index, index_itr]() {
+      ForEachBulkLoadedKey(
+          index, bulk_loaded_ranges,
+          [index](const storage::Tuple *key, const ItemPointer &location) {
+            index->BulkLoadEntry(key, location);
+          });
+
+      index_status[index_itr] = index->FinishBulkLoad();
+    }));
+  }
+
+  bool status = true;
+  for (oid_t index_itr = 0; index_itr < index_count; index_itr++) {
+    index_threads[index_itr].join();
+    if (index_status[index_itr] == false) {
+      LOG_WARN("Index constraint violated");
+      status = false;
+    }
+  }
+
+  if (status == true) {
+    for (oid_t index_itr = 0; index_itr < index_count; index_itr++) {
+      GetIndex(index_itr)->IncreaseNumberOfTuplesBy(version_count);
+    }
+    LOG_TRACE("Built %u indexes over %u versions", index_count,
+              version_count);
+    return true;
+  }
+
+  // Take the versions back out of every index, and make them invisible, so
+  // that no version is left without its index entries
+  for (oid_t index_itr = 0; index_itr < index_count; index_itr++) {
+    auto index = GetIndex(index_itr);
+    ForEachBulkLoadedKey(
+        index, bulk_loaded_ranges,
+        [index](const storage::Tuple *key, const ItemPointer &location) {
+          index->DeleteEntry(key, location);
+        });
+  }
+
+  auto &catalog_manager = catalog::Manager::GetInstance();
+  for (auto &range : bulk_loaded_ranges) {
+    auto tile_group = catalog_manager.GetTileGroup(range.first.block);
+    if (tile_group == nullptr) {
+      continue;
+    }
+    auto tile_group_header = tile_group->GetHeader();
+    for (oid_t tuple_slot = range.first.offset;
+         tuple_slot < range.first.offset + range.second; tuple_slot++) {
+      tile_group_header->SetTransactionId(tuple_slot, INVALID_TXN_ID);
+      tile_group_header->SetBeginCommitId(tuple_slot, MAX_CID);
+      tile_group_header->SetEndCommitId(tuple_slot, MAX_CID);
+    }
+  }
+  DecreaseNumberOfTuplesBy(version_count);
+
+  LOG_TRACE("Rolled back %u bulk loaded versions", version_count);
+
+  return false;
+}
+
 /**
  * @brief Insert a tuple into all indexes. If index is primary/unique,
  * check visibility of existing
@@ -464,10 +822,13 @@ void DataTable::ResetDirty() { dirty_ = false; }
 
 uint64_t DataTable::GetMemoryFootprint(const oid_t table_oid) const {
   uint64_t count = 0;
-  for (size_t i = 0; i < tile_groups_.size(); ++i)
-  {
-    auto tile_group = GetTileGroup(i);
-    size_t recycled_count = gc::GCManagerFactory::GetInstance().GetRefurbishedTupleSlotCountPerTileGroup(table_oid, tile_groups_[i]);
+  // the tile groups may be dropped meanwhile, so walk a snapshot of the ids
+  for (auto tile_group_id : GetTileGroupIds()) {
+    auto tile_group = GetTileGroupById(tile_group_id);
+    if (tile_group.get() == nullptr) {
+      continue;
+    }
+    size_t recycled_count = gc::GCManagerFactory::GetInstance().GetRefurbishedTupleSlotCountPerTileGroup(table_oid, tile_group_id);
     count += tile_group -> GetMemoryFootprint(recycled_count);
   }
   return count;
@@ -635,15 +996,72 @@ void DataTable::AddTileGroup(const std::shared_ptr<TileGroup> &tile_group) {
   LOG_TRACE("Recording tile group : %u ", tile_group_id);
 }
 
+void DataTable::AddTileGroupBeforeLast(
+    const std::shared_ptr<TileGroup> &tile_group) {
+  oid_t tile_group_id = tile_group->GetTileGroupId();
+
+  // add tile group in catalog
+  catalog::Manager::GetInstance().AddTileGroup(tile_group_id, tile_group);
+
+  // the inserters keep claiming slots in the last visible tile group
+  tile_group_lock_.WriteLock();
+  size_t tile_group_offset = (tile_group_count_ > 0) ? tile_group_count_ - 1 : 0;
+  tile_groups_.insert(tile_groups_.begin() + tile_group_offset, tile_group_id);
+  tile_group_count_++;
+  tile_group_lock_.Unlock();
+
+  LOG_TRACE("Recording tile group : %u ", tile_group_id);
+}
+
 size_t DataTable::GetTileGroupCount() const {
   return tile_group_count_;
 }
 
+std::vector<oid_t> DataTable::GetTileGroupIds() const {
+  tile_group_lock_.ReadLock();
+  std::vector<oid_t> tile_group_ids(tile_groups_.begin(),
+                                    tile_groups_.begin() + tile_group_count_);
+  tile_group_lock_.Unlock();
+
+  return tile_group_ids;
+}
+
+bool DataTable::DropTileGroup(const oid_t &tile_group_id) {
+  {
+    tile_group_lock_.WriteLock();
+
+    auto tile_group_itr =
+        std::find(tile_groups_.begin(), tile_groups_.end(), tile_group_id);
+
+    // not in this table, or still taking the inserts
+    if (tile_group_itr == tile_groups_.end() ||
+        tile_group_itr + 1 >= tile_groups_.begin() + tile_group_count_) {
+      tile_group_lock_.Unlock();
+      return false;
+    }
+
+    tile_groups_.erase(tile_group_itr);
+    tile_group_count_--;
+
+    tile_group_lock_.Unlock();
+  }
+
+  // the memory is released once the last user lets go of the tile group
+  catalog::Manager::GetInstance().DropTileGroup(tile_group_id);
+
+  LOG_TRACE("Dropped tile group : %u ", tile_group_id);
+
+  return true;
+}
+
 std::shared_ptr<storage::TileGroup> DataTable::GetTileGroup(
     const oid_t &tile_group_offset) const {
-  assert(tile_group_offset < GetTileGroupCount());
-
   tile_group_lock_.ReadLock();
+  // the table may have shrunk since the caller read the tile group count
+  if (tile_group_offset >= tile_groups_.size()) {
+    tile_group_lock_.Unlock();
+    return std::shared_ptr<storage::TileGroup>();
+  }
   auto tile_group_id = tile_groups_.at(tile_group_offset);
   tile_group_lock_.Unlock();
 
@@ -662,14 +1080,17 @@ const std::string DataTable::GetInfo() const {
   //os << "=====================================================\n";
   //os << "TABLE :\n";
 
-  oid_t tile_group_count = GetTileGroupCount();
-  //os << "Tile Group Count : " << tile_group_count << "\n";
+  auto tile_group_ids = GetTileGroupIds();
+  //os << "Tile Group Count : " << tile_group_ids.size() << "\n";
 
   oid_t tuple_count = 0;
   oid_t table_id = 0;
-  for (oid_t tile_group_itr = 0; tile_group_itr < tile_group_count;
-       tile_group_itr++) {
-    auto tile_group = GetTileGroup(tile_group_itr);
+  for (auto tile_group_id : tile_group_ids) {
+    auto tile_group = GetTileGroupById(tile_group_id);
+    // dropped since the snapshot
+    if (tile_group.get() == nullptr) {
+      continue;
+    }
     table_id = tile_group->GetTableId();
     auto tile_tuple_count = tile_group->GetNextTupleSlot();
 
@@ -846,46 +1267,199 @@ void SetTransformedTileGroup(storage::TileGroup *orig_tile_group,
   auto header = orig_tile_group->GetHeader();
   auto new_header = new_tile_group->GetHeader();
   *new_header = *header;
+
+  // Rebuild the synopses from the copied values
+  new_tile_group->GetZoneMap()->Recompute(new_tile_group);
 }
 
 storage::TileGroup *DataTable::TransformTileGroup(
     const oid_t &tile_group_offset, const double &theta) {
   // First, check if the tile group is in this table
+  tile_group_lock_.ReadLock();
   if (tile_group_offset >= tile_groups_.size()) {
+    tile_group_lock_.Unlock();
     LOG_ERROR("Tile group offset not found in table : %u ", tile_group_offset);
     return nullptr;
   }
-
   auto tile_group_id = tile_groups_[tile_group_offset];
+  tile_group_lock_.Unlock();
+
+  return TransformTileGroupById(tile_group_id, theta);
+}
+
+// The claimed empty slots are emptied again, the versions are released
+static void UnlockTileGroup(storage::TileGroupHeader *tile_group_header,
+                            const txn_id_t &lock_txn_id,
+                            const std::vector<oid_t> &empty_slots) {
+  for (auto tuple_id : empty_slots) {
+    tile_group_header->SetAtomicTransactionId(tuple_id, lock_txn_id,
+                                              INVALID_TXN_ID);
+  }
+
+  auto tuple_count = tile_group_header->GetCurrentNextTupleSlot();
+  for (oid_t tuple_id = 0; tuple_id < tuple_count; tuple_id++) {
+    tile_group_header->SetAtomicTransactionId(tuple_id, lock_txn_id,
+                                              INITIAL_TXN_ID);
+  }
+}
+
+// Locks the latest versions of a tile group, so that no transaction can write
+// them while the tile group is copied. Its empty slots are claimed too, an
+// inserter may have got one before the slot reuse was disabled and would
+// fill it after the copy otherwise. Returns false if one of them is owned
+// already or the tile group still has versions that may change.
+static bool LockTileGroup(storage::TileGroupHeader *tile_group_header,
+                          const txn_id_t &lock_txn_id,
+                          std::vector<oid_t> &empty_slots) {
+  auto tuple_count = tile_group_header->GetCurrentNextTupleSlot();
+  bool gc_enabled = (gc::GCManagerFactory::GetGCType() != GC_TYPE_OFF);
+
+  for (oid_t tuple_id = 0; tuple_id < tuple_count; tuple_id++) {
+    auto txn_id = tile_group_header->GetTransactionId(tuple_id);
+    // empty slot or delete marker
+    if (txn_id == INVALID_TXN_ID) {
+      if (tile_group_header->SetAtomicTransactionId(
+              tuple_id, INVALID_TXN_ID, lock_txn_id) == INVALID_TXN_ID) {
+        empty_slots.push_back(tuple_id);
+        continue;
+      }
+    } else {
+      // old versions are refurbished by the GC without taking ownership
+      bool is_latest =
+          (tile_group_header->GetEndCommitId(tuple_id) == MAX_CID);
+      if ((is_latest == true || gc_enabled == false) &&
+          tile_group_header->SetAtomicTransactionId(tuple_id, lock_txn_id) ==
+              true) {
+        continue;
+      }
+    }
+
+    // undo, only the slots before this one are ours
+    UnlockTileGroup(tile_group_header, lock_txn_id, empty_slots);
+    empty_slots.clear();
+    return false;
+  }
+
+  return true;
+}
+
+storage::TileGroup *DataTable::TransformTileGroupById(
+    const oid_t &tile_group_id, const double &theta) {
+  // These protocols keep reader lists (or the last reader, under TO) in the
+  // tuple headers, which readers still holding the original tile group would
+  // update behind our back
+  auto protocol = concurrency::TransactionManagerFactory::GetProtocol();
+  if (protocol == CONCURRENCY_TYPE_EAGER_WRITE ||
+      protocol == CONCURRENCY_TYPE_TO || protocol == CONCURRENCY_TYPE_SSI) {
+    LOG_TRACE("Tile groups are not transformed under this protocol");
+    return nullptr;
+  }
+
+  column_map_type column_map;
+  {
+    std::lock_guard<std::mutex> lock(clustering_mutex_);
+    column_map = default_partition_;
+  }
 
   // Get orig tile group from catalog
   auto &catalog_manager = catalog::Manager::GetInstance();
   auto tile_group = catalog_manager.GetTileGroup(tile_group_id);
-  auto diff = tile_group->GetSchemaDifference(default_partition_);
+  if (tile_group == nullptr || tile_group->GetTableId() != table_oid) {
+    LOG_ERROR("Tile group not found in table : %u ", tile_group_id);
+    return nullptr;
+  }
 
   // Check threshold for transformation
+  auto diff = tile_group->GetSchemaDifference(column_map);
   if (diff < theta) {
     return nullptr;
   }
 
+  // Frozen tile groups stay frozen
+  return SwapTileGroup(tile_group, column_map, tile_group->IsFrozen());
+}
+
+storage::TileGroup *DataTable::FreezeTileGroupById(const oid_t &tile_group_id) {
+  // Same as for transforming
+  auto protocol = concurrency::TransactionManagerFactory::GetProtocol();
+  if (protocol == CONCURRENCY_TYPE_EAGER_WRITE ||
+      protocol == CONCURRENCY_TYPE_TO || protocol == CONCURRENCY_TYPE_SSI) {
+    LOG_TRACE("Tile groups are not frozen under this protocol");
+    return nullptr;
+  }
+
+  auto &catalog_manager = catalog::Manager::GetInstance();
+  auto tile_group = catalog_manager.GetTileGroup(tile_group_id);
+  if (tile_group == nullptr || tile_group->GetTableId() != table_oid) {
+    LOG_ERROR("Tile group not found in table : %u ", tile_group_id);
+    return nullptr;
+  }
+
+  if (tile_group->IsFrozen() == true) {
+    return nullptr;
+  }
+
+  return SwapTileGroup(tile_group, tile_group->GetColumnMap(), true);
+}
+
+storage::TileGroup *DataTable::SwapTileGroup(
+    const std::shared_ptr<storage::TileGroup> &tile_group,
+    const column_map_type &column_map, bool freeze) {
+  auto &catalog_manager = catalog::Manager::GetInstance();
+  auto tile_group_id = tile_group->GetTileGroupId();
+
+  // Tile groups still taking inserts are left alone
+  auto tile_group_header = tile_group->GetHeader();
+  if (tile_group_header->GetCurrentNextTupleSlot() <
+      tile_group->GetAllocatedTupleCount()) {
+    return nullptr;
+  }
+
+  // Keep the GC from handing out free slots, this also keeps the compactor
+  // away from the tile group
+  auto &gc_manager = gc::GCManagerFactory::GetInstance();
+  if (gc_manager.DisableSlotReuse(tile_group_id) == false) {
+    return nullptr;
+  }
+
+  // Writers that got hold of a version, and inserters that got hold of a
+  // slot, before we locked it are waited out by giving up, the tile group is
+  // tried again later
+  auto lock_txn_id = concurrency::TransactionManagerFactory::GetInstance()
+                         .GetNextTransactionId();
+  std::vector<oid_t> empty_slots;
+  if (LockTileGroup(tile_group_header, lock_txn_id, empty_slots) == false) {
+    gc_manager.EnableSlotReuse(tile_group_id);
+    return nullptr;
+  }
+
   // Get the schema for the new transformed tile group
-  auto new_schema =
-      TransformTileGroupSchema(tile_group.get(), default_partition_);
+  auto new_schema = TransformTileGroupSchema(tile_group.get(), column_map);
 
   // Allocate space for the transformed tile group
   std::shared_ptr<storage::TileGroup> new_tile_group(
       TileGroupFactory::GetTileGroup(
           tile_group->GetDatabaseId(), tile_group->GetTableId(),
           tile_group->GetTileGroupId(), tile_group->GetAbstractTable(),
-          new_schema, default_partition_,
-          tile_group->GetAllocatedTupleCount()));
+          new_schema, column_map, tile_group->GetAllocatedTupleCount()));
 
-  // Set the transformed tile group column-at-a-time
+  // Set the transformed tile group column-at-a-time, the header comes along
+  // with the locks
   SetTransformedTileGroup(tile_group.get(), new_tile_group.get());
 
-  // Set the location of the new tile group
-  // and clean up the orig tile group
+  // Nobody sees the new tile group yet
+  if (freeze == true) {
+    new_tile_group->Freeze();
+  }
+
+  // Set the location of the new tile group. Readers that got the orig tile
+  // group before keep it alive and see the same versions.
   catalog_manager.AddTileGroup(tile_group_id, new_tile_group);
+  tile_group->SetReplaced();
+
+  UnlockTileGroup(new_tile_group->GetHeader(), lock_txn_id, empty_slots);
+  UnlockTileGroup(tile_group_header, lock_txn_id, empty_slots);
+  gc_manager.EnableSlotReuse(tile_group_id);
 
   return new_tile_group.get();
 }
@@ -942,7 +1516,17 @@ void DataTable::UpdateDefaultPartition() {
   }
 
   // TODO: Max number of tiles
-  default_partition_ = clusterer.GetPartitioning(2);
+  auto partitioning = clusterer.GetPartitioning(2);
+
+  {
+    std::lock_guard<std::mutex> lock(clustering_mutex_);
+    default_partition_ = partitioning;
+  }
+}
+
+size_t DataTable::GetSampleCount() {
+  std::lock_guard<std::mutex> lock(clustering_mutex_);
+  return samples_.size();
 }
 
 //===--------------------------------------------------------------------===//
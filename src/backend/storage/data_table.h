@@ -12,10 +12,12 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <memory>
 #include <queue>
 #include <map>
 #include <mutex>
+#include <thread>
 
 #include "backend/brain/sample.h"
 #include "backend/bridge/ddl/bridge.h"
@@ -51,6 +53,9 @@ extern bool peloton_fsm;
 
 extern std::vector<peloton::oid_t> hyadapt_column_ids;
 
+// # of tile groups per table that take inserts concurrently
+extern size_t peloton_active_tilegroup_count;
+
 namespace peloton {
 
 typedef std::map<oid_t, std::pair<oid_t, oid_t>> column_map_type;
@@ -105,6 +110,26 @@ class DataTable : public AbstractTable {
   // bool DeleteTuple(const concurrency::Transaction *transaction,
   //                  ItemPointer location);
 
+  //===--------------------------------------------------------------------===//
+  // BULK LOADING
+  //===--------------------------------------------------------------------===//
+
+  // Bulk loading is meant for tables that no transaction uses yet, e.g. while
+  // loading a database. The tuples are copied into tile groups of their own
+  // as versions committed at the given commit id, without constraint checks,
+  // logging or index updates. The indexes are built by BuildIndexes.
+  void BulkInsertTuples(const std::vector<std::unique_ptr<Tuple>> &tuples,
+                        const cid_t &commit_id = START_CID);
+
+  // Remember a version put into the table by other means, e.g. by the
+  // checkpoint recovery, for the next BuildIndexes
+  void AddBulkLoadedVersion(const ItemPointer &location);
+
+  // Put the versions loaded since the last call into all the indexes, one
+  // thread per index. Returns false if a unique key shows up twice, the
+  // versions are then taken out of the indexes and made invisible.
+  bool BuildIndexes();
+
   //===--------------------------------------------------------------------===//
   // TILE GROUP
   //===--------------------------------------------------------------------===//
@@ -125,6 +150,16 @@ class DataTable : public AbstractTable {
 
   size_t GetTileGroupCount() const;
 
+  // # of tile groups taking inserts concurrently
+  size_t GetActiveTileGroupCount() const { return active_tilegroup_count_; }
+
+  // Ids of the tile groups currently in the table, in table order
+  std::vector<oid_t> GetTileGroupIds() const;
+
+  // remove an emptied tile group from the table and the catalog
+  // (the tile group that takes the inserts can't be dropped)
+  bool DropTileGroup(const oid_t &tile_group_id);
+
   // Get a tile group with given layout
   TileGroup *GetTileGroupWithLayout(const column_map_type &partitioning);
 
@@ -161,6 +196,16 @@ class DataTable : public AbstractTable {
   storage::TileGroup *TransformTileGroup(const oid_t &tile_group_offset,
                                          const double &theta);
 
+  // Swaps in a copy of the tile group laid out with the default partition.
+  // Only full tile groups that no transaction is writing are transformed,
+  // returns nullptr otherwise.
+  storage::TileGroup *TransformTileGroupById(const oid_t &tile_group_id,
+                                             const double &theta);
+
+  // Swaps in a frozen copy of the tile group, see Tile::Freeze. Writing to
+  // the copy thaws it again. Same restrictions as for transforming.
+  storage::TileGroup *FreezeTileGroupById(const oid_t &tile_group_id);
+
   //===--------------------------------------------------------------------===//
   // STATS
   //===--------------------------------------------------------------------===//
@@ -181,6 +226,8 @@ class DataTable : public AbstractTable {
 
   const column_map_type &GetDefaultPartition();
 
+  bool IsAdaptTable() const { return adapt_table_; }
+
   //===--------------------------------------------------------------------===//
   // Clustering
   //===--------------------------------------------------------------------===//
@@ -189,6 +236,8 @@ class DataTable : public AbstractTable {
 
   void UpdateDefaultPartition();
 
+  size_t GetSampleCount();
+
   //===--------------------------------------------------------------------===//
   // UTILITIES
   //===--------------------------------------------------------------------===//
@@ -223,9 +272,39 @@ class DataTable : public AbstractTable {
   // add a default unpartitioned tile group to table
   oid_t AddDefaultTileGroup();
 
+  // claim a tuple slot in one of the active tile groups
+  ItemPointer GetActiveTupleSlot(const storage::Tuple *tuple);
+
+  // copy the tuple into an empty slot, in whichever tile group holds the slot
+  // now. false if the tile group was dropped.
+  bool FillTupleSlot(const ItemPointer &location, const storage::Tuple *tuple);
+
+  // ask the preallocation thread for the successor of an active tile group
+  void RequestPreallocation(const size_t &active_slot);
+
+  // Infinite poll used by the preallocation thread
+  void Preallocating();
+
+  // allocate the tile group that replaces the given active tile group
+  void PreallocateTileGroup(const size_t &active_slot);
+
+  // replace a full active tile group by its preallocated successor
+  void ReplaceActiveTileGroup(const size_t &active_slot);
+
   // get a partitioning with given layout type
   column_map_type GetTileGroupLayout(LayoutType layout_type);
 
+  // add a tile group to table in front of the tile group taking the inserts
+  void AddTileGroupBeforeLast(const std::shared_ptr<TileGroup> &tile_group);
+
+  // swap in a copy of the tile group with the given layout, frozen if asked
+  storage::TileGroup *SwapTileGroup(
+      const std::shared_ptr<storage::TileGroup> &tile_group,
+      const column_map_type &column_map, bool freeze);
+
+  // remember a bulk loaded version, the caller holds the bulk load mutex
+  void RecordBulkLoadedVersion(const ItemPointer &location);
+
   //===--------------------------------------------------------------------===//
   // INDEX HELPERS
   //===--------------------------------------------------------------------===//
@@ -255,11 +334,41 @@ class DataTable : public AbstractTable {
   std::vector<oid_t> tile_groups_;
 
   std::atomic<size_t> tile_group_count_ = ATOMIC_VAR_INIT(0);
+
+  // ACTIVE TILE GROUPS
+  // # of tile groups taking inserts concurrently
+  size_t active_tilegroup_count_;
+
+  // tile groups taking inserts, each inserting thread sticks to one of them.
+  // only used when there is more than one active tile group.
+  std::vector<std::shared_ptr<TileGroup>> active_tile_groups_;
+
+  // empty tile groups allocated ahead of time, not yet part of the table
+  std::vector<std::shared_ptr<TileGroup>> spare_tile_groups_;
+
+  // allocates the spare tile groups in the background
+  std::thread preallocation_thread_;
+
+  // active slots whose successor is requested, and whether the thread runs
+  std::mutex preallocation_mutex_;
+  std::condition_variable preallocation_cv_;
+  std::vector<size_t> pending_preallocations_;
+  bool is_preallocating_ = false;
   
   // tile group mutex
   // TODO: don't know why need this mutex --Yingjun
   std::mutex tile_group_mutex_;
 
+  // BULK LOADING
+  std::mutex bulk_load_mutex_;
+
+  // tile group the bulk loaded tuples go to, nullptr once full
+  std::shared_ptr<TileGroup> bulk_load_tile_group_;
+
+  // versions not yet in the indexes, as runs of slots
+  // (location of the first version, # of versions)
+  std::vector<std::pair<ItemPointer, oid_t>> bulk_loaded_ranges_;
+
   // INDEXES
   std::vector<index::Index *> indexes_;
 
@@ -0,0 +1,434 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// persistent_heap.cpp
+//
+// Identification: src/backend/storage/persistent_heap.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cpuid.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+#include "backend/common/logger.h"
+#include "backend/storage/persistent_heap.h"
+
+namespace peloton {
+namespace storage {
+
+// 64B cache line size
+#define CACHE_LINE_SIZE 64
+
+// The segment header takes the first page of a segment
+#define SEGMENT_HEADER_SIZE 4096
+
+#define SEGMENT_MAGIC UINT64_C(0x50454c4f544f4e48)  // "PELOTONH"
+
+// Block states
+#define BLOCK_ALLOCATED UINT64_C(0xa110ca7edb10c000)
+#define BLOCK_FREE UINT64_C(0xf4eedb10c0000000)
+
+struct SegmentHeader {
+  uint64_t magic;
+  uint64_t segment_size;
+  // end of the carved out part of the segment
+  uint64_t end_offset;
+};
+
+// Takes a whole cache line, so that blocks are cache line aligned
+struct BlockHeader {
+  uint64_t state;
+  uint64_t size_class;
+};
+
+//===--------------------------------------------------------------------===//
+// Cache line write back
+//===--------------------------------------------------------------------===//
+
+enum FlushInstruction {
+  FLUSH_INSTRUCTION_CLFLUSH,
+  FLUSH_INSTRUCTION_CLFLUSHOPT,
+  FLUSH_INSTRUCTION_CLWB
+};
+
+static FlushInstruction DetectFlushInstruction() {
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid_max(0, nullptr) < 7) {
+    return FLUSH_INSTRUCTION_CLFLUSH;
+  }
+
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+  if (ebx & (1 << 24)) {
+    return FLUSH_INSTRUCTION_CLWB;
+  }
+  if (ebx & (1 << 23)) {
+    return FLUSH_INSTRUCTION_CLFLUSHOPT;
+  }
+  return FLUSH_INSTRUCTION_CLFLUSH;
+}
+
+static const FlushInstruction flush_instruction = DetectFlushInstruction();
+
+// Write back the cache lines covering the range, without ordering them
+static inline void FlushLines(const void *address, size_t length) {
+  uintptr_t uptr = (uintptr_t)address & ~(CACHE_LINE_SIZE - 1);
+  uintptr_t end = (uintptr_t)address + length;
+
+  // the instructions are emitted as bytes, so that no -m flags are needed
+  switch (flush_instruction) {
+    case FLUSH_INSTRUCTION_CLWB:
+      for (; uptr < end; uptr += CACHE_LINE_SIZE) {
+        asm volatile(".byte 0x66; xsaveopt %0" : "+m"(*(volatile char *)uptr));
+      }
+      break;
+    case FLUSH_INSTRUCTION_CLFLUSHOPT:
+      for (; uptr < end; uptr += CACHE_LINE_SIZE) {
+        asm volatile(".byte 0x66; clflush %0" : "+m"(*(volatile char *)uptr));
+      }
+      break;
+    case FLUSH_INSTRUCTION_CLFLUSH:
+    default:
+      for (; uptr < end; uptr += CACHE_LINE_SIZE) {
+        __builtin_ia32_clflush((void *)uptr);
+      }
+      break;
+  }
+}
+
+static inline void Fence() { __builtin_ia32_sfence(); }
+
+void PersistentHeap::Persist(const void *address, size_t length) {
+  FlushLines(address, length);
+  Fence();
+}
+
+//===--------------------------------------------------------------------===//
+// Size classes
+//===--------------------------------------------------------------------===//
+
+// Block size of a size class: 64, 96, 128, 192, 256, ...
+static inline size_t GetBlockSize(size_t size_class) {
+  if (size_class % 2 == 0) return size_t(64) << (size_class / 2);
+  return size_t(96) << (size_class / 2);
+}
+
+// Smallest size class whose blocks hold the given number of bytes
+static inline size_t GetSizeClass(size_t block_size) {
+  if (block_size <= 64) return 0;
+  // block_size lies in (2^exponent, 2^(exponent + 1)]
+  size_t exponent = 63 - __builtin_clzll(block_size - 1);
+  size_t size_class = 2 * (exponent - 6) + 1;
+  if (block_size > (size_t(3) << (exponent - 1))) size_class++;
+  return size_class;
+}
+
+static inline size_t RoundUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+//===--------------------------------------------------------------------===//
+// Persistent Heap
+//===--------------------------------------------------------------------===//
+
+PersistentHeap::PersistentHeap(const std::string &directory,
+                               const std::string &file_name,
+                               size_t segment_size, bool recover)
+    : directory(directory),
+      file_name(file_name),
+      segment_size(RoundUp(segment_size, SEGMENT_HEADER_SIZE)) {
+  for (size_t segment_id = 0; segment_id < PERSISTENT_HEAP_MAX_SEGMENT_COUNT;
+       segment_id++) {
+    std::string segment_file_name = GetSegmentFileName(segment_id);
+    if (access(segment_file_name.c_str(), F_OK) != 0) {
+      break;
+    }
+
+    if (recover == true && RecoverSegment(segment_file_name) == true) {
+      next_segment_id = segment_id + 1;
+    } else {
+      if (unlink(segment_file_name.c_str()) != 0) {
+        LOG_ERROR("Couldn't delete heap segment %s : %s",
+                  segment_file_name.c_str(), strerror(errno));
+      }
+    }
+  }
+
+  LOG_INFO("Opened persistent heap with %lu segments", segments.size());
+}
+
+PersistentHeap::~PersistentHeap() {
+  for (auto &segment : segments) {
+    if (munmap(segment.address, segment.size) != 0) {
+      LOG_ERROR("Couldn't unmap heap segment %s : %s",
+                segment.file_name.c_str(), strerror(errno));
+    }
+  }
+}
+
+std::string PersistentHeap::GetSegmentFileName(size_t segment_id) const {
+  std::string segment_file_name = directory + file_name;
+  if (segment_id > 0) {
+    segment_file_name += "." + std::to_string(segment_id);
+  }
+  return segment_file_name;
+}
+
+bool PersistentHeap::AddSegment(size_t block_size) {
+  if (segments.size() >= PERSISTENT_HEAP_MAX_SEGMENT_COUNT) {
+    LOG_ERROR("Persistent heap is full");
+    return false;
+  }
+
+  size_t size = std::max(segment_size,
+                         RoundUp(SEGMENT_HEADER_SIZE + block_size,
+                                 SEGMENT_HEADER_SIZE));
+  std::string segment_file_name = GetSegmentFileName(next_segment_id++);
+
+  int fd = open(segment_file_name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0666);
+  if (fd < 0) {
+    LOG_ERROR("Couldn't create heap segment %s : %s",
+              segment_file_name.c_str(), strerror(errno));
+    return false;
+  }
+
+  // A new segment reads as zeros, which recovery relies on
+  int ret = posix_fallocate(fd, 0, size);
+  if (ret != 0) {
+    LOG_ERROR("Couldn't allocate heap segment %s : %s",
+              segment_file_name.c_str(), strerror(ret));
+    close(fd);
+    unlink(segment_file_name.c_str());
+    return false;
+  }
+
+  void *address =
+      mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED) {
+    LOG_ERROR("Couldn't map heap segment %s : %s", segment_file_name.c_str(),
+              strerror(errno));
+    unlink(segment_file_name.c_str());
+    return false;
+  }
+
+  auto segment_header = reinterpret_cast<SegmentHeader *>(address);
+  segment_header->segment_size = size;
+  segment_header->end_offset = SEGMENT_HEADER_SIZE;
+  FlushLines(segment_header, sizeof(SegmentHeader));
+  Fence();
+  // the magic number goes last, a segment without it is not recovered
+  segment_header->magic = SEGMENT_MAGIC;
+  Persist(segment_header, sizeof(SegmentHeader));
+
+  // make the new file itself durable on a regular file system
+  msync(address, SEGMENT_HEADER_SIZE, MS_SYNC);
+  msync_count++;
+
+  segments.push_back(
+      Segment{segment_file_name, reinterpret_cast<char *>(address), size});
+  LOG_INFO("Added heap segment %s of %lu bytes", segment_file_name.c_str(),
+           size);
+  return true;
+}
+
+bool PersistentHeap::RecoverSegment(const std::string &segment_file_name) {
+  int fd = open(segment_file_name.c_str(), O_RDWR);
+  if (fd < 0) {
+    LOG_ERROR("Couldn't open heap segment %s : %s", segment_file_name.c_str(),
+              strerror(errno));
+    return false;
+  }
+
+  struct stat segment_stat;
+  if (fstat(fd, &segment_stat) != 0 ||
+      (size_t)segment_stat.st_size < SEGMENT_HEADER_SIZE) {
+    close(fd);
+    return false;
+  }
+
+  size_t size = segment_stat.st_size;
+  void *address =
+      mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED) {
+    LOG_ERROR("Couldn't map heap segment %s : %s", segment_file_name.c_str(),
+              strerror(errno));
+    return false;
+  }
+
+  char *segment_address = reinterpret_cast<char *>(address);
+  auto segment_header = reinterpret_cast<SegmentHeader *>(address);
+  if (segment_header->magic != SEGMENT_MAGIC ||
+      segment_header->segment_size != size ||
+      segment_header->end_offset > size) {
+    LOG_ERROR("Heap segment %s is not valid", segment_file_name.c_str());
+    munmap(address, size);
+    return false;
+  }
+
+  // Walk the blocks, stopping at a block whose header did not make it
+  size_t offset = SEGMENT_HEADER_SIZE;
+  while (offset < segment_header->end_offset) {
+    auto block_header =
+        reinterpret_cast<BlockHeader *>(segment_address + offset);
+    if ((block_header->state != BLOCK_ALLOCATED &&
+         block_header->state != BLOCK_FREE) ||
+        block_header->size_class >= PERSISTENT_HEAP_SIZE_CLASS_COUNT ||
+        offset + GetBlockSize(block_header->size_class) >
+            segment_header->end_offset) {
+      LOG_INFO("Heap segment %s ends in a torn block at %lu",
+               segment_file_name.c_str(), offset);
+      segment_header->end_offset = offset;
+      Persist(&segment_header->end_offset, sizeof(uint64_t));
+      break;
+    }
+
+    size_t block_size = GetBlockSize(block_header->size_class);
+    if (block_header->state == BLOCK_FREE) {
+      free_lists[block_header->size_class].push_back(
+          reinterpret_cast<char *>(block_header));
+    } else {
+      allocated_bytes += block_size;
+    }
+    offset += block_size;
+  }
+
+  // The header of a block carved out right before the crash may have made it
+  // without the segment end. Clear it, so that it is never mistaken for the
+  // header of the block carved out there next.
+  if (segment_header->end_offset + sizeof(BlockHeader) <= size) {
+    auto stale_header = segment_address + segment_header->end_offset;
+    memset(stale_header, 0, sizeof(BlockHeader));
+    Persist(stale_header, sizeof(BlockHeader));
+  }
+
+  segments.push_back(Segment{segment_file_name, segment_address, size});
+  return true;
+}
+
+void *PersistentHeap::Allocate(size_t size) {
+  size_t size_class = GetSizeClass(size + CACHE_LINE_SIZE);
+  if (size_class >= PERSISTENT_HEAP_SIZE_CLASS_COUNT) {
+    return nullptr;
+  }
+  size_t block_size = GetBlockSize(size_class);
+
+  std::lock_guard<std::mutex> heap_lock(heap_mutex);
+
+  // Reuse a free block of the same size class
+  auto &free_list = free_lists[size_class];
+  if (free_list.empty() == false) {
+    char *block = free_list.back();
+    free_list.pop_back();
+
+    auto block_header = reinterpret_cast<BlockHeader *>(block);
+    block_header->state = BLOCK_ALLOCATED;
+    Persist(block_header, sizeof(BlockHeader));
+
+    allocated_bytes += block_size;
+    return block + CACHE_LINE_SIZE;
+  }
+
+  // Carve a new block from the first segment with enough room, adding a
+  // segment if there is none
+  Segment *segment = nullptr;
+  for (auto &candidate : segments) {
+    auto segment_header = reinterpret_cast<SegmentHeader *>(candidate.address);
+    if (segment_header->end_offset + block_size <= candidate.size) {
+      segment = &candidate;
+      break;
+    }
+  }
+
+  if (segment == nullptr) {
+    if (AddSegment(block_size) == false) {
+      return nullptr;
+    }
+    segment = &segments.back();
+  }
+
+  auto segment_header = reinterpret_cast<SegmentHeader *>(segment->address);
+  char *block = segment->address + segment_header->end_offset;
+
+  // Recovery stops at a block whose header did not make it, so both lines
+  // can be written back under a single fence
+  auto block_header = reinterpret_cast<BlockHeader *>(block);
+  block_header->size_class = size_class;
+  block_header->state = BLOCK_ALLOCATED;
+  segment_header->end_offset += block_size;
+  FlushLines(block_header, sizeof(BlockHeader));
+  FlushLines(&segment_header->end_offset, sizeof(uint64_t));
+  Fence();
+
+  allocated_bytes += block_size;
+  return block + CACHE_LINE_SIZE;
+}
+
+void PersistentHeap::Release(void *address) {
+  if (address == nullptr) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> heap_lock(heap_mutex);
+  assert(Contains(address));
+
+  char *block = reinterpret_cast<char *>(address) - CACHE_LINE_SIZE;
+  auto block_header = reinterpret_cast<BlockHeader *>(block);
+  if (block_header->state != BLOCK_ALLOCATED) {
+    LOG_ERROR("Releasing a block that is not allocated : %p", address);
+    return;
+  }
+
+  // The block must be persistently free before it can be handed out again
+  block_header->state = BLOCK_FREE;
+  Persist(block_header, sizeof(BlockHeader));
+
+  free_lists[block_header->size_class].push_back(block);
+  allocated_bytes -= GetBlockSize(block_header->size_class);
+}
+
+void PersistentHeap::SyncSegments() {
+  std::lock_guard<std::mutex> heap_lock(heap_mutex);
+
+  for (auto &segment : segments) {
+    if (msync(segment.address, segment.size, MS_SYNC) != 0) {
+      LOG_ERROR("Couldn't sync heap segment %s : %s",
+                segment.file_name.c_str(), strerror(errno));
+    }
+    msync_count++;
+  }
+}
+
+bool PersistentHeap::Contains(const void *address) const {
+  auto location = reinterpret_cast<const char *>(address);
+  for (auto &segment : segments) {
+    if (location >= segment.address + SEGMENT_HEADER_SIZE &&
+        location < segment.address + segment.size) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t PersistentHeap::GetMappedBytes() const {
+  size_t mapped_bytes = 0;
+  for (auto &segment : segments) {
+    mapped_bytes += segment.size;
+  }
+  return mapped_bytes;
+}
+
+}  // End storage namespace
+}  // End peloton namespace
@@ -0,0 +1,129 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// persistent_heap.h
+//
+// Identification: src/backend/storage/persistent_heap.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace peloton {
+namespace storage {
+
+//===--------------------------------------------------------------------===//
+// Persistent Heap
+//===--------------------------------------------------------------------===//
+
+// Max number of backing files of a heap
+#define PERSISTENT_HEAP_MAX_SEGMENT_COUNT 64
+// Block sizes go from 64 B up in steps of 1 and 1.5 times a power of two
+#define PERSISTENT_HEAP_SIZE_CLASS_COUNT 64
+
+/**
+ * Allocator over memory mapped files on NVM (or any other file system).
+ *
+ * The heap is made of segments, one file each. A new segment is added
+ * whenever none of the existing ones can fit an allocation. Every segment
+ * starts with a header page holding the end of the carved out part of the
+ * segment. Every block starts with a cache line holding its size class and
+ * whether it is allocated or free.
+ *
+ * Only the block headers and the end of the carved out part are persistent.
+ * The free lists are rebuilt from the block headers when an existing heap is
+ * opened, so they are consistent after any crash: a block is carved out by
+ * writing its header before moving the end of the segment, and it is freed
+ * by persisting its free state before it is put on a free list.
+ *
+ * Persisting writes back the cache lines with clwb or clflushopt when the
+ * CPU supports them, followed by a single fence, and falls back to clflush.
+ */
+class PersistentHeap {
+ public:
+  PersistentHeap(const PersistentHeap &) = delete;
+  PersistentHeap &operator=(const PersistentHeap &) = delete;
+
+  // Opens the heap in the given directory. Existing segments are recovered
+  // if asked to, and removed otherwise.
+  PersistentHeap(const std::string &directory, const std::string &file_name,
+                 size_t segment_size, bool recover);
+
+  ~PersistentHeap();
+
+  // Allocate a cache line aligned block, or nullptr if the heap is full
+  void *Allocate(size_t size);
+
+  // Return a block to the heap
+  void Release(void *address);
+
+  // Write back the cache lines of the range to NVM
+  static void Persist(const void *address, size_t length);
+
+  // Write back all segments to the underlying file system
+  void SyncSegments();
+
+  // Whether the address lies in one of the segments
+  bool Contains(const void *address) const;
+
+  // Stats
+  size_t GetSegmentCount() const { return segments.size(); }
+
+  // Bytes in allocated blocks, headers included
+  size_t GetAllocatedBytes() const { return allocated_bytes; }
+
+  // Bytes mapped from the backing files
+  size_t GetMappedBytes() const;
+
+  size_t GetMsyncCount() const { return msync_count; }
+
+ private:
+  struct Segment {
+    std::string file_name;
+    char *address;
+    size_t size;
+  };
+
+  // Create a new segment big enough for a block of the given size
+  bool AddSegment(size_t block_size);
+
+  // Map an existing segment and put its free blocks on the free lists
+  bool RecoverSegment(const std::string &file_name);
+
+  std::string GetSegmentFileName(size_t segment_id) const;
+
+  //===--------------------------------------------------------------------===//
+  // Member Variables
+  //===--------------------------------------------------------------------===//
+
+  std::string directory;
+
+  std::string file_name;
+
+  size_t segment_size;
+
+  std::vector<Segment> segments;
+
+  // id of the next segment file
+  size_t next_segment_id = 0;
+
+  // free blocks per size class, rebuilt on recovery
+  std::vector<char *> free_lists[PERSISTENT_HEAP_SIZE_CLASS_COUNT];
+
+  size_t allocated_bytes = 0;
+
+  size_t msync_count = 0;
+
+  std::mutex heap_mutex;
+};
+
+}  // End storage namespace
+}  // End peloton namespace
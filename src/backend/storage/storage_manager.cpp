@@ -26,6 +26,7 @@
 #include "backend/common/types.h"
 #include "backend/common/logger.h"
 #include "backend/common/exception.h"
+#include "backend/common/numa.h"
 #include "backend/storage/storage_manager.h"
 
 //===--------------------------------------------------------------------===//
@@ -40,19 +41,6 @@ size_t peloton_data_file_size = 0;
 namespace peloton {
 namespace storage {
 
-// 64B cache line size
-#define ALIGN 64
-
-static inline void pmem_flush_cache(void *addr, size_t len) {
-  uintptr_t uptr = (uintptr_t) addr & ~(ALIGN - 1);
-  uintptr_t end = (uintptr_t) addr + len;
-
-  // loop through 64B-aligned chunks covering the given range
-  for (; uptr < end; uptr += ALIGN) {
-    __builtin_ia32_clflush((void *)uptr);
-  }
-}
-
 #define DATA_FILE_LEN 1024 * 1024 * UINT64_C(512)  // 512 MB
 #define DATA_FILE_NAME "peloton.pmem"
 
@@ -62,16 +50,14 @@ StorageManager &StorageManager::GetInstance(void) {
   return storage_manager;
 }
 
-StorageManager::StorageManager()
-    : data_file_address(nullptr), data_file_len(0), data_file_offset(0) {
+StorageManager::StorageManager() : data_file_len(0) {
   // Check if we need a data pool
   if (IsBasedOnWriteAheadLogging(peloton_logging_mode) == true ||
       peloton_logging_mode == LOGGING_TYPE_INVALID) {
     return;
   }
 
-  int data_fd;
-  std::string data_file_name;
+  std::string data_dir;
   struct stat data_stat;
 
   // Initialize file size
@@ -89,7 +75,7 @@ StorageManager::StorageManager()
     case LOGGING_TYPE_NVM_HDD: {
       int status = stat(NVM_DIR, &data_stat);
       if (status == 0 && S_ISDIR(data_stat.st_mode)) {
-        data_file_name = std::string(NVM_DIR) + std::string(DATA_FILE_NAME);
+        data_dir = NVM_DIR;
         found_file_system = true;
       }
 
@@ -100,7 +86,7 @@ StorageManager::StorageManager()
     case LOGGING_TYPE_HDD_HDD: {
       int status = stat(HDD_DIR, &data_stat);
       if (status == 0 && S_ISDIR(data_stat.st_mode)) {
-        data_file_name = std::string(HDD_DIR) + std::string(DATA_FILE_NAME);
+        data_dir = HDD_DIR;
         found_file_system = true;
       }
 
@@ -114,81 +100,45 @@ StorageManager::StorageManager()
   if (found_file_system == false) {
     int status = stat(TMP_DIR, &data_stat);
     if (status == 0 && S_ISDIR(data_stat.st_mode)) {
-      data_file_name = std::string(TMP_DIR) + std::string(DATA_FILE_NAME);
+      data_dir = TMP_DIR;
     } else {
       throw Exception("Could not find temp directory : " +
                       std::string(TMP_DIR));
     }
   }
 
-  // TODO:
-  LOG_TRACE("DATA DIR :: %s ", data_file_name.c_str());
-
-  // Create a data file
-  if ((data_fd = open(data_file_name.c_str(), O_CREAT | O_RDWR, 0666)) < 0) {
-    perror(data_file_name.c_str());
-    exit(EXIT_FAILURE);
-  }
-
-  // Allocate the data file
-  if ((errno = posix_fallocate(data_fd, 0, data_file_len)) != 0) {
-    perror("posix_fallocate");
-    exit(EXIT_FAILURE);
-  }
-
-  // map the data file in memory
-  if ((data_file_address = mmap(NULL, data_file_len, PROT_READ | PROT_WRITE,
-                                MAP_SHARED, data_fd, 0)) == MAP_FAILED) {
-    perror("mmap");
-    exit(EXIT_FAILURE);
-  }
+  LOG_TRACE("DATA DIR :: %s ", data_dir.c_str());
 
-  // close the pmem file -- it will remain mapped
-  close(data_fd);
+  // The data does not outlive the process, start with an empty heap. It
+  // grows by another file of the same size whenever it runs full.
+  data_heap.reset(
+      new PersistentHeap(data_dir, DATA_FILE_NAME, data_file_len, false));
 }
 
 StorageManager::~StorageManager() {
   // Check if we need a PMEM pool
   if (peloton_logging_mode != LOGGING_TYPE_NVM_NVM) return;
 
-  // sync and unmap the data file
-  if (data_file_address != nullptr) {
-    // sync the mmap'ed file to SSD or HDD
-    int status = msync(data_file_address, data_file_len, MS_SYNC);
-    if (status != 0) {
-      perror("msync");
-      exit(EXIT_FAILURE);
-    }
-
-    if (munmap(data_file_address, data_file_len) == MAP_FAILED) {
-      perror("munmap");
-      exit(EXIT_FAILURE);
-    }
+  // sync the mmap'ed files, the heap unmaps them
+  if (data_heap != nullptr) {
+    data_heap->SyncSegments();
   }
-
 }
 
 void *StorageManager::Allocate(BackendType type, size_t size) {
   switch (type) {
     case BACKEND_TYPE_MM: {
-      return ::operator new(size);
+      void *address = ::operator new(size);
+      NumaManager::GetInstance().PlaceMemory(address, size);
+      return address;
     } break;
 
     case BACKEND_TYPE_NVM:
     case BACKEND_TYPE_SSD:
     case BACKEND_TYPE_HDD: {
-      {
-        std::lock_guard<std::mutex> pmem_lock(pmem_mutex);
+      if (data_heap == nullptr) return nullptr;
 
-        if (data_file_offset >= data_file_len) return nullptr;
-
-        void *address =
-            reinterpret_cast<char *>(data_file_address) + data_file_offset;
-
-        // offset by requested size
-        data_file_offset += size;
-        return address;
-      }
+      return data_heap->Allocate(size);
     } break;
 
     case BACKEND_TYPE_INVALID:
@@ -205,7 +155,9 @@ void StorageManager::Release(BackendType type, void *address) {
     case BACKEND_TYPE_NVM:
     case BACKEND_TYPE_SSD:
     case BACKEND_TYPE_HDD: {
-      // Nothing to do here
+      if (data_heap != nullptr) {
+        data_heap->Release(address);
+      }
     } break;
 
     case BACKEND_TYPE_INVALID:
@@ -223,19 +175,16 @@ void StorageManager::Sync(BackendType type, void *address, size_t length) {
     } break;
 
     case BACKEND_TYPE_NVM: {
-      // flush writes to NVM
-      pmem_flush_cache(address, length);
-      __builtin_ia32_sfence();
+      // flush writes to NVM, ordered by a single fence
+      PersistentHeap::Persist(address, length);
       clflush_count++;
     } break;
 
     case BACKEND_TYPE_SSD:
     case BACKEND_TYPE_HDD: {
-      // sync the mmap'ed file to SSD or HDD
-      int status = msync(data_file_address, data_file_len, MS_SYNC);
-      if (status != 0) {
-        perror("msync");
-        exit(EXIT_FAILURE);
+      // sync the mmap'ed files to SSD or HDD
+      if (data_heap != nullptr) {
+        data_heap->SyncSegments();
       }
 
       msync_count++;
@@ -12,9 +12,10 @@
 
 #pragma once
 
-#include <mutex>
+#include <memory>
 
 #include "backend/common/types.h"
+#include "backend/storage/persistent_heap.h"
 
 namespace peloton {
 namespace storage {
@@ -42,19 +43,16 @@ class StorageManager {
 
   size_t GetClflushCount() const { return clflush_count; }
 
- private:
-  // pmem file address
-  void *data_file_address;
+  // heap backing the NVM, SSD and HDD backends (nullptr if not needed)
+  PersistentHeap *GetPersistentHeap() const { return data_heap.get(); }
 
-  // pmem file synch mutex
-  std::mutex pmem_mutex;
+ private:
+  // heap over the pmem files
+  std::unique_ptr<PersistentHeap> data_heap;
 
   // pmem file len
   size_t data_file_len;
 
-  // pmem offset
-  size_t data_file_offset;
-
   // stats
   size_t msync_count = 0;
 
@@ -16,9 +16,11 @@
 
 #include "backend/catalog/schema.h"
 #include "backend/common/exception.h"
+#include "backend/common/logger.h"
 #include "backend/common/pool.h"
 #include "backend/common/serializer.h"
 #include "backend/common/types.h"
+#include "backend/storage/compressed_column.h"
 #include "backend/storage/tuple_iterator.h"
 #include "backend/storage/tuple.h"
 #include "backend/storage/storage_manager.h"
@@ -46,7 +48,8 @@ Tile::Tile(BackendType backend_type, TileGroupHeader *tile_header,
       uninlined_data_size(0),
       column_header(NULL),
       column_header_size(INVALID_OID),
-      tile_group_header(tile_header) {
+      tile_group_header(tile_header),
+      frozen(false) {
   assert(tuple_count > 0);
 
   tile_size = tuple_count * tuple_length;
@@ -67,9 +70,12 @@ Tile::Tile(BackendType backend_type, TileGroupHeader *tile_header,
 Tile::~Tile() {
   // reclaim the tile memory (INLINED data)
   auto &storage_manager = storage::StorageManager::GetInstance();
-  storage_manager.Release(backend_type, data);
+  if (data != NULL) storage_manager.Release(backend_type, data);
   data = NULL;
 
+  // the dictionaries keep their uninlined data in the pool
+  compressed_columns.clear();
+
   // reclaim the tile memory (UNINLINED data)
   if (schema.IsInlined() == false) delete pool;
   pool = NULL;
@@ -91,7 +97,7 @@ void Tile::InsertTuple(const oid_t tuple_offset, Tuple *tuple) {
   assert(tuple_offset < GetAllocatedTupleCount());
 
   // Find slot location
-  char *location = tuple_offset * tuple_length + data;
+  char *location = GetTupleLocation(tuple_offset);
 
   // Copy over the tuple data into the tuple slot in the tile
   std::memcpy(location, tuple->tuple_data, tuple_length);
@@ -105,9 +111,14 @@ Value Tile::GetValue(const oid_t tuple_offset, const oid_t column_id) {
   assert(tuple_offset < GetAllocatedTupleCount());
   assert(column_id < schema.GetColumnCount());
 
+  if (frozen == true) {
+    return compressed_columns[column_id]->GetValue(tuple_offset);
+  }
+
   const ValueType column_type = schema.GetType(column_id);
 
-  const char *tuple_location = GetTupleLocation(tuple_offset);
+  // reading does not thaw the tile
+  const char *tuple_location = data + (tuple_offset * tuple_length);
   const char *field_location = tuple_location + schema.GetOffset(column_id);
   const bool is_inlined = schema.IsInlined(column_id);
 
@@ -124,7 +135,16 @@ Value Tile::GetValueFast(const oid_t tuple_offset, const size_t column_offset,
   assert(tuple_offset < GetAllocatedTupleCount());
   assert(column_offset < schema.GetLength());
 
-  const char *tuple_location = GetTupleLocation(tuple_offset);
+  if (frozen == true) {
+    for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+      if (schema.GetOffset(column_itr) == column_offset) {
+        return compressed_columns[column_itr]->GetValue(tuple_offset);
+      }
+    }
+  }
+
+  // reading does not thaw the tile
+  const char *tuple_location = data + (tuple_offset * tuple_length);
   const char *field_location = tuple_location + column_offset;
 
   return Value::InitFromTupleStorage(field_location, column_type, is_inlined);
@@ -168,6 +188,29 @@ void Tile::SetValueFast(const Value &value, const oid_t tuple_offset,
       field_location, is_inlined, column_length, is_in_bytes, pool);
 }
 
+void Tile::FreeUninlinedData(const oid_t tuple_offset) {
+  assert(tuple_offset < num_tuple_slots);
+  // frozen tiles keep no uninlined data per tuple slot
+  if (schema.IsInlined() == true || frozen == true) {
+    return;
+  }
+
+  char *tuple_location = GetTupleLocation(tuple_offset);
+  auto uninlined_column_count = schema.GetUninlinedColumnCount();
+  for (oid_t column_itr = 0; column_itr < uninlined_column_count;
+       column_itr++) {
+    auto column_id = schema.GetUninlinedColumn(column_itr);
+    Varlen **field_location = reinterpret_cast<Varlen **>(
+        tuple_location + schema.GetOffset(column_id));
+
+    // NULL values have no storage
+    if (*field_location != nullptr) {
+      Varlen::Destroy(*field_location, pool);
+      *field_location = nullptr;
+    }
+  }
+}
+
 Tile *Tile::CopyTile(BackendType backend_type) {
   auto schema = GetSchema();
   bool tile_columns_inlined = schema->IsInlined();
@@ -179,7 +222,21 @@ Tile *Tile::CopyTile(BackendType backend_type) {
       backend_type, INVALID_OID, INVALID_OID, INVALID_OID, INVALID_OID,
       new_header, *schema, tile_group, allocated_tuple_count);
 
-  ::memcpy(static_cast<void *>(new_tile->data), static_cast<void *>(data),
+  // copying does not thaw the tile, the values are decoded into the copy
+  if (frozen == true) {
+    auto column_count = schema->GetColumnCount();
+    for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+      for (oid_t tuple_itr = 0; tuple_itr < allocated_tuple_count;
+           tuple_itr++) {
+        new_tile->SetValue(GetValue(tuple_itr, column_itr), tuple_itr,
+                           column_itr);
+      }
+    }
+    return new_tile;
+  }
+
+  ::memcpy(static_cast<void *>(new_tile->data),
+           static_cast<void *>(GetTupleLocation(0)),
            tile_size);
 
   // Do a deep copy if some column is uninlined, so that
@@ -203,6 +260,79 @@ Tile *Tile::CopyTile(BackendType backend_type) {
   return new_tile;
 }
 
+uint32_t Tile::GetSize(size_t allocated, size_t recycled) const {
+  if (frozen == true) {
+    size_t size = 0;
+    for (auto &compressed_column : compressed_columns) {
+      size += compressed_column->GetSize();
+    }
+    return size;
+  }
+  return (allocated - recycled) * tuple_length + uninlined_data_size;
+}
+
+//===--------------------------------------------------------------------===//
+// Compression
+//===--------------------------------------------------------------------===//
+
+void Tile::Freeze() {
+  if (frozen == true) {
+    return;
+  }
+  assert(compressed_columns.empty());
+
+  for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+    compressed_columns.emplace_back(
+        CompressedColumn::Compress(this, column_itr, num_tuple_slots));
+  }
+
+  // the dictionaries have their own copy of the uninlined data
+  for (oid_t tuple_itr = 0; tuple_itr < num_tuple_slots; tuple_itr++) {
+    FreeUninlinedData(tuple_itr);
+  }
+
+  auto &storage_manager = storage::StorageManager::GetInstance();
+  storage_manager.Release(backend_type, data);
+  data = NULL;
+
+  frozen = true;
+}
+
+void Tile::Thaw() {
+  std::lock_guard<std::mutex> lock(thaw_mutex);
+  if (frozen == false) {
+    return;
+  }
+
+  auto &storage_manager = storage::StorageManager::GetInstance();
+  char *new_data = reinterpret_cast<char *>(
+      storage_manager.Allocate(backend_type, tile_size));
+  assert(new_data != NULL);
+  std::memset(new_data, 0, tile_size);
+
+  const bool is_in_bytes = false;
+  for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+    auto compressed_column = compressed_columns[column_itr].get();
+    auto column_offset = schema.GetOffset(column_itr);
+    const bool is_inlined = schema.IsInlined(column_itr);
+    size_t column_length = schema.GetAppropriateLength(column_itr);
+
+    for (oid_t tuple_itr = 0; tuple_itr < num_tuple_slots; tuple_itr++) {
+      char *field_location =
+          new_data + (tuple_itr * tuple_length) + column_offset;
+      compressed_column->GetValue(tuple_itr)
+          .SerializeToTupleStorageAllocateForObjects(
+              field_location, is_inlined, column_length, is_in_bytes, pool);
+    }
+  }
+
+  // readers that see the tile thawed find the tuple slots filled in
+  data = new_data;
+  frozen = false;
+
+  LOG_TRACE("Thawed tile %u of tile group %u", tile_id, tile_group_id);
+}
+
 //===--------------------------------------------------------------------===//
 // Utilities
 //===--------------------------------------------------------------------===//
@@ -221,6 +351,20 @@ const std::string Tile::GetInfo() const {
   os << "\t-----------------------------------------------------------\n";
   os << "\tDATA\n";
 
+  // printing does not thaw the tile
+  if (frozen == true) {
+    for (oid_t tuple_itr = 0; tuple_itr < GetActiveTupleCount(); tuple_itr++) {
+      os << "\t";
+      for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+        os << "(" << compressed_columns[column_itr]->GetValue(tuple_itr)
+           << ")";
+      }
+      os << "\n";
+    }
+    os << "\t-----------------------------------------------------------\n";
+    return os.str();
+  }
+
   TupleIterator tile_itr(this);
   Tuple tuple(&schema);
 
@@ -465,7 +609,8 @@ oid_t Tile::GetActiveTupleCount() const {
 }
 
 void Tile::Sync() {
-  // Sync the tile data
+  // Sync the tile data, frozen tiles live in memory only
+  if (frozen == true) return;
   auto &storage_manager = storage::StorageManager::GetInstance();
   storage_manager.Sync(backend_type, data, tile_size);
 }
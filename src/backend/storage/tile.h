@@ -18,16 +18,108 @@
 #include "backend/common/pool.h"
 #include "backend/common/printable.h"
 
+#include <atomic>
+#include <cassert>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 namespace peloton {
 namespace storage {
 
+//===--------------------------------------------------------------------===//
+// Column Span
+//===--------------------------------------------------------------------===//
+
+// Whether the values of a column type are kept as a T in the tuple slots
+template <typename T>
+inline bool IsStoredAs(ValueType column_type);
+
+template <>
+inline bool IsStoredAs<int8_t>(ValueType column_type) {
+  return (column_type == VALUE_TYPE_TINYINT);
+}
+
+template <>
+inline bool IsStoredAs<int16_t>(ValueType column_type) {
+  return (column_type == VALUE_TYPE_SMALLINT);
+}
+
+template <>
+inline bool IsStoredAs<int32_t>(ValueType column_type) {
+  return (column_type == VALUE_TYPE_INTEGER || column_type == VALUE_TYPE_DATE);
+}
+
+template <>
+inline bool IsStoredAs<int64_t>(ValueType column_type) {
+  return (column_type == VALUE_TYPE_BIGINT ||
+          column_type == VALUE_TYPE_TIMESTAMP);
+}
+
+template <>
+inline bool IsStoredAs<double>(ValueType column_type) {
+  return (column_type == VALUE_TYPE_REAL || column_type == VALUE_TYPE_DOUBLE);
+}
+
+// NULLs are kept as the smallest value of the type
+inline bool IsNullStorage(int8_t value) { return (value == INT8_NULL); }
+
+inline bool IsNullStorage(int16_t value) { return (value == INT16_NULL); }
+
+inline bool IsNullStorage(int32_t value) { return (value == INT32_NULL); }
+
+inline bool IsNullStorage(int64_t value) { return (value == INT64_NULL); }
+
+inline bool IsNullStorage(double value) { return (value <= DOUBLE_NULL); }
+
+/**
+ * Typed view of a fixed length column of a tile. The values are read
+ * straight out of the tuple slots, one stride apart, without building a
+ * Value for each of them.
+ *
+ * An empty span means the column can't be read this way, e.g. because the
+ * tile is frozen. Use GetValue then.
+ */
+template <typename T>
+class ColumnSpan {
+ public:
+  ColumnSpan() : base(nullptr), stride(0), size(0) {}
+
+  ColumnSpan(const char *base, size_t stride, oid_t size)
+      : base(base), stride(stride), size(size) {}
+
+  T operator[](const oid_t tuple_offset) const {
+    assert(tuple_offset < size);
+    return *reinterpret_cast<const T *>(base + tuple_offset * stride);
+  }
+
+  bool IsNull(const oid_t tuple_offset) const {
+    return IsNullStorage((*this)[tuple_offset]);
+  }
+
+  bool IsEmpty() const { return (base == nullptr); }
+
+  // # of tuple slots covered
+  oid_t GetSize() const { return size; }
+
+  // # of bytes from one value to the next
+  size_t GetStride() const { return stride; }
+
+ private:
+  // value in the first tuple slot
+  const char *base;
+
+  size_t stride;
+
+  oid_t size;
+};
+
 //===--------------------------------------------------------------------===//
 // Tile
 //===--------------------------------------------------------------------===//
 
 class Tuple;
+class CompressedColumn;
 class TileGroup;
 class TileGroupHeader;
 class TupleIterator;
@@ -38,6 +130,12 @@ class TupleIterator;
  * Tiles are only instantiated via TileFactory.
  *
  * NOTE: MVCC is implemented on the shared TileGroupHeader.
+ *
+ * A tile can be frozen to save space once its tile group is cold. A frozen
+ * tile keeps every column compressed instead of the tuple slots, values are
+ * decoded when they are read. Anything that needs the tuple slots themselves,
+ * like writing a tuple, thaws the tile back first. The compressed columns stay
+ * around until the tile goes away, for the readers that saw the tile frozen.
  */
 class Tile : public Printable {
   friend class TileFactory;
@@ -87,6 +185,14 @@ class Tile : public Printable {
   Value GetValueFast(const oid_t tuple_offset, const size_t column_offset,
                      const ValueType column_type, const bool is_inlined);
 
+  /**
+   * Typed view of the column over the first tuple_count tuple slots.
+   * Empty if the column is not kept as a T, or the tile is frozen.
+   */
+  template <typename T>
+  ColumnSpan<T> GetColumnSpan(const oid_t column_id,
+                              const oid_t tuple_count) const;
+
   /**
    * Sets value at tuple slot.
    */
@@ -101,6 +207,9 @@ class Tile : public Printable {
                     const size_t column_offset, const bool is_inlined,
                     const size_t column_length);
 
+  // Return the uninlined data of the tuple slot to the pool
+  void FreeUninlinedData(const oid_t tuple_offset);
+
   // Get tuple at location
   static Tuple *GetTuple(catalog::Manager *catalog,
                          const ItemPointer *tuple_location);
@@ -108,6 +217,24 @@ class Tile : public Printable {
   // Copy current tile in given backend and return new tile
   Tile *CopyTile(BackendType backend_type);
 
+  //===--------------------------------------------------------------------===//
+  // Compression
+  //===--------------------------------------------------------------------===//
+
+  // Compress all columns and give up the tuple slots.
+  // NOTE : Only for tiles no other thread can see yet.
+  void Freeze();
+
+  // Get the tuple slots back, safe with concurrent readers
+  void Thaw();
+
+  bool IsFrozen() const { return frozen; }
+
+  // Only valid once the tile was frozen
+  CompressedColumn *GetCompressedColumn(const oid_t column_id) const {
+    return compressed_columns[column_id].get();
+  }
+
   //===--------------------------------------------------------------------===//
   // Size Stats
   //===--------------------------------------------------------------------===//
@@ -118,9 +245,7 @@ class Tile : public Printable {
   int64_t GetUninlinedDataSize() const { return uninlined_data_size; }
 
   // Both inlined and uninlined data
-  uint32_t GetSize(size_t allocated, size_t recycled) const {
-    return (allocated - recycled) * tuple_length + uninlined_data_size;
-  }
+  uint32_t GetSize(size_t allocated, size_t recycled) const;
 
   //===--------------------------------------------------------------------===//
   // Columns
@@ -223,16 +348,43 @@ class Tile : public Printable {
    * This is maintained by shared Tile Header.
    */
   TileGroupHeader *tile_group_header;
+
+  // Set while the columns are compressed and there are no tuple slots
+  std::atomic<bool> frozen;
+
+  std::vector<std::unique_ptr<CompressedColumn>> compressed_columns;
+
+  std::mutex thaw_mutex;
 };
 
 // Returns a pointer to the tuple requested. No checks are done that the index
 // is valid.
 inline char *Tile::GetTupleLocation(const oid_t tuple_offset) const {
+  // the caller may write the tuple slot
+  if (frozen == true) {
+    const_cast<Tile *>(this)->Thaw();
+  }
+
   char *tuple_location = data + (tuple_offset * tuple_length);
 
   return tuple_location;
 }
 
+template <typename T>
+ColumnSpan<T> Tile::GetColumnSpan(const oid_t column_id,
+                                  const oid_t tuple_count) const {
+  assert(column_id < schema.GetColumnCount());
+  assert(tuple_count <= num_tuple_slots);
+
+  // thawing only ever swaps in the tuple slots, they stay put afterwards
+  if (frozen == true || IsStoredAs<T>(schema.GetType(column_id)) == false) {
+    return ColumnSpan<T>();
+  }
+
+  return ColumnSpan<T>(data + schema.GetOffset(column_id), tuple_length,
+                       tuple_count);
+}
+
 // Finds index of tuple for a given tuple address.
 // Returns -1 if no matching tuple was found
 inline int Tile::GetTupleOffset(const char *tuple_address) const {
@@ -22,6 +22,7 @@
 #include "backend/storage/tile.h"
 #include "backend/storage/tuple.h"
 #include "backend/storage/tile_group_header.h"
+#include "backend/storage/zone_map.h"
 
 namespace peloton {
 namespace storage {
@@ -38,7 +39,9 @@ TileGroup::TileGroup(BackendType backend_type,
       tile_group_header(tile_group_header),
       table(table),
       num_tuple_slots(tuple_count),
-      column_map(column_map) {
+      column_map(column_map),
+      zone_map(new ZoneMap(tile_schemas, column_map)),
+      is_replaced(false) {
   tile_count = tile_schemas.size();
 
   for (oid_t tile_itr = 0; tile_itr < tile_count; tile_itr++) {
@@ -52,6 +55,21 @@ TileGroup::TileGroup(BackendType backend_type,
     // Add a reference to the tile in the tile group
     tiles.push_back(tile);
   }
+
+  column_locations.resize(column_map.size());
+  for (auto entry : column_map) {
+    auto &column_location = column_locations[entry.first];
+    auto tile_offset = entry.second.first;
+    auto tile_column_offset = entry.second.second;
+    auto &schema = tile_schemas[tile_offset];
+
+    column_location.tile = tiles[tile_offset].get();
+    column_location.tile_offset = tile_offset;
+    column_location.tile_column_offset = tile_column_offset;
+    column_location.column_offset = schema.GetOffset(tile_column_offset);
+    column_location.column_type = schema.GetType(tile_column_offset);
+    column_location.is_inlined = schema.IsInlined(tile_column_offset);
+  }
 }
 
 TileGroup::~TileGroup() {
@@ -101,6 +119,12 @@ uint64_t TileGroup::GetMemoryFootprint(const size_t recycled_slot_count) const {
 // Operations
 //===--------------------------------------------------------------------===//
 
+void TileGroup::FreeUninlinedData(const oid_t &tuple_slot_id) {
+  for (oid_t tile_itr = 0; tile_itr < tile_count; tile_itr++) {
+    GetTile(tile_itr)->FreeUninlinedData(tuple_slot_id);
+  }
+}
+
 /**
  * Grab next slot (thread-safe) and fill in the tuple
  *
@@ -132,6 +156,8 @@ void TileGroup::CopyTuple(const Tuple *tuple, const oid_t &tuple_slot_id) {
       column_itr++;
     }
   }
+
+  zone_map->Update(this, tuple_slot_id);
 }
 
 void TileGroup::CopyTuple(const oid_t &tuple_slot_id, Tuple *tuple) {
@@ -186,6 +212,8 @@ oid_t TileGroup::InsertTuple(const Tuple *tuple) {
     }
   }
 
+  zone_map->Update(this, tuple_slot_id);
+
   //  // Set MVCC info
   assert(tile_group_header->GetTransactionId(tuple_slot_id) == INVALID_TXN_ID);
   assert(tile_group_header->GetBeginCommitId(tuple_slot_id) == MAX_CID);
@@ -244,6 +272,8 @@ oid_t TileGroup::InsertTupleFromRecovery(cid_t commit_id, oid_t tuple_slot_id,
   tile_group_header->SetDeleteCommit(tuple_slot_id, false);
   tile_group_header->SetNextItemPointer(tuple_slot_id, INVALID_ITEMPOINTER);
 
+  zone_map->Update(this, tuple_slot_id);
+
   return tuple_slot_id;
 }
 
@@ -332,19 +362,9 @@ oid_t TileGroup::InsertTupleFromCheckpoint(oid_t tuple_slot_id,
   tile_group_header->SetDeleteCommit(tuple_slot_id, false);
   tile_group_header->SetNextItemPointer(tuple_slot_id, INVALID_ITEMPOINTER);
 
-  return tuple_slot_id;
-}
-
-// Sets the tile id and column id w.r.t that tile corresponding to
-// the specified tile group column id.
-void TileGroup::LocateTileAndColumn(oid_t column_offset, oid_t &tile_offset,
-                                    oid_t &tile_column_offset) {
-  assert(column_map.count(column_offset) != 0);
+  zone_map->Update(this, tuple_slot_id);
 
-  // get the entry in the column map
-  auto entry = column_map.at(column_offset);
-  tile_offset = entry.first;
-  tile_column_offset = entry.second;
+  return tuple_slot_id;
 }
 
 oid_t TileGroup::GetTileIdFromColumnId(oid_t column_id) {
@@ -361,9 +381,16 @@ oid_t TileGroup::GetTileColumnId(oid_t column_id) {
 
 Value TileGroup::GetValue(oid_t tuple_id, oid_t column_id) {
   assert(tuple_id < GetNextTupleSlot());
-  oid_t tile_column_id, tile_offset;
-  LocateTileAndColumn(column_id, tile_offset, tile_column_id);
-  return GetTile(tile_offset)->GetValue(tuple_id, tile_column_id);
+  auto &column_location = GetColumnLocation(column_id);
+  auto tile = column_location.tile;
+
+  if (tile->IsFrozen() == true) {
+    return tile->GetValue(tuple_id, column_location.tile_column_offset);
+  }
+
+  return tile->GetValueFast(tuple_id, column_location.column_offset,
+                            column_location.column_type,
+                            column_location.is_inlined);
 }
 
 Tile *TileGroup::GetTile(const oid_t tile_offset) const {
@@ -405,6 +432,21 @@ void TileGroup::Sync() {
   }
 }
 
+void TileGroup::Freeze() {
+  for (auto tile : tiles) {
+    tile->Freeze();
+  }
+}
+
+bool TileGroup::IsFrozen() const {
+  for (auto &tile : tiles) {
+    if (tile->IsFrozen() == true) {
+      return true;
+    }
+  }
+  return false;
+}
+
 //===--------------------------------------------------------------------===//
 // Utilities
 //===--------------------------------------------------------------------===//
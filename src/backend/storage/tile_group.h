@@ -42,9 +42,27 @@ class Tile;
 class TileGroupHeader;
 class AbstractTable;
 class TileGroupIterator;
+class ZoneMap;
 
 typedef std::map<oid_t, std::pair<oid_t, oid_t>> column_map_type;
 
+// Where a column of a tile group lives, flattened out of the column map
+struct ColumnLocation {
+  // tile holding the column
+  Tile *tile;
+
+  oid_t tile_offset;
+
+  oid_t tile_column_offset;
+
+  // offset of the column within the tuple slot of the tile
+  size_t column_offset;
+
+  ValueType column_type;
+
+  bool is_inlined;
+};
+
 /**
  * Represents a group of tiles logically horizontally contiguous.
  *
@@ -78,6 +96,9 @@ class TileGroup : public Printable {
 
   void CopyTuple(const oid_t &tuple_slot_id, Tuple *tuple);
 
+  // return the uninlined data of a reclaimed tuple slot to the tile pools
+  void FreeUninlinedData(const oid_t &tuple_slot_id);
+
   // insert tuple at next available slot in tile if a slot exists
   oid_t InsertTuple(const Tuple *tuple);
 
@@ -147,8 +168,20 @@ class TileGroup : public Printable {
 
   size_t GetTileCount() const { return tile_count; }
 
+  // Sets the tile id and column id w.r.t that tile corresponding to
+  // the specified tile group column id.
   void LocateTileAndColumn(oid_t column_offset, oid_t &tile_offset,
-                           oid_t &tile_column_offset);
+                           oid_t &tile_column_offset) const {
+    assert(column_offset < column_locations.size());
+    auto &column_location = column_locations[column_offset];
+    tile_offset = column_location.tile_offset;
+    tile_column_offset = column_location.tile_column_offset;
+  }
+
+  const ColumnLocation &GetColumnLocation(oid_t column_offset) const {
+    assert(column_offset < column_locations.size());
+    return column_locations[column_offset];
+  }
 
   oid_t GetTileIdFromColumnId(oid_t column_id);
 
@@ -159,6 +192,23 @@ class TileGroup : public Printable {
   double GetSchemaDifference(const storage::column_map_type &new_column_map);
 
   uint64_t GetMemoryFootprint(const size_t) const;
+
+  // Freeze all tiles, see Tile::Freeze.
+  // NOTE : Only for tile groups no other thread can see yet.
+  void Freeze();
+
+  // Whether any of the tiles is still frozen
+  bool IsFrozen() const;
+
+  // Whether the catalog points to a copy of the tile group instead, see
+  // DataTable::SwapTileGroup
+  bool IsReplaced() const { return is_replaced.load(); }
+
+  void SetReplaced() { is_replaced = true; }
+
+  // Min/max synopses of the columns, see ZoneMap
+  ZoneMap *GetZoneMap() const { return zone_map.get(); }
+
   // Sync the contents
   void Sync();
 
@@ -198,6 +248,15 @@ class TileGroup : public Printable {
   // column to tile mapping :
   // <column offset> to <tile offset, tile column offset>
   column_map_type column_map;
+
+  // column map laid out by column offset, so finding a column is a lookup
+  std::vector<ColumnLocation> column_locations;
+
+  // synopses of the values written to the tile group
+  std::unique_ptr<ZoneMap> zone_map;
+
+  // set once a copy of the tile group took its place in the catalog
+  std::atomic<bool> is_replaced;
 };
 
 }  // End storage namespace
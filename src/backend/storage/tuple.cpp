@@ -207,35 +207,64 @@ void Tuple::DeserializeFrom(SerializeInputBE &input, VarlenPool *dataPool) {
   const int column_count = tuple_schema->GetColumnCount();
 
   for (int column_itr = 0; column_itr < column_count; column_itr++) {
-    const ValueType type = tuple_schema->GetType(column_itr);
+    DeserializeColumnFrom(input, dataPool, column_itr);
+  }
+}
 
-    /**
-     * DeserializeFrom is only called when we serialize/deserialize tables.
-     * The serialization format for Strings/Objects in a serialized table
-     * happens to have the same in memory representation as the Strings/Objects
-     * in a Tuple. The goal here is to wrap the serialized representation of
-     * the value in an Value and then serialize that into the tuple from the
-     * Value. This makes it possible to push more value specific functionality
-     * out of Tuple. The memory allocation will be performed when serializing
-     * to tuple storage.
-     */
-    const bool is_inlined = tuple_schema->IsInlined(column_itr);
-    int32_t column_length;
-    char *data_ptr = GetDataPtr(column_itr);
+void Tuple::DeserializeColumnsFrom(SerializeInputBE &input,
+                                   VarlenPool *dataPool,
+                                   std::vector<oid_t> &columns) {
+  assert(tuple_schema);
+  assert(tuple_data);
 
-    if (is_inlined) {
-      column_length = tuple_schema->GetLength(column_itr);
-    } else {
-      column_length = tuple_schema->GetVariableLength(column_itr);
+  input.ReadInt();
+  const oid_t column_count = input.ReadInt();
+  const oid_t schema_column_count = tuple_schema->GetColumnCount();
+  columns.clear();
+  columns.reserve(column_count);
+
+  for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+    oid_t column_id = input.ReadInt();
+    if (column_id >= schema_column_count) {
+      throw SerializationException("Column id out of range in delta tuple");
     }
 
-    // TODO: Not sure about arguments
-    const bool is_in_bytes = false;
-    Value::DeserializeFrom(input, dataPool, data_ptr, type, is_inlined,
-                           column_length, is_in_bytes);
+    DeserializeColumnFrom(input, dataPool, column_id);
+    columns.push_back(column_id);
   }
 }
 
+void Tuple::DeserializeColumnFrom(SerializeInputBE &input,
+                                  VarlenPool *dataPool,
+                                  const oid_t column_id) {
+  const ValueType type = tuple_schema->GetType(column_id);
+
+  /**
+   * DeserializeFrom is only called when we serialize/deserialize tables.
+   * The serialization format for Strings/Objects in a serialized table
+   * happens to have the same in memory representation as the Strings/Objects
+   * in a Tuple. The goal here is to wrap the serialized representation of
+   * the value in an Value and then serialize that into the tuple from the
+   * Value. This makes it possible to push more value specific functionality
+   * out of Tuple. The memory allocation will be performed when serializing
+   * to tuple storage.
+   */
+  const bool is_inlined = tuple_schema->IsInlined(column_id);
+  int32_t column_length;
+  char *data_ptr = GetDataPtr(column_id);
+
+  if (is_inlined) {
+    column_length = tuple_schema->GetLength(column_id);
+  } else {
+    column_length = tuple_schema->GetVariableLength(column_id);
+  }
+
+  // TODO: Not sure about arguments
+  const bool is_in_bytes = false;
+  Value::DeserializeFrom(input, dataPool, data_ptr, type, is_inlined,
+                         column_length, is_in_bytes);
+}
+
 void Tuple::DeserializeWithHeaderFrom(SerializeInputBE &input) {
   assert(tuple_schema);
   assert(tuple_data);
@@ -292,6 +321,21 @@ void Tuple::SerializeTo(SerializeOutput &output) {
       start, static_cast<int32_t>(output.Position() - start - sizeof(int32_t)));
 }
 
+void Tuple::SerializeColumnsTo(SerializeOutput &output,
+                               const std::vector<oid_t> &columns) {
+  size_t start = output.ReserveBytes(4);
+  output.WriteInt(static_cast<int32_t>(columns.size()));
+
+  for (auto column_id : columns) {
+    output.WriteInt(static_cast<int32_t>(column_id));
+    Value value = GetValue(column_id);
+    value.SerializeTo(output);
+  }
+
+  output.WriteIntAt(
+      start, static_cast<int32_t>(output.Position() - start - sizeof(int32_t)));
+}
+
 void Tuple::SerializeToExport(ExportSerializeOutput &output, int colOffset,
                               uint8_t *null_array) {
   const int column_count = GetColumnCount();
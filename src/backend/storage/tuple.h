@@ -174,7 +174,15 @@ class Tuple : public AbstractTuple {
                          uint8_t *null_array);
   void SerializeWithHeaderTo(SerializeOutput &output);
 
+  // Serialize only the given columns, prefixed with their ids
+  void SerializeColumnsTo(SerializeOutput &output,
+                          const std::vector<oid_t> &columns);
+
   void DeserializeFrom(SerializeInputBE &input, VarlenPool *pool);
+
+  // Inverse of SerializeColumnsTo; the column ids read are returned in columns
+  void DeserializeColumnsFrom(SerializeInputBE &input, VarlenPool *pool,
+                              std::vector<oid_t> &columns);
   void DeserializeWithHeaderFrom(SerializeInputBE &input);
 
   size_t HashCode(size_t seed) const;
@@ -187,6 +195,9 @@ class Tuple : public AbstractTuple {
   const std::string GetInfo() const;
 
  private:
+  void DeserializeColumnFrom(SerializeInputBE &input, VarlenPool *pool,
+                             const oid_t column_id);
+
   char *GetDataPtr(const oid_t column_id);
 
   const char *GetDataPtr(const oid_t column_id) const;
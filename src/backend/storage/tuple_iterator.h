@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include "backend/common/iterator.h"
 #include "backend/storage/tuple.h"
 #include "backend/storage/tile.h"
@@ -27,21 +29,31 @@ namespace storage {
 /**
  * Iterator for tile which goes over all active tuples within
  * a single tile.
+ *
+ * Iterating does not thaw a frozen tile, the iterator walks a copy of it
+ * instead.
  **/
 class TupleIterator : public Iterator<Tuple> {
   TupleIterator() = delete;
 
  public:
   TupleIterator(const Tile *tile)
-      : data(tile->data),
-        tile(tile),
-        tuple_itr(0),
-        tuple_length(tile->tuple_length) {
+      : tile(tile), tuple_itr(0), tuple_length(tile->tuple_length) {
     tile_group_header = tile->tile_group_header;
+
+    // tiles are only ever thawed once they are visible, so a tile that is
+    // not frozen now keeps its tuple slots
+    if (tile->IsFrozen() == true) {
+      tile_copy.reset(const_cast<Tile *>(tile)->CopyTile(tile->backend_type));
+      data = tile_copy->GetTupleLocation(0);
+    } else {
+      data = tile->GetTupleLocation(0);
+    }
   }
 
   TupleIterator(const TupleIterator &other)
       : data(other.data),
+        tile_copy(other.tile_copy),
         tile(other.tile),
         tile_group_header(other.tile_group_header),
         tuple_itr(other.tuple_itr),
@@ -70,6 +82,9 @@ class TupleIterator : public Iterator<Tuple> {
   // Base tile data
   char *data;
 
+  // Thawed copy of a frozen tile, shared by the copies of the iterator
+  std::shared_ptr<Tile> tile_copy;
+
   const Tile *tile;
 
   const TileGroupHeader *tile_group_header;
@@ -0,0 +1,236 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// zone_map.cpp
+//
+// Identification: src/backend/storage/zone_map.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "backend/storage/zone_map.h"
+
+#include <sstream>
+
+#include "backend/catalog/schema.h"
+#include "backend/common/logger.h"
+#include "backend/storage/tile_group.h"
+
+namespace peloton {
+namespace storage {
+
+ZoneMap::ZoneMap(const std::vector<catalog::Schema> &tile_schemas,
+                 const column_map_type &column_map)
+    : column_synopses(column_map.size()) {
+  for (auto entry : column_map) {
+    auto &schema = tile_schemas[entry.second.first];
+
+    // Values of the other types point into the tile
+    switch (schema.GetType(entry.second.second)) {
+      case VALUE_TYPE_TINYINT:
+      case VALUE_TYPE_SMALLINT:
+      case VALUE_TYPE_INTEGER:
+      case VALUE_TYPE_BIGINT:
+      case VALUE_TYPE_REAL:
+      case VALUE_TYPE_DOUBLE:
+      case VALUE_TYPE_DATE:
+      case VALUE_TYPE_TIMESTAMP:
+      case VALUE_TYPE_DECIMAL:
+      case VALUE_TYPE_BOOLEAN:
+        column_synopses[entry.first].is_tracked = true;
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+void ZoneMap::Update(TileGroup *tile_group, const oid_t tuple_slot_id) {
+  std::vector<Value> values;
+  ReadValues(tile_group, tuple_slot_id, values);
+
+  zone_map_lock.Lock();
+
+  for (oid_t column_itr = 0; column_itr < column_synopses.size();
+       column_itr++) {
+    if (column_synopses[column_itr].is_tracked == true) {
+      Widen(column_synopses[column_itr], values[column_itr]);
+    }
+  }
+  update_count++;
+
+  zone_map_lock.Unlock();
+}
+
+bool ZoneMap::Recompute(TileGroup *tile_group) {
+  zone_map_lock.Lock();
+  auto start_update_count = update_count;
+  std::vector<ColumnSynopsis> new_column_synopses(column_synopses.size());
+  for (oid_t column_itr = 0; column_itr < column_synopses.size();
+       column_itr++) {
+    new_column_synopses[column_itr].is_tracked =
+        column_synopses[column_itr].is_tracked;
+  }
+  zone_map_lock.Unlock();
+
+  // Writers update the zone map after writing the tuple, so the values of
+  // tuples written before the count was read are seen here, and any other
+  // write changes the count. Reclaimed slots keep their values until reused.
+  oid_t next_tuple_slot = tile_group->GetNextTupleSlot();
+  std::vector<Value> values;
+
+  for (oid_t tuple_slot_id = 0; tuple_slot_id < next_tuple_slot;
+       tuple_slot_id++) {
+    ReadValues(tile_group, tuple_slot_id, values);
+    for (oid_t column_itr = 0; column_itr < new_column_synopses.size();
+         column_itr++) {
+      if (new_column_synopses[column_itr].is_tracked == true) {
+        Widen(new_column_synopses[column_itr], values[column_itr]);
+      }
+    }
+  }
+
+  zone_map_lock.Lock();
+  bool status = (update_count == start_update_count);
+  if (status == true) {
+    column_synopses = std::move(new_column_synopses);
+    recompute_update_count = update_count;
+  }
+  zone_map_lock.Unlock();
+
+  if (status == false) {
+    LOG_TRACE("Tile group %u was written while recomputing its zone map",
+              tile_group->GetTileGroupId());
+  }
+
+  return status;
+}
+
+bool ZoneMap::NeedsRecompute() const {
+  zone_map_lock.Lock();
+  bool status = (update_count != recompute_update_count);
+  zone_map_lock.Unlock();
+  return status;
+}
+
+bool ZoneMap::MightMatch(const oid_t column_id, ExpressionType comparison,
+                         const Value &constant) const {
+  if (column_synopses[column_id].is_tracked == false) {
+    return true;
+  }
+
+  // Comparing with NULL is never true
+  if (constant.IsNull() == true) {
+    return false;
+  }
+
+  zone_map_lock.Lock();
+  auto &synopsis = column_synopses[column_id];
+  if (synopsis.has_values == false) {
+    zone_map_lock.Unlock();
+    return false;
+  }
+  int min_compare = synopsis.min_value.CompareWithoutNull(constant);
+  int max_compare = synopsis.max_value.CompareWithoutNull(constant);
+  zone_map_lock.Unlock();
+
+  switch (comparison) {
+    case EXPRESSION_TYPE_COMPARE_EQUAL:
+      return (min_compare <= 0 && max_compare >= 0);
+    case EXPRESSION_TYPE_COMPARE_NOTEQUAL:
+      return (min_compare != 0 || max_compare != 0);
+    case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+      return (min_compare < 0);
+    case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+      return (min_compare <= 0);
+    case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+      return (max_compare > 0);
+    case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+      return (max_compare >= 0);
+    default:
+      return true;
+  }
+}
+
+Value ZoneMap::GetMinValue(const oid_t column_id) const {
+  zone_map_lock.Lock();
+  auto &synopsis = column_synopses[column_id];
+  Value min_value = (synopsis.has_values == true)
+                        ? synopsis.min_value
+                        : Value::GetNullValue(VALUE_TYPE_INTEGER);
+  zone_map_lock.Unlock();
+  return min_value;
+}
+
+Value ZoneMap::GetMaxValue(const oid_t column_id) const {
+  zone_map_lock.Lock();
+  auto &synopsis = column_synopses[column_id];
+  Value max_value = (synopsis.has_values == true)
+                        ? synopsis.max_value
+                        : Value::GetNullValue(VALUE_TYPE_INTEGER);
+  zone_map_lock.Unlock();
+  return max_value;
+}
+
+oid_t ZoneMap::GetNullCount(const oid_t column_id) const {
+  zone_map_lock.Lock();
+  oid_t null_count = column_synopses[column_id].null_count;
+  zone_map_lock.Unlock();
+  return null_count;
+}
+
+void ZoneMap::Widen(ColumnSynopsis &synopsis, const Value &value) {
+  if (value.IsNull() == true) {
+    synopsis.null_count++;
+  } else if (synopsis.has_values == false) {
+    synopsis.min_value = value;
+    synopsis.max_value = value;
+    synopsis.has_values = true;
+  } else if (value.CompareWithoutNull(synopsis.min_value) < 0) {
+    synopsis.min_value = value;
+  } else if (value.CompareWithoutNull(synopsis.max_value) > 0) {
+    synopsis.max_value = value;
+  }
+}
+
+void ZoneMap::ReadValues(TileGroup *tile_group, const oid_t tuple_slot_id,
+                         std::vector<Value> &values) const {
+  values.resize(column_synopses.size());
+  for (oid_t column_itr = 0; column_itr < column_synopses.size();
+       column_itr++) {
+    if (column_synopses[column_itr].is_tracked == true) {
+      values[column_itr] = tile_group->GetValue(tuple_slot_id, column_itr);
+    }
+  }
+}
+
+const std::string ZoneMap::GetInfo() const {
+  std::ostringstream os;
+
+  os << "\tZONE MAP :\n";
+
+  zone_map_lock.Lock();
+  for (oid_t column_itr = 0; column_itr < column_synopses.size();
+       column_itr++) {
+    auto &synopsis = column_synopses[column_itr];
+    os << "\t Column " << column_itr << " :: ";
+    if (synopsis.is_tracked == false) {
+      os << "not tracked\n";
+      continue;
+    }
+    if (synopsis.has_values == true) {
+      os << "[" << synopsis.min_value << ", " << synopsis.max_value << "]";
+    } else {
+      os << "[]";
+    }
+    os << " NULLs : " << synopsis.null_count << "\n";
+  }
+  zone_map_lock.Unlock();
+
+  return os.str();
+}
+
+}  // End storage namespace
+}  // End peloton namespace
@@ -0,0 +1,120 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// zone_map.h
+//
+// Identification: src/backend/storage/zone_map.h
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "backend/common/platform.h"
+#include "backend/common/types.h"
+#include "backend/common/value.h"
+
+namespace peloton {
+
+namespace catalog {
+class Schema;
+}
+
+namespace storage {
+
+class TileGroup;
+
+typedef std::map<oid_t, std::pair<oid_t, oid_t>> column_map_type;
+
+//===--------------------------------------------------------------------===//
+// Zone Map
+//===--------------------------------------------------------------------===//
+
+/**
+ * Smallest and largest value and # of NULLs of every column of a tile group.
+ *
+ * The synopses only ever widen as tuples are written. Deleted versions stay
+ * in them until their slots are reused and the synopses are recomputed from
+ * what is left in the slots. So they may cover values that are not in the
+ * tile group anymore, but never miss one. Only columns of fixed length are
+ * tracked.
+ */
+class ZoneMap {
+  ZoneMap() = delete;
+  ZoneMap(ZoneMap const &) = delete;
+
+ public:
+  ZoneMap(const std::vector<catalog::Schema> &tile_schemas,
+          const column_map_type &column_map);
+
+  // Widen the synopses with the values in the tuple slot
+  void Update(TileGroup *tile_group, const oid_t tuple_slot_id);
+
+  // Rebuild the synopses from the values in the slots. Gives up and returns
+  // false if a tuple is written in the meantime.
+  bool Recompute(TileGroup *tile_group);
+
+  // Whether tuples were written since the last recomputation
+  bool NeedsRecompute() const;
+
+  // Whether "value <comparison> constant" might hold for some tuple
+  bool MightMatch(const oid_t column_id, ExpressionType comparison,
+                  const Value &constant) const;
+
+  bool IsTracked(const oid_t column_id) const {
+    return column_synopses[column_id].is_tracked;
+  }
+
+  // NULL if the column has no values, or is not tracked
+  Value GetMinValue(const oid_t column_id) const;
+
+  Value GetMaxValue(const oid_t column_id) const;
+
+  oid_t GetNullCount(const oid_t column_id) const;
+
+  // Get a string representation for debugging
+  const std::string GetInfo() const;
+
+ private:
+  struct ColumnSynopsis {
+    bool is_tracked = false;
+
+    // false until a value that is not NULL is seen
+    bool has_values = false;
+
+    Value min_value;
+
+    Value max_value;
+
+    oid_t null_count = 0;
+  };
+
+  // Widen a synopsis with a single value
+  static void Widen(ColumnSynopsis &synopsis, const Value &value);
+
+  // Read the tracked columns of a tuple slot
+  void ReadValues(TileGroup *tile_group, const oid_t tuple_slot_id,
+                  std::vector<Value> &values) const;
+
+  //===--------------------------------------------------------------------===//
+  // Data members
+  //===--------------------------------------------------------------------===//
+
+  std::vector<ColumnSynopsis> column_synopses;
+
+  // # of updates so far, tells a recomputation it missed a write
+  size_t update_count = 0;
+
+  // # of updates when last recomputed
+  size_t recompute_update_count = 0;
+
+  mutable Spinlock zone_map_lock;
+};
+
+}  // End storage namespace
+}  // End peloton namespace
@@ -36,6 +36,9 @@
 #include "backend/logging/log_manager.h"
 #include "backend/planner/seq_scan_plan.h"
 #include "backend/gc/gc_manager_factory.h"
+#include "backend/gc/tile_group_compactor.h"
+#include "backend/brain/layout_tuner.h"
+#include "backend/storage/data_table.h"
 
 #include "postgres.h"
 #include "c.h"
@@ -133,6 +136,16 @@ peloton_bootstrap() {
     // start GC as per configuration
     peloton::gc::GCManagerFactory::Configure(peloton_gc_mode);
     peloton::gc::GCManagerFactory::GetInstance().StartGC();
+
+    // reclaim the sparse tile groups the gc leaves behind
+    if (peloton_compaction == true) {
+      peloton::gc::TileGroupCompactor::GetInstance().StartCompaction();
+    }
+
+    // adapt the tile group layouts to the workload in hybrid mode
+    if (peloton_layout_mode == LAYOUT_HYBRID) {
+      peloton::brain::LayoutTuner::GetInstance().StartTuning();
+    }
   }
   catch(const std::exception &exception) {
     elog(ERROR, "Peloton exception :: %s", exception.what());
@@ -434,7 +434,8 @@ typedef enum GCType
   GC_TYPE_OFF, /* No GC */
   GC_TYPE_VACUUM, /* Periodic vacuuming thread */
   GC_TYPE_COOPERATIVE, /* No separate thread for GC */
-  GC_TYPE_EPOCH /* Epoch based co-operative GC */
+  GC_TYPE_EPOCH, /* Epoch based co-operative GC */
+  GC_TYPE_PARALLEL_VACUUM /* Sharded vacuuming threads */
 } GCType;
 
 static const struct config_enum_entry peloton_gc_mode_options[] = {
@@ -442,6 +443,7 @@ static const struct config_enum_entry peloton_gc_mode_options[] = {
   {"vacuum", GC_TYPE_VACUUM, false},
   {"cooperative", GC_TYPE_COOPERATIVE, false},
   {"epoch", GC_TYPE_EPOCH, false},
+  {"parallel", GC_TYPE_PARALLEL_VACUUM, false},
   {NULL, 0, false}
 };
 
@@ -531,6 +533,9 @@ LoggingType     peloton_logging_mode;
 // GC mode
 GCType      peloton_gc_mode;
 
+// Compact sparse tile groups and freeze cold ones
+bool        peloton_compaction;
+
 // Checkpoint mode
 CheckpointType     peloton_checkpoint_mode;
 
@@ -1721,6 +1726,15 @@ struct config_bool ConfigureNamesBool[] =
 		false,
 		NULL, NULL, NULL
 	},
+	{
+		{"peloton_compaction", PGC_USERSET, PELOTON_GC_OPTIONS,
+			gettext_noop("Compacts sparse tile groups and freezes cold ones."),
+			gettext_noop("Needs a gc mode other than off.")
+		},
+		&peloton_compaction,
+		false,
+		NULL, NULL, NULL
+	},
 
 	/* End-of-list marker */
 	{
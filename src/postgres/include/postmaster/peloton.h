@@ -30,6 +30,7 @@
 
 extern LoggingType peloton_logging_mode;
 extern GCType peloton_gc_mode;
+extern bool peloton_compaction;
 
 //===--------------------------------------------------------------------===//
 // Peloton_Status     Sent by the peloton to share the status with backend.
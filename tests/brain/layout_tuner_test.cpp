@@ -0,0 +1,121 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// layout_tuner_test.cpp
+//
+// Identification: tests/brain/layout_tuner_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+
+#include "harness.h"
+
+#include "backend/brain/layout_tuner.h"
+#include "backend/common/value_factory.h"
+#include "backend/concurrency/transaction_manager_factory.h"
+#include "backend/expression/comparison_expression.h"
+#include "backend/expression/constant_value_expression.h"
+#include "backend/expression/tuple_value_expression.h"
+#include "backend/storage/data_table.h"
+#include "backend/storage/tile_group.h"
+#include "backend/storage/tile_group_header.h"
+
+#include "executor/executor_tests_util.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Layout Tuner Tests
+//===--------------------------------------------------------------------===//
+
+class LayoutTunerTests : public PelotonTest {};
+
+TEST_F(LayoutTunerTests, BasicTest) {
+  const int tuple_count = TESTS_TUPLES_PER_TILEGROUP;
+
+  // Two full tile groups and one still taking inserts
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  txn_manager.BeginTransaction();
+  std::unique_ptr<storage::DataTable> data_table(
+      ExecutorTestsUtil::CreateTable(tuple_count, false));
+  ExecutorTestsUtil::PopulateTable(data_table.get(),
+                                   tuple_count * 2 + tuple_count / 2, false,
+                                   false, false);
+  txn_manager.CommitTransaction();
+  EXPECT_EQ(data_table->GetTileGroupCount(), 3);
+
+  brain::LayoutTuner layout_tuner;
+
+  // Scans are only sampled while the tuner runs
+  std::vector<oid_t> column_ids = {1};
+  expression::TupleValueExpression *tup_val_exp =
+      new expression::TupleValueExpression(VALUE_TYPE_INTEGER, 0, 0);
+  expression::ConstantValueExpression *const_val_exp =
+      new expression::ConstantValueExpression(
+          ValueFactory::GetIntegerValue(10));
+  std::unique_ptr<expression::AbstractExpression> predicate(
+      new expression::ComparisonExpression<expression::CmpLt>(
+          EXPRESSION_TYPE_COMPARE_LESSTHAN, tup_val_exp, const_val_exp));
+
+  layout_tuner.RecordScan(data_table.get(), column_ids, predicate.get());
+  EXPECT_EQ(data_table->GetSampleCount(), 0);
+
+  layout_tuner.StartTuning();
+  for (int scan_itr = 0;
+       scan_itr < LAYOUT_TUNER_SAMPLE_RATE * LAYOUT_TUNER_MIN_SAMPLE_COUNT;
+       scan_itr++) {
+    layout_tuner.RecordScan(data_table.get(), column_ids, predicate.get());
+  }
+  layout_tuner.StopTuning();
+  EXPECT_EQ(data_table->GetSampleCount(), LAYOUT_TUNER_MIN_SAMPLE_COUNT);
+
+  // A version being written keeps its tile group as it is
+  auto second_header = data_table->GetTileGroup(1)->GetHeader();
+  second_header->SetTransactionId(0, START_TXN_ID);
+
+  EXPECT_EQ(layout_tuner.TuneTable(data_table.get(), 10.0), 1);
+  EXPECT_EQ(layout_tuner.GetPartitionUpdateCount(), 1);
+  EXPECT_EQ(data_table->GetSampleCount(), 0);
+
+  // The scanned columns end up in a tile of their own
+  auto &column_map = data_table->GetDefaultPartition();
+  EXPECT_EQ(column_map.at(0).first, 0);
+  EXPECT_EQ(column_map.at(1).first, 0);
+  EXPECT_NE(column_map.at(2).first, 0);
+  EXPECT_NE(column_map.at(3).first, 0);
+
+  auto tile_group = data_table->GetTileGroup(0);
+  EXPECT_GT(tile_group->GetTileCount(), 1);
+  EXPECT_EQ(data_table->GetTileGroup(1)->GetTileCount(), 1);
+  EXPECT_EQ(data_table->GetTileGroup(2)->GetTileCount(), 1);
+
+  // Same versions, unlocked again
+  auto tile_group_header = tile_group->GetHeader();
+  for (oid_t tuple_id = 0; tuple_id < (oid_t)tuple_count; tuple_id++) {
+    EXPECT_EQ(tile_group_header->GetTransactionId(tuple_id), INITIAL_TXN_ID);
+    EXPECT_EQ(tile_group->GetValue(tuple_id, 0).GetIntegerForTestsOnly(),
+              ExecutorTestsUtil::PopulatedValue(tuple_id, 0));
+    EXPECT_EQ(tile_group->GetValue(tuple_id, 3).Compare(
+                  ValueFactory::GetStringValue(std::to_string(
+                      ExecutorTestsUtil::PopulatedValue(tuple_id, 3)))),
+              0);
+  }
+
+  // The skipped tile group is picked up once it is not written anymore
+  second_header = data_table->GetTileGroup(1)->GetHeader();
+  second_header->SetTransactionId(0, INITIAL_TXN_ID);
+
+  EXPECT_EQ(layout_tuner.TuneTable(data_table.get(), 10.0), 1);
+  EXPECT_GT(data_table->GetTileGroup(1)->GetTileCount(), 1);
+
+  EXPECT_EQ(layout_tuner.GetTransformedTileGroupCount(), 2);
+  EXPECT_GT(layout_tuner.GetScanSpeedup(), 0);
+}
+
+}  // End test namespace
+}  // End peloton namespace
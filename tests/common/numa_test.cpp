@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// numa_test.cpp
+//
+// Identification: tests/common/numa_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <thread>
+
+#include "harness.h"
+
+#include "backend/common/numa.h"
+#include "backend/storage/storage_manager.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// NUMA Tests
+//===--------------------------------------------------------------------===//
+
+class NumaTests : public PelotonTest {};
+
+TEST_F(NumaTests, BasicTest) {
+  auto &numa_manager = NumaManager::GetInstance();
+  EXPECT_GE(numa_manager.GetNodeCount(), 1);
+
+  auto node = numa_manager.GetCurrentNode();
+  EXPECT_GE(node, 0);
+  EXPECT_LT(node, (int)numa_manager.GetNodeCount());
+
+  // Pinning only happens on machines with more than one node
+  std::thread worker([&numa_manager] {
+    EXPECT_EQ(numa_manager.PinThread(3), numa_manager.IsNuma());
+    EXPECT_EQ(numa_manager.PinThreadToNode(0), numa_manager.IsNuma());
+    EXPECT_FALSE(
+        numa_manager.PinThreadToNode(numa_manager.GetNodeCount()));
+  });
+  worker.join();
+}
+
+TEST_F(NumaTests, PlacementTest) {
+  auto &storage_manager = storage::StorageManager::GetInstance();
+  const size_t size = NUMA_MIN_PLACEMENT_SIZE * 4;
+
+  // Placed memory holds what is written to it, whatever the policy
+  NumaPlacementType placements[] = {NUMA_PLACEMENT_DEFAULT,
+                                    NUMA_PLACEMENT_LOCAL,
+                                    NUMA_PLACEMENT_INTERLEAVE};
+  for (auto placement : placements) {
+    peloton_numa_placement = placement;
+    auto data = static_cast<char *>(
+        storage_manager.Allocate(BACKEND_TYPE_MM, size));
+    EXPECT_NE(data, nullptr);
+    std::memset(data, 'x', size);
+    EXPECT_EQ(data[0], 'x');
+    EXPECT_EQ(data[size - 1], 'x');
+    storage_manager.Release(BACKEND_TYPE_MM, data);
+  }
+
+  peloton_numa_placement = NUMA_PLACEMENT_DEFAULT;
+}
+
+}  // End test namespace
+}  // End peloton namespace
@@ -0,0 +1,122 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// pool_test.cpp
+//
+// Identification: tests/common/pool_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "harness.h"
+
+#include "backend/common/pool.h"
+#include "backend/common/varlen.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Varlen Pool Test
+//===--------------------------------------------------------------------===//
+
+class PoolTest : public PelotonTest {};
+
+TEST_F(PoolTest, FreeTest) {
+  VarlenPool pool(BACKEND_TYPE_MM, 4096, 1);
+  auto reserved_memory = pool.GetAllocatedMemory();
+  EXPECT_EQ(pool.GetLiveMemory(), 0);
+
+  // A freed block is reused for the next block of the same size class
+  auto block = pool.Allocate(40);
+  EXPECT_GT(pool.GetLiveMemory(), 40);
+  pool.Free(block);
+  EXPECT_EQ(pool.GetLiveMemory(), 0);
+  EXPECT_EQ(pool.Allocate(36), block);
+  pool.Free(block);
+
+  // Repeated updates of a varchar don't grow the pool
+  for (int update_itr = 0; update_itr < 1000; update_itr++) {
+    auto varlen = Varlen::Create(100, &pool);
+    ::memset(varlen->Get(), 'a', 100);
+    Varlen::Destroy(varlen, &pool);
+  }
+  EXPECT_EQ(pool.GetLiveMemory(), 0);
+  EXPECT_EQ(pool.GetAllocatedMemory(), reserved_memory);
+
+  // Oversize blocks are released right away
+  auto oversize_block = pool.Allocate(10000);
+  EXPECT_GT(pool.GetAllocatedMemory(), reserved_memory + 10000);
+  pool.Free(oversize_block);
+  EXPECT_EQ(pool.GetAllocatedMemory(), reserved_memory);
+  EXPECT_EQ(pool.GetLiveMemory(), 0);
+}
+
+TEST_F(PoolTest, CrossThreadFreeTest) {
+  VarlenPool pool(BACKEND_TYPE_MM, 4096, 1);
+  int64_t reserved_memory = 0;
+
+  // Blocks freed by another thread, like the GC, are reused by the thread
+  // that allocated them
+  for (int round_itr = 0; round_itr < 100; round_itr++) {
+    std::vector<void *> blocks;
+    for (int block_itr = 0; block_itr < 100; block_itr++) {
+      blocks.push_back(pool.Allocate(100));
+    }
+    std::thread free_thread([&] {
+      for (auto block : blocks) {
+        pool.Free(block);
+      }
+    });
+    free_thread.join();
+
+    if (round_itr == 0) {
+      reserved_memory = pool.GetAllocatedMemory();
+    }
+  }
+  EXPECT_EQ(pool.GetAllocatedMemory(), reserved_memory);
+  EXPECT_EQ(pool.GetLiveMemory(), 0);
+}
+
+void AllocateAndFree(VarlenPool *pool) {
+  std::vector<char *> blocks;
+  for (size_t block_itr = 0; block_itr < 1000; block_itr++) {
+    size_t size = 8 + (block_itr % 200);
+    char *block = reinterpret_cast<char *>(pool->Allocate(size));
+    ::memset(block, block_itr % 128, size);
+    blocks.push_back(block);
+  }
+
+  // No other thread wrote into our blocks
+  for (size_t block_itr = 0; block_itr < blocks.size(); block_itr++) {
+    size_t size = 8 + (block_itr % 200);
+    for (size_t byte_itr = 0; byte_itr < size; byte_itr++) {
+      EXPECT_EQ(blocks[block_itr][byte_itr], char(block_itr % 128));
+    }
+    pool->Free(blocks[block_itr]);
+  }
+}
+
+TEST_F(PoolTest, ConcurrentTest) {
+  VarlenPool pool(BACKEND_TYPE_MM, 4096, 1);
+
+  LaunchParallelTest(8, AllocateAndFree, &pool);
+  EXPECT_EQ(pool.GetLiveMemory(), 0);
+
+  // The freed blocks are reused
+  auto reserved_memory = pool.GetAllocatedMemory();
+  LaunchParallelTest(8, AllocateAndFree, &pool);
+  EXPECT_EQ(pool.GetAllocatedMemory(), reserved_memory);
+
+  pool.Purge();
+  EXPECT_EQ(pool.GetAllocatedMemory(), 4096);
+}
+
+}  // End test namespace
+}  // End peloton namespace
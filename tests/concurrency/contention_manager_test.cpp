@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// contention_manager_test.cpp
+//
+// Identification: tests/concurrency/contention_manager_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <thread>
+
+#include "harness.h"
+#include "concurrency/transaction_tests_util.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Contention Manager Tests
+//===--------------------------------------------------------------------===//
+
+class ContentionManagerTests : public PelotonTest {};
+
+TEST_F(ContentionManagerTests, HotTupleTest) {
+  auto &contention_manager = concurrency::ContentionManager::GetInstance();
+  ItemPointer hot_location(1000, 1);
+  ItemPointer cold_location(1000, 2);
+
+  auto conflict_count = contention_manager.GetConflictCount(hot_location);
+  for (int conflict_itr = 0; conflict_itr < CONTENTION_HOT_THRESHOLD;
+       conflict_itr++) {
+    contention_manager.RecordConflict(hot_location);
+  }
+  EXPECT_EQ(conflict_count + CONTENTION_HOT_THRESHOLD,
+            contention_manager.GetConflictCount(hot_location));
+  EXPECT_TRUE(contention_manager.IsHot(hot_location));
+  EXPECT_FALSE(contention_manager.IsHot(cold_location));
+
+  // The tuple cools down once the others cause the aborts
+  for (int conflict_itr = 0; conflict_itr < 4 * CONTENTION_DECAY_INTERVAL;
+       conflict_itr++) {
+    contention_manager.RecordConflict(ItemPointer(2000, conflict_itr));
+  }
+  EXPECT_FALSE(contention_manager.IsHot(hot_location));
+}
+
+TEST_F(ContentionManagerTests, RetryTest) {
+  concurrency::TransactionManagerFactory::Configure(
+      CONCURRENCY_TYPE_OPTIMISTIC);
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto &contention_manager = concurrency::ContentionManager::GetInstance();
+  std::unique_ptr<storage::DataTable> table(
+      TransactionTestsUtil::CreateTable());
+
+  std::vector<RetryPolicyType> retry_policies = {
+    RETRY_POLICY_IMMEDIATE, RETRY_POLICY_BACKOFF, RETRY_POLICY_QUEUE
+  };
+  const int thread_count = 4;
+  const int txn_count = 20;
+  int expected_value = 0;
+
+  for (auto retry_policy : retry_policies) {
+    contention_manager.SetRetryPolicy(retry_policy);
+
+    // Every transaction increments the same row until it commits
+    std::vector<std::thread> threads;
+    for (int thread_itr = 0; thread_itr < thread_count; thread_itr++) {
+      threads.emplace_back([&] {
+        for (int txn_itr = 0; txn_itr < txn_count; txn_itr++) {
+          contention_manager.RunWithRetry([&] {
+            auto txn = txn_manager.BeginTransaction();
+            int result = -1;
+            if (TransactionTestsUtil::ExecuteRead(txn, table.get(), 0,
+                                                  result) == false ||
+                TransactionTestsUtil::ExecuteUpdate(txn, table.get(), 0,
+                                                    result + 1) == false) {
+              txn_manager.AbortTransaction();
+              return false;
+            }
+            return txn_manager.CommitTransaction() == RESULT_SUCCESS;
+          });
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    expected_value += thread_count * txn_count;
+    auto txn = txn_manager.BeginTransaction();
+    int result = -1;
+    TransactionTestsUtil::ExecuteRead(txn, table.get(), 0, result);
+    EXPECT_EQ(RESULT_SUCCESS, txn_manager.CommitTransaction());
+    EXPECT_EQ(expected_value, result);
+  }
+
+  // An aborted transaction runs until it commits
+  size_t run_count = 0;
+  EXPECT_EQ(3, contention_manager.RunWithRetry([&] {
+    contention_manager.RecordConflict(ItemPointer(1000, 1));
+    return ++run_count > 3;
+  }));
+
+  contention_manager.SetRetryPolicy(RETRY_POLICY_IMMEDIATE);
+}
+
+}  // End test namespace
+}  // End peloton namespace
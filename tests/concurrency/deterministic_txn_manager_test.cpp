@@ -0,0 +1,133 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// deterministic_txn_manager_test.cpp
+//
+// Identification: tests/concurrency/deterministic_txn_manager_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "harness.h"
+#include "concurrency/transaction_tests_util.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Deterministic Transaction Manager Tests
+//===--------------------------------------------------------------------===//
+
+class DeterministicTxnManagerTests : public PelotonTest {};
+
+// Row i of the test table is locked through key i
+static int ReadRow(storage::DataTable *table, const int id) {
+  auto &txn_manager = concurrency::DeterministicTxnManager::GetInstance();
+  auto txn = txn_manager.BeginDeterministicTransaction({(oid_t)id}, {});
+  int result = -1;
+  TransactionTestsUtil::ExecuteRead(txn, table, id, result);
+  EXPECT_EQ(RESULT_SUCCESS, txn_manager.CommitTransaction());
+  return result;
+}
+
+TEST_F(DeterministicTxnManagerTests, LockOrderTest) {
+  concurrency::TransactionManagerFactory::Configure(
+      CONCURRENCY_TYPE_DETERMINISTIC);
+  auto &txn_manager = concurrency::DeterministicTxnManager::GetInstance();
+  std::unique_ptr<storage::DataTable> table(
+      TransactionTestsUtil::CreateTable());
+
+  // T0 writes row 0 and reads row 1
+  auto txn = txn_manager.BeginDeterministicTransaction({1}, {0});
+  EXPECT_TRUE(TransactionTestsUtil::ExecuteUpdate(txn, table.get(), 0, 1));
+
+  // A later reader of row 1 shares it, a later writer of row 0 waits
+  std::thread reader([&] { EXPECT_EQ(0, ReadRow(table.get(), 1)); });
+  reader.join();
+
+  std::atomic<bool> is_begun(false);
+  int result = -1;
+  std::thread other([&] {
+    auto other_txn = txn_manager.BeginDeterministicTransaction({}, {0});
+    is_begun = true;
+    TransactionTestsUtil::ExecuteRead(other_txn, table.get(), 0, result);
+    EXPECT_TRUE(
+        TransactionTestsUtil::ExecuteUpdate(other_txn, table.get(), 0, 2));
+    EXPECT_EQ(RESULT_SUCCESS, txn_manager.CommitTransaction());
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_FALSE(is_begun);
+  EXPECT_EQ(RESULT_SUCCESS, txn_manager.CommitTransaction());
+  other.join();
+
+  EXPECT_TRUE(is_begun);
+  EXPECT_EQ(1, result);
+  EXPECT_EQ(2, ReadRow(table.get(), 0));
+
+  // The writes of an aborted transaction are undone
+  txn = txn_manager.BeginTransaction();
+  EXPECT_TRUE(TransactionTestsUtil::ExecuteUpdate(txn, table.get(), 0, 3));
+  EXPECT_TRUE(TransactionTestsUtil::ExecuteDelete(txn, table.get(), 2));
+  EXPECT_EQ(RESULT_ABORTED, txn_manager.AbortTransaction());
+  EXPECT_EQ(2, ReadRow(table.get(), 0));
+  EXPECT_EQ(0, ReadRow(table.get(), 2));
+
+  // A transaction that writes a row it did not declare aborts on the owner
+  txn = txn_manager.BeginDeterministicTransaction({}, {0});
+  EXPECT_TRUE(TransactionTestsUtil::ExecuteUpdate(txn, table.get(), 0, 4));
+  std::thread writer([&] {
+    auto writer_txn = txn_manager.BeginDeterministicTransaction({}, {1});
+    EXPECT_FALSE(
+        TransactionTestsUtil::ExecuteUpdate(writer_txn, table.get(), 0, 5));
+    EXPECT_EQ(RESULT_ABORTED, txn_manager.AbortTransaction());
+  });
+  writer.join();
+  EXPECT_EQ(RESULT_SUCCESS, txn_manager.CommitTransaction());
+  EXPECT_EQ(4, ReadRow(table.get(), 0));
+}
+
+TEST_F(DeterministicTxnManagerTests, BatchTest) {
+  concurrency::TransactionManagerFactory::Configure(
+      CONCURRENCY_TYPE_DETERMINISTIC);
+  auto &txn_manager = concurrency::DeterministicTxnManager::GetInstance();
+  std::unique_ptr<storage::DataTable> table(
+      TransactionTestsUtil::CreateTable());
+
+  const size_t thread_count = 4;
+  const size_t txn_count = 50;
+  txn_manager.SetBatchSize(thread_count);
+  auto batch_count = txn_manager.GetBatchCount();
+
+  // Every transaction increments the same row, none of them aborts
+  std::vector<std::thread> threads;
+  for (size_t thread_itr = 0; thread_itr < thread_count; thread_itr++) {
+    threads.emplace_back([&] {
+      for (size_t txn_itr = 0; txn_itr < txn_count; txn_itr++) {
+        auto txn = txn_manager.BeginDeterministicTransaction({0}, {0});
+        int result = -1;
+        TransactionTestsUtil::ExecuteRead(txn, table.get(), 0, result);
+        EXPECT_TRUE(TransactionTestsUtil::ExecuteUpdate(txn, table.get(), 0,
+                                                        result + 1));
+        EXPECT_EQ(RESULT_SUCCESS, txn_manager.CommitTransaction());
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ((int)(thread_count * txn_count), ReadRow(table.get(), 0));
+  EXPECT_GT(txn_manager.GetBatchCount(), batch_count);
+
+  txn_manager.SetBatchSize(DETERMINISTIC_BATCH_MAX_SIZE);
+}
+
+}  // End test namespace
+}  // End peloton namespace
@@ -0,0 +1,146 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// epoch_manager_test.cpp
+//
+// Identification: tests/concurrency/epoch_manager_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <thread>
+
+#include "harness.h"
+
+#include "backend/concurrency/epoch_manager.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Epoch Manager Tests
+//===--------------------------------------------------------------------===//
+
+class EpochManagerTests : public PelotonTest {};
+
+static std::atomic<int> freed_count(0);
+
+struct RetiredItem {
+  ~RetiredItem() { freed_count++; }
+};
+
+TEST_F(EpochManagerTests, RetireTest) {
+  auto &epoch_manager = concurrency::EpochManagerFactory::GetInstance();
+  freed_count = 0;
+
+  epoch_manager.EnterEpoch();
+  epoch_manager.EnterEpoch();
+  EXPECT_TRUE(epoch_manager.IsInEpoch());
+  epoch_manager.Retire(new RetiredItem());
+  EXPECT_EQ(epoch_manager.GetRetiredCount(), 1);
+
+  // The thread itself may still hold the item
+  concurrency::EpochManager::AdvanceEpoch();
+  EXPECT_EQ(epoch_manager.Reclaim(), 0);
+  epoch_manager.ExitEpoch();
+  EXPECT_TRUE(epoch_manager.IsInEpoch());
+  EXPECT_EQ(epoch_manager.Reclaim(), 0);
+  EXPECT_EQ(freed_count, 0);
+
+  epoch_manager.ExitEpoch();
+  EXPECT_FALSE(epoch_manager.IsInEpoch());
+  concurrency::EpochManager::AdvanceEpoch();
+  epoch_manager.Reclaim();
+  EXPECT_EQ(freed_count, 1);
+  EXPECT_EQ(epoch_manager.GetRetiredCount(), 0);
+}
+
+TEST_F(EpochManagerTests, ThreadTest) {
+  auto &epoch_manager = concurrency::EpochManagerFactory::GetInstance();
+  freed_count = 0;
+
+  std::atomic<bool> is_entered(false);
+  std::atomic<bool> should_exit(false);
+  std::thread reader([&] {
+    epoch_manager.EnterEpoch();
+    is_entered = true;
+    while (should_exit == false) {
+      std::this_thread::yield();
+    }
+    epoch_manager.ExitEpoch();
+  });
+
+  while (is_entered == false) {
+    std::this_thread::yield();
+  }
+
+  // The other thread entered before the item was retired
+  epoch_manager.Retire(new RetiredItem());
+  concurrency::EpochManager::AdvanceEpoch();
+  EXPECT_LT(epoch_manager.GetSafeEpoch(),
+            concurrency::EpochManager::GetEpoch());
+  EXPECT_EQ(epoch_manager.Reclaim(), 0);
+  EXPECT_EQ(freed_count, 0);
+
+  should_exit = true;
+  reader.join();
+
+  EXPECT_EQ(epoch_manager.Reclaim(), 1);
+  EXPECT_EQ(freed_count, 1);
+}
+
+TEST_F(EpochManagerTests, SnapshotTest) {
+  auto &epoch_manager = concurrency::EpochManagerFactory::GetInstance();
+  EXPECT_EQ(epoch_manager.GetOldestSnapshotCid(), MAX_CID);
+
+  epoch_manager.EnterEpoch();
+  epoch_manager.SetSnapshotCid(10);
+  EXPECT_EQ(epoch_manager.GetOldestSnapshotCid(), 10);
+
+  // The snapshot is dropped with the epoch
+  epoch_manager.ExitEpoch();
+  EXPECT_EQ(epoch_manager.GetOldestSnapshotCid(), MAX_CID);
+}
+
+TEST_F(EpochManagerTests, SnapshotReclaimTest) {
+  auto &epoch_manager = concurrency::EpochManagerFactory::GetInstance();
+
+  // Versions of a tile group that does not exist, nothing is refurbished
+  epoch_manager.RetireTupleSlot(TupleMetadata(1000, 1000, 0, 5));
+  epoch_manager.RetireTupleSlot(TupleMetadata(1000, 1000, 1, 20));
+  concurrency::EpochManager::AdvanceEpoch();
+
+  // The reader enters after the versions were retired, but reads an older
+  // snapshot
+  std::atomic<bool> is_entered(false);
+  std::atomic<bool> should_exit(false);
+  std::thread reader([&] {
+    epoch_manager.EnterEpoch();
+    epoch_manager.SetSnapshotCid(10);
+    is_entered = true;
+    while (should_exit == false) {
+      std::this_thread::yield();
+    }
+    epoch_manager.ExitEpoch();
+  });
+
+  while (is_entered == false) {
+    std::this_thread::yield();
+  }
+
+  // Only the version that ended before the snapshot is reclaimed
+  EXPECT_EQ(epoch_manager.Reclaim(), 1);
+  EXPECT_EQ(epoch_manager.GetRetiredCount(), 1);
+
+  should_exit = true;
+  reader.join();
+
+  EXPECT_EQ(epoch_manager.Reclaim(), 1);
+  EXPECT_EQ(epoch_manager.GetRetiredCount(), 0);
+}
+
+}  // End test namespace
+}  // End peloton namespace
@@ -0,0 +1,121 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// hybrid_txn_manager_test.cpp
+//
+// Identification: tests/concurrency/hybrid_txn_manager_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "harness.h"
+#include "concurrency/transaction_tests_util.h"
+
+namespace peloton {
+
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Hybrid Transaction Manager Tests
+//===--------------------------------------------------------------------===//
+
+class HybridTxnManagerTests : public PelotonTest {};
+
+// T0 reads (0, ?) and T1 updates it before T0 commits
+static void ReadUpdateTest(storage::DataTable *table,
+                           concurrency::TransactionManager *txn_manager,
+                           Result expected_reader_result,
+                           Result expected_updater_result) {
+  TransactionScheduler scheduler(2, table, txn_manager);
+  scheduler.Txn(0).Read(0);
+  scheduler.Txn(1).Update(0, 1);
+  scheduler.Txn(0).Commit();
+  scheduler.Txn(1).Commit();
+
+  scheduler.Run();
+
+  EXPECT_EQ(expected_reader_result, scheduler.schedules[0].txn_result);
+  EXPECT_EQ(expected_updater_result, scheduler.schedules[1].txn_result);
+}
+
+TEST_F(HybridTxnManagerTests, LockedTableTest) {
+  concurrency::TransactionManagerFactory::Configure(CONCURRENCY_TYPE_HYBRID);
+  auto &txn_manager = concurrency::HybridTxnManager::GetInstance();
+  std::unique_ptr<storage::DataTable> table(
+      TransactionTestsUtil::CreateTable());
+  auto table_id = table->GetOid();
+
+  // The optimistic reader fails the validation
+  txn_manager.SetTableMode(table_id, CONCURRENCY_TYPE_OPTIMISTIC);
+  ReadUpdateTest(table.get(), &txn_manager, RESULT_ABORTED, RESULT_SUCCESS);
+
+  // The locked reader makes the updater abort right away
+  txn_manager.SetTableMode(table_id, CONCURRENCY_TYPE_PESSIMISTIC);
+  ReadUpdateTest(table.get(), &txn_manager, RESULT_SUCCESS, RESULT_ABORTED);
+
+  // The mode is per table, conflicts on another one are still found at
+  // commit time
+  std::unique_ptr<storage::DataTable> other_table(
+      TransactionTestsUtil::CreateTable(10, "OTHER_TABLE", INVALID_OID, 1));
+  txn_manager.SetTableMode(other_table->GetOid(),
+                           CONCURRENCY_TYPE_OPTIMISTIC);
+  {
+    TransactionScheduler scheduler(2, other_table.get(), &txn_manager);
+    scheduler.Txn(0).Read(0);
+    scheduler.Txn(1).Update(0, 1);
+    scheduler.Txn(1).Commit();
+    scheduler.Txn(0).Update(1, 1);
+    scheduler.Txn(0).Commit();
+
+    scheduler.Run();
+
+    EXPECT_EQ(RESULT_SUCCESS, scheduler.schedules[1].txn_result);
+    EXPECT_EQ(RESULT_ABORTED, scheduler.schedules[0].txn_result);
+  }
+
+  EXPECT_EQ(0, concurrency::LockManager::GetInstance().GetLockCount());
+}
+
+TEST_F(HybridTxnManagerTests, ModeSwitchTest) {
+  concurrency::TransactionManagerFactory::Configure(CONCURRENCY_TYPE_HYBRID);
+  auto &txn_manager = concurrency::HybridTxnManager::GetInstance();
+  std::unique_ptr<storage::DataTable> table(
+      TransactionTestsUtil::CreateTable());
+  auto table_id = table->GetOid();
+  txn_manager.SetTableMode(table_id, CONCURRENCY_TYPE_OPTIMISTIC);
+
+  // Every other transaction conflicts, the table gets locked within a window
+  for (int round = 0; round < HYBRID_STATS_WINDOW; round++) {
+    TransactionScheduler scheduler(2, table.get(), &txn_manager);
+    scheduler.Txn(0).Read(0);
+    scheduler.Txn(1).Update(0, round);
+    scheduler.Txn(1).Commit();
+    scheduler.Txn(0).Update(1, round);
+    scheduler.Txn(0).Commit();
+    scheduler.Run();
+
+    if (txn_manager.GetTableMode(table_id) == CONCURRENCY_TYPE_PESSIMISTIC) {
+      break;
+    }
+  }
+  EXPECT_EQ(CONCURRENCY_TYPE_PESSIMISTIC, txn_manager.GetTableMode(table_id));
+
+  // Without conflicts it goes back to optimistic within a window
+  for (int round = 0; round < HYBRID_STATS_WINDOW; round++) {
+    TransactionScheduler scheduler(1, table.get(), &txn_manager);
+    scheduler.Txn(0).Read(0);
+    scheduler.Txn(0).Update(0, round);
+    scheduler.Txn(0).Commit();
+    scheduler.Run();
+
+    EXPECT_EQ(RESULT_SUCCESS, scheduler.schedules[0].txn_result);
+  }
+  EXPECT_EQ(CONCURRENCY_TYPE_OPTIMISTIC, txn_manager.GetTableMode(table_id));
+
+  EXPECT_EQ(0, concurrency::LockManager::GetInstance().GetLockCount());
+}
+
+}  // End test namespace
+}  // End peloton namespace
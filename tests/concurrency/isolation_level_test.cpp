@@ -29,7 +29,8 @@ static std::vector<ConcurrencyType> TEST_TYPES = {
   CONCURRENCY_TYPE_SSI,
   // CONCURRENCY_TYPE_SPECULATIVE_READ,
   CONCURRENCY_TYPE_EAGER_WRITE,
-  CONCURRENCY_TYPE_TO
+  CONCURRENCY_TYPE_TO,
+  CONCURRENCY_TYPE_HYBRID
 };
 
 void DirtyWriteTest() {
@@ -0,0 +1,180 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// lock_manager_test.cpp
+//
+// Identification: tests/concurrency/lock_manager_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "harness.h"
+
+#include "backend/concurrency/lock_manager.h"
+#include "backend/concurrency/transaction.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Lock Manager Tests
+//===--------------------------------------------------------------------===//
+
+class LockManagerTests : public PelotonTest {};
+
+// Stands in for the transaction id in the tuple header
+class TestLock {
+ public:
+  std::function<bool()> Exclusive(const txn_id_t txn_id) {
+    return [this, txn_id]() {
+      txn_id_t free = INVALID_TXN_ID;
+      return holder.compare_exchange_strong(free, txn_id);
+    };
+  }
+
+  void Unlock() { holder = INVALID_TXN_ID; }
+
+  std::atomic<txn_id_t> holder{INVALID_TXN_ID};
+};
+
+TEST_F(LockManagerTests, NoWaitTest) {
+  auto &lock_manager = concurrency::LockManager::GetInstance();
+  concurrency::Transaction older(1, 1), younger(2, 2);
+  ItemPointer location(100, 1);
+  TestLock lock;
+
+  EXPECT_TRUE(lock_manager.AcquireLock(&younger, location,
+                                       concurrency::LOCK_MODE_EXCLUSIVE,
+                                       LOCK_POLICY_NO_WAIT, lock.Exclusive(2)));
+  EXPECT_FALSE(lock_manager.AcquireLock(&older, location,
+                                        concurrency::LOCK_MODE_EXCLUSIVE,
+                                        LOCK_POLICY_NO_WAIT, lock.Exclusive(1)));
+
+  lock.Unlock();
+  lock_manager.ReleaseLock(2, location);
+  EXPECT_EQ(lock_manager.GetLockCount(), 0);
+}
+
+TEST_F(LockManagerTests, WaitDieTest) {
+  auto &lock_manager = concurrency::LockManager::GetInstance();
+  concurrency::Transaction older(1, 1), holder(2, 2), younger(3, 3);
+  ItemPointer location(100, 2);
+  TestLock lock;
+
+  EXPECT_TRUE(lock_manager.AcquireLock(&holder, location,
+                                       concurrency::LOCK_MODE_EXCLUSIVE,
+                                       LOCK_POLICY_WAIT_DIE, lock.Exclusive(2)));
+
+  // The younger one dies
+  EXPECT_FALSE(lock_manager.AcquireLock(&younger, location,
+                                        concurrency::LOCK_MODE_EXCLUSIVE,
+                                        LOCK_POLICY_WAIT_DIE,
+                                        lock.Exclusive(3)));
+
+  // The older one waits until the lock is released
+  std::atomic<bool> is_granted(false);
+  std::thread waiter([&] {
+    is_granted = lock_manager.AcquireLock(&older, location,
+                                          concurrency::LOCK_MODE_EXCLUSIVE,
+                                          LOCK_POLICY_WAIT_DIE,
+                                          lock.Exclusive(1));
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_FALSE(is_granted);
+  lock.Unlock();
+  lock_manager.ReleaseLock(2, location);
+  waiter.join();
+
+  EXPECT_TRUE(is_granted);
+  EXPECT_EQ(lock.holder.load(), 1);
+  EXPECT_FALSE(holder.IsWounded());
+
+  lock.Unlock();
+  lock_manager.ReleaseLock(1, location);
+  EXPECT_EQ(lock_manager.GetLockCount(), 0);
+}
+
+TEST_F(LockManagerTests, WoundWaitTest) {
+  auto &lock_manager = concurrency::LockManager::GetInstance();
+  concurrency::Transaction older(1, 1), holder(2, 2), younger(3, 3);
+  ItemPointer location(100, 3);
+  TestLock lock;
+
+  EXPECT_TRUE(lock_manager.AcquireLock(
+      &holder, location, concurrency::LOCK_MODE_EXCLUSIVE,
+      LOCK_POLICY_WOUND_WAIT, lock.Exclusive(2)));
+
+  // The younger one waits, the older one wounds the holder and waits
+  std::atomic<bool> is_younger_granted(false);
+  std::thread younger_waiter([&] {
+    is_younger_granted = lock_manager.AcquireLock(
+        &younger, location, concurrency::LOCK_MODE_EXCLUSIVE,
+        LOCK_POLICY_WOUND_WAIT, lock.Exclusive(3));
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  std::atomic<bool> is_older_granted(false);
+  std::thread older_waiter([&] {
+    is_older_granted = lock_manager.AcquireLock(
+        &older, location, concurrency::LOCK_MODE_EXCLUSIVE,
+        LOCK_POLICY_WOUND_WAIT, lock.Exclusive(1));
+  });
+
+  // The wounded waiter leaves the queue
+  younger_waiter.join();
+  EXPECT_FALSE(is_younger_granted);
+  EXPECT_TRUE(younger.IsWounded());
+  EXPECT_TRUE(holder.IsWounded());
+  EXPECT_FALSE(older.IsWounded());
+
+  // A wounded transaction gets no more locks
+  EXPECT_FALSE(lock_manager.AcquireLock(
+      &holder, ItemPointer(100, 4), concurrency::LOCK_MODE_SHARED,
+      LOCK_POLICY_WOUND_WAIT, [] { return true; }));
+
+  lock.Unlock();
+  lock_manager.ReleaseLock(2, location);
+  older_waiter.join();
+
+  EXPECT_TRUE(is_older_granted);
+  EXPECT_EQ(lock.holder.load(), 1);
+
+  lock.Unlock();
+  lock_manager.ReleaseLock(1, location);
+  EXPECT_EQ(lock_manager.GetLockCount(), 0);
+}
+
+TEST_F(LockManagerTests, SharedTest) {
+  auto &lock_manager = concurrency::LockManager::GetInstance();
+  concurrency::Transaction older(1, 1), younger(2, 2);
+  ItemPointer location(100, 5);
+  std::atomic<int> reader_count(0);
+  auto try_shared = [&reader_count]() {
+    reader_count++;
+    return true;
+  };
+
+  // Readers do not wait for each other
+  EXPECT_TRUE(lock_manager.AcquireLock(&older, location,
+                                       concurrency::LOCK_MODE_SHARED,
+                                       LOCK_POLICY_WAIT_DIE, try_shared));
+  EXPECT_TRUE(lock_manager.AcquireLock(&younger, location,
+                                       concurrency::LOCK_MODE_SHARED,
+                                       LOCK_POLICY_WAIT_DIE, try_shared));
+  EXPECT_EQ(reader_count, 2);
+  EXPECT_EQ(lock_manager.GetLockCount(), 1);
+
+  lock_manager.ReleaseLock(1, location);
+  lock_manager.ReleaseLock(2, location);
+  EXPECT_EQ(lock_manager.GetLockCount(), 0);
+}
+
+}  // End test namespace
+}  // End peloton namespace
@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// partitioned_txn_manager_test.cpp
+//
+// Identification: tests/concurrency/partitioned_txn_manager_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "harness.h"
+#include "concurrency/transaction_tests_util.h"
+
+namespace peloton {
+
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Partitioned Transaction Manager Tests
+//===--------------------------------------------------------------------===//
+
+class PartitionedTxnManagerTests : public PelotonTest {};
+
+// Row i of the test table is in the partition of key i
+static int ReadRow(storage::DataTable *table, const int id) {
+  auto &txn_manager = concurrency::PartitionedTxnManager::GetInstance();
+  auto txn = txn_manager.BeginPartitionedTransaction({(oid_t)id});
+  int result = -1;
+  TransactionTestsUtil::ExecuteRead(txn, table, id, result);
+  // reads are not recorded
+  EXPECT_TRUE(txn->GetRWSet().IsEmpty());
+  EXPECT_EQ(RESULT_SUCCESS, txn_manager.CommitTransaction());
+  return result;
+}
+
+TEST_F(PartitionedTxnManagerTests, SinglePartitionTest) {
+  concurrency::TransactionManagerFactory::Configure(
+      CONCURRENCY_TYPE_PARTITIONED);
+  auto &txn_manager = concurrency::PartitionedTxnManager::GetInstance();
+  txn_manager.SetPartitionCount(2);
+  std::unique_ptr<storage::DataTable> table(
+      TransactionTestsUtil::CreateTable());
+  txn_manager.SetPartitionColumn(table->GetOid(), 0);
+
+  // T0 updates row 0 and holds partition 0, T1 runs in partition 1 meanwhile
+  auto txn = txn_manager.BeginPartitionedTransaction({0});
+  EXPECT_TRUE(TransactionTestsUtil::ExecuteUpdate(txn, table.get(), 0, 1));
+
+  std::thread other([&] {
+    auto other_txn = txn_manager.BeginPartitionedTransaction({1});
+    EXPECT_TRUE(
+        TransactionTestsUtil::ExecuteUpdate(other_txn, table.get(), 1, 2));
+    EXPECT_EQ(RESULT_SUCCESS, txn_manager.CommitTransaction());
+  });
+  other.join();
+
+  EXPECT_EQ(RESULT_SUCCESS, txn_manager.CommitTransaction());
+  EXPECT_EQ(1, ReadRow(table.get(), 0));
+  EXPECT_EQ(2, ReadRow(table.get(), 1));
+
+  // The writes of an aborted transaction are undone
+  txn = txn_manager.BeginPartitionedTransaction({0});
+  EXPECT_TRUE(TransactionTestsUtil::ExecuteUpdate(txn, table.get(), 0, 3));
+  EXPECT_TRUE(TransactionTestsUtil::ExecuteDelete(txn, table.get(), 2));
+  EXPECT_EQ(RESULT_ABORTED, txn_manager.AbortTransaction());
+  EXPECT_EQ(1, ReadRow(table.get(), 0));
+  EXPECT_EQ(0, ReadRow(table.get(), 2));
+
+  // A transaction that declared the wrong partition aborts instead of
+  // overwriting the owner
+  txn = txn_manager.BeginPartitionedTransaction({0});
+  EXPECT_TRUE(TransactionTestsUtil::ExecuteUpdate(txn, table.get(), 0, 4));
+
+  std::thread wrong([&] {
+    auto wrong_txn = txn_manager.BeginPartitionedTransaction({1});
+    EXPECT_FALSE(
+        TransactionTestsUtil::ExecuteUpdate(wrong_txn, table.get(), 0, 5));
+    EXPECT_EQ(RESULT_ABORTED, txn_manager.AbortTransaction());
+  });
+  wrong.join();
+
+  EXPECT_EQ(RESULT_SUCCESS, txn_manager.CommitTransaction());
+  EXPECT_EQ(4, ReadRow(table.get(), 0));
+
+  // Rows of partitions the transaction did not declare cannot be read
+  txn = txn_manager.BeginPartitionedTransaction({0});
+  int result = -1;
+  EXPECT_FALSE(TransactionTestsUtil::ExecuteRead(txn, table.get(), 1, result));
+  EXPECT_EQ(RESULT_FAILURE, txn->GetResult());
+  EXPECT_EQ(RESULT_ABORTED, txn_manager.AbortTransaction());
+}
+
+TEST_F(PartitionedTxnManagerTests, MultiPartitionTest) {
+  concurrency::TransactionManagerFactory::Configure(
+      CONCURRENCY_TYPE_PARTITIONED);
+  auto &txn_manager = concurrency::PartitionedTxnManager::GetInstance();
+  txn_manager.SetPartitionCount(2);
+  std::unique_ptr<storage::DataTable> table(
+      TransactionTestsUtil::CreateTable());
+
+  auto txn = txn_manager.BeginPartitionedTransaction({0});
+  EXPECT_TRUE(TransactionTestsUtil::ExecuteUpdate(txn, table.get(), 0, 1));
+
+  // The multi-partition transaction waits for partition 0, and sees the
+  // update once it owns it
+  std::atomic<bool> is_begun(false);
+  int result = -1;
+  std::thread other([&] {
+    auto other_txn = txn_manager.BeginPartitionedTransaction({1, 0, 3});
+    is_begun = true;
+    TransactionTestsUtil::ExecuteRead(other_txn, table.get(), 0, result);
+    EXPECT_TRUE(
+        TransactionTestsUtil::ExecuteUpdate(other_txn, table.get(), 1, 2));
+    EXPECT_EQ(RESULT_SUCCESS, txn_manager.CommitTransaction());
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_FALSE(is_begun);
+  EXPECT_EQ(RESULT_SUCCESS, txn_manager.CommitTransaction());
+  other.join();
+
+  EXPECT_TRUE(is_begun);
+  EXPECT_EQ(1, result);
+  EXPECT_EQ(2, ReadRow(table.get(), 1));
+
+  // Without keys a transaction owns every partition
+  txn = txn_manager.BeginTransaction();
+  EXPECT_TRUE(TransactionTestsUtil::ExecuteUpdate(txn, table.get(), 1, 3));
+  EXPECT_EQ(RESULT_SUCCESS, txn_manager.CommitTransaction());
+  EXPECT_EQ(3, ReadRow(table.get(), 1));
+
+  txn_manager.SetPartitionCount(1);
+}
+
+}  // End test namespace
+}  // End peloton namespace
@@ -29,7 +29,8 @@ static std::vector<ConcurrencyType> TEST_TYPES = {
   CONCURRENCY_TYPE_SSI,
   CONCURRENCY_TYPE_SPECULATIVE_READ,
   CONCURRENCY_TYPE_EAGER_WRITE,
-  CONCURRENCY_TYPE_TO
+  CONCURRENCY_TYPE_TO,
+  CONCURRENCY_TYPE_HYBRID
 };
 
 void TransactionTest(concurrency::TransactionManager *txn_manager) {
@@ -220,5 +221,148 @@ TEST_F(TransactionTests, AbortTest) {
   }
 }
 
+TEST_F(TransactionTests, ReadOnlyTransactionTest) {
+  for (auto test_type : TEST_TYPES) {
+    concurrency::TransactionManagerFactory::Configure(test_type);
+    auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+    std::unique_ptr<storage::DataTable> table(
+        TransactionTestsUtil::CreateTable());
+
+    // T1 updates before the read-only T0 begins and commits after, T2 updates
+    // and commits while T0 runs. T0 sees neither of them, and commits.
+    {
+      TransactionScheduler scheduler(3, table.get(), &txn_manager);
+      scheduler.Txn(0).ReadOnly();
+      scheduler.Txn(1).Update(0, 1);
+      scheduler.Txn(0).Read(0);
+      scheduler.Txn(1).Commit();
+      scheduler.Txn(0).Read(0);
+      scheduler.Txn(2).Update(1, 2);
+      scheduler.Txn(0).Read(1);
+      scheduler.Txn(2).Commit();
+      scheduler.Txn(0).Read(1);
+      scheduler.Txn(0).Commit();
+
+      scheduler.Run();
+
+      EXPECT_EQ(RESULT_SUCCESS, scheduler.schedules[0].txn_result);
+      EXPECT_EQ(RESULT_SUCCESS, scheduler.schedules[1].txn_result);
+      EXPECT_EQ(RESULT_SUCCESS, scheduler.schedules[2].txn_result);
+      EXPECT_EQ(0, scheduler.schedules[0].results[0]);
+      EXPECT_EQ(0, scheduler.schedules[0].results[1]);
+      EXPECT_EQ(0, scheduler.schedules[0].results[2]);
+      EXPECT_EQ(0, scheduler.schedules[0].results[3]);
+    }
+
+    // A read-only transaction cannot write
+    {
+      TransactionScheduler scheduler(1, table.get(), &txn_manager);
+      scheduler.Txn(0).ReadOnly();
+      scheduler.Txn(0).Update(0, 3);
+      scheduler.Txn(0).Commit();
+
+      scheduler.Run();
+
+      EXPECT_EQ(RESULT_ABORTED, scheduler.schedules[0].txn_result);
+    }
+
+    // Nothing is recorded, and the GC keeps the snapshot
+    {
+      auto txn = txn_manager.BeginReadOnlyTransaction();
+      int result;
+      TransactionTestsUtil::ExecuteRead(txn, table.get(), 0, result);
+      EXPECT_EQ(1, result);
+      EXPECT_TRUE(txn->GetRWSet().IsEmpty());
+      EXPECT_LE(txn_manager.GetMaxCommittedCid(), txn->GetSnapshotCommitId());
+      EXPECT_EQ(RESULT_SUCCESS, txn_manager.CommitTransaction());
+    }
+  }
+}
+
+TEST_F(TransactionTests, RWSetTest) {
+  std::unique_ptr<storage::DataTable> table(
+      TransactionTestsUtil::CreateTable());
+  auto tile_group = table->GetTileGroup(0);
+  auto tile_group_id = tile_group->GetTileGroupId();
+  const oid_t entry_count = 1000;
+
+  for (int txn_itr = 0; txn_itr < 2; txn_itr++) {
+    concurrency::Transaction txn;
+    auto &rw_set = txn.GetRWSet();
+    EXPECT_TRUE(rw_set.IsEmpty());
+
+    // Enough versions to grow the table a few times
+    for (oid_t tuple_itr = 0; tuple_itr < entry_count; tuple_itr++) {
+      txn.RecordRead(ItemPointer(tile_group_id, tuple_itr));
+    }
+    txn.RecordRead(ItemPointer(tile_group_id, 5));
+    EXPECT_EQ(rw_set.GetSize(), entry_count);
+
+    txn.RecordUpdate(ItemPointer(tile_group_id, 5));
+    txn.RecordDelete(ItemPointer(tile_group_id, 7));
+    txn.RecordInsert(ItemPointer(tile_group_id + 1, 0), tile_group);
+    EXPECT_FALSE(txn.IsReadOnly());
+
+    EXPECT_EQ(rw_set.Find(ItemPointer(tile_group_id, 5))->type,
+              concurrency::RW_TYPE_UPDATE);
+    EXPECT_EQ(rw_set.Find(ItemPointer(tile_group_id, 7))->type,
+              concurrency::RW_TYPE_DELETE);
+    EXPECT_EQ(rw_set.Find(ItemPointer(tile_group_id + 1, 0))->type,
+              concurrency::RW_TYPE_INSERT);
+    EXPECT_EQ(rw_set.Find(ItemPointer(tile_group_id, entry_count)), nullptr);
+
+    // Entries are kept in the order they were first seen, with their header
+    oid_t tuple_itr = 0;
+    for (auto &entry : rw_set) {
+      if (tuple_itr < entry_count) {
+        EXPECT_EQ(entry.location.offset, tuple_itr);
+      }
+      EXPECT_EQ(entry.GetTileGroupHeader(), tile_group->GetHeader());
+      tuple_itr++;
+    }
+    EXPECT_EQ(tuple_itr, entry_count + 1);
+  }
+}
+
+// Transactions that end on the thread they began on reuse its pooled objects
+TEST_F(TransactionTests, PoolTest) {
+  std::vector<ConcurrencyType> test_types = {
+    CONCURRENCY_TYPE_OPTIMISTIC,
+    CONCURRENCY_TYPE_PESSIMISTIC,
+    CONCURRENCY_TYPE_EAGER_WRITE,
+    CONCURRENCY_TYPE_TO
+  };
+  for (auto test_type : test_types) {
+    concurrency::TransactionManagerFactory::Configure(test_type);
+    auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+    std::unique_ptr<storage::DataTable> table(
+        TransactionTestsUtil::CreateTable());
+
+    size_t allocation_count = 0;
+    for (int txn_itr = 0; txn_itr < 100; txn_itr++) {
+      auto txn = txn_manager.BeginTransaction();
+      int result = -1;
+      EXPECT_TRUE(TransactionTestsUtil::ExecuteRead(txn, table.get(), 0,
+                                                    result));
+      EXPECT_TRUE(TransactionTestsUtil::ExecuteUpdate(txn, table.get(), 0,
+                                                      txn_itr));
+      if (txn_itr % 2 == 0) {
+        EXPECT_EQ(RESULT_SUCCESS, txn_manager.CommitTransaction());
+      } else {
+        EXPECT_EQ(RESULT_ABORTED, txn_manager.AbortTransaction());
+      }
+
+      // The first transactions fill the pools
+      if (txn_itr == 1) {
+        allocation_count =
+            concurrency::TransactionManagerFactory::GetAllocationCount();
+      }
+    }
+
+    EXPECT_EQ(allocation_count,
+              concurrency::TransactionManagerFactory::GetAllocationCount());
+  }
+}
+
 }  // End test namespace
 }  // End peloton namespace
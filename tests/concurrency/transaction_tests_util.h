@@ -169,7 +169,10 @@ struct TransactionSchedule {
   std::vector<TransactionOperation> operations;
   std::vector<int> results;
   int stored_value;
-  TransactionSchedule() : txn_result(RESULT_FAILURE), stored_value(0) {}
+  // begins as a declared read-only transaction
+  bool is_read_only;
+  TransactionSchedule()
+      : txn_result(RESULT_FAILURE), stored_value(0), is_read_only(false) {}
 };
 
 // A thread wrapper that runs a transaction
@@ -227,7 +230,11 @@ class TransactionThread {
     if (value == TXN_STORED_VALUE)
       value = schedule->stored_value;
 
-    if (cur_seq == 0) txn = txn_manager->BeginTransaction();
+    if (cur_seq == 0) {
+      txn = (schedule->is_read_only == true)
+                ? txn_manager->BeginReadOnlyTransaction()
+                : txn_manager->BeginTransaction();
+    }
     if (schedule->txn_result == RESULT_ABORTED) {
       cur_seq++;
       return;
@@ -366,6 +373,9 @@ class TransactionScheduler {
     return *this;
   }
 
+  // Must come before the first operation of the txn
+  void ReadOnly() { schedules[cur_txn_id].is_read_only = true; }
+
   void Insert(int id, int value) {
     schedules[cur_txn_id].operations.emplace_back(TXN_OP_INSERT, id, value);
     sequence[time++] = cur_txn_id;
@@ -34,6 +34,7 @@
 #include "backend/expression/abstract_expression.h"
 #include "backend/storage/tile.h"
 #include "backend/storage/tile_group.h"
+#include "backend/storage/tile_group_header.h"
 #include "backend/storage/table_factory.h"
 #include "backend/concurrency/transaction_manager_factory.h"
 
@@ -404,5 +405,44 @@ TEST_F(MutateTests, UpdateTest) {
   tuple_id = 0;
 }
 
+// Writers holding a tile group that was transformed meanwhile give up
+TEST_F(MutateTests, StaleTileGroupTest) {
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  std::unique_ptr<storage::DataTable> table(
+      ExecutorTestsUtil::CreateAndPopulateTable());
+
+  // The child reads the tile group before it is transformed
+  auto stale_tile_group = table->GetTileGroup(0);
+  std::unique_ptr<executor::LogicalTile> source_logical_tile(
+      executor::LogicalTileFactory::WrapTileGroup(stale_tile_group));
+  EXPECT_NE(table->TransformTileGroup(0, 0.0), nullptr);
+  EXPECT_TRUE(stale_tile_group->IsReplaced());
+
+  auto txn = txn_manager.BeginTransaction();
+  std::unique_ptr<executor::ExecutorContext> context(
+      new executor::ExecutorContext(txn));
+
+  planner::DeletePlan node(table.get(), false);
+  executor::DeleteExecutor executor(&node, context.get());
+
+  MockExecutor child_executor;
+  executor.AddChild(&child_executor);
+
+  EXPECT_CALL(child_executor, DInit()).WillOnce(Return(true));
+  EXPECT_CALL(child_executor, DExecute()).WillOnce(Return(true));
+  EXPECT_CALL(child_executor, GetOutput())
+      .WillOnce(Return(source_logical_tile.release()));
+
+  EXPECT_TRUE(executor.Init());
+  EXPECT_FALSE(executor.Execute());
+  EXPECT_EQ(txn->GetResult(), RESULT_FAILURE);
+  txn_manager.AbortTransaction();
+
+  // The current versions are neither owned nor deleted
+  auto tile_group_header = table->GetTileGroup(0)->GetHeader();
+  EXPECT_EQ(tile_group_header->GetTransactionId(0), INITIAL_TXN_ID);
+  EXPECT_EQ(tile_group_header->GetEndCommitId(0), MAX_CID);
+}
+
 }  // namespace test
 }  // namespace peloton
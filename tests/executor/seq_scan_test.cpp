@@ -263,6 +263,53 @@ TEST_F(SeqScanTests, TwoTileGroupsWithPredicateTest) {
   txn_manager.CommitTransaction();
 }
 
+// Sequential scan with comparisons that are evaluated on the raw columns.
+TEST_F(SeqScanTests, ColumnPredicateTest) {
+  std::unique_ptr<storage::DataTable> table(CreateTable());
+
+  // COL_A >= 10 AND 42.0 > COL_C
+  auto predicate = expression::ExpressionUtil::ConjunctionFactory(
+      EXPRESSION_TYPE_CONJUNCTION_AND,
+      expression::ExpressionUtil::ComparisonFactory(
+          EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+          expression::ExpressionUtil::TupleValueFactory(VALUE_TYPE_INTEGER, 0,
+                                                        0),
+          expression::ExpressionUtil::ConstantValueFactory(
+              ValueFactory::GetBigIntValue(10))),
+      expression::ExpressionUtil::ComparisonFactory(
+          EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+          expression::ExpressionUtil::ConstantValueFactory(
+              ValueFactory::GetDoubleValue(42.0)),
+          expression::ExpressionUtil::TupleValueFactory(VALUE_TYPE_DOUBLE, 0,
+                                                        2)));
+
+  std::vector<oid_t> column_ids({0, 2});
+  planner::SeqScanPlan node(table.get(), predicate, column_ids);
+
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  std::unique_ptr<executor::ExecutorContext> context(
+      new executor::ExecutorContext(txn));
+
+  executor::SeqScanExecutor executor(&node, context.get());
+  EXPECT_TRUE(executor.Init());
+
+  // Tuples 1 to 3 of every populated tile group
+  std::set<int> expected_values({10, 20, 30});
+  size_t tuple_count = 0;
+  while (executor.Execute() == true) {
+    std::unique_ptr<executor::LogicalTile> result_tile(executor.GetOutput());
+    for (oid_t tuple_id : *result_tile) {
+      EXPECT_EQ(1, expected_values.count(
+                       result_tile->GetValue(tuple_id, 0).GetIntegerForTestsOnly()));
+      tuple_count++;
+    }
+  }
+  EXPECT_EQ(tuple_count, 3 * expected_values.size());
+
+  txn_manager.CommitTransaction();
+}
+
 // Sequential scan of logical tile with predicate.
 TEST_F(SeqScanTests, NonLeafNodePredicateTest) {
   // No table for this case as seq scan is not a leaf node.
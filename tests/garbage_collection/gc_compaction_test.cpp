@@ -0,0 +1,223 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// gc_compaction_test.cpp
+//
+// Identification: tests/garbage_collection/gc_compaction_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <atomic>
+
+#include "harness.h"
+
+#include "backend/catalog/schema.h"
+#include "backend/common/value_factory.h"
+#include "backend/common/types.h"
+#include "backend/common/pool.h"
+
+#include "backend/executor/executor_context.h"
+#include "backend/executor/delete_executor.h"
+#include "backend/executor/insert_executor.h"
+#include "backend/executor/seq_scan_executor.h"
+#include "backend/executor/update_executor.h"
+#include "backend/executor/logical_tile_factory.h"
+#include "backend/expression/expression_util.h"
+#include "backend/expression/tuple_value_expression.h"
+#include "backend/expression/comparison_expression.h"
+#include "backend/expression/abstract_expression.h"
+#include "backend/storage/tile.h"
+#include "backend/storage/tile_group.h"
+#include "backend/storage/table_factory.h"
+#include "backend/concurrency/transaction_manager_factory.h"
+#include "backend/gc/gc_manager_factory.h"
+#include "backend/gc/tile_group_compactor.h"
+#include "backend/index/index.h"
+
+#include "executor/executor_tests_util.h"
+#include "executor/mock_executor.h"
+
+#include "backend/planner/delete_plan.h"
+#include "backend/planner/insert_plan.h"
+#include "backend/planner/seq_scan_plan.h"
+#include "backend/planner/update_plan.h"
+
+using ::testing::NotNull;
+using ::testing::Return;
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// GC Tests
+//===--------------------------------------------------------------------===//
+
+class GCCompactionTest : public PelotonTest {};
+
+std::atomic<int> tuple_id;
+std::atomic<int> delete_tuple_id;
+enum GCType type = GC_TYPE_VACUUM;
+
+void InsertTuple(storage::DataTable *table, VarlenPool *pool) {
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  std::unique_ptr<executor::ExecutorContext> context(
+      new executor::ExecutorContext(txn));
+
+  for (oid_t tuple_itr = 0; tuple_itr < 10; tuple_itr++) {
+    auto tuple = ExecutorTestsUtil::GetTuple(table, ++tuple_id, pool);
+
+    planner::InsertPlan node(table, std::move(tuple));
+    executor::InsertExecutor executor(&node, context.get());
+    executor.Execute();
+  }
+
+  txn_manager.CommitTransaction();
+}
+
+void UpdateTuple(storage::DataTable *table) {
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  std::unique_ptr<executor::ExecutorContext> context(
+      new executor::ExecutorContext(txn));
+
+  // Update
+  std::vector<oid_t> update_column_ids = {2};
+  std::vector<Value> values;
+  Value update_val = ValueFactory::GetDoubleValue(23.5);
+
+  planner::ProjectInfo::TargetList target_list;
+  planner::ProjectInfo::DirectMapList direct_map_list;
+  target_list.emplace_back(
+      2, expression::ExpressionUtil::ConstantValueFactory(update_val));
+  LOG_INFO("%u", target_list.at(0).first);
+  direct_map_list.emplace_back(0, std::pair<oid_t, oid_t>(0, 0));
+  direct_map_list.emplace_back(1, std::pair<oid_t, oid_t>(0, 1));
+  direct_map_list.emplace_back(3, std::pair<oid_t, oid_t>(0, 3));
+
+  std::unique_ptr<const planner::ProjectInfo> project_info(
+      new planner::ProjectInfo(std::move(target_list),
+                               std::move(direct_map_list)));
+  planner::UpdatePlan update_node(table, std::move(project_info));
+
+  executor::UpdateExecutor update_executor(&update_node, context.get());
+
+  // Predicate
+
+  // WHERE ATTR_0 < 70
+  expression::TupleValueExpression *tup_val_exp =
+      new expression::TupleValueExpression(VALUE_TYPE_INTEGER, 0, 0);
+  expression::ConstantValueExpression *const_val_exp =
+      new expression::ConstantValueExpression(
+          ValueFactory::GetIntegerValue(70));
+  auto predicate = new expression::ComparisonExpression<expression::CmpLt>(
+      EXPRESSION_TYPE_COMPARE_LESSTHAN, tup_val_exp, const_val_exp);
+
+  // Seq scan
+  std::vector<oid_t> column_ids = {0};
+  std::unique_ptr<planner::SeqScanPlan> seq_scan_node(
+      new planner::SeqScanPlan(table, predicate, column_ids));
+  executor::SeqScanExecutor seq_scan_executor(seq_scan_node.get(),
+                                              context.get());
+
+  // Parent-Child relationship
+  update_node.AddChild(std::move(seq_scan_node));
+  update_executor.AddChild(&seq_scan_executor);
+
+  EXPECT_TRUE(update_executor.Init());
+  while (update_executor.Execute())
+    ;
+
+  txn_manager.CommitTransaction();
+}
+
+int SeqScanCount(storage::DataTable *table,
+                 const std::vector<oid_t> &column_ids,
+                 expression::AbstractExpression *predicate) {
+
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  std::unique_ptr<executor::ExecutorContext> context(
+      new executor::ExecutorContext(txn));
+
+  planner::SeqScanPlan seq_scan_node(table, predicate, column_ids);
+  executor::SeqScanExecutor seq_scan_executor(&seq_scan_node, context.get());
+
+  EXPECT_TRUE(seq_scan_executor.Init());
+  auto tuple_cnt = 0;
+
+  while (seq_scan_executor.Execute()) {
+    std::unique_ptr<executor::LogicalTile> result_logical_tile(
+        seq_scan_executor.GetOutput());
+    tuple_cnt += result_logical_tile->GetTupleCount();
+  }
+
+  txn_manager.CommitTransaction();
+
+  return tuple_cnt;
+}
+
+TEST_F(GCCompactionTest, CompactionTest) {
+  peloton::gc::GCManagerFactory::Configure(type);
+  // GC is driven by hand, so that every step is deterministic
+  auto &gc_manager = peloton::gc::GCManagerFactory::GetInstance();
+
+  // Small tile groups, so that the updates leave a sparse one behind
+  std::unique_ptr<storage::DataTable> table(ExecutorTestsUtil::CreateTable(10));
+  auto testing_pool = TestingHarness::GetInstance().GetTestingPool();
+  gc::TileGroupCompactor compactor(0.5);
+
+  // Fills the first tile group, then moves 6 of its tuples to the second
+  LaunchParallelTest(1, InsertTuple, table.get(), testing_pool);
+  LaunchParallelTest(1, UpdateTuple, table.get());
+  gc_manager.PerformGC();
+
+  auto first_tile_group_id = table->GetTileGroup(0)->GetTileGroupId();
+  EXPECT_EQ(gc_manager.GetRefurbishedTupleSlotCountPerTileGroup(
+                table->GetOid(), first_tile_group_id),
+            6);
+
+  // The 4 remaining tuples are moved out
+  EXPECT_EQ(compactor.CompactTable(table.get()), 0);
+  EXPECT_EQ(compactor.GetRelocatedTupleCount(), 4);
+  // Free slots of the draining tile group are not handed out anymore
+  EXPECT_TRUE(gc_manager.ReturnFreeSlot(table->GetOid()).IsNull());
+  // but stay in the free list, in case the compaction gives up on it
+  EXPECT_EQ(gc_manager.GetRefurbishedTupleSlotCountPerTileGroup(
+                table->GetOid(), first_tile_group_id),
+            6);
+
+  // Once the old versions are reclaimed the tile group is dropped
+  gc_manager.PerformGC();
+  auto tile_group_count = table->GetTileGroupCount();
+  EXPECT_EQ(compactor.CompactTable(table.get()), 1);
+  EXPECT_EQ(compactor.GetDroppedTileGroupCount(), 1);
+  EXPECT_GT(compactor.GetReclaimedMemory(), 0);
+
+  EXPECT_EQ(table->GetTileGroupCount(), tile_group_count - 1);
+  EXPECT_TRUE(table->GetTileGroupById(first_tile_group_id) == nullptr);
+
+  // No index entry leads into the dropped tile group
+  auto primary_index = table->GetIndex(0);
+  std::vector<ItemPointer> locations;
+  primary_index->ScanAllKeys(locations);
+  EXPECT_EQ(locations.size(), 10);
+  for (auto location : locations) {
+    EXPECT_NE(location.block, first_tile_group_id);
+  }
+
+  auto tuple_cnt = SeqScanCount(table.get(), {0}, nullptr);
+  EXPECT_EQ(tuple_cnt, 10);
+
+  tuple_id = 0;
+}
+
+}  // namespace test
+}  // namespace peloton
@@ -37,6 +37,8 @@
 #include "backend/storage/tile_group.h"
 #include "backend/storage/table_factory.h"
 #include "backend/concurrency/transaction_manager_factory.h"
+#include "backend/gc/gc_manager_factory.h"
+#include "backend/index/index.h"
 
 #include "executor/executor_tests_util.h"
 #include "executor/mock_executor.h"
@@ -203,5 +205,85 @@ TEST_F(GCUpdateTestVacuum, UpdateTest) {
 
 }
 
+// The versions a read-only transaction reads are kept by a GC pass that runs
+// after the transaction began, even though the transaction read nothing yet
+TEST_F(GCUpdateTestVacuum, ReadOnlySnapshotTest) {
+  peloton::gc::GCManagerFactory::Configure(type);
+  auto &gc_manager = peloton::gc::GCManagerFactory::GetInstance();
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+
+  std::unique_ptr<storage::DataTable> table(
+      ExecutorTestsUtil::CreateTable(1024));
+  auto testing_pool = TestingHarness::GetInstance().GetTestingPool();
+  LaunchParallelTest(1, InsertTuple, table.get(), testing_pool);
+
+  auto txn = txn_manager.BeginReadOnlyTransaction();
+
+  LaunchParallelTest(1, UpdateTuple, table.get());
+  gc_manager.PerformGC();
+
+  // The snapshot is older than the update, every old version is still there
+  std::unique_ptr<executor::ExecutorContext> context(
+      new executor::ExecutorContext(txn));
+  planner::SeqScanPlan seq_scan_node(table.get(), nullptr, {0});
+  executor::SeqScanExecutor seq_scan_executor(&seq_scan_node, context.get());
+
+  EXPECT_TRUE(seq_scan_executor.Init());
+  auto tuple_cnt = 0;
+  while (seq_scan_executor.Execute()) {
+    std::unique_ptr<executor::LogicalTile> result_logical_tile(
+        seq_scan_executor.GetOutput());
+    tuple_cnt += result_logical_tile->GetTupleCount();
+  }
+  EXPECT_EQ(tuple_cnt, 10);
+  EXPECT_EQ(txn_manager.CommitTransaction(), RESULT_SUCCESS);
+
+  tuple_id = 0;
+}
+
+TEST_F(GCUpdateTestVacuum, IndexReclaimTest) {
+  peloton::gc::GCManagerFactory::Configure(type);
+  auto &gc_manager = peloton::gc::GCManagerFactory::GetInstance();
+
+  std::unique_ptr<storage::DataTable> table(
+      ExecutorTestsUtil::CreateTable(1024));
+  auto testing_pool = TestingHarness::GetInstance().GetTestingPool();
+
+  auto reclaimed_entries_before = gc_manager.GetReclaimedIndexEntryCount();
+  auto reclaimed_memory_before = gc_manager.GetReclaimedIndexMemory();
+
+  LaunchParallelTest(1, InsertTuple, table.get(), testing_pool);
+  LaunchParallelTest(1, UpdateTuple, table.get());
+
+  // Every new version got its own secondary index entry
+  auto secondary_index = table->GetIndex(1);
+  std::vector<ItemPointer> locations;
+  secondary_index->ScanAllKeys(locations);
+  EXPECT_EQ(locations.size(), 16);
+
+  // No transaction is running, a single pass reclaims every old version
+  gc_manager.PerformGC();
+
+  // The entries of the old versions are gone
+  locations.clear();
+  secondary_index->ScanAllKeys(locations);
+  EXPECT_EQ(locations.size(), 10);
+
+  EXPECT_EQ(gc_manager.GetReclaimedIndexEntryCount() - reclaimed_entries_before,
+            6);
+  EXPECT_GT(gc_manager.GetReclaimedIndexMemory(), reclaimed_memory_before);
+
+  // The primary index still leads to every tuple
+  auto primary_index = table->GetIndex(0);
+  std::vector<ItemPointer *> location_ptrs;
+  primary_index->ScanAllKeys(location_ptrs);
+  EXPECT_EQ(location_ptrs.size(), 10);
+
+  auto tuple_cnt = SeqScanCount(table.get(), {0}, nullptr);
+  EXPECT_EQ(tuple_cnt, 10);
+
+  tuple_id = 0;
+}
+
 }  // namespace test
 }  // namespace peloton
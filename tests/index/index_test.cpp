@@ -109,6 +109,32 @@ TEST_F(IndexTests, BasicTest) {
   delete tuple_schema;
 }
 
+TEST_F(IndexTests, BulkLoadFallbackTest) {
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  std::vector<ItemPointer> locations;
+
+  // INDEX
+  std::unique_ptr<index::Index> index(BuildIndex(true));
+
+  std::unique_ptr<storage::Tuple> key0(new storage::Tuple(key_schema, true));
+  key0->SetValue(0, ValueFactory::GetIntegerValue(100), pool);
+  key0->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+
+  // The fallback of indexes without bulk loading reports duplicate keys
+  index->index::Index::BulkLoadEntry(key0.get(), item0);
+  EXPECT_TRUE(index->index::Index::FinishBulkLoad());
+
+  index->index::Index::BulkLoadEntry(key0.get(), item1);
+  EXPECT_FALSE(index->index::Index::FinishBulkLoad());
+
+  index->ScanKey(key0.get(), locations);
+  EXPECT_EQ(locations.size(), 1);
+  EXPECT_EQ(locations[0].offset, item0.offset);
+  locations.clear();
+
+  delete tuple_schema;
+}
+
 // INSERT HELPER FUNCTION
 void InsertTest(index::Index *index, VarlenPool *pool, size_t scale_factor) {
   // Loop based on scale factor
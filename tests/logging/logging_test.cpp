@@ -17,6 +17,7 @@
 #include "backend/storage/data_table.h"
 #include "backend/storage/tile.h"
 #include "backend/logging/loggers/wal_frontend_logger.h"
+#include "backend/logging/log_segment_manager.h"
 
 #include "executor/mock_executor.h"
 #include "executor/executor_tests_util.h"
@@ -173,6 +174,172 @@ TEST_F(LoggingTests, BasicUpdateTest) {
   EXPECT_EQ(recovery_table->GetTileGroupCount(), 2);
 }
 
+TEST_F(LoggingTests, DeltaUpdateTest) {
+  auto recovery_table = ExecutorTestsUtil::CreateTable(1024);
+  auto &manager = catalog::Manager::GetInstance();
+  storage::Database db(DEFAULT_DB_ID);
+  manager.AddDatabase(&db);
+  db.AddTable(recovery_table);
+
+  auto tuples = BuildLoggingTuples(recovery_table, 2, false, false);
+  EXPECT_EQ(tuples.size(), 2);
+  logging::WriteAheadFrontendLogger fel(true);
+  cid_t test_commit_id = 10;
+
+  Value val0 = tuples[0]->GetValue(0);
+  Value val2 = tuples[0]->GetValue(2);
+  Value val3 = tuples[0]->GetValue(3);
+  Value new_val1 = tuples[1]->GetValue(1);
+
+  // Recover the prior version first
+  auto curr_rec = new logging::TupleRecord(
+      LOGRECORD_TYPE_TUPLE_INSERT, test_commit_id, recovery_table->GetOid(),
+      ItemPointer(100, 4), INVALID_ITEMPOINTER, tuples[0], DEFAULT_DB_ID);
+  curr_rec->SetTuple(tuples[0]);
+  fel.InsertTuple(curr_rec);
+  delete curr_rec;
+
+  // Round trip the delta body carrying only column 1
+  std::vector<oid_t> delta_columns = {1};
+  CopySerializeOutput output;
+  tuples[1]->SerializeColumnsTo(output, delta_columns);
+  delete tuples[1];
+
+  CopySerializeInputBE input(output.Data(), output.Size());
+  std::vector<oid_t> read_columns;
+  auto delta_tuple = new storage::Tuple(recovery_table->GetSchema(), true);
+  delta_tuple->DeserializeColumnsFrom(
+      input, TestingHarness::GetInstance().GetTestingPool(), read_columns);
+  EXPECT_EQ(read_columns, delta_columns);
+
+  curr_rec = new logging::TupleRecord(
+      LOGRECORD_TYPE_TUPLE_DELTA_UPDATE, test_commit_id + 1,
+      recovery_table->GetOid(), ItemPointer(100, 5), ItemPointer(100, 4),
+      delta_tuple, DEFAULT_DB_ID);
+  curr_rec->SetTuple(delta_tuple);
+  curr_rec->SetDeltaColumns(read_columns);
+  fel.UpdateTuple(curr_rec);
+  delete curr_rec;
+
+  auto tg_header = recovery_table->GetTileGroupById(100)->GetHeader();
+  EXPECT_EQ(tg_header->GetEndCommitId(5), MAX_CID);
+  EXPECT_EQ(tg_header->GetEndCommitId(4), test_commit_id + 1);
+
+  // Unmodified columns come from the prior version
+  auto tile_group = recovery_table->GetTileGroupById(100);
+  EXPECT_TRUE(val0.Compare(tile_group->GetValue(5, 0)) == 0);
+  EXPECT_TRUE(new_val1.Compare(tile_group->GetValue(5, 1)) == 0);
+  EXPECT_TRUE(val2.Compare(tile_group->GetValue(5, 2)) == 0);
+  EXPECT_TRUE(val3.Compare(tile_group->GetValue(5, 3)) == 0);
+
+  EXPECT_EQ(recovery_table->GetNumberOfTuples(), 1);
+}
+
+TEST_F(LoggingTests, SegmentRecycleTest) {
+  std::string log_directory = "/tmp/peloton_segment_test";
+  mkdir(log_directory.c_str(), 0700);
+  std::string first_segment = log_directory + "/peloton_log_0.log";
+  std::string second_segment = log_directory + "/peloton_log_1.log";
+
+  size_t segment_size = 16 * logging::LogSegmentManager::block_size;
+  logging::LogSegmentManager segment_manager(log_directory, segment_size,
+                                             true);
+  EXPECT_NE(segment_manager.OpenSegment(first_segment), -1);
+
+  // Fill up the segment, syncing every few records
+  char record[1000];
+  memset(record, 7, sizeof(record));
+  size_t record_count = 0;
+  while (segment_manager.HasSpaceFor(sizeof(record))) {
+    segment_manager.Write(record, sizeof(record));
+    if (++record_count % 3 == 0) {
+      segment_manager.Sync();
+    }
+  }
+  segment_manager.CloseSegment(42);
+
+  // The segment never grows and ends with a zero byte
+  FILE *segment_file = fopen(first_segment.c_str(), "rb");
+  txn_id_t max_commit_id = 0;
+  EXPECT_EQ(fread(&max_commit_id, sizeof(max_commit_id), 1, segment_file), 1);
+  EXPECT_EQ(max_commit_id, 42);
+  fseek(segment_file, 0, SEEK_END);
+  EXPECT_EQ(ftell(segment_file), segment_size);
+  fseek(segment_file, sizeof(txn_id_t) + record_count * sizeof(record) - 1,
+        SEEK_SET);
+  EXPECT_EQ(fgetc(segment_file), 7);
+  EXPECT_EQ(fgetc(segment_file), 0);
+  fclose(segment_file);
+
+  // A recycled segment starts out empty
+  segment_manager.RecycleSegment(first_segment);
+  EXPECT_EQ(segment_manager.GetSpareSegmentCount(), 1);
+  EXPECT_NE(segment_manager.OpenSegment(second_segment), -1);
+  EXPECT_EQ(segment_manager.GetSpareSegmentCount(), 0);
+
+  segment_file = fopen(second_segment.c_str(), "rb");
+  EXPECT_EQ(fread(&max_commit_id, sizeof(max_commit_id), 1, segment_file), 1);
+  EXPECT_EQ(max_commit_id, 0);
+  EXPECT_EQ(fgetc(segment_file), 0);
+  fclose(segment_file);
+
+  segment_manager.CloseSegment(0);
+  remove(second_segment.c_str());
+  rmdir(log_directory.c_str());
+}
+
+TEST_F(LoggingTests, SegmentSwitchTest) {
+  std::string log_directory = "/tmp/peloton_segment_test";
+  mkdir(log_directory.c_str(), 0700);
+  std::string first_segment = log_directory + "/peloton_log_0.log";
+  std::string second_segment = log_directory + "/peloton_log_1.log";
+
+  size_t segment_size = 16 * logging::LogSegmentManager::block_size;
+  logging::LogSegmentManager segment_manager(log_directory, segment_size,
+                                             false);
+  EXPECT_NE(segment_manager.OpenSegment(first_segment), -1);
+
+  char record[1000];
+  memset(record, 7, sizeof(record));
+  segment_manager.Write(record, sizeof(record));
+
+  // The current segment stays open if the next one cannot be opened
+  EXPECT_EQ(segment_manager.SwitchSegment(log_directory + "/missing/log", 1),
+            -1);
+  EXPECT_TRUE(segment_manager.IsOpen());
+  segment_manager.Write(record, sizeof(record));
+  EXPECT_NE(segment_manager.SwitchSegment(second_segment, 42), -1);
+
+  FILE *segment_file = fopen(first_segment.c_str(), "rb");
+  txn_id_t max_commit_id = 0;
+  EXPECT_EQ(fread(&max_commit_id, sizeof(max_commit_id), 1, segment_file), 1);
+  EXPECT_EQ(max_commit_id, 42);
+  fseek(segment_file, sizeof(txn_id_t) + 2 * sizeof(record) - 1, SEEK_SET);
+  EXPECT_EQ(fgetc(segment_file), 7);
+  EXPECT_EQ(fgetc(segment_file), 0);
+  fclose(segment_file);
+
+  // A record larger than a segment grows the segment it is written to
+  std::vector<char> large_record(2 * segment_size, 9);
+  EXPECT_FALSE(segment_manager.HasSpaceFor(large_record.size()));
+  segment_manager.Write(large_record.data(), large_record.size());
+  segment_manager.Sync();
+  EXPECT_GT(segment_manager.GetFileSize(), segment_size);
+  segment_manager.CloseSegment(43);
+
+  segment_file = fopen(second_segment.c_str(), "rb");
+  fseek(segment_file, sizeof(txn_id_t) + large_record.size() - 1, SEEK_SET);
+  EXPECT_EQ(fgetc(segment_file), 9);
+  EXPECT_EQ(fgetc(segment_file), 0);
+  fclose(segment_file);
+
+  // Only segments of the regular size are recycled
+  segment_manager.RecycleSegment(second_segment);
+  EXPECT_EQ(segment_manager.GetSpareSegmentCount(), 0);
+  remove(first_segment.c_str());
+  rmdir(log_directory.c_str());
+}
+
 /* TODO: Fix this
 TEST_F(LoggingTests, BasicDeleteTest) {
   auto recovery_table = ExecutorTestsUtil::CreateTable(1024);
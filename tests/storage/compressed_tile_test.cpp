@@ -0,0 +1,324 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// compressed_tile_test.cpp
+//
+// Identification: tests/storage/compressed_tile_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <string>
+
+#include "harness.h"
+
+#include "backend/common/value_factory.h"
+#include "backend/concurrency/transaction_manager_factory.h"
+#include "backend/executor/executor_context.h"
+#include "backend/executor/logical_tile.h"
+#include "backend/executor/seq_scan_executor.h"
+#include "backend/expression/comparison_expression.h"
+#include "backend/expression/conjunction_expression.h"
+#include "backend/expression/constant_value_expression.h"
+#include "backend/expression/tuple_value_expression.h"
+#include "backend/planner/seq_scan_plan.h"
+#include "backend/storage/compressed_column.h"
+#include "backend/storage/data_table.h"
+#include "backend/storage/tile.h"
+#include "backend/storage/tile_group.h"
+#include "backend/storage/tuple.h"
+#include "backend/storage/tuple_iterator.h"
+
+#include "executor/executor_tests_util.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Compressed Tile Tests
+//===--------------------------------------------------------------------===//
+
+class CompressedTileTests : public PelotonTest {};
+
+TEST_F(CompressedTileTests, EncodingTest) {
+  const oid_t tuple_count = 1000;
+
+  std::vector<catalog::Column> columns = {
+      catalog::Column(VALUE_TYPE_INTEGER, GetTypeSize(VALUE_TYPE_INTEGER),
+                      "ID", true),
+      catalog::Column(VALUE_TYPE_VARCHAR, 32, "CITY", false),
+      catalog::Column(VALUE_TYPE_INTEGER, GetTypeSize(VALUE_TYPE_INTEGER),
+                      "YEAR", true),
+      catalog::Column(VALUE_TYPE_DOUBLE, GetTypeSize(VALUE_TYPE_DOUBLE),
+                      "PRICE", true)};
+  catalog::Schema schema(columns);
+
+  std::unique_ptr<storage::Tile> tile(
+      storage::TileFactory::GetTempTile(schema, tuple_count));
+
+  for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+    tile->SetValue(ValueFactory::GetIntegerValue(100000 + tuple_itr),
+                   tuple_itr, 0);
+    // every tenth city is unknown
+    if (tuple_itr % 10 == 0) {
+      tile->SetValue(Value::GetNullValue(VALUE_TYPE_VARCHAR), tuple_itr, 1);
+    } else {
+      tile->SetValue(ValueFactory::GetStringValue(
+                         "city" + std::to_string(tuple_itr % 4)),
+                     tuple_itr, 1);
+    }
+    tile->SetValue(ValueFactory::GetIntegerValue(2000 + tuple_itr / 250),
+                   tuple_itr, 2);
+    tile->SetValue(ValueFactory::GetDoubleValue(tuple_itr * 1.5), tuple_itr,
+                   3);
+  }
+
+  std::vector<std::unique_ptr<storage::CompressedColumn>> compressed_columns;
+  for (oid_t column_itr = 0; column_itr < columns.size(); column_itr++) {
+    compressed_columns.emplace_back(storage::CompressedColumn::Compress(
+        tile.get(), column_itr, tuple_count));
+  }
+
+  EXPECT_EQ(compressed_columns[0]->GetEncodingType(),
+            storage::CompressedColumn::ENCODING_TYPE_FRAME_OF_REFERENCE);
+  EXPECT_EQ(compressed_columns[1]->GetEncodingType(),
+            storage::CompressedColumn::ENCODING_TYPE_DICTIONARY);
+  EXPECT_EQ(compressed_columns[2]->GetEncodingType(),
+            storage::CompressedColumn::ENCODING_TYPE_RUN_LENGTH);
+  EXPECT_EQ(compressed_columns[3]->GetEncodingType(),
+            storage::CompressedColumn::ENCODING_TYPE_PLAIN);
+
+  // Ids take 10 bits instead of 32, and a year per run
+  EXPECT_LT(compressed_columns[0]->GetSize(), tuple_count * 2);
+  EXPECT_LT(compressed_columns[2]->GetSize(), 100);
+
+  // Every value comes back
+  for (oid_t column_itr = 0; column_itr < columns.size(); column_itr++) {
+    for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+      auto value = tile->GetValue(tuple_itr, column_itr);
+      auto decoded_value = compressed_columns[column_itr]->GetValue(tuple_itr);
+      EXPECT_EQ(value.IsNull(), decoded_value.IsNull());
+      if (value.IsNull() == false) {
+        EXPECT_EQ(value.Compare(decoded_value), 0);
+      }
+    }
+  }
+
+  // Comparisons on the encoded columns match comparing the values
+  std::vector<ExpressionType> comparisons = {
+      EXPRESSION_TYPE_COMPARE_EQUAL, EXPRESSION_TYPE_COMPARE_NOTEQUAL,
+      EXPRESSION_TYPE_COMPARE_LESSTHAN, EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+      EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO,
+      EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO};
+  std::vector<Value> constants = {
+      ValueFactory::GetIntegerValue(100500),
+      ValueFactory::GetStringValue("city2"),
+      ValueFactory::GetIntegerValue(2002),
+      ValueFactory::GetDoubleValue(300.0)};
+
+  for (oid_t column_itr = 0; column_itr < columns.size(); column_itr++) {
+    for (auto comparison : comparisons) {
+      std::vector<bool> matches(tuple_count, true);
+      compressed_columns[column_itr]->EvaluateComparison(
+          comparison, constants[column_itr], matches);
+
+      for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+        auto value = tile->GetValue(tuple_itr, column_itr);
+        bool expected = false;
+        if (value.IsNull() == false) {
+          int result = value.Compare(constants[column_itr]);
+          switch (comparison) {
+            case EXPRESSION_TYPE_COMPARE_EQUAL:
+              expected = (result == 0);
+              break;
+            case EXPRESSION_TYPE_COMPARE_NOTEQUAL:
+              expected = (result != 0);
+              break;
+            case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+              expected = (result < 0);
+              break;
+            case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+              expected = (result > 0);
+              break;
+            case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+              expected = (result <= 0);
+              break;
+            default:
+              expected = (result >= 0);
+              break;
+          }
+        }
+        EXPECT_EQ(matches[tuple_itr], expected);
+      }
+    }
+  }
+
+  // The compressed columns keep their uninlined data in the tile pool
+  compressed_columns.clear();
+}
+
+// Counts the tuples with COL_A < 500 and COL_B >= 101
+static int ScanCount(storage::DataTable *table) {
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  std::unique_ptr<executor::ExecutorContext> context(
+      new executor::ExecutorContext(txn));
+
+  auto col_a_predicate =
+      new expression::ComparisonExpression<expression::CmpLt>(
+          EXPRESSION_TYPE_COMPARE_LESSTHAN,
+          new expression::TupleValueExpression(VALUE_TYPE_INTEGER, 0, 0),
+          new expression::ConstantValueExpression(
+              ValueFactory::GetIntegerValue(500)));
+  // written the other way round
+  auto col_b_predicate =
+      new expression::ComparisonExpression<expression::CmpLte>(
+          EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO,
+          new expression::ConstantValueExpression(
+              ValueFactory::GetIntegerValue(101)),
+          new expression::TupleValueExpression(VALUE_TYPE_INTEGER, 0, 1));
+  auto predicate =
+      new expression::ConjunctionExpression<expression::ConjunctionAnd>(
+          EXPRESSION_TYPE_CONJUNCTION_AND, col_a_predicate, col_b_predicate);
+
+  std::vector<oid_t> column_ids = {0, 3};
+  planner::SeqScanPlan seq_scan_node(table, predicate, column_ids);
+  executor::SeqScanExecutor seq_scan_executor(&seq_scan_node, context.get());
+
+  EXPECT_TRUE(seq_scan_executor.Init());
+  int tuple_count = 0;
+  while (seq_scan_executor.Execute()) {
+    std::unique_ptr<executor::LogicalTile> result_logical_tile(
+        seq_scan_executor.GetOutput());
+    tuple_count += result_logical_tile->GetTupleCount();
+  }
+
+  txn_manager.CommitTransaction();
+  return tuple_count;
+}
+
+TEST_F(CompressedTileTests, FreezeTest) {
+  const int tuple_count = 100;
+
+  // Two full tile groups and one still taking inserts
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  txn_manager.BeginTransaction();
+  std::unique_ptr<storage::DataTable> data_table(
+      ExecutorTestsUtil::CreateTable(tuple_count, false));
+  ExecutorTestsUtil::PopulateTable(data_table.get(),
+                                   tuple_count * 2 + tuple_count / 2, false,
+                                   false, false);
+  txn_manager.CommitTransaction();
+  EXPECT_EQ(data_table->GetTileGroupCount(), 3);
+
+  EXPECT_EQ(ScanCount(data_table.get()), 40);
+
+  auto tile_group_ids = data_table->GetTileGroupIds();
+  auto tile_group = data_table->GetTileGroupById(tile_group_ids[0]);
+  auto memory_footprint = tile_group->GetMemoryFootprint(0);
+
+  EXPECT_EQ(data_table->FreezeTileGroupById(tile_group_ids[2]), nullptr);
+  EXPECT_NE(data_table->FreezeTileGroupById(tile_group_ids[0]), nullptr);
+  EXPECT_NE(data_table->FreezeTileGroupById(tile_group_ids[1]), nullptr);
+  EXPECT_EQ(data_table->FreezeTileGroupById(tile_group_ids[0]), nullptr);
+
+  auto frozen_tile_group = data_table->GetTileGroupById(tile_group_ids[0]);
+  EXPECT_TRUE(frozen_tile_group->IsFrozen());
+  EXPECT_LT(frozen_tile_group->GetMemoryFootprint(0), memory_footprint);
+
+  // Same values and versions as before
+  for (oid_t tuple_itr = 0; tuple_itr < (oid_t)tuple_count; tuple_itr++) {
+    for (oid_t column_itr = 0; column_itr < 4; column_itr++) {
+      EXPECT_EQ(tile_group->GetValue(tuple_itr, column_itr)
+                    .Compare(frozen_tile_group->GetValue(tuple_itr, column_itr)),
+                0);
+    }
+    EXPECT_EQ(frozen_tile_group->GetHeader()->GetTransactionId(tuple_itr),
+              INITIAL_TXN_ID);
+  }
+
+  // The predicate is evaluated on the encoded columns
+  EXPECT_EQ(ScanCount(data_table.get()), 40);
+
+  // Writing a tuple slot thaws the tile group
+  std::unique_ptr<storage::Tuple> tuple(
+      new storage::Tuple(data_table->GetSchema(), true));
+  auto testing_pool = TestingHarness::GetInstance().GetTestingPool();
+  tuple->SetValue(0, ValueFactory::GetIntegerValue(7), testing_pool);
+  tuple->SetValue(1, ValueFactory::GetIntegerValue(8), testing_pool);
+  tuple->SetValue(2, ValueFactory::GetDoubleValue(9), testing_pool);
+  tuple->SetValue(3, ValueFactory::GetStringValue("10"), testing_pool);
+  frozen_tile_group->CopyTuple(tuple.get(), 0);
+
+  EXPECT_FALSE(frozen_tile_group->IsFrozen());
+  EXPECT_EQ(frozen_tile_group->GetValue(0, 3).Compare(
+                ValueFactory::GetStringValue("10")),
+            0);
+  for (oid_t tuple_itr = 1; tuple_itr < (oid_t)tuple_count; tuple_itr++) {
+    for (oid_t column_itr = 0; column_itr < 4; column_itr++) {
+      EXPECT_EQ(tile_group->GetValue(tuple_itr, column_itr)
+                    .Compare(frozen_tile_group->GetValue(tuple_itr, column_itr)),
+                0);
+    }
+  }
+
+  // The thawed tile group is scanned as usual
+  EXPECT_EQ(ScanCount(data_table.get()), 40);
+  EXPECT_TRUE(data_table->GetTileGroupById(tile_group_ids[1])->IsFrozen());
+}
+
+TEST_F(CompressedTileTests, FrozenTileReadTest) {
+  const int tuple_count = 100;
+
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  txn_manager.BeginTransaction();
+  std::unique_ptr<storage::DataTable> data_table(
+      ExecutorTestsUtil::CreateTable(tuple_count, false));
+  ExecutorTestsUtil::PopulateTable(data_table.get(), tuple_count * 2, false,
+                                   false, false);
+  txn_manager.CommitTransaction();
+
+  auto tile_group_id = data_table->GetTileGroupIds()[0];
+  EXPECT_NE(data_table->FreezeTileGroupById(tile_group_id), nullptr);
+  auto tile_group = data_table->GetTileGroupById(tile_group_id);
+
+  // Iterating over and copying a frozen tile leave it frozen
+  for (oid_t tile_itr = 0; tile_itr < tile_group->GetTileCount(); tile_itr++) {
+    auto tile = tile_group->GetTile(tile_itr);
+    auto column_count = tile->GetColumnCount();
+    EXPECT_TRUE(tile->IsFrozen());
+
+    storage::TupleIterator tuple_iterator(tile);
+    storage::Tuple tuple(tile->GetSchema());
+    oid_t tuple_offset = 0;
+    while (tuple_iterator.Next(tuple)) {
+      for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+        EXPECT_EQ(tuple.GetValue(column_itr)
+                      .Compare(tile->GetValue(tuple_offset, column_itr)),
+                  0);
+      }
+      tuple_offset++;
+    }
+    tuple.SetNull();
+    EXPECT_EQ(tuple_offset, tuple_count);
+
+    std::unique_ptr<storage::Tile> tile_copy(tile->CopyTile(BACKEND_TYPE_MM));
+    EXPECT_FALSE(tile_copy->IsFrozen());
+    for (tuple_offset = 0; tuple_offset < (oid_t)tuple_count; tuple_offset++) {
+      for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+        EXPECT_EQ(tile_copy->GetValue(tuple_offset, column_itr)
+                      .Compare(tile->GetValue(tuple_offset, column_itr)),
+                  0);
+      }
+    }
+
+    EXPECT_TRUE(tile->IsFrozen());
+  }
+  EXPECT_TRUE(tile_group->IsFrozen());
+}
+
+}  // End test namespace
+}  // End peloton namespace
@@ -10,10 +10,19 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include <thread>
+
 #include "harness.h"
 
+#include "backend/common/value_factory.h"
+#include "backend/common/value_peeker.h"
+#include "backend/index/index.h"
 #include "backend/storage/data_table.h"
 #include "backend/storage/tile_group.h"
+#include "backend/storage/tile_group_header.h"
 #include "backend/concurrency/transaction_manager_factory.h"
 #include "executor/executor_tests_util.h"
 
@@ -69,5 +78,161 @@ TEST_F(DataTableTests, TransformTileGroupTest) {
   data_table->TransformTileGroup(0, theta);
 }
 
+std::atomic<oid_t> insert_tuple_id(0);
+
+void InsertTuples(storage::DataTable *table, VarlenPool *pool) {
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  txn_manager.BeginTransaction();
+  for (oid_t tuple_itr = 0; tuple_itr < 25; tuple_itr++) {
+    auto tuple = ExecutorTestsUtil::GetTuple(table, ++insert_tuple_id, pool);
+    EXPECT_FALSE(table->InsertTuple(tuple.get()).IsNull());
+  }
+  txn_manager.CommitTransaction();
+}
+
+TEST_F(DataTableTests, ActiveTileGroupTest) {
+  peloton_active_tilegroup_count = 4;
+  std::unique_ptr<storage::DataTable> data_table(
+      ExecutorTestsUtil::CreateTable(10));
+  peloton_active_tilegroup_count = 1;
+
+  EXPECT_EQ(data_table->GetActiveTileGroupCount(), 4);
+  EXPECT_EQ(data_table->GetTileGroupCount(), 4);
+
+  auto testing_pool = TestingHarness::GetInstance().GetTestingPool();
+  LaunchParallelTest(4, InsertTuples, data_table.get(), testing_pool);
+
+  // Every tuple got its own slot, and full tile groups were replaced
+  size_t tuple_count = 0;
+  for (auto tile_group_id : data_table->GetTileGroupIds()) {
+    auto tile_group = data_table->GetTileGroupById(tile_group_id);
+    tuple_count += std::min(tile_group->GetNextTupleSlot(),
+                            tile_group->GetAllocatedTupleCount());
+  }
+  EXPECT_EQ(tuple_count, 100);
+  EXPECT_GE(data_table->GetTileGroupCount(), 10);
+}
+
+// Tuples that are copied into their slots while the tile groups are swapped
+// end up in the current tile groups
+TEST_F(DataTableTests, SwapWhileInsertingTest) {
+  std::unique_ptr<storage::DataTable> data_table(
+      ExecutorTestsUtil::CreateTable(10));
+  auto first_tuple_id = insert_tuple_id.load();
+
+  std::atomic<bool> is_inserting(true);
+  std::thread swapper([&] {
+    while (is_inserting == true) {
+      for (auto tile_group_id : data_table->GetTileGroupIds()) {
+        data_table->TransformTileGroupById(tile_group_id, 0.0);
+      }
+    }
+  });
+
+  auto testing_pool = TestingHarness::GetInstance().GetTestingPool();
+  LaunchParallelTest(4, InsertTuples, data_table.get(), testing_pool);
+  is_inserting = false;
+  swapper.join();
+
+  std::set<int> values;
+  for (auto tile_group_id : data_table->GetTileGroupIds()) {
+    auto tile_group = data_table->GetTileGroupById(tile_group_id);
+    auto tuple_count = std::min(tile_group->GetNextTupleSlot(),
+                                tile_group->GetAllocatedTupleCount());
+    for (oid_t tuple_id = 0; tuple_id < tuple_count; tuple_id++) {
+      values.insert(
+          ValuePeeker::PeekAsInteger(tile_group->GetValue(tuple_id, 0)));
+    }
+  }
+  EXPECT_EQ(values.size(), 100);
+  for (oid_t tuple_id = first_tuple_id + 1; tuple_id <= first_tuple_id + 100;
+       tuple_id++) {
+    EXPECT_EQ(values.count(ExecutorTestsUtil::PopulatedValue(tuple_id, 0)), 1);
+  }
+}
+
+static size_t GetIndexEntryCount(index::Index *index) {
+  std::vector<ItemPointer> locations;
+  index->ScanAllKeys(locations);
+  return locations.size();
+}
+
+TEST_F(DataTableTests, BulkLoadTest) {
+  std::unique_ptr<storage::DataTable> data_table(
+      ExecutorTestsUtil::CreateTable(10));
+  auto testing_pool = TestingHarness::GetInstance().GetTestingPool();
+  auto primary_index = data_table->GetIndex(0);
+  auto secondary_index = data_table->GetIndex(1);
+
+  std::vector<std::unique_ptr<storage::Tuple>> tuples;
+  for (oid_t tuple_itr = 0; tuple_itr < 25; tuple_itr++) {
+    tuples.push_back(
+        ExecutorTestsUtil::GetTuple(data_table.get(), tuple_itr, testing_pool));
+  }
+  data_table->BulkInsertTuples(tuples);
+
+  // The loaded tuples are in tile groups in front of the one taking inserts
+  auto tile_group_ids = data_table->GetTileGroupIds();
+  EXPECT_EQ(tile_group_ids.size(), 4);
+  EXPECT_EQ(data_table->GetTileGroup(3)->GetNextTupleSlot(), 0);
+  EXPECT_EQ(data_table->GetNumberOfTuples(), 25);
+
+  auto tile_group = data_table->GetTileGroup(0);
+  auto tile_group_header = tile_group->GetHeader();
+  EXPECT_EQ(tile_group_header->GetTransactionId(0), INITIAL_TXN_ID);
+  EXPECT_EQ(tile_group_header->GetBeginCommitId(0), START_CID);
+  EXPECT_EQ(tile_group_header->GetEndCommitId(0), MAX_CID);
+  EXPECT_EQ(tile_group->GetValue(0, 0).Compare(ValueFactory::GetIntegerValue(
+                ExecutorTestsUtil::PopulatedValue(0, 0))),
+            0);
+
+  // The indexes are only built on request
+  EXPECT_EQ(GetIndexEntryCount(primary_index), 0);
+  EXPECT_TRUE(data_table->BuildIndexes());
+  EXPECT_EQ(GetIndexEntryCount(primary_index), 25);
+  EXPECT_EQ(GetIndexEntryCount(secondary_index), 25);
+  EXPECT_EQ(primary_index->GetNumberOfTuples(), 25);
+
+  // Transactions keep inserting into the last tile group
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  txn_manager.BeginTransaction();
+  auto tuple = ExecutorTestsUtil::GetTuple(data_table.get(), 25, testing_pool);
+  auto location = data_table->InsertTuple(tuple.get());
+  txn_manager.CommitTransaction();
+  EXPECT_EQ(location.block, tile_group_ids[3]);
+  EXPECT_EQ(GetIndexEntryCount(primary_index), 26);
+
+  // More tuples fill up the last loaded tile group first
+  tuples.clear();
+  for (oid_t tuple_itr = 30; tuple_itr < 35; tuple_itr++) {
+    tuples.push_back(
+        ExecutorTestsUtil::GetTuple(data_table.get(), tuple_itr, testing_pool));
+  }
+  data_table->BulkInsertTuples(tuples);
+  EXPECT_EQ(data_table->GetTileGroupCount(), 4);
+  EXPECT_TRUE(data_table->BuildIndexes());
+  EXPECT_EQ(GetIndexEntryCount(primary_index), 31);
+  EXPECT_EQ(GetIndexEntryCount(secondary_index), 31);
+
+  // A duplicate primary key leaves the indexes as they were, and the loaded
+  // version is made invisible
+  auto tuple_count = data_table->GetNumberOfTuples();
+  tuples.clear();
+  tuples.push_back(
+      ExecutorTestsUtil::GetTuple(data_table.get(), 0, testing_pool));
+  data_table->BulkInsertTuples(tuples);
+  EXPECT_FALSE(data_table->BuildIndexes());
+  EXPECT_EQ(GetIndexEntryCount(primary_index), 31);
+  EXPECT_EQ(GetIndexEntryCount(secondary_index), 31);
+  EXPECT_EQ(data_table->GetNumberOfTuples(), tuple_count);
+
+  // the last loaded tile group was full, the version is in a new one
+  tile_group = data_table->GetTileGroup(data_table->GetTileGroupCount() - 2);
+  tile_group_header = tile_group->GetHeader();
+  auto tuple_slot = tile_group->GetNextTupleSlot() - 1;
+  EXPECT_EQ(tile_group_header->GetTransactionId(tuple_slot), INVALID_TXN_ID);
+  EXPECT_EQ(tile_group_header->GetBeginCommitId(tuple_slot), MAX_CID);
+}
+
 }  // End test namespace
 }  // End peloton namespace
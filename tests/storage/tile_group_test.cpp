@@ -127,6 +127,23 @@ TEST_F(TileGroupTests, BasicTest) {
 
   EXPECT_EQ(3, tile_group->GetActiveTupleCount());
 
+  // The columns are found through the flattened column map
+  auto &column_location = tile_group->GetColumnLocation(3);
+  EXPECT_EQ(column_location.tile, tile_group->GetTile(1));
+  EXPECT_EQ(column_location.tile_offset, 1);
+  EXPECT_EQ(column_location.tile_column_offset, 1);
+  EXPECT_EQ(column_location.column_offset, schemas[1].GetOffset(1));
+  EXPECT_EQ(column_location.column_type, VALUE_TYPE_VARCHAR);
+  EXPECT_FALSE(column_location.is_inlined);
+  EXPECT_EQ(tile_group->GetColumnLocation(2).column_type, VALUE_TYPE_TINYINT);
+  EXPECT_TRUE(tile_group->GetColumnLocation(2).is_inlined);
+
+  EXPECT_EQ(tile_group->GetValue(1, 1).Compare(ValueFactory::GetIntegerValue(2)),
+            0);
+  EXPECT_EQ(tile_group->GetValue(1, 3).Compare(
+                ValueFactory::GetStringValue("tuple 2")),
+            0);
+
   delete tuple1;
   delete tuple2;
   delete schema;
@@ -12,6 +12,7 @@
 
 #include "harness.h"
 
+#include "backend/common/value_factory.h"
 #include "backend/storage/tile.h"
 #include "backend/storage/tile_group.h"
 #include "backend/storage/tuple_iterator.h"
@@ -94,6 +95,23 @@ TEST_F(TileTests, BasicTest) {
   tile->InsertTuple(1, tuple2);
   tile->InsertTuple(2, tuple3);
 
+  // Typed views of the fixed length columns
+  auto column_span = tile->GetColumnSpan<int32_t>(1, 3);
+  EXPECT_FALSE(column_span.IsEmpty());
+  EXPECT_EQ(column_span.GetSize(), 3);
+  EXPECT_EQ(column_span.GetStride(), schema->GetLength());
+  EXPECT_EQ(column_span[0], 1);
+  EXPECT_EQ(column_span[2], 3);
+  EXPECT_FALSE(column_span.IsNull(1));
+  EXPECT_EQ(tile->GetColumnSpan<int8_t>(2, 3)[1], 2);
+  EXPECT_TRUE(tile->GetColumnSpan<int64_t>(1, 3).IsEmpty());
+  EXPECT_TRUE(tile->GetColumnSpan<int32_t>(3, 3).IsEmpty());
+
+  tuple3->SetValue(1, ValueFactory::GetNullValueByType(VALUE_TYPE_INTEGER),
+                   pool);
+  tile->InsertTuple(3, tuple3);
+  EXPECT_TRUE(tile->GetColumnSpan<int32_t>(1, 4).IsNull(3));
+
   delete tuple1;
   delete tuple2;
   delete tuple3;
@@ -0,0 +1,169 @@
+//===----------------------------------------------------------------------===//
+//
+//                         Peloton
+//
+// zone_map_test.cpp
+//
+// Identification: tests/storage/zone_map_test.cpp
+//
+// Copyright (c) 2015-16, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+
+#include "harness.h"
+
+#include "backend/common/value_factory.h"
+#include "backend/concurrency/transaction_manager_factory.h"
+#include "backend/executor/executor_context.h"
+#include "backend/executor/logical_tile.h"
+#include "backend/executor/seq_scan_executor.h"
+#include "backend/expression/comparison_expression.h"
+#include "backend/expression/constant_value_expression.h"
+#include "backend/expression/tuple_value_expression.h"
+#include "backend/planner/seq_scan_plan.h"
+#include "backend/storage/data_table.h"
+#include "backend/storage/tile_group.h"
+#include "backend/storage/tuple.h"
+#include "backend/storage/zone_map.h"
+
+#include "executor/executor_tests_util.h"
+
+namespace peloton {
+namespace test {
+
+//===--------------------------------------------------------------------===//
+// Zone Map Tests
+//===--------------------------------------------------------------------===//
+
+class ZoneMapTests : public PelotonTest {};
+
+// Two full tile groups and one still taking inserts, COL_A is 10 * row
+static storage::DataTable *CreateAndPopulateTable() {
+  const int tuple_count = 100;
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  txn_manager.BeginTransaction();
+  auto data_table = ExecutorTestsUtil::CreateTable(tuple_count, false);
+  ExecutorTestsUtil::PopulateTable(data_table,
+                                   tuple_count * 2 + tuple_count / 2, false,
+                                   false, false);
+  txn_manager.CommitTransaction();
+  return data_table;
+}
+
+static bool MightMatch(storage::TileGroup *tile_group,
+                       ExpressionType comparison, int constant) {
+  return tile_group->GetZoneMap()->MightMatch(
+      0, comparison, ValueFactory::GetIntegerValue(constant));
+}
+
+TEST_F(ZoneMapTests, SkipTest) {
+  std::unique_ptr<storage::DataTable> data_table(CreateAndPopulateTable());
+  auto tile_group_ids = data_table->GetTileGroupIds();
+  EXPECT_EQ(tile_group_ids.size(), 3);
+
+  auto tile_group = data_table->GetTileGroupById(tile_group_ids[0]);
+  auto zone_map = tile_group->GetZoneMap();
+  EXPECT_EQ(zone_map->GetMinValue(0).Compare(ValueFactory::GetIntegerValue(0)),
+            0);
+  EXPECT_EQ(
+      zone_map->GetMaxValue(0).Compare(ValueFactory::GetIntegerValue(990)), 0);
+  EXPECT_EQ(zone_map->GetNullCount(0), 0);
+  EXPECT_TRUE(zone_map->IsTracked(2));
+  EXPECT_FALSE(zone_map->IsTracked(3));
+
+  EXPECT_TRUE(
+      MightMatch(tile_group.get(), EXPRESSION_TYPE_COMPARE_EQUAL, 985));
+  EXPECT_FALSE(
+      MightMatch(tile_group.get(), EXPRESSION_TYPE_COMPARE_EQUAL, 1000));
+  EXPECT_FALSE(
+      MightMatch(tile_group.get(), EXPRESSION_TYPE_COMPARE_LESSTHAN, 0));
+  EXPECT_TRUE(MightMatch(tile_group.get(),
+                         EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO, 0));
+  EXPECT_FALSE(
+      MightMatch(tile_group.get(), EXPRESSION_TYPE_COMPARE_GREATERTHAN, 990));
+  EXPECT_TRUE(MightMatch(tile_group.get(),
+                         EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO, 990));
+  EXPECT_TRUE(
+      MightMatch(tile_group.get(), EXPRESSION_TYPE_COMPARE_NOTEQUAL, 0));
+
+  // Only the last tile group holds the tuples the scan is after
+  for (oid_t tile_group_itr = 0; tile_group_itr < 3; tile_group_itr++) {
+    auto scanned_tile_group =
+        data_table->GetTileGroupById(tile_group_ids[tile_group_itr]);
+    EXPECT_EQ(MightMatch(scanned_tile_group.get(),
+                         EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO, 2300),
+              tile_group_itr == 2);
+  }
+
+  auto &txn_manager = concurrency::TransactionManagerFactory::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  std::unique_ptr<executor::ExecutorContext> context(
+      new executor::ExecutorContext(txn));
+
+  // COL_A >= 2300, written the other way round
+  auto predicate = new expression::ComparisonExpression<expression::CmpLte>(
+      EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO,
+      new expression::ConstantValueExpression(
+          ValueFactory::GetIntegerValue(2300)),
+      new expression::TupleValueExpression(VALUE_TYPE_INTEGER, 0, 0));
+  std::vector<oid_t> column_ids = {0, 1};
+  planner::SeqScanPlan seq_scan_node(data_table.get(), predicate, column_ids);
+  executor::SeqScanExecutor seq_scan_executor(&seq_scan_node, context.get());
+
+  EXPECT_TRUE(seq_scan_executor.Init());
+  int tuple_count = 0;
+  while (seq_scan_executor.Execute()) {
+    std::unique_ptr<executor::LogicalTile> result_logical_tile(
+        seq_scan_executor.GetOutput());
+    tuple_count += result_logical_tile->GetTupleCount();
+  }
+  txn_manager.CommitTransaction();
+
+  EXPECT_EQ(tuple_count, 20);
+}
+
+TEST_F(ZoneMapTests, RecomputeTest) {
+  std::unique_ptr<storage::DataTable> data_table(CreateAndPopulateTable());
+  auto tile_group_ids = data_table->GetTileGroupIds();
+  auto tile_group = data_table->GetTileGroupById(tile_group_ids[0]);
+  auto zone_map = tile_group->GetZoneMap();
+  EXPECT_TRUE(zone_map->Recompute(tile_group.get()));
+  EXPECT_FALSE(zone_map->NeedsRecompute());
+
+  // Overwriting a slot only widens the synopses
+  std::unique_ptr<storage::Tuple> tuple(
+      new storage::Tuple(data_table->GetSchema(), true));
+  auto testing_pool = TestingHarness::GetInstance().GetTestingPool();
+  tile_group->CopyTuple(0, tuple.get());
+  tuple->SetValue(0, ValueFactory::GetIntegerValue(5000), testing_pool);
+  tile_group->CopyTuple(tuple.get(), 0);
+  tuple->SetValue(0, ValueFactory::GetIntegerValue(0), testing_pool);
+  tile_group->CopyTuple(tuple.get(), 0);
+
+  EXPECT_TRUE(zone_map->NeedsRecompute());
+  EXPECT_TRUE(
+      MightMatch(tile_group.get(), EXPRESSION_TYPE_COMPARE_EQUAL, 5000));
+
+  // and recomputing shrinks them back
+  EXPECT_TRUE(zone_map->Recompute(tile_group.get()));
+  EXPECT_FALSE(zone_map->NeedsRecompute());
+  EXPECT_FALSE(
+      MightMatch(tile_group.get(), EXPRESSION_TYPE_COMPARE_EQUAL, 5000));
+  EXPECT_EQ(
+      zone_map->GetMaxValue(0).Compare(ValueFactory::GetIntegerValue(990)), 0);
+
+  // A swapped in copy of the tile group gets the same synopses
+  auto frozen_tile_group = data_table->FreezeTileGroupById(tile_group_ids[1]);
+  EXPECT_NE(frozen_tile_group, nullptr);
+  EXPECT_EQ(frozen_tile_group->GetZoneMap()->GetMinValue(0).Compare(
+                ValueFactory::GetIntegerValue(1000)),
+            0);
+  EXPECT_EQ(frozen_tile_group->GetZoneMap()->GetMaxValue(0).Compare(
+                ValueFactory::GetIntegerValue(1990)),
+            0);
+}
+
+}  // End test namespace
+}  // End peloton namespace